@@ -18,6 +18,53 @@ typedef struct splinter_header_snapshot {
     @brief Diagnostics: counts of parse failures reported by clients / harnesses
     uint64_t parse_failures;
     uint64_t last_failure_epoch;
+
+    @brief Longest probe distance of any key; a miss reads at most max_probe + 1 slots.
+    uint32_t max_probe;
+    @brief Key hash function (SPLINTER_HASH_*).
+    uint32_t hash_alg;
+    @brief Hash seed (0 for unseeded hash functions).
+    uint64_t hash_seed;
+    @brief Size of the shared value arena (0 = fixed per-slot values).
+    uint64_t arena_sz;
+    @brief Arena bytes carved into blocks so far.
+    uint64_t arena_used;
+    @brief Records in the change feed ring (0 = no feed).
+    uint64_t feed_len;
+    @brief Changes appended to the feed so far.
+    uint64_t feed_head;
+    @brief Mapping flags the store was created with (SPLINTER_MAP_*).
+    uint32_t map_flags;
+    @brief Slots in use, counting deleted-key tombstones.
+    uint32_t used_slots;
+    @brief Keys stored.
+    uint64_t keys;
+    @brief Size the store's backing object may grow to by resizing.
+    uint64_t max_size;
+    @brief Resize generation; odd while keys are being moved to a new table.
+    uint32_t gen;
+    @brief Non-zero if values carry CRC32C checksums (see splinter_verify()).
+    uint32_t checksums;
+    @brief Records in the expiry log (0 = none; see splinter_reap()).
+    uint64_t expiry_log_len;
+    @brief Expired keys deleted so far.
+    uint64_t expired;
+    @brief Live keys evicted to make room in a full store.
+    uint64_t evicted;
+    @brief What writes to a full store do (SPLINTER_EVICT_*).
+    uint32_t evict_policy;
+    @brief Non-zero if the store keeps an ordered key index.
+    uint32_t key_index;
+    @brief Floats per key embedding (0 = no embeddings; see splinter_knn()).
+    uint32_t embed_dim;
+    @brief HNSW neighbours per node (0 = no graph; see splinter_ann()).
+    uint32_t ann_m;
+    @brief Candidates each graph insert searches.
+    uint32_t ann_ef_construction;
+    @brief Candidates splinter_ann() searches when not told.
+    uint32_t ann_ef_search;
+    @brief The metric the graph is built for (SPLINTER_METRIC_*).
+    uint32_t ann_metric;
 } splinter_header_snapshot_t;
 */
 
@@ -29,17 +76,40 @@ export type SplinterHeaderSnapshot = {
     epoch: bigint,  
     auto_vacuum: number,
     parse_failures: bigint,
-    last_failure_epoch: bigint
+    last_failure_epoch: bigint,
+    max_probe: number,
+    hash_alg: number,
+    hash_seed: bigint,
+    arena_sz: bigint,
+    arena_used: bigint,
+    feed_len: bigint,
+    feed_head: bigint,
+    map_flags: number,
+    used_slots: number,
+    keys: bigint,
+    max_size: bigint,
+    gen: number,
+    checksums: number,
+    expiry_log_len: bigint,
+    expired: bigint,
+    evicted: bigint,
+    evict_policy: number,
+    key_index: number,
+    embed_dim: number,
+    ann_m: number,
+    ann_ef_construction: number,
+    ann_ef_search: number,
+    ann_metric: number
 };
 
 /*
 typedef struct splinter_slot_snapshot {
-    @brief The FNV-1a hash of the key. 0 indicates an empty slot. 
+    @brief The hash of the key. 0 = never used, 1 = deleted (tombstone). 
     uint64_t hash;
     @brief Per-slot epoch, incremented on write to this slot. Used for polling. 
     uint64_t epoch;
     @brief Offset into the VALUES region where the value data is stored. 
-    uint32_t val_off;
+    uint64_t val_off;
     @brief The actual length of the stored value data (atomic). 
     uint32_t val_len;
     @brief The null-terminated key string. 
@@ -50,7 +120,50 @@ typedef struct splinter_slot_snapshot {
 export type SplinterSlotSnapshot = {
     hash: bigint,
     epoch: bigint,
-    val_off: number,
+    val_off: bigint,
     val_len: number,
     key: string
-};
\ No newline at end of file
+};
+
+/*
+typedef struct splinter_change {
+    @brief Position in the feed, counting from 1.
+    uint64_t seq;
+    @brief The slot's epoch right after the change.
+    uint64_t epoch;
+    @brief Hash of the key that changed.
+    uint64_t hash;
+    @brief Index of the slot that changed.
+    uint32_t slot;
+    @brief SPLINTER_CHANGE_SET (1) or SPLINTER_CHANGE_UNSET (2).
+    uint32_t op;
+    @brief The key, for a set the slot still holds; empty otherwise.
+    char key[KEY_MAX];
+} splinter_change_t;
+*/
+
+export type SplinterChange = {
+    seq: bigint,
+    epoch: bigint,
+    hash: bigint,
+    slot: number,
+    op: "set" | "unset",
+    key: string
+};
+
+/*
+typedef struct splinter_knn_hit {
+    @brief The key.
+    char key[KEY_MAX];
+    @brief Its score under the metric asked for (a distance for SPLINTER_METRIC_L2).
+    float score;
+    @brief The slot epoch the embedding was read at.
+    uint64_t epoch;
+} splinter_knn_hit_t;
+*/
+
+export type SplinterKnnHit = {
+    key: string,
+    score: number,
+    epoch: bigint
+};
@@ -3,7 +3,7 @@
  * License: MIT
  */
 import { Libsplinter } from "./splinter_deno_ffi.ts";
-import { SplinterHeaderSnapshot, SplinterSlotSnapshot } from "./ffi_types.ts";
+import { SplinterChange, SplinterHeaderSnapshot, SplinterKnnHit, SplinterSlotSnapshot } from "./ffi_types.ts";
 
 export class Splinter {
   private isOpen = false;
@@ -123,6 +123,37 @@ export class Splinter {
     return ret;
   }
 
+  /**
+   * Set what writes to a full store do: 0 = fail, 1 = evict by CLOCK,
+   * 2 = evict the soonest to expire, 3 = evict the oldest write
+   * @param policy one of the SPLINTER_EVICT_* values
+   * @throws if not connected or the policy is unknown
+   */
+  setEvictPolicy(policy: number) : void {
+    if (! this.isOpen) {
+      throw new Error("You must be connected to set the eviction policy");
+    }
+    if (Libsplinter.symbols.splinter_set_evict_policy(policy) < 0) {
+      throw new Error(`Unknown eviction policy ${policy}`);
+    }
+  }
+
+  /**
+   * Get the eviction policy of the connected bus
+   * @returns number
+   * @throws if not connected
+   */
+  getEvictPolicy() : number {
+    if (! this.isOpen) {
+      throw new Error("You must be connected to get the eviction policy");
+    }
+    const ret = Libsplinter.symbols.splinter_get_evict_policy();
+    if (ret < 0) {
+      throw new Error("Error getting the eviction policy");
+    }
+    return ret;
+  }
+
   /**
    * Sets or updates a key-value pair in the store.
    * @param key The key string
@@ -155,6 +186,204 @@ export class Splinter {
     }
   }
 
+  /**
+   * Sets a key only if its slot epoch is still the one it was read at (as
+   * returned by getSlotSnapshot()), for optimistic read-modify-write.
+   * @param key The key string
+   * @param epoch The epoch the value was read at, or 0n to only create the key
+   * @param value The value (encoded as for set())
+   * @returns true if the key was set, false if it changed since (or a write
+   * was in progress)
+   */
+  setIfEpoch(key: string, epoch: bigint, value: string | Uint8Array): boolean {
+    this.checkOpen();
+
+    const keyBuffer = new TextEncoder().encode(key + '\0');
+    const valueData = typeof value === 'string' ? new TextEncoder().encode(value) : value;
+    return Libsplinter.symbols.splinter_set_if_epoch(keyBuffer, epoch, valueData,
+      BigInt(valueData.length)) === 0;
+  }
+
+  /**
+   * Appends to a key's value (creating the key if needed). Only the new
+   * bytes are written, so streaming a value costs O(length), not O(length²).
+   * @param key The key string
+   * @param value The bytes (or string) to append
+   * @throws Error if operation fails (e.g., value would exceed max size)
+   */
+  append(key: string, value: string | Uint8Array): void {
+    this.checkOpen();
+
+    const keyBuffer = new TextEncoder().encode(key + '\0');
+    const valueData = typeof value === 'string' ? new TextEncoder().encode(value) : value;
+
+    const result = Libsplinter.symbols.splinter_append(keyBuffer, valueData, BigInt(valueData.length));
+    if (result !== 0) {
+      throw new Error(`Failed to append to key: ${key}`);
+    }
+  }
+
+  /**
+   * Stores a 64-bit integer, making the key an integer key.
+   * @param key The key string
+   * @param value The value
+   * @throws Error if operation fails (e.g., store is full)
+   */
+  setInt(key: string, value: bigint | number): void {
+    this.checkOpen();
+
+    const keyBuffer = new TextEncoder().encode(key + '\0');
+    if (Libsplinter.symbols.splinter_set_int(keyBuffer, BigInt(value)) !== 0) {
+      throw new Error(`Failed to set key: ${key}`);
+    }
+  }
+
+  /**
+   * Reads an integer key.
+   * @param key The key to look up
+   * @returns The value, or null if the key was not found or isn't an integer key
+   */
+  getInt(key: string): bigint | null {
+    this.checkOpen();
+
+    const keyBuffer = new TextEncoder().encode(key + '\0');
+    const out = new BigInt64Array(1);
+    return Libsplinter.symbols.splinter_get_int(keyBuffer, out) === 0 ? out[0] : null;
+  }
+
+  /**
+   * Sets an integer key to value if its current value compares to cmp as
+   * asked (equal, less than, greater than), atomically.
+   * @param op The comparison
+   * @param key The key string
+   * @param cmp What to compare the current value with
+   * @param value The new value
+   * @returns true if the key was set, false if the comparison failed, the
+   * key is missing or isn't an integer key, or a write was in progress
+   */
+  setIfInt(op: "eq" | "lt" | "gt", key: string, cmp: bigint | number, value: bigint | number): boolean {
+    this.checkOpen();
+
+    const keyBuffer = new TextEncoder().encode(key + '\0');
+    return Libsplinter.symbols[`splinter_set_if_${op}`](keyBuffer, BigInt(cmp), BigInt(value)) === 0;
+  }
+
+  /**
+   * Atomically adds to an integer key, creating it as 0 if needed.
+   * @param key The key string
+   * @param delta Amount to add (default: 1)
+   * @returns The new value
+   * @throws Error if the key holds a non-integer value
+   */
+  incr(key: string, delta: bigint | number = 1): bigint {
+    return this.intOp("splinter_incr", key, BigInt(delta));
+  }
+
+  /**
+   * Atomically subtracts from an integer key, creating it as 0 if needed.
+   * @param key The key string
+   * @param delta Amount to subtract (default: 1)
+   * @returns The new value
+   * @throws Error if the key holds a non-integer value
+   */
+  decr(key: string, delta: bigint | number = 1): bigint {
+    return this.intOp("splinter_decr", key, BigInt(delta));
+  }
+
+  /**
+   * Atomically ANDs, ORs or XORs a mask into an integer key.
+   * @param op The operation
+   * @param key The key string
+   * @param mask The mask
+   * @returns The value before the operation
+   * @throws Error if the key holds a non-integer value
+   */
+  fetchBitwise(op: "and" | "or" | "xor", key: string, mask: bigint | number): bigint {
+    return this.intOp(`splinter_fetch_${op}`, key, BigInt.asUintN(64, BigInt(mask)));
+  }
+
+  private intOp(
+    fn: "splinter_incr" | "splinter_decr" | "splinter_fetch_and" | "splinter_fetch_or" | "splinter_fetch_xor",
+    key: string,
+    arg: bigint
+  ): bigint {
+    this.checkOpen();
+
+    const keyBuffer = new TextEncoder().encode(key + '\0');
+    const out = new BigInt64Array(1);
+    if (Libsplinter.symbols[fn](keyBuffer, arg, out) !== 0) {
+      throw new Error(`Integer operation failed on key: ${key}`);
+    }
+    return out[0];
+  }
+
+  /**
+   * Sets a key to the concatenation of several pieces, without joining them
+   * into one buffer first (see splinter_setv).
+   * @param key The key string
+   * @param parts The pieces of the value, in order
+   * @throws Error if operation fails (e.g., store is full)
+   */
+  setParts(key: string, parts: Uint8Array[]): void {
+    this.checkOpen();
+
+    const keyBuffer = new TextEncoder().encode(key + '\0');
+    // struct iovec { void *iov_base; size_t iov_len; }
+    const iov = new BigUint64Array(parts.length * 2);
+    parts.forEach((part, i) => {
+      iov[i * 2] = BigInt(Deno.UnsafePointer.value(Deno.UnsafePointer.of(<BufferSource> part)));
+      iov[i * 2 + 1] = BigInt(part.length);
+    });
+
+    const result = Libsplinter.symbols.splinter_setv(keyBuffer, iov, parts.length);
+    if (result !== 0) {
+      throw new Error(`Failed to set key: ${key}`);
+    }
+  }
+
+  /**
+   * Sets several key-value pairs in one call (see splinter_mset). Values are
+   * encoded as for set().
+   * @param entries The keys and values to write
+   * @returns The keys that could not be written (empty if all were)
+   */
+  mset(entries: Record<string, string | Uint8Array | unknown>): string[] {
+    this.checkOpen();
+
+    const keys = Object.keys(entries);
+    const n = keys.length;
+    const keyBuffers = keys.map((k) => new TextEncoder().encode(k + '\0'));
+    const values = keys.map((k) => {
+      const value = entries[k];
+      if (typeof value === 'string') return new TextEncoder().encode(value);
+      if (value instanceof Uint8Array) return value;
+      return new TextEncoder().encode(JSON.stringify(value));
+    });
+    const lens = BigUint64Array.from(values, (v) => BigInt(v.length));
+    const errs = new Int32Array(n);
+
+    const result = Libsplinter.symbols.splinter_mset(
+      Splinter.pointerArray(keyBuffers),
+      Splinter.pointerArray(values),
+      lens,
+      BigInt(n),
+      errs
+    );
+    if (result < 0) {
+      throw new Error("Failed to set keys");
+    }
+
+    return keys.filter((_, i) => errs[i] !== 0);
+  }
+
+  /**
+   * Builds a C array of pointers to the given buffers.
+   */
+  private static pointerArray(buffers: Uint8Array[]): BigUint64Array {
+    return BigUint64Array.from(buffers, (b) =>
+      BigInt(Deno.UnsafePointer.value(Deno.UnsafePointer.of(<BufferSource> b))));
+  }
+
   /**
    * Removes a key-value pair from the store.
    * @param key The key to remove
@@ -219,6 +448,87 @@ export class Splinter {
     return buffer;
   }
 
+  /**
+   * Retrieves the raw bytes for several keys in one call (see splinter_mget).
+   * @param keys The keys to look up
+   * @returns One entry per key: its value, or null if it was not found (or
+   * was being written at the time)
+   * @throws Error if operation fails
+   */
+  mgetRaw(keys: string[]): (Uint8Array | null)[] {
+    this.checkOpen();
+
+    const n = keys.length;
+    const keyBuffers = keys.map((k) => new TextEncoder().encode(k + '\0'));
+    const keyPtrs = Splinter.pointerArray(keyBuffers);
+    const sizes = new BigUint64Array(n);
+    const errs = new Int32Array(n);
+
+    // First call to get the sizes
+    let result = Libsplinter.symbols.splinter_mget(keyPtrs, BigInt(n), null, null, sizes, errs);
+    if (result < 0) {
+      throw new Error("Failed to get keys");
+    }
+
+    // Second call to get the actual data
+    const buffers = keys.map((_, i) => new Uint8Array(Number(sizes[i])));
+    const bufSizes = BigUint64Array.from(sizes);
+    result = Libsplinter.symbols.splinter_mget(
+      keyPtrs,
+      BigInt(n),
+      Splinter.pointerArray(buffers),
+      bufSizes,
+      sizes,
+      errs
+    );
+    if (result < 0) {
+      throw new Error("Failed to get keys");
+    }
+
+    return buffers.map((buf, i) => errs[i] === 0 ? buf.subarray(0, Number(sizes[i])) : null);
+  }
+
+  /**
+   * Runs a callback over a key's value in shared memory, without copying it.
+   * The view is only good for the duration of the callback; if a writer
+   * touched the key meanwhile, the result is discarded and the callback runs
+   * again on the new value.
+   * @param key The key to look up
+   * @param fn Consumes the value bytes (must not keep a reference to them)
+   * @param retries How many times to try before giving up (default: 16)
+   * @returns Whatever fn returned for a consistent view, or null if the key
+   * was not found (or kept changing)
+   */
+  withView<T>(key: string, fn: (view: Uint8Array) => T, retries = 16): T | null {
+    this.checkOpen();
+
+    const keyBuffer = new TextEncoder().encode(key + '\0');
+    const ptrOut = new BigUint64Array(1);
+    const lenOut = new BigUint64Array(1);
+    const epochOut = new BigUint64Array(1);
+
+    for (let i = 0; i < retries; i++) {
+      const result = Libsplinter.symbols.splinter_get_view(
+        keyBuffer,
+        Deno.UnsafePointer.of(ptrOut),
+        Deno.UnsafePointer.of(lenOut),
+        Deno.UnsafePointer.of(epochOut)
+      );
+      if (result !== 0) continue; // missing, or mid-write
+
+      const len = Number(lenOut[0]);
+      const ptr = Deno.UnsafePointer.create(ptrOut[0]);
+      const view = len === 0 || ptr === null
+        ? new Uint8Array(0)
+        : new Uint8Array(Deno.UnsafePointerView.getArrayBuffer(ptr, len));
+      const out = fn(view);
+      if (Libsplinter.symbols.splinter_view_valid(keyBuffer, epochOut[0]) === 1) {
+        return out;
+      }
+    }
+    return null;
+  }
+
   /**
    * Retrieves a value as a string.
    * @param key The key to look up
@@ -277,6 +587,197 @@ export class Splinter {
     return keys;
   }
 
+  /**
+   * Computes the combined bloom mask of some tags (see splinter_tag_mask).
+   */
+  private static tagMask(tags: string[]): bigint {
+    let mask = 0n;
+    for (const t of tags) {
+      mask |= Libsplinter.symbols.splinter_tag_mask(new TextEncoder().encode(t + '\0'));
+    }
+    return mask;
+  }
+
+  /**
+   * Adds tags to an existing key, or replaces its tags with these.
+   * @param key The key string
+   * @param tags Tags such as "session:42"
+   * @param replace Replace the key's tags instead of adding to them
+   * @throws Error if the key doesn't exist
+   */
+  tag(key: string, tags: string[], replace = false): void {
+    this.checkOpen();
+
+    const keyBuffer = new TextEncoder().encode(key + '\0');
+    const mask = Splinter.tagMask(tags);
+    const rc = replace ? Libsplinter.symbols.splinter_set_tags(keyBuffer, mask)
+                       : Libsplinter.symbols.splinter_add_tags(keyBuffer, mask);
+    if (rc !== 0) {
+      throw new Error(`Failed to tag key: ${key}`);
+    }
+  }
+
+  /**
+   * Reads a key's tag bloom.
+   * @param key The key to look up
+   * @returns The bloom bits, or null if the key was not found
+   */
+  getTags(key: string): bigint | null {
+    this.checkOpen();
+
+    const keyBuffer = new TextEncoder().encode(key + '\0');
+    const out = new BigUint64Array(1);
+    return Libsplinter.symbols.splinter_get_tags(keyBuffer, out) === 0 ? out[0] : null;
+  }
+
+  /**
+   * Lists the keys tagged with all of tags, from one SIMD scan of the
+   * store's tag blooms (splinter_find_tagged).
+   * @param tags Tags every key must have
+   * @param maxKeys Maximum number of keys to return (default: 1000)
+   * @returns Array of key strings
+   * @throws Error if the scan fails
+   */
+  findTagged(tags: string[], maxKeys = 1000): string[] {
+    this.checkOpen();
+
+    const mask = Splinter.tagMask(tags);
+    if (mask === 0n) return [];
+    // a resize in between leaves the bitmap too small: size it again
+    let bits = new BigUint64Array(0);
+    for (let tries = 0; ; tries++) {
+      bits = new BigUint64Array(Math.ceil(this.getBusHeaderSnapshot().slots / 64));
+      if (Libsplinter.symbols.splinter_find_tagged(mask, bits, BigInt(bits.length)) >= 0) break;
+      if (tries === 2) {
+        throw new Error("Failed to find tagged keys");
+      }
+    }
+
+    const outKeysPtr = new BigUint64Array(maxKeys);
+    const outCountPtr = new BigUint64Array(1);
+    if (Libsplinter.symbols.splinter_list_slots(bits, BigInt(bits.length), Deno.UnsafePointer.of(outKeysPtr),
+                                                BigInt(maxKeys), Deno.UnsafePointer.of(outCountPtr)) !== 0) {
+      throw new Error("Failed to list tagged keys");
+    }
+
+    const keys: string[] = [];
+    for (let i = 0; i < Number(outCountPtr[0]); i++) {
+      const strPtr = Deno.UnsafePointer.create(outKeysPtr[i]);
+      if (strPtr === null) {
+        throw new Error(`Invalid pointer at index ${i}`);
+      }
+      keys.push(new Deno.UnsafePointerView(strPtr).getCString());
+    }
+    return keys;
+  }
+
+  /**
+   * Sets a key's embedding vector, along with a new value if one is given.
+   * @param key The key string
+   * @param vector embed_dim floats (see the header snapshot)
+   * @param value A new value; without one the key must exist and keeps its value
+   * @throws Error if the store keeps no embeddings or the write fails
+   */
+  setEmbeddings(key: string, vector: number[] | Float32Array, value?: string | Uint8Array): void {
+    this.checkOpen();
+
+    const keyBuffer = new TextEncoder().encode(key + '\0');
+    const vec = Float32Array.from(vector);
+    const dim = this.getBusHeaderSnapshot().embed_dim;
+    if (vec.length !== dim) {
+      throw new Error(`Embedding must have ${dim} floats`);
+    }
+    let rc: number;
+    if (value === undefined) {
+      rc = Libsplinter.symbols.splinter_set_embeddings(keyBuffer, vec);
+    } else {
+      const valBuffer = typeof value === "string" ? new TextEncoder().encode(value) : value;
+      rc = Libsplinter.symbols.splinter_set_with_embeddings(keyBuffer, valBuffer, BigInt(valBuffer.length), vec);
+    }
+    if (rc !== 0) {
+      throw new Error(`Failed to set embedding for key: ${key}`);
+    }
+  }
+
+  /**
+   * Reads a key's embedding vector.
+   * @param key The key to look up
+   * @returns The vector, or null if the key doesn't exist or has none
+   */
+  getEmbeddings(key: string): Float32Array | null {
+    this.checkOpen();
+
+    const dim = this.getBusHeaderSnapshot().embed_dim;
+    if (dim === 0) return null;
+    const keyBuffer = new TextEncoder().encode(key + '\0');
+    const out = new Float32Array(dim);
+    return Libsplinter.symbols.splinter_get_embeddings(keyBuffer, out) === 0 ? out : null;
+  }
+
+  /**
+   * Finds the k keys whose embeddings are nearest to a vector, by a SIMD
+   * brute-force scan on every CPU (splinter_knn).
+   * @param query embed_dim floats
+   * @param k Most hits to return (default: 10)
+   * @param metric "cosine" (default), "dot" or "l2" (squared distance, lower is nearer)
+   * @returns Hits, nearest first
+   * @throws Error if the store keeps no embeddings or the search fails
+   */
+  knn(query: number[] | Float32Array, k = 10, metric: "dot" | "cosine" | "l2" = "cosine"): SplinterKnnHit[] {
+    this.checkOpen();
+
+    // splinter_knn_hit_t: key (64) + score (4, +4 pad) + epoch (8)
+    const HIT_SIZE = 80;
+    const out = new Uint8Array(HIT_SIZE * k);
+    const metrics = { dot: 0, cosine: 1, l2: 2 };
+    const n = Libsplinter.symbols.splinter_knn(Float32Array.from(query), BigInt(k), metrics[metric], 0, out);
+    if (n < 0) {
+      throw new Error("Failed to search embeddings");
+    }
+    return this.decodeHits(out, n);
+  }
+
+  /**
+   * Finds about the k keys whose embeddings are nearest to a vector, from the
+   * store's HNSW graph (splinter_ann), under the metric it was built for.
+   * @param query embed_dim floats
+   * @param k Most hits to return (default: 10)
+   * @param ef Candidates to search, at least k; 0 for the store's default
+   * @returns Hits, nearest first
+   * @throws Error if the store keeps no graph or the search fails
+   */
+  ann(query: number[] | Float32Array, k = 10, ef = 0): SplinterKnnHit[] {
+    this.checkOpen();
+
+    const HIT_SIZE = 80;
+    const out = new Uint8Array(HIT_SIZE * k);
+    const n = Libsplinter.symbols.splinter_ann(Float32Array.from(query), BigInt(k), ef, out);
+    if (n < 0) {
+      throw new Error("Failed to search the embedding graph");
+    }
+    return this.decodeHits(out, n);
+  }
+
+  /**
+   * Decodes n splinter_knn_hit_t records: key (64) + score (4, +4 pad) + epoch (8).
+   */
+  private decodeHits(out: Uint8Array, n: number): SplinterKnnHit[] {
+    const HIT_SIZE = 80;
+    const view = new DataView(out.buffer);
+    const hits: SplinterKnnHit[] = [];
+    for (let i = 0; i < n; i++) {
+      const base = i * HIT_SIZE;
+      const keyBytes = out.subarray(base, base + 64);
+      const end = keyBytes.indexOf(0);
+      hits.push({
+        key: new TextDecoder().decode(keyBytes.subarray(0, end < 0 ? 64 : end)),
+        score: view.getFloat32(base + 64, true),
+        epoch: view.getBigUint64(base + 72, true)
+      });
+    }
+    return hits;
+  }
+
   /**
    * Get a snapshot of a key-slot header by key name
    * @param key Name of the key owning the slot to snapshot
@@ -289,8 +790,9 @@ export class Splinter {
     const KEY_MAX = 64;
     
     // Calculate struct size:
-    // uint64_t (8) + uint64_t (8) + uint32_t (4) + uint32_t (4) + char[KEY_MAX]
-    const STRUCT_SIZE = 8 + 8 + 4 + 4 + KEY_MAX;
+    // uint64_t (8) + uint64_t (8) + uint64_t (8) + uint32_t (4) + char[KEY_MAX],
+    // padded to the struct's 8-byte alignment
+    const STRUCT_SIZE = 8 + 8 + 8 + 4 + KEY_MAX + 4;
     
     const snapshotBuffer = new Uint8Array(STRUCT_SIZE);
     const snapshotPtr = Deno.UnsafePointer.of(snapshotBuffer);
@@ -318,8 +820,8 @@ export class Splinter {
     offset += 8;
     const epoch = view.getBigUint64(offset, true);
     offset += 8;
-    const val_off = view.getUint32(offset, true);
-    offset += 4;
+    const val_off = view.getBigUint64(offset, true);
+    offset += 8;
     const val_len = view.getUint32(offset, true);
     offset += 4;
     
@@ -344,6 +846,83 @@ export class Splinter {
     };
   }
 
+  /**
+   * Gets the change feed's write cursor, to follow changes from now on with
+   * readChanges(). Take it before scanning the store, not after.
+   * @returns The cursor
+   * @throws Error if the store was created without a change feed
+   */
+  feedCursor(): bigint {
+    this.checkOpen();
+
+    const out = new BigUint64Array(1);
+    if (Libsplinter.symbols.splinter_feed_cursor(out) !== 0) {
+      throw new Error("Store has no change feed");
+    }
+    return out[0];
+  }
+
+  /**
+   * Reads the changes made since cursor (see splinter_feed_read).
+   * @param cursor Where the last read left off
+   * @param max Most changes to return at once (default: 64)
+   * @returns The changes and the cursor to continue from, or null if the
+   * reader fell too far behind and has to rescan the store
+   * @throws Error if the store was created without a change feed
+   */
+  readChanges(cursor: bigint, max = 64): { cursor: bigint; changes: SplinterChange[] } | null {
+    this.checkOpen();
+
+    // splinter_change_t: seq, epoch, hash (8 each) + slot, op (4 each) + key[64] = 96 bytes
+    const STRUCT_SIZE = 96;
+    const buffer = new Uint8Array(STRUCT_SIZE * max);
+    const cursorBuf = new BigUint64Array([cursor]);
+    const n = Libsplinter.symbols.splinter_feed_read(cursorBuf, buffer, BigInt(max));
+    if (n < 0) {
+      if (this.getBusHeaderSnapshot().feed_len === 0n) {
+        throw new Error("Store has no change feed");
+      }
+      return null;
+    }
+
+    const view = new DataView(buffer.buffer);
+    const decoder = new TextDecoder();
+    const changes: SplinterChange[] = [];
+    for (let i = 0; i < n; i++) {
+      const base = i * STRUCT_SIZE;
+      const keyBytes = buffer.subarray(base + 32, base + STRUCT_SIZE);
+      const keyEnd = keyBytes.indexOf(0);
+      changes.push({
+        seq: view.getBigUint64(base, true),
+        epoch: view.getBigUint64(base + 8, true),
+        hash: view.getBigUint64(base + 16, true),
+        slot: view.getUint32(base + 24, true),
+        op: view.getUint32(base + 28, true) === 2 ? "unset" : "set",
+        key: decoder.decode(keyBytes.subarray(0, keyEnd < 0 ? keyBytes.length : keyEnd)),
+      });
+    }
+    return { cursor: cursorBuf[0], changes };
+  }
+
+  /**
+   * Grows the store to the given number of slots while it stays in use
+   * (see splinter_resize). Keys are moved over before this returns.
+   * @param slots The new slot count (more than the store has now)
+   * @throws Error if the store can't grow that far, or another process is
+   * resizing it
+   */
+  resize(slots: number): void {
+    this.checkOpen();
+
+    const ret = Libsplinter.symbols.splinter_resize(BigInt(slots));
+    if (ret === -2) {
+      throw new Error(`Cannot resize to ${slots} slots (stores only grow)`);
+    }
+    if (ret !== 0) {
+      throw new Error(`Failed to resize to ${slots} slots`);
+    }
+  }
+
   /**
    * Get a snapshot of the atomic bus status and configuration structire
    * @returns SplinterHeaderSnapshot<>
@@ -351,10 +930,15 @@ export class Splinter {
    */
   getBusHeaderSnapshot(): SplinterHeaderSnapshot {
     this.checkOpen();
-    // Calculate the size of the C struct
-    // uint32_t (4 bytes) * 4 + uint64_t (8 bytes) * 3 + uint32_t (4 bytes) * 1
-    // = 16 + 24 + 4 = 44 bytes
-    const STRUCT_SIZE = 44;
+    // Calculate the size of the C struct, including alignment padding:
+    // uint32_t * 4 (16) + epoch (8) + auto_vacuum (4, +4 pad) + uint64_t * 2 (16)
+    // + max_probe (4) + hash_alg (4) + hash_seed (8) + arena_sz (8) + arena_used (8)
+    // + feed_len (8) + feed_head (8) + map_flags (4) + used_slots (4) + keys (8)
+    // + max_size (8) + gen (4) + checksums (4) + expiry_log_len (8) + expired (8)
+    // + evicted (8) + evict_policy (4) + key_index (4) + embed_dim (4) + ann_m (4)
+    // + ann_ef_construction (4) + ann_ef_search (4) + ann_metric (4, +4 pad)
+    // = 184 bytes
+    const STRUCT_SIZE = 184;
     const buffer = new Uint8Array(STRUCT_SIZE);
     const ptr = Deno.UnsafePointer.of(buffer);
     const result = Libsplinter.symbols.splinter_get_header_snapshot(ptr);
@@ -379,10 +963,56 @@ export class Splinter {
     const epoch = view.getBigUint64(offset, true);
     offset += 8;
     const auto_vacuum = view.getUint32(offset, true);
-    offset += 4;
+    offset += 8; // 4 + padding to align the next uint64_t
     const parse_failures = view.getBigUint64(offset, true);
     offset += 8;
     const last_failure_epoch = view.getBigUint64(offset, true);
+    offset += 8;
+    const max_probe = view.getUint32(offset, true);
+    offset += 4;
+    const hash_alg = view.getUint32(offset, true);
+    offset += 4;
+    const hash_seed = view.getBigUint64(offset, true);
+    offset += 8;
+    const arena_sz = view.getBigUint64(offset, true);
+    offset += 8;
+    const arena_used = view.getBigUint64(offset, true);
+    offset += 8;
+    const feed_len = view.getBigUint64(offset, true);
+    offset += 8;
+    const feed_head = view.getBigUint64(offset, true);
+    offset += 8;
+    const map_flags = view.getUint32(offset, true);
+    offset += 4;
+    const used_slots = view.getUint32(offset, true);
+    offset += 4;
+    const keys = view.getBigUint64(offset, true);
+    offset += 8;
+    const max_size = view.getBigUint64(offset, true);
+    offset += 8;
+    const gen = view.getUint32(offset, true);
+    offset += 4;
+    const checksums = view.getUint32(offset, true);
+    offset += 4;
+    const expiry_log_len = view.getBigUint64(offset, true);
+    offset += 8;
+    const expired = view.getBigUint64(offset, true);
+    offset += 8;
+    const evicted = view.getBigUint64(offset, true);
+    offset += 8;
+    const evict_policy = view.getUint32(offset, true);
+    offset += 4;
+    const key_index = view.getUint32(offset, true);
+    offset += 4;
+    const embed_dim = view.getUint32(offset, true);
+    offset += 4;
+    const ann_m = view.getUint32(offset, true);
+    offset += 4;
+    const ann_ef_construction = view.getUint32(offset, true);
+    offset += 4;
+    const ann_ef_search = view.getUint32(offset, true);
+    offset += 4;
+    const ann_metric = view.getUint32(offset, true);
     
     // Return the snapshot as a typed object
     return {
@@ -393,7 +1023,30 @@ export class Splinter {
       epoch,
       auto_vacuum,
       parse_failures,
-      last_failure_epoch
+      last_failure_epoch,
+      max_probe,
+      hash_alg,
+      hash_seed,
+      arena_sz,
+      arena_used,
+      feed_len,
+      feed_head,
+      map_flags,
+      used_slots,
+      keys,
+      max_size,
+      gen,
+      checksums,
+      expiry_log_len,
+      expired,
+      evicted,
+      evict_policy,
+      key_index,
+      embed_dim,
+      ann_m,
+      ann_ef_construction,
+      ann_ef_search,
+      ann_metric
     };
   }
 
@@ -421,6 +1074,26 @@ export class Splinter {
     }
   }
 
+  /**
+   * Creates a watch set: many keys waited on together with one call (see
+   * splinter_watch_create). Keys that don't exist yet are reported once
+   * they're created.
+   * @param keys The keys to watch
+   * @returns The watch set; close() it when done
+   * @throws Error if the watch set can't be created
+   */
+  watch(keys: string[] = []): SplinterWatch {
+    this.checkOpen();
+
+    const handle = Libsplinter.symbols.splinter_watch_create();
+    if (handle === null) {
+      throw new Error("Failed to create watch set");
+    }
+    const w = new SplinterWatch(handle);
+    w.add(keys);
+    return w;
+  }
+
   /**
    * Closes the splinter store and unmaps the shared memory region.
    * After calling this, the instance cannot be used anymore.
@@ -438,4 +1111,126 @@ export class Splinter {
   get opened(): boolean {
     return this.isOpen;
   }
-}
\ No newline at end of file
+}
+
+/**
+ * A set of keys waited on together (see Splinter.watch()).
+ */
+export class SplinterWatch {
+  constructor(private handle: Deno.PointerValue) {}
+
+  private static keyArray(keys: string[]): [Uint8Array[], BigUint64Array] {
+    const buffers = keys.map((k) => new TextEncoder().encode(k + '\0'));
+    const ptrs = BigUint64Array.from(buffers, (b) =>
+      BigInt(Deno.UnsafePointer.value(Deno.UnsafePointer.of(<BufferSource> b))));
+    return [buffers, ptrs];
+  }
+
+  private checkOpen(): void {
+    if (this.handle === null) {
+      throw new Error("Watch set is closed");
+    }
+  }
+
+  /**
+   * Adds keys to the set.
+   * @param keys The keys to add
+   * @throws Error if the keys could not be added
+   */
+  add(keys: string[]): void {
+    this.checkOpen();
+    if (keys.length === 0) return;
+
+    const [_buffers, ptrs] = SplinterWatch.keyArray(keys);
+    if (Libsplinter.symbols.splinter_watch_add(this.handle, ptrs, BigInt(keys.length)) !== 0) {
+      throw new Error("Failed to add keys to watch set");
+    }
+  }
+
+  /**
+   * Adds every key tagged with all of tags (keys tagged later aren't added).
+   * @param tags Tags such as "session:42"
+   * @returns How many keys were found
+   * @throws Error if the keys could not be added
+   */
+  addTagged(tags: string[]): number {
+    this.checkOpen();
+    if (tags.length === 0) return 0;
+
+    const [_buffers, ptrs] = SplinterWatch.keyArray(tags);
+    const n = Libsplinter.symbols.splinter_watch_add_tagged(this.handle, ptrs, BigInt(tags.length));
+    if (n < 0) {
+      throw new Error("Failed to add tagged keys to watch set");
+    }
+    return n;
+  }
+
+  /**
+   * Removes keys from the set.
+   * @param keys The keys to remove
+   * @returns How many of them were in the set
+   */
+  eject(keys: string[]): number {
+    this.checkOpen();
+    if (keys.length === 0) return 0;
+
+    const [_buffers, ptrs] = SplinterWatch.keyArray(keys);
+    return Libsplinter.symbols.splinter_watch_eject(this.handle, ptrs, BigInt(keys.length));
+  }
+
+  /**
+   * Waits for keys in the set to change.
+   * @param timeoutMs How long to wait (0 only collects what already changed)
+   * @param max Most keys to return at once (default: 64)
+   * @returns The keys that changed (each once), with their new slot epochs
+   * (0n for deleted keys); empty on timeout
+   */
+  wait(timeoutMs: number, max = 64): { key: string; epoch: bigint }[] {
+    this.checkOpen();
+
+    // splinter_watch_event_t: key[64] + epoch (8) = 72 bytes
+    const STRUCT_SIZE = 72;
+    const buffer = new Uint8Array(STRUCT_SIZE * max);
+    const n = Libsplinter.symbols.splinter_watch_wait(this.handle, BigInt(timeoutMs), buffer, BigInt(max));
+    if (n <= 0) return [];
+
+    const view = new DataView(buffer.buffer);
+    const decoder = new TextDecoder();
+    const out = [];
+    for (let i = 0; i < n; i++) {
+      const keyBytes = buffer.subarray(i * STRUCT_SIZE, i * STRUCT_SIZE + 64);
+      const keyEnd = keyBytes.indexOf(0);
+      out.push({
+        key: decoder.decode(keyBytes.subarray(0, keyEnd < 0 ? 64 : keyEnd)),
+        epoch: view.getBigUint64(i * STRUCT_SIZE + 64, true),
+      });
+    }
+    return out;
+  }
+
+  /**
+   * Gets an eventfd that becomes readable when keys in the set change, for
+   * event loops that poll file descriptors.
+   * @returns The file descriptor
+   * @throws Error if it can't be created
+   */
+  fd(): number {
+    this.checkOpen();
+
+    const fd = Libsplinter.symbols.splinter_watch_fd(this.handle);
+    if (fd < 0) {
+      throw new Error("Failed to get watch set fd");
+    }
+    return fd;
+  }
+
+  /**
+   * Frees the watch set. It can't be used afterwards.
+   */
+  close(): void {
+    if (this.handle !== null) {
+      Libsplinter.symbols.splinter_watch_destroy(this.handle);
+      this.handle = null;
+    }
+  }
+}
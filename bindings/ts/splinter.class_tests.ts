@@ -3,7 +3,7 @@
  * Could use more comprehensive (assertThrows style) tests, too.
  * Run with: deno test --allow-ffi
  */
-import { assertEquals, assert, assertLessOrEqual } from "https://deno.land/std@0.208.0/assert/mod.ts";
+import { assertEquals, assert, assertLessOrEqual, assertThrows } from "https://deno.land/std@0.208.0/assert/mod.ts";
 import { Splinter } from "./splinter.class.ts";
 import { assertGreaterOrEqual } from "https://deno.land/std@0.208.0/assert/assert_greater_or_equal.ts";
 
@@ -37,6 +37,139 @@ Deno.test({
   },
 });
 
+// read a value in place
+Deno.test({
+  name: "Zero-copy view of a value (2 Operations / 2 Tests)",
+  fn: () => {
+    cleanup();
+    const splinter = Splinter.createOrOpen(TEST_STORE, TEST_SLOTS, TEST_MAX_VALUE_SIZE);
+    splinter.set("__test", "stage:v");
+    const seen = splinter.withView("__test", (view) => new TextDecoder().decode(view));
+    assertEquals(seen, "stage:v");
+    assertEquals(splinter.withView("__missing", (view) => view.length), null);
+    splinter.unset("__test");
+    splinter.close();
+  },
+});
+
+// batch set / get
+Deno.test({
+  name: "Batched set and get (2 Operations / 3 Tests)",
+  fn: () => {
+    cleanup();
+    const splinter = Splinter.createOrOpen(TEST_STORE, TEST_SLOTS, TEST_MAX_VALUE_SIZE);
+    assertEquals(splinter.mset({ "__b1": "one", "__b2": "two" }), []);
+    const [one, missing, two] = splinter.mgetRaw(["__b1", "__missing", "__b2"]);
+    assertEquals(new TextDecoder().decode(one!), "one");
+    assertEquals(missing, null);
+    assertEquals(new TextDecoder().decode(two!), "two");
+    splinter.unset("__b1");
+    splinter.unset("__b2");
+    splinter.close();
+  },
+});
+
+// gathered set
+Deno.test({
+  name: "Set a value from parts (1 Operation / 1 Test)",
+  fn: () => {
+    cleanup();
+    const splinter = Splinter.createOrOpen(TEST_STORE, TEST_SLOTS, TEST_MAX_VALUE_SIZE);
+    const enc = new TextEncoder();
+    splinter.setParts("__parts", [enc.encode("head:"), enc.encode("body"), enc.encode(":tail")]);
+    assertEquals(splinter.getString("__parts"), "head:body:tail");
+    splinter.unset("__parts");
+    splinter.close();
+  },
+});
+
+// streaming append
+Deno.test({
+  name: "Append to a value (2 Operations / 1 Test)",
+  fn: () => {
+    cleanup();
+    const splinter = Splinter.createOrOpen(TEST_STORE, TEST_SLOTS, TEST_MAX_VALUE_SIZE);
+    splinter.append("__stream", "Hello");
+    splinter.append("__stream", ", world");
+    assertEquals(splinter.getString("__stream"), "Hello, world");
+    splinter.unset("__stream");
+    splinter.close();
+  },
+});
+
+// integer keys
+Deno.test({
+  name: "Atomic integer keys (4 Operations / 3 Tests)",
+  fn: () => {
+    cleanup();
+    const splinter = Splinter.createOrOpen(TEST_STORE, TEST_SLOTS, TEST_MAX_VALUE_SIZE);
+    splinter.unset("__count");
+    assertEquals(splinter.incr("__count", 5), 5n);
+    assertEquals(splinter.decr("__count"), 4n);
+    assertEquals(splinter.fetchBitwise("or", "__count", 0x10), 4n);
+    assertEquals(splinter.getInt("__count"), 0x14n);
+    splinter.unset("__count");
+    splinter.close();
+  },
+});
+
+// conditional sets
+Deno.test({
+  name: "Conditional sets (4 Operations / 4 Tests)",
+  fn: () => {
+    cleanup();
+    const splinter = Splinter.createOrOpen(TEST_STORE, TEST_SLOTS, TEST_MAX_VALUE_SIZE);
+    splinter.set("__cas", "old");
+    const { epoch } = splinter.getSlotSnapshot("__cas");
+    assertEquals(splinter.setIfEpoch("__cas", epoch, "new"), true);
+    assertEquals(splinter.setIfEpoch("__cas", epoch, "stale"), false);
+    splinter.setInt("__level", 3);
+    assertEquals(splinter.setIfInt("lt", "__level", 3, 9), false);
+    assertEquals(splinter.setIfInt("eq", "__level", 3, 9), true);
+    splinter.unset("__cas");
+    splinter.unset("__level");
+    splinter.close();
+  },
+});
+
+// multi-key watch
+Deno.test({
+  name: "Watch several keys at once (3 Operations / 3 Tests)",
+  fn: () => {
+    cleanup();
+    const splinter = Splinter.createOrOpen(TEST_STORE, TEST_SLOTS, TEST_MAX_VALUE_SIZE);
+    splinter.set("__w1", "a");
+    const w = splinter.watch(["__w1", "__w2"]);
+    assertEquals(w.wait(0), []);
+    splinter.set("__w1", "b");
+    splinter.set("__w2", "c");
+    assertEquals(w.wait(100).map((e) => e.key), ["__w1", "__w2"]);
+    assertEquals(w.eject(["__w1", "__w2"]), 2);
+    w.close();
+    splinter.unset("__w1");
+    splinter.unset("__w2");
+    splinter.close();
+  },
+});
+
+// online resize
+Deno.test({
+  name: "Resize a store in place (3 Operations / 4 Tests)",
+  fn: () => {
+    cleanup();
+    const splinter = Splinter.createOrOpen(TEST_STORE, TEST_SLOTS, TEST_MAX_VALUE_SIZE);
+    splinter.set("__grow", "still here");
+    splinter.resize(TEST_SLOTS * 4);
+    const snapshot = splinter.getBusHeaderSnapshot();
+    assertEquals(snapshot.slots, TEST_SLOTS * 4);
+    assertEquals(snapshot.keys, 1n);
+    assertEquals(splinter.getString("__grow"), "still here");
+    assertThrows(() => splinter.resize(TEST_SLOTS));
+    splinter.close();
+    cleanup();
+  },
+});
+
 // get splinter bus header 
 Deno.test({
   name: "Get global atomic bus config snapshot - returns header information (2 Operations / 5 Tests)",
@@ -50,6 +183,8 @@ Deno.test({
     assertEquals(snapshot.slots, TEST_SLOTS);
     assertEquals(snapshot.max_val_sz, TEST_MAX_VALUE_SIZE);
     assert(snapshot.epoch !== undefined);
+    assertEquals(snapshot.feed_len, 0n); // created without a change feed
+    assertEquals(snapshot.map_flags, 0); // nor any mapping flags
     
     splinter.close();
     cleanup();
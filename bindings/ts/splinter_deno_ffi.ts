@@ -9,6 +9,10 @@ export const Libsplinter = Deno.dlopen("../../libsplinter.so", {
   "splinter_create": {
     parameters: ["buffer", "usize", "usize"],
     result: "i32",
+  },
+  "splinter_create_ex": {
+    parameters: ["buffer", "buffer"],
+    result: "i32",
   },
     "splinter_create_or_open": {
     parameters: ["buffer", "usize", "usize"],
@@ -34,14 +38,170 @@ export const Libsplinter = Deno.dlopen("../../libsplinter.so", {
     parameters: ["buffer", "pointer", "usize", "pointer"],
     result: "i32",
   },
+  "splinter_setv": {
+    parameters: ["buffer", "buffer", "i32"],
+    result: "i32",
+  },
+  "splinter_set_if_epoch": {
+    parameters: ["buffer", "u64", "buffer", "usize"],
+    result: "i32",
+  },
+  "splinter_getv": {
+    parameters: ["buffer", "buffer", "i32", "pointer"],
+    result: "i32",
+  },
+  "splinter_append": {
+    parameters: ["buffer", "buffer", "usize"],
+    result: "i32",
+  },
+  "splinter_set_range": {
+    parameters: ["buffer", "usize", "buffer", "usize"],
+    result: "i32",
+  },
+  "splinter_get_from": {
+    parameters: ["buffer", "usize", "pointer", "usize", "pointer"],
+    result: "i32",
+  },
+  "splinter_set_int": {
+    parameters: ["buffer", "i64"],
+    result: "i32",
+  },
+  "splinter_get_int": {
+    parameters: ["buffer", "buffer"],
+    result: "i32",
+  },
+  "splinter_set_if_eq": {
+    parameters: ["buffer", "i64", "i64"],
+    result: "i32",
+  },
+  "splinter_set_if_lt": {
+    parameters: ["buffer", "i64", "i64"],
+    result: "i32",
+  },
+  "splinter_set_if_gt": {
+    parameters: ["buffer", "i64", "i64"],
+    result: "i32",
+  },
+  "splinter_incr": {
+    parameters: ["buffer", "i64", "buffer"],
+    result: "i32",
+  },
+  "splinter_decr": {
+    parameters: ["buffer", "i64", "buffer"],
+    result: "i32",
+  },
+  "splinter_fetch_and": {
+    parameters: ["buffer", "u64", "buffer"],
+    result: "i32",
+  },
+  "splinter_fetch_or": {
+    parameters: ["buffer", "u64", "buffer"],
+    result: "i32",
+  },
+  "splinter_fetch_xor": {
+    parameters: ["buffer", "u64", "buffer"],
+    result: "i32",
+  },
+  "splinter_get_view": {
+    parameters: ["buffer", "pointer", "pointer", "pointer"],
+    result: "i32",
+  },
+  "splinter_view_valid": {
+    parameters: ["buffer", "u64"],
+    result: "i32",
+  },
+  "splinter_mget": {
+    parameters: ["buffer", "usize", "buffer", "buffer", "buffer", "buffer"],
+    result: "i32",
+  },
+  "splinter_mset": {
+    parameters: ["buffer", "buffer", "buffer", "usize", "buffer"],
+    result: "i32",
+  },
   "splinter_list": { 
     parameters: ["pointer", "usize", "pointer"], 
     result: "i32" 
   },
+  "splinter_tag_mask": {
+    parameters: ["buffer"],
+    result: "u64"
+  },
+  "splinter_add_tags": {
+    parameters: ["buffer", "u64"],
+    result: "i32"
+  },
+  "splinter_set_tags": {
+    parameters: ["buffer", "u64"],
+    result: "i32"
+  },
+  "splinter_get_tags": {
+    parameters: ["buffer", "buffer"],
+    result: "i32"
+  },
+  "splinter_find_tagged": {
+    parameters: ["u64", "buffer", "usize"],
+    result: "i32"
+  },
+  "splinter_list_slots": {
+    parameters: ["buffer", "usize", "pointer", "usize", "pointer"],
+    result: "i32"
+  },
+  "splinter_set_with_embeddings": {
+    parameters: ["buffer", "buffer", "usize", "buffer"],
+    result: "i32"
+  },
+  "splinter_set_embeddings": {
+    parameters: ["buffer", "buffer"],
+    result: "i32"
+  },
+  "splinter_get_embeddings": {
+    parameters: ["buffer", "buffer"],
+    result: "i32"
+  },
+  "splinter_knn": {
+    parameters: ["buffer", "usize", "i32", "u32", "buffer"],
+    result: "i32"
+  },
+  "splinter_ann": {
+    parameters: ["buffer", "usize", "u32", "buffer"],
+    result: "i32"
+  },
   "splinter_poll": { 
     parameters: ["buffer", "u64"], 
     result: "i32" 
   },
+  "splinter_watch_create": {
+    parameters: [],
+    result: "pointer"
+  },
+  "splinter_watch_add": {
+    parameters: ["pointer", "buffer", "usize"],
+    result: "i32"
+  },
+  "splinter_watch_add_tagged": {
+    parameters: ["pointer", "buffer", "usize"],
+    result: "i32"
+  },
+  "splinter_watch_eject": {
+    parameters: ["pointer", "buffer", "usize"],
+    result: "i32"
+  },
+  "splinter_watch_wait": {
+    parameters: ["pointer", "u64", "buffer", "usize"],
+    result: "i32"
+  },
+  "splinter_watch_fd": {
+    parameters: ["pointer"],
+    result: "i32"
+  },
+  "splinter_watch_destroy": {
+    parameters: ["pointer"],
+    result: "void"
+  },
+  "splinter_set_poll_spin": {
+    parameters: ["u32"],
+    result: "i32"
+  },
   "splinter_set_av": {
     parameters: ["u32"],
     result: "i32"
@@ -50,6 +210,14 @@ export const Libsplinter = Deno.dlopen("../../libsplinter.so", {
     parameters: [],
     result: "i32"
   },
+  "splinter_set_evict_policy": {
+    parameters: ["u32"],
+    result: "i32"
+  },
+  "splinter_get_evict_policy": {
+    parameters: [],
+    result: "i32"
+  },
   "splinter_get_header_snapshot": {
     parameters: ["pointer"],
     result: "i32"
@@ -58,6 +226,18 @@ export const Libsplinter = Deno.dlopen("../../libsplinter.so", {
     parameters: ["buffer", "pointer"],
     result: "i32"
   },
+  "splinter_feed_cursor": {
+    parameters: ["buffer"],
+    result: "i32"
+  },
+  "splinter_feed_read": {
+    parameters: ["buffer", "buffer", "usize"],
+    result: "i32"
+  },
+  "splinter_resize": {
+    parameters: ["usize"],
+    result: "i32"
+  },
   "splinter_close": { 
     parameters: [], 
     result: "void" 
@@ -14,6 +14,15 @@
 #define DEFAULT_SLOTS 1024
 #define DEFAULT_VAL_MAXLEN 4096
 
+// slot load (percent, tombstones included) at which the CLI suggests
+// a resize, and at which probing starts to get expensive.
+#define LOAD_WARN_PCT 75
+#define LOAD_HIGH_PCT 90
+
+// expiry log records 'init --reaper' gives a store: enough for the TTLs
+// set between two reaper passes (a pass after it wraps rescans once).
+#define DEFAULT_EXPIRY_LOG 65536
+
 // do we have the valgrind development headers?
 // comment out (undefine) if not.
 //#define HAVE_VALGRIND_H 1
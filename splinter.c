@@ -26,14 +26,74 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <string.h>
+#include <stdlib.h>
 #include <stdatomic.h>
 #include <stdio.h>
 #include <errno.h>
 #include <time.h>
 #include <stdint.h>
+#include <limits.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <sys/random.h>
+#include <sys/eventfd.h>
+#include <pthread.h>
+#include <signal.h>
+#include <linux/futex.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 #include "config.h"
 
 
+/** @brief Alignment of every region and hot header field. */
+#define SPLINTER_CACHE_LINE 64
+/** @brief Stores created with SPLINTER_MAP_HUGEPAGES are sized in multiples of this. */
+#define HUGE_PAGE_SZ        (2UL << 20)
+/** @brief Default max_size: how many times its initial size a store may grow to. */
+#define RESIZE_HEADROOM     16
+
+/**
+ * @brief Value arena size classes: class c holds blocks of (64 << c) bytes,
+ * so classes 0..26 cover every value up to max_val_sz's 4 GiB limit.
+ */
+#define ARENA_CLASSES   27
+#define ARENA_BLOCK     SPLINTER_CACHE_LINE
+#define ARENA_NO_CLASS  0xff
+#define ARENA_NO_BLOCK  UINT32_MAX
+
+/**
+ * @struct table_geom
+ * @brief Where one slot table lives in the mapping. Each table has its own
+ * slot metadata, control bytes and keys; values are per table without an
+ * arena, and the arena (shared by every table) otherwise.
+ */
+struct table_geom {
+    /** @brief Number of key-value slots. */
+    uint32_t slots;
+    uint32_t reserved;
+    /** @brief Offset of the slot metadata array from the start of the mapping. */
+    uint64_t slots_off;
+    /** @brief Offset of the control byte array from the start of the mapping. */
+    uint64_t ctrl_off;
+    /** @brief Offset of the key array from the start of the mapping. */
+    uint64_t keys_off;
+    /** @brief Offset of the value region from the start of the mapping. */
+    uint64_t values_off;
+    /** @brief Offset of the value checksums (a uint32_t per slot); 0 if the store keeps none. */
+    uint64_t sums_off;
+    /** @brief Offset of the reaper's timing wheel (see wheel_size()); 0 if the store has no expiry log. */
+    uint64_t wheel_off;
+    /** @brief Offset of the ordered key index (see index_size()); 0 if the store keeps none. */
+    uint64_t index_off;
+    /** @brief Offset of the tag blooms (a uint64_t per slot). */
+    uint64_t tags_off;
+    /** @brief Offset of the embeddings (embed_stride bytes per slot); 0 if the store keeps none. */
+    uint64_t vecs_off;
+    /** @brief Offset of the HNSW graph over the embeddings (see ann_size()); 0 if the store keeps none. */
+    uint64_t ann_off;
+};
+
 /**
  * @struct splinter_header
  * @brief Defines the header structure for the shared memory region.
@@ -41,60 +101,514 @@
  * This header contains metadata for the entire splinter store, including
  * magic number for validation, version, and overall store configuration.
  *
+ * Fields are grouped by how often they're written, one cache line per group,
+ * so the global epoch bumped by every writer doesn't keep evicting the
+ * geometry every reader needs.
+ *
  * NOTE: We add parse_failures/last_failure_epoch for diagnostics.
  */
 struct splinter_header {
+    /* Geometry: written at creation (and the spare table entry by a resize). */
+
     /** @brief Magic number (SPLINTER_MAGIC) to verify integrity. */
     uint32_t magic;
     /** @brief Data layout version (SPLINTER_VER). */
     uint32_t version;
-    /** @brief Total number of available key-value slots. */
-    uint32_t slots;
     /** @brief Maximum size for any single value. */
     uint32_t max_val_sz;
+    /** @brief Distance between values in the value region (max_val_sz, cache-line aligned). */
+    uint32_t val_stride;
+    /** @brief Key hash function (SPLINTER_HASH_*), fixed at creation. */
+    uint32_t hash_alg;
+    /** @brief SPLINTER_MAP_* flags every process applies when mapping the store. */
+    uint32_t map_flags;
+    /** @brief Floats in each key's embedding; 0 = the store keeps none. */
+    uint32_t embed_dim;
+    /** @brief Distance between embeddings (embed_dim floats, cache-line aligned). */
+    uint32_t embed_stride;
+    /** @brief HNSW graph: neighbours per node above level 0 (twice this on it); 0 = no graph. */
+    uint32_t ann_m;
+    /** @brief HNSW graph: candidates kept while linking a new node. */
+    uint32_t ann_ef_construction;
+    /** @brief HNSW graph: candidates kept by searches that don't say. */
+    uint32_t ann_ef_search;
+    /** @brief HNSW graph: the metric it's built for (SPLINTER_METRIC_*). */
+    uint32_t ann_metric;
+    /** @brief Per-store seed for SPLINTER_HASH_WY, fixed at creation. */
+    uint64_t hash_seed;
+    /** @brief Size of the shared value arena in bytes; 0 = one fixed region per slot. */
+    uint64_t arena_sz;
+    /** @brief Offset of the change feed ring from the start of the mapping. */
+    uint64_t feed_off;
+    /** @brief Records in the change feed ring (a power of two); 0 = no feed. */
+    uint64_t feed_len;
+    /** @brief Offset of the expiry log from the start of the mapping. */
+    uint64_t exp_off;
+    /** @brief Records in the expiry log (a power of two); 0 = no log, and no timing wheel. */
+    uint64_t exp_len;
+    /** @brief Largest the store may grow to by resizing; every opener reserves this much. */
+    uint64_t max_size;
+    /**
+     * @brief The slot table, and the one it's being migrated from during a
+     * resize, indexed by table id & 1 (see store_map()). A resize writes the
+     * entry not in use before publishing it through gen.
+     */
+    struct table_geom tables[2];
+
+    /** @brief Table generation: even when stable, odd while a resize migrates keys. */
+    _Alignas(SPLINTER_CACHE_LINE) atomic_uint_least32_t gen;
+    /** @brief pid of the process setting up a resize (0 = none). */
+    atomic_uint_least32_t resize_owner;
+    /** @brief Bytes of the backing object in use; grows with each resize. */
+    atomic_uint_least64_t total_sz;
+
     /** @brief Global epoch, incremented on any write. Used for change detection. */
-    atomic_uint_least64_t epoch;
+    _Alignas(SPLINTER_CACHE_LINE) atomic_uint_least64_t epoch;
+
+    /** @brief Per table: longest distance (in slots) of any key from its home slot. Bounds misses. */
+    _Alignas(SPLINTER_CACHE_LINE) atomic_uint_least32_t max_probe[2];
+
+    /** @brief Keys stored (across both tables while migrating). */
+    _Alignas(SPLINTER_CACHE_LINE) atomic_uint_least64_t keys;
+    /** @brief Per table: slots ever claimed (keys plus tombstones), for the load factor. */
+    atomic_uint_least32_t used[2];
+
+    /** @brief Resize migration: next slot of the old table to hand out, and slots done. */
+    _Alignas(SPLINTER_CACHE_LINE) atomic_uint_least64_t migrate_next;
+    atomic_uint_least64_t migrate_done;
+
+    /** @brief Change feed write cursor: records ever appended (see feed_append()). */
+    _Alignas(SPLINTER_CACHE_LINE) atomic_uint_least64_t feed_head;
+
+    /** @brief Expiry log write cursor: records ever appended (see exp_log_append()). */
+    _Alignas(SPLINTER_CACHE_LINE) atomic_uint_least64_t exp_head;
+    /** @brief Expired keys deleted so far, by the reaper or by writers needing the slot. */
+    atomic_uint_least64_t expired;
+    /** @brief Live keys evicted by writers to a full table (see evict_one()). */
+    atomic_uint_least64_t evicted;
+
+    /** @brief pid of the process running a reaper pass (0 = none). See splinter_store_reap(). */
+    _Alignas(SPLINTER_CACHE_LINE) atomic_uint_least32_t reap_owner;
+    /*
+     * The rest belongs to whoever holds reap_owner: the table the timing wheel
+     * was built for (its id plus one; 0 = rebuild it), the expiry log records
+     * filed so far, and the wheel's clock (CLOCK_REALTIME ms).
+     */
+    uint32_t wheel_table;
+    uint64_t reap_cursor;
+    uint64_t wheel_now;
+
+    /** @brief pid of the process updating the key index (0 = none). See index_lock(). */
+    _Alignas(SPLINTER_CACHE_LINE) atomic_uint_least32_t index_owner;
+    /** @brief Key index version: odd while it's being updated, bumped by 2 per update. */
+    atomic_uint_least64_t index_seq;
+
+    /** @brief pid of the process linking a node into the HNSW graph (0 = none). See ann_lock(). */
+    _Alignas(SPLINTER_CACHE_LINE) atomic_uint_least32_t ann_owner;
+
+    /** @brief Watch sets: bumped whenever a watched slot changes; the futex they sleep on. */
+    _Alignas(SPLINTER_CACHE_LINE) atomic_uint_least32_t watch_seq;
+    /** @brief Watch sets sleeping on watch_seq; writers only FUTEX_WAKE when non-zero. */
+    atomic_uint_least32_t watch_sleepers;
+    /** @brief Watched keys that don't exist right now; creating any key notifies while non-zero. */
+    atomic_uint_least32_t watch_orphans;
+
     /** @brief toggle for zeroing out the value region prior to writing there. */
-    atomic_uint_least32_t auto_vacuum;
+    _Alignas(SPLINTER_CACHE_LINE) atomic_uint_least32_t auto_vacuum;
+    /** @brief What a write to a full table does (SPLINTER_EVICT_*). */
+    atomic_uint_least32_t evict_policy;
 
     /* Diagnostics: counts of parse failures reported by clients / harnesses */
     atomic_uint_least64_t parse_failures;
     atomic_uint_least64_t last_failure_epoch;
+
+    /** @brief Value arena: bytes handed out so far (blocks are never returned to it). */
+    _Alignas(SPLINTER_CACHE_LINE) atomic_uint_least64_t arena_top;
+    /** @brief Value arena: tagged free list head per size class (see arena_alloc()). */
+    atomic_uint_least64_t arena_free[ARENA_CLASSES];
 };
 
+/*
+ * Control bytes: one per slot, in their own array, so a lookup can check 16 or
+ * 32 slots with a single vector compare and only visit slots whose tag
+ * matches. The top bit marks a full slot and the low 7 bits carry the top 7
+ * bits of the key's hash. The array is padded by CTRL_GROUP bytes (always
+ * CTRL_EMPTY) so a group load starting at any slot stays inside the mapping.
+ */
+#define CTRL_EMPTY 0x00
+#define CTRL_TOMB  0x01
+#define CTRL_FULL  0x80
+#define CTRL_GROUP 32
+
 /**
  * @struct splinter_slot
- * @brief Defines a single key-value slot in the hash table.
+ * @brief Defines the metadata for a single key-value slot in the hash table.
+ *
+ * An all-zero slot is an empty one (HASH_EMPTY, epoch 0, no value), so a new
+ * store needs no per-slot setup: the zero-filled pages of a fresh object are
+ * already a valid table, and only pages that get written are ever committed.
  *
- * Each slot holds a key, its value's location and length, and metadata
- * for concurrent access and change tracking.
+ * Slots hold what probing, the seqlock, expiry and eviction need, one to a cache line:
+ * a lookup that finds its hash has everything it checks in that one line, and
+ * writers to neighbouring slots never bounce each other's lines. The key
+ * lives at the same index in a parallel key array (see slot_key()), which is
+ * only touched once the hash matches.
  *
  * We changed val_len to atomic to avoid tearing on platforms where a plain
  * 32-bit write could be observed partially by a reader.
  */
 struct splinter_slot {
-    /** @brief The FNV-1a hash of the key. 0 indicates an empty slot. */
-    atomic_uint_least64_t hash;
+    /** @brief The hash of the key. HASH_EMPTY / HASH_TOMB are reserved. */
+    _Alignas(SPLINTER_CACHE_LINE) atomic_uint_least64_t hash;
     /** @brief Per-slot epoch, incremented on write to this slot. Used for polling. */
     atomic_uint_least64_t epoch;
-    /** @brief Offset into the VALUES region where the value data is stored. */
-    uint32_t val_off;
+    /** @brief Where the value lives in the VALUES region, in 64-byte blocks. */
+    atomic_uint_least32_t val_blk;
     /** @brief The actual length of the stored value data (atomic). */
     atomic_uint_least32_t val_len;
-    /** @brief The null-terminated key string. */
+    /**
+     * @brief Pollers blocked on this slot (low 16 bits) and watch sets that
+     * include it (high 16 bits); writers only wake anyone when non-zero.
+     */
+    atomic_uint_least32_t watchers;
+    /**
+     * @brief Arena size class of the value's block, plus one, so a zeroed slot
+     * reads as ARENA_NO_CLASS (no block / fixed values). See slot_class().
+     */
+    uint8_t val_class;
+    /** @brief What the value holds (SLOT_BYTES / SLOT_INT). */
+    uint8_t val_type;
+    /** @brief Integer operations in flight; writers wait for zero before touching the value. */
+    atomic_uint_least16_t pins;
+    /** @brief When the key expires (CLOCK_REALTIME ms); 0 = never. See slot_expired(). */
+    atomic_uint_least64_t expires;
+    /** @brief CLOCK reference bit: set when the key is looked up or written, cleared by evict_clock(). */
+    atomic_uint_least8_t ref;
+    /** @brief Non-zero if the key has an embedding (see slot_vec()). */
+    atomic_uint_least8_t embedded;
+    /** @brief The global epoch when the value was last written (SPLINTER_EVICT_OLDEST evicts the smallest). */
+    atomic_uint_least64_t written;
+};
+
+_Static_assert(sizeof(struct splinter_slot) == SPLINTER_CACHE_LINE, "slot metadata must fill one cache line");
+
+/**
+ * @struct feed_rec
+ * @brief One change feed record: a slot that was written, and its epoch after.
+ *
+ * seq is the record's position in the feed plus one, stored last; it's 0
+ * while a writer is filling the record in, so readers can tell a complete
+ * record from one being reused.
+ */
+struct feed_rec {
+    atomic_uint_least64_t seq;
+    atomic_uint_least64_t epoch;
+    atomic_uint_least64_t hash;
+    /**
+     * @brief Slot index in the low 32 bits, SPLINTER_CHANGE_* in the next 8,
+     * and the id of the table the slot belongs to above that.
+     */
+    atomic_uint_least64_t slot_op;
+};
+
+_Static_assert(sizeof(struct feed_rec) == 32, "feed records must pack two to a cache line");
+
+#define FEED_TABLE_SHIFT 40
+
+/**
+ * @struct exp_rec
+ * @brief One expiry log record: a slot that was given an expiry.
+ *
+ * seq works as in feed_rec. The reaper reads the expiry from the slot itself
+ * when it gets to the record, so the record only says where to look.
+ */
+struct exp_rec {
+    atomic_uint_least64_t seq;
+    /** @brief Slot index in the low 32 bits, the id of its table above. */
+    atomic_uint_least64_t slot;
+};
+
+_Static_assert(sizeof(struct exp_rec) == 16, "expiry log records must pack four to a cache line");
+
+/*
+ * Timing wheel (see splinter_store_reap()): WHEEL_LEVELS levels of WHEEL_SIZE
+ * buckets, level l's buckets WHEEL_SIZE^l ms wide, followed by a link per
+ * slot. Bucket heads and links hold slot index + 1 (0 = none).
+ */
+#define WHEEL_BITS    6
+#define WHEEL_SIZE    (1u << WHEEL_BITS)
+#define WHEEL_LEVELS  6
+#define WHEEL_BUCKETS (WHEEL_LEVELS * WHEEL_SIZE)
+
+/**
+ * @struct wheel_link
+ * @brief Where a slot is filed in the timing wheel.
+ */
+struct wheel_link {
+    /** @brief Neighbours in the bucket's list (slot index + 1; 0 = none). */
+    uint32_t next, prev;
+    /** @brief The bucket, plus one; 0 = not filed. */
+    uint32_t bucket;
+};
+
+/*
+ * Ordered key index (see splinter_store_scan_range()): a skiplist over the
+ * keys of a table, INDEX_LEVELS level heads followed by a node per slot, so
+ * a key's node is found by its slot index and needs no allocation. Heads and
+ * links hold slot index + 1 (0 = end of list), so a zero-filled region is an
+ * empty index. A key's height comes from its hash, each level a quarter as
+ * likely as the one below.
+ */
+#define INDEX_LEVELS 12
+
+/**
+ * @struct index_node
+ * @brief A slot's links in the key index, one per level it's on.
+ */
+struct index_node {
+    atomic_uint_least32_t next[INDEX_LEVELS];
+};
+
+/*
+ * HNSW graph over the embeddings (see splinter_store_ann()): a head, a node
+ * per slot, and a pool the nodes on upper levels take their lists from.
+ * Like the key index, a slot's node is found by its index and a zero-filled
+ * region is an empty graph. Lists hold slot indexes; a node's level comes
+ * from its slot index, each level 1/M as likely as the one below, so a
+ * slot that is reused keeps its level and its lists' place in the pool.
+ */
+/** @brief Levels in the graph; at M = 2, 2^16 slots fill them out. */
+#define ANN_MAX_LEVEL   16
+/** @brief ann_ef_construction and ann_ef_search when splinter_create_ex() isn't told. */
+#define ANN_EF_CONSTRUCTION 100
+#define ANN_EF_SEARCH   64
+/** @brief Times a reader re-reads a list that's being rewritten before using what it got. */
+#define ANN_RETRIES     8
+
+/**
+ * @struct ann_head
+ * @brief Where searches start, and how much of the pool is taken.
+ */
+struct ann_head {
+    /** @brief Entry point: its level << 32 | (slot index + 1); 0 = empty graph. */
+    atomic_uint_least64_t entry;
+    /** @brief Pool words handed out so far. */
+    atomic_uint_least32_t pool_used;
+};
+
+/**
+ * @struct ann_node
+ * @brief A slot's place in the graph. Nodes are packed, ann_node_size()
+ * apart, rather than each padded out to whole cache lines.
+ */
+struct ann_node {
+    /** @brief Odd while the node's lists are being rewritten; readers validate against it. */
+    atomic_uint_least32_t ver;
+    /** @brief Highest level the node is on, plus one; 0 = never linked. */
+    atomic_uint_least32_t level;
+    /** @brief Where its lists for levels 1 and up start in the pool (0 = none). */
+    atomic_uint_least32_t upper;
+    /** @brief Level 0 list: a count, then room for 2 * ann_m slot indexes. */
+    atomic_uint_least32_t n0;
+    atomic_uint_least32_t nbr[];
+};
+
+/** @brief Slot watchers: the pollers count, and one watch set's share of the count. */
+#define WATCH_POLLERS   0xffffu
+#define WATCH_SET_ONE   0x10000u
+
+/** @brief Slot value types. */
+#define SLOT_BYTES 0
+#define SLOT_INT   1
+
+/**
+ * @brief Bitmasks (bit i = slot i of the group) from one control group scan.
+ */
+struct ctrl_masks {
+    /** @brief Full slots whose tag matches. */
+    uint32_t match;
+    /** @brief Never-used slots. */
+    uint32_t empty;
+    /** @brief Full slots. */
+    uint32_t full;
+};
+
+/**
+ * @brief What one pass of an embedding kernel adds up: the query's dot
+ * product with a stored vector, and the vector's with itself (every metric
+ * splinter_store_knn() offers can be had from the two).
+ */
+struct vec_dots {
+    float qv, vv;
+};
+
+/**
+ * @struct table
+ * @brief One slot table as this process sees it: pointers into the mapping
+ * and slot-index constants, built from a table_geom by bind_table().
+ */
+struct table {
+    /** @brief Pointer to the array of slots within the mapped region. */
+    struct splinter_slot *S;
+    /** @brief Pointer to the control byte array (one per slot, plus CTRL_GROUP padding). */
+    uint8_t *CTRL;
+    /** @brief Pointer to the key array (SPLINTER_KEY_MAX bytes per slot). */
+    char *KEYS;
+    /** @brief Pointer to the start of the value storage area. */
+    uint8_t *VALUES;
+    /** @brief CRC32C of each slot's value, or NULL if the store keeps no checksums. */
+    atomic_uint_least32_t *SUMS;
+    /** @brief Timing wheel bucket heads and per-slot links, or NULL without an expiry log. */
+    uint32_t *WHEEL;
+    struct wheel_link *LINKS;
+    /** @brief Key index level heads and per-slot nodes, or NULL if the store keeps no index. */
+    atomic_uint_least32_t *IDX_HEAD;
+    struct index_node *IDX;
+    /** @brief Each slot's tag bloom (see splinter_store_find_tagged()). */
+    uint64_t *TAGS;
+    /** @brief Each slot's embedding (see slot_vec()), or NULL if the store keeps none. */
+    float *VECS;
+    /** @brief Floats from one embedding to the next (embed_dim, padded to a cache line). */
+    uint32_t vec_floats;
+    /** @brief HNSW graph head, nodes and list pool, or NULL if the store keeps no graph. */
+    struct ann_head *ANN_HEAD;
+    uint8_t *ANN;
+    atomic_uint_least32_t *ANN_POOL;
+    uint32_t ann_pool_len;
+    /** @brief Size of the value storage area. */
+    uint64_t values_sz;
+    /** @brief Number of slots. */
+    uint32_t slots;
+    /** @brief Resizes that happened before this table was created (gen / 2, rounded up). */
+    uint32_t id;
+    /** @brief slots - 1 when slots is a power of two, otherwise 0. */
+    uint64_t slot_mask;
+    /** @brief Fast-modulo reciprocal of slots (used when slot_mask is 0). */
+    uint64_t slot_recip;
+    /** @brief Blocks per slot when every slot has its own value region; 0 with an arena. */
+    uint32_t fixed_blks;
+    /** @brief This table's max_probe and used counters in the header. */
+    atomic_uint_least32_t *max_probe;
+    atomic_uint_least32_t *used;
+};
+
+/**
+ * @struct store_map
+ * @brief The tables of one header generation. Immutable once published; a
+ * resize publishes a new one (see store_map()) and the old ones are kept
+ * until the store is closed, since other threads may still be using them.
+ */
+struct store_map {
+    /** @brief The header gen this map was built from. */
+    uint32_t gen;
+    /** @brief Where keys are written. */
+    struct table cur;
+    /** @brief The table being migrated from (odd gen), or all zeros. */
+    struct table old;
+    /** @brief The map this one replaced. */
+    struct store_map *prev;
+};
+
+/**
+ * @struct splinter_store
+ * @brief A mapped splinter store (the thing behind splinter_store_t).
+ *
+ * Everything that used to be process-global lives here, so one process can
+ * have as many stores mapped as it likes. The handle-less API operates on a
+ * single static instance (g_store) for compatibility.
+ */
+struct splinter_store {
+    /** @brief Base pointer to the memory-mapped region. */
+    void *base;
+    /** @brief Bytes of the backing object mapped so far. */
+    size_t total_sz;
+    /** @brief Address space reserved at base for the store to grow into (H->max_size). */
+    size_t reserve_sz;
+    /** @brief The backing object, kept open to grow the mapping after a resize. */
+    int fd;
+    /** @brief Pointer to the header within the mapped region. */
+    struct splinter_header *H;
+    /** @brief Current tables (see store_map()). */
+    _Atomic(struct store_map *) map;
+    /** @brief Serialises rebuilding map after a resize. */
+    pthread_mutex_t remap_lock;
+    /** @brief The shared value arena (NULL without one). */
+    uint8_t *ARENA;
+    /** @brief Pointer to the change feed ring (NULL if the store has none). */
+    struct feed_rec *FEED;
+    /** @brief feed_len - 1. */
+    uint64_t feed_mask;
+    /** @brief Pointer to the expiry log (NULL if the store has none). */
+    struct exp_rec *EXPLOG;
+    /** @brief exp_len - 1. */
+    uint64_t exp_mask;
+    /** @brief Epoch checks splinter_poll spins through before sleeping (process-local). */
+    unsigned int poll_spin;
+    /** @brief Cached copy of H->hash_alg. */
+    uint32_t hash_alg;
+    /** @brief Cached copy of H->hash_seed. */
+    uint64_t hash_seed;
+    /** @brief Control byte group matcher picked for this CPU (see ctrl_matcher()). */
+    struct ctrl_masks (*ctrl_match)(const uint8_t *ctrl, uint8_t tag);
+    /** @brief Embedding kernel picked for this CPU (see vec_kernel()). */
+    struct vec_dots (*vec_dot)(const float *q, const float *v, size_t n);
+    /** @brief Tag bloom scanner picked for this CPU (see tag_scanner()). */
+    uint64_t (*tag_scan)(const uint64_t *tags, size_t n, uint64_t mask, uint64_t *bits);
+    /** @brief CRC32C picked for this CPU (see crc32c_impl()); NULL without checksums. */
+    uint32_t (*crc32c)(uint32_t crc, const void *buf, size_t len);
+    /** @brief Watch sets open on this handle (process-local), released when it's closed. */
+    struct splinter_watch *watches;
+    /** @brief Guards watches. */
+    pthread_mutex_t watch_lock;
+};
+
+/** @brief watch_entry.slot for a watched key that doesn't exist right now. */
+#define WATCH_NO_SLOT UINT32_MAX
+
+/**
+ * @brief One key in a watch set.
+ */
+struct watch_entry {
     char key[SPLINTER_KEY_MAX];
+    uint64_t hash;
+    /** @brief Slot we're registered on, or WATCH_NO_SLOT (counted in watch_orphans). */
+    uint32_t slot;
+    /** @brief Id of the table slot belongs to (see watch_slot()). */
+    uint32_t tab;
+    /** @brief Slot epoch as of the last change reported. */
+    uint64_t seen;
+};
+
+/**
+ * @struct splinter_watch
+ * @brief A set of keys waited on together (the thing behind splinter_watch_t).
+ *
+ * Each key registers on its slot's watcher count, so writers to those slots
+ * bump the store-wide watch_seq; the set sleeps on that one word and works
+ * out which of its own keys changed by comparing slot epochs. Everything
+ * here is process-local; the lock is only contended by the notifier thread
+ * behind splinter_watch_fd().
+ */
+struct splinter_watch {
+    /** @brief The store watched; NULL once it's been closed (see store_drop_watches()). */
+    splinter_store_t *st;
+    /** @brief Neighbours on st->watches. */
+    struct splinter_watch *next, *prev;
+    struct watch_entry *ent;
+    size_t n, cap;
+    /** @brief Entries with slot == WATCH_NO_SLOT. */
+    size_t orphans;
+    pthread_mutex_t lock;
+    /** @brief eventfd handed out by splinter_watch_fd(), or -1. */
+    int efd;
+    pthread_t notifier;
+    atomic_int stop;
 };
 
-/** @brief Base pointer to the memory-mapped region. */
-static void *g_base = NULL;
-/** @brief Total size of the memory-mapped region. */
-static size_t g_total_sz = 0;
-/** @brief Pointer to the header within the mapped region. */
-static struct splinter_header *H;
-/** @brief Pointer to the array of slots within the mapped region. */
-static struct splinter_slot *S;
-/** @brief Pointer to the start of the value storage area. */
-static uint8_t *VALUES;
+/** @brief The default store used by the handle-less (global) API. */
+static splinter_store_t g_store = {
+    .fd = -1, .remap_lock = PTHREAD_MUTEX_INITIALIZER, .watch_lock = PTHREAD_MUTEX_INITIALIZER
+};
 
 /**
  * @brief Computes the 64-bit FNV-1a hash of a string.
@@ -107,490 +621,6145 @@ static uint64_t fnv1a(const char *s) {
     return h;
 }
 
-/**
- * @brief Calculates the initial slot index for a given hash.
- * @param hash The hash of the key.
- * @param slots The total number of slots in the store.
- * @return The calculated slot index.
+/*
+ * A small wyhash-style hash: reads the key a word at a time and folds with
+ * 64x64->128 multiplies, so a typical key costs a few multiplies instead of
+ * one multiply per byte. Keys are at most SPLINTER_KEY_MAX bytes, so there is
+ * a single 16-byte lane. Seeded per store, which keeps anyone who can choose
+ * key names from building long probe chains on purpose.
  */
-static inline size_t slot_idx(uint64_t hash, uint32_t slots) {
-    return (size_t)(hash % slots);
+#define WY_S0 0xa0761d6478bd642full
+#define WY_S1 0xe7037ed1a0b428dbull
+
+static inline uint64_t wy_mix(uint64_t a, uint64_t b) {
+    __uint128_t r = (__uint128_t)a * b;
+    return (uint64_t)r ^ (uint64_t)(r >> 64);
+}
+
+static inline uint64_t wy_r8(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline uint64_t wy_r4(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
 }
 
 /**
- * @brief Adds a specified number of milliseconds to a timespec struct.
- * @param ts Pointer to the timespec struct to modify.
- * @param ms The number of milliseconds to add.
+ * @brief Computes the seeded word-at-a-time hash of a string.
+ * @param s The null-terminated string to hash.
+ * @param seed The store's hash seed.
+ * @return The 64-bit hash value.
  */
-static void add_ms(struct timespec *ts, uint64_t ms) {
-    ts->tv_nsec += (ms % 1000) * NS_PER_MS;
-    ts->tv_sec  += ms / 1000;
-    if (ts->tv_nsec >= 1000000000L) {
-        ts->tv_nsec -= 1000000000L;
-        ts->tv_sec  += 1;
+static uint64_t wyhash_str(const char *s, uint64_t seed) {
+    const uint8_t *p = (const uint8_t *)s;
+    size_t len = strlen(s), i = len;
+    uint64_t a, b;
+
+    seed ^= wy_mix(seed ^ WY_S0, WY_S1);
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (wy_r4(p) << 32) | wy_r4(p + ((len >> 3) << 2));
+            b = (wy_r4(p + len - 4) << 32) | wy_r4(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        while (i > 16) {
+            seed = wy_mix(wy_r8(p) ^ WY_S1, wy_r8(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+        a = wy_r8(p + i - 16);
+        b = wy_r8(p + i - 8);
     }
+    __uint128_t r = (__uint128_t)(a ^ WY_S1) * (b ^ seed);
+    return wy_mix((uint64_t)r ^ WY_S0 ^ len, (uint64_t)(r >> 64) ^ WY_S1);
 }
 
 /**
- * @brief Internal helper to memory-map a file descriptor and set up global pointers.
- * @param fd The file descriptor to map.
- * @param size The size of the region to map.
- * @return 0 on success, -1 on failure.
+ * @brief Reserved slot hash values.
+ *
+ * HASH_EMPTY marks a slot that has never held a key: probe chains end there.
+ * HASH_TOMB marks a slot whose key was deleted: it can be reused by an insert,
+ * but lookups must keep probing past it. Slots never go back to HASH_EMPTY,
+ * which is what keeps every chain intact without locking neighbours.
  */
-static int map_fd(int fd, size_t size) {
-    g_total_sz = size;
-    g_base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-    if (g_base == MAP_FAILED) return -1;
-    H = (struct splinter_header *)g_base;
-    S = (struct splinter_slot *)(H + 1);
-    VALUES = (uint8_t *)(S + H->slots);
-    return 0;
+#define HASH_EMPTY 0ull
+#define HASH_TOMB  1ull
+
+/**
+ * @brief Hashes a key with the store's hash function, steering clear of the
+ * reserved slot hash values.
+ */
+static inline uint64_t key_hash(const splinter_store_t *st, const char *key) {
+    uint64_t h = st->hash_alg == SPLINTER_HASH_FNV1A ? fnv1a(key) : wyhash_str(key, st->hash_seed);
+    return h > HASH_TOMB ? h : h + 2;
 }
 
 /**
- * @brief Creates and initializes a new splinter store.
+ * @brief Calculates the initial slot index for a given hash.
  *
- * The store is created as a shared memory object (`/dev/shm/...`) unless the
- * `SPLINTER_PERSISTENT` macro is defined, in which case it's a regular file.
- * The function fails if the store already exists.
+ * Power-of-two stores just mask. Anything else uses Lemire's fastmod: a
+ * multiply by the precomputed reciprocal instead of a 64-bit division.
  *
- * @param name_or_path The name of the shared memory object or path to the file.
- * @param slots The total number of key-value slots to allocate.
- * @param max_value_sz The maximum size in bytes for any single value.
- * @return 0 on success, -1 on failure.
+ * @param t The table (for its cached geometry).
+ * @param hash The hash of the key.
+ * @return The calculated slot index.
  */
-int splinter_create(const char *name_or_path, size_t slots, size_t max_value_sz) {
-    int fd;
-
-    if (slots <= 0 || max_value_sz <= 0) {
-        errno = ENOTSUP;
-        return -2;
-    }
-
-#ifdef SPLINTER_PERSISTENT
-    fd = open(name_or_path, O_RDWR | O_CREAT, 0666);
-#else
-    // O_EXCL ensures this fails if the object already exists.
-    fd = shm_open(name_or_path, O_RDWR | O_CREAT | O_EXCL, 0666);
-#endif
-    if (fd < 0) return -1;
-    size_t region_sz = slots * max_value_sz;
-    size_t total_sz  = sizeof(struct splinter_header) + slots * sizeof(struct splinter_slot) + region_sz;
-    if (ftruncate(fd, (off_t)total_sz) != 0) return -1;
-    if (map_fd(fd, total_sz) != 0) return -1;
-    
-    // Initialize header
-    H->magic = SPLINTER_MAGIC;
-    H->version = SPLINTER_VER;
-    H->slots = (uint32_t)slots;
-    H->max_val_sz = (uint32_t)max_value_sz;
-    atomic_store_explicit(&H->epoch, 1, memory_order_relaxed);
-    atomic_store_explicit(&H->auto_vacuum, 1, memory_order_relaxed);
-    atomic_store_explicit(&H->parse_failures, 0, memory_order_relaxed);
-    atomic_store_explicit(&H->last_failure_epoch, 0, memory_order_relaxed);
-    
-    // Initialize slots
-    size_t i;
-    for (i = 0; i < slots; ++i) {
-        atomic_store_explicit(&S[i].hash, 0, memory_order_relaxed);
-        atomic_store_explicit(&S[i].epoch, 0, memory_order_relaxed);
-        S[i].val_off = (uint32_t)(i * max_value_sz);
-        atomic_store_explicit(&S[i].val_len, 0, memory_order_relaxed);
-        S[i].key[0] = '\0';      
-    }
-    return 0;
+static inline size_t slot_idx(const struct table *t, uint64_t hash) {
+    if (t->slot_mask) return (size_t)(hash & t->slot_mask);
+    uint32_t folded = (uint32_t)hash ^ (uint32_t)(hash >> 32);
+    uint64_t lowbits = t->slot_recip * folded;
+    return (size_t)(((__uint128_t)lowbits * t->slots) >> 64);
 }
 
 /**
- * @brief Opens an existing splinter store.
- *
- * The function fails if the store does not exist or if the header metadata
- * (magic number, version) is invalid.
- *
- * @param name_or_path The name of the shared memory object or path to the file.
- * @return 0 on success, -1 on failure.
+ * @brief Control byte for a full slot holding a key with hash h.
  */
-int splinter_open(const char *name_or_path) {
-    int fd;
-#ifdef SPLINTER_PERSISTENT
-    fd = open(name_or_path, O_RDWR);
-#else
-    fd = shm_open(name_or_path, O_RDWR, 0666);
-#endif
-    if (fd < 0) return -1;
-    struct stat st;
-    if (fstat(fd, &st) != 0) return -1;
-    if (map_fd(fd, (size_t)st.st_size) != 0) return -1;
-    
-    // Validate header
-    if (H->magic != SPLINTER_MAGIC || H->version != SPLINTER_VER) return -1;
-    return 0;
+static inline uint8_t ctrl_tag(uint64_t h) {
+    return (uint8_t)(CTRL_FULL | (h >> 57));
 }
 
 /**
- * @brief Creates a new splinter store, or opens it if it already exists.
- *
- * Tries to create first, and on failure, tries to open.
- *
- * @param name_or_path The name of the shared memory object or path to the file.
- * @param slots The total number of key-value slots if creating.
- * @param max_value_sz The maximum value size in bytes if creating.
- * @return 0 on success, -1 on failure.
+ * @brief Publishes a slot's control byte.
  */
-int splinter_create_or_open(const char *name_or_path, size_t slots, size_t max_value_sz) {
-    int ret = splinter_create(name_or_path, slots, max_value_sz);
-    return (ret == 0 ? ret : splinter_open(name_or_path));
+static inline void ctrl_store(uint8_t *ctrl, uint8_t v) {
+    __atomic_store_n(ctrl, v, __ATOMIC_RELEASE);
 }
 
 /**
- * @brief Opens an existing splinter store, or creates it if it does not exist.
- *
- * Tries to open first, and on failure, tries to create.
- *
- * @param name_or_path The name of the shared memory object or path to the file.
- * @param slots The total number of key-value slots if creating.
- * @param max_value_sz The maximum value size in bytes if creating.
- * @return 0 on success, -1 on failure.
+ * @brief Scans a control group one byte at a time. Works everywhere.
  */
-int splinter_open_or_create(const char *name_or_path, size_t slots, size_t max_value_sz) {
-    int ret = splinter_open(name_or_path);
-    return (ret == 0 ? ret : splinter_create(name_or_path, slots, max_value_sz));
+static struct ctrl_masks ctrl_match_scalar(const uint8_t *ctrl, uint8_t tag) {
+    struct ctrl_masks m = { 0, 0, 0 };
+    unsigned int i;
+
+    for (i = 0; i < CTRL_GROUP; i++) {
+        uint8_t c = __atomic_load_n(&ctrl[i], __ATOMIC_ACQUIRE);
+        if (c == tag) m.match |= 1u << i;
+        if (c == CTRL_EMPTY) m.empty |= 1u << i;
+        if (c & CTRL_FULL) m.full |= 1u << i;
+    }
+    return m;
 }
 
+#if defined(__x86_64__) || defined(__i386__)
 /**
- * @brief Sets the auto_vacuum atomic feature flag of the current bus (0 or 1)
- * @return -2 if the bus is unavailable, 0 otherwise.
+ * @brief Scans a control group 16 bytes per compare (SSE2).
  */
-int splinter_set_av(unsigned int mode) {
-    if (!H) return -2;
-    atomic_store_explicit(&H->auto_vacuum, mode, memory_order_relaxed);
-    return 0;   
+__attribute__((target("sse2")))
+static struct ctrl_masks ctrl_match_sse2(const uint8_t *ctrl, uint8_t tag) {
+    struct ctrl_masks m;
+    const __m128i want = _mm_set1_epi8((char)tag), none = _mm_setzero_si128();
+    __m128i lo = _mm_loadu_si128((const __m128i *)ctrl);
+    __m128i hi = _mm_loadu_si128((const __m128i *)(ctrl + 16));
+
+    atomic_thread_fence(memory_order_acquire);
+    m.match = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(lo, want)) |
+        (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(hi, want)) << 16;
+    m.empty = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(lo, none)) |
+        (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(hi, none)) << 16;
+    m.full = (uint32_t)_mm_movemask_epi8(lo) | (uint32_t)_mm_movemask_epi8(hi) << 16;
+    return m;
 }
 
 /**
- * @brief Get the auto_vacuum atomic feature flag of the current bus, as int.
- * @return -2 if the bus is unavailable, value of the (unsigned) flag otherwise. 
+ * @brief Scans a control group in a single 32-byte compare (AVX2).
  */
-int splinter_get_av(void) {
-    if (!H) return -2;
-    return (int) atomic_load_explicit(&H->auto_vacuum, memory_order_acquire);
+__attribute__((target("avx2")))
+static struct ctrl_masks ctrl_match_avx2(const uint8_t *ctrl, uint8_t tag) {
+    struct ctrl_masks m;
+    __m256i c = _mm256_loadu_si256((const __m256i *)ctrl);
+
+    atomic_thread_fence(memory_order_acquire);
+    m.match = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, _mm256_set1_epi8((char)tag)));
+    m.empty = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(c, _mm256_setzero_si256()));
+    m.full = (uint32_t)_mm256_movemask_epi8(c);
+    return m;
 }
+#endif
 
 /**
- * @brief Closes the splinter store and unmaps the shared memory region.
+ * @brief Picks the widest control group matcher this CPU supports.
  */
-void splinter_close(void) {
-    if (g_base) munmap(g_base, g_total_sz);
-    g_base = NULL; H = NULL; S = NULL; VALUES = NULL; g_total_sz = 0;
+static struct ctrl_masks (*ctrl_matcher(void))(const uint8_t *, uint8_t) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return ctrl_match_avx2;
+    if (__builtin_cpu_supports("sse2")) return ctrl_match_sse2;
+#endif
+    return ctrl_match_scalar;
 }
 
 /**
- * @brief "unsets" a key (delete).
- *
- * This function atomically marks the slot as free. With seqlock semantics,
- * if the slot is observed in the middle of a write (odd epoch), it returns
- * -1 with errno = EAGAIN so the caller can retry.
+ * @brief Scans tag blooms one word at a time. Works everywhere.
  *
- * @param key The null-terminated key string.
- * @return length of value deleted on success,
- *         -1 if key not found,
- *         -2 if store or key are invalid,
- *         -1 with errno = EAGAIN if writer in progress.
+ * Every tag scanner sets bit i % 64 of bits[i / 64] for each of the n slots
+ * whose tags include all of mask (clearing the rest of the word, so bits
+ * needs (n + 63) / 64 words), and returns how many bits it set.
  */
-int splinter_unset(const char *key) {
-    if (!H || !key) return -2;
-    uint64_t h = fnv1a(key);
-    size_t idx = slot_idx(h, H->slots);
+static uint64_t tag_scan_scalar(const uint64_t *tags, size_t n, uint64_t mask, uint64_t *bits) {
+    uint64_t hits = 0;
+    size_t i, j;
 
-    size_t i;
-    for (i = 0; i < H->slots; ++i) {
-        struct splinter_slot *slot = &S[(idx + i) % H->slots];
-        uint64_t slot_hash = atomic_load_explicit(&slot->hash, memory_order_acquire);
-
-        if (slot_hash == h && strncmp(slot->key, key, SPLINTER_KEY_MAX) == 0) {
-            uint64_t start_epoch = atomic_load_explicit(&slot->epoch, memory_order_acquire);
-            if (start_epoch & 1) {
-                // Writer in progress
-                errno = EAGAIN;
-                return -1;
-            }
-
-            int ret = (int)atomic_load_explicit(&slot->val_len, memory_order_acquire);
+    for (i = 0; i < n; i += 64) {
+        size_t k = n - i < 64 ? n - i : 64;
+        uint64_t w = 0;
+        for (j = 0; j < k; j++)
+            w |= (uint64_t)((__atomic_load_n(&tags[i + j], __ATOMIC_RELAXED) & mask) == mask) << j;
+        bits[i / 64] = w;
+        hits += (uint64_t)__builtin_popcountll(w);
+    }
+    return hits;
+}
 
-            // Mark the hash 0 → slot unused
-            atomic_store_explicit(&slot->hash, 0, memory_order_release);
+#if defined(__x86_64__) || defined(__i386__)
+/**
+ * @brief Scans tag blooms two words per compare (SSE4.1).
+ */
+__attribute__((target("sse4.1")))
+static uint64_t tag_scan_sse41(const uint64_t *tags, size_t n, uint64_t mask, uint64_t *bits) {
+    const __m128i want = _mm_set1_epi64x((long long)mask);
+    size_t i, j, whole = n & ~(size_t)63;
+    uint64_t hits = 0;
 
-            // Cleanup
+    for (i = 0; i < whole; i += 64) {
+        uint64_t w = 0;
+        for (j = 0; j < 64; j += 2) {
+            __m128i v = _mm_loadu_si128((const __m128i *)(tags + i + j));
+            w |= (uint64_t)_mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(_mm_and_si128(v, want), want))) << j;
+        }
+        bits[i / 64] = w;
+        hits += (uint64_t)__builtin_popcountll(w);
+    }
+    return hits + (whole < n ? tag_scan_scalar(tags + whole, n - whole, mask, bits + whole / 64) : 0);
+}
 
-            if (atomic_load_explicit(&H->auto_vacuum, memory_order_relaxed) == 1) {
-                memset(VALUES + slot->val_off, 0, H->max_val_sz);
-                memset(slot->key, 0, SPLINTER_KEY_MAX);
-            } else {
-                slot->key[0] = '\0';
-            }
-            
-            atomic_store_explicit(&slot->val_len, 0, memory_order_release);
+/**
+ * @brief Scans tag blooms four words per compare, eight per step (AVX2).
+ */
+__attribute__((target("avx2,popcnt")))
+static uint64_t tag_scan_avx2(const uint64_t *tags, size_t n, uint64_t mask, uint64_t *bits) {
+    const __m256i want = _mm256_set1_epi64x((long long)mask);
+    size_t i, j, whole = n & ~(size_t)63;
+    uint64_t hits = 0;
 
-            // Increment slot epoch to mark the change (leave even)
-            atomic_fetch_add_explicit(&slot->epoch, 2, memory_order_release);
-            return ret;
+    for (i = 0; i < whole; i += 64) {
+        uint64_t w = 0;
+        for (j = 0; j < 64; j += 8) {
+            __m256i a = _mm256_loadu_si256((const __m256i *)(tags + i + j));
+            __m256i b = _mm256_loadu_si256((const __m256i *)(tags + i + j + 4));
+            uint64_t lo = (uint64_t)_mm256_movemask_pd(
+                _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(a, want), want)));
+            uint64_t hi = (uint64_t)_mm256_movemask_pd(
+                _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(b, want), want)));
+            w |= (lo | hi << 4) << j;
         }
+        bits[i / 64] = w;
+        hits += (uint64_t)__builtin_popcountll(w);
     }
-
-    return -1; // didn't find it
+    return hits + (whole < n ? tag_scan_scalar(tags + whole, n - whole, mask, bits + whole / 64) : 0);
 }
+#endif
 
+/**
+ * @brief Picks the widest tag bloom scanner this CPU supports.
+ */
+static uint64_t (*tag_scanner(void))(const uint64_t *, size_t, uint64_t, uint64_t *) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt")) return tag_scan_avx2;
+    if (__builtin_cpu_supports("sse4.1")) return tag_scan_sse41;
+#endif
+    return tag_scan_scalar;
+}
 
 /**
- * @brief Sets or updates a key-value pair in the store.
- *
- * This function uses linear probing to resolve hash collisions. It searches for
- * an empty slot or a slot with a matching key starting from the key's
- * natural hash position. If the store is full, the operation will fail.
- *
- * @param key The null-terminated key string.
- * @param val Pointer to the value data.
- * @param len The length of the value data. Must not exceed `max_val_sz`.
- * @return 0 on success, -1 on failure (e.g., store is full, len is too large).
+ * @brief Square root of a float, without pulling in libm.
  */
-int splinter_set(const char *key, const void *val, size_t len) {
-    if (!H || !key) return -1;
-    if (len == 0 || len > H->max_val_sz) return -1; // require non-zero len
+static inline float vec_sqrt(float x) {
+#if defined(__SSE__)
+    return _mm_cvtss_f32(_mm_sqrt_ss(_mm_set_ss(x)));
+#else
+    return __builtin_sqrtf(x);
+#endif
+}
 
-    uint64_t h = fnv1a(key);
-    size_t idx = slot_idx(h, H->slots);
-    const size_t arena_sz = (size_t)H->slots * (size_t)H->max_val_sz;
+/**
+ * @brief Computes q·v and v·v over n floats (a multiple of 16), four lanes at a
+ * time in plain C. Works everywhere.
+ */
+static struct vec_dots vec_dot_scalar(const float *q, const float *v, size_t n) {
+    float qv[4] = { 0 }, vv[4] = { 0 };
+    size_t i, j;
+
+    for (i = 0; i < n; i += 4) {
+        for (j = 0; j < 4; j++) {
+            qv[j] += q[i + j] * v[i + j];
+            vv[j] += v[i + j] * v[i + j];
+        }
+    }
+    return (struct vec_dots){ (qv[0] + qv[1]) + (qv[2] + qv[3]), (vv[0] + vv[1]) + (vv[2] + vv[3]) };
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/**
+ * @brief Adds up the eight floats of an AVX register.
+ */
+__attribute__((target("avx")))
+static inline float hsum256(__m256 x) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+
+/**
+ * @brief Computes q·v and v·v 8 floats per fused multiply-add, a cache
+ * line per step (AVX2 + FMA). q and v are 32-byte aligned.
+ */
+__attribute__((target("avx2,fma")))
+static struct vec_dots vec_dot_avx2(const float *q, const float *v, size_t n) {
+    __m256 qv0 = _mm256_setzero_ps(), qv1 = _mm256_setzero_ps();
+    __m256 vv0 = _mm256_setzero_ps(), vv1 = _mm256_setzero_ps();
+
+    for (size_t i = 0; i < n; i += 16) {
+        __m256 a = _mm256_load_ps(v + i), b = _mm256_load_ps(v + i + 8);
+        qv0 = _mm256_fmadd_ps(_mm256_load_ps(q + i), a, qv0);
+        qv1 = _mm256_fmadd_ps(_mm256_load_ps(q + i + 8), b, qv1);
+        vv0 = _mm256_fmadd_ps(a, a, vv0);
+        vv1 = _mm256_fmadd_ps(b, b, vv1);
+    }
+    return (struct vec_dots){ hsum256(_mm256_add_ps(qv0, qv1)), hsum256(_mm256_add_ps(vv0, vv1)) };
+}
+
+/**
+ * @brief Computes q·v and v·v 16 floats (a cache line) per fused
+ * multiply-add (AVX-512). q and v are 64-byte aligned.
+ */
+__attribute__((target("avx512f")))
+static struct vec_dots vec_dot_avx512(const float *q, const float *v, size_t n) {
+    __m512 qv = _mm512_setzero_ps(), vv = _mm512_setzero_ps();
+
+    for (size_t i = 0; i < n; i += 16) {
+        __m512 a = _mm512_load_ps(v + i);
+        qv = _mm512_fmadd_ps(_mm512_load_ps(q + i), a, qv);
+        vv = _mm512_fmadd_ps(a, a, vv);
+    }
+    return (struct vec_dots){ _mm512_reduce_add_ps(qv), _mm512_reduce_add_ps(vv) };
+}
+#endif
+
+/**
+ * @brief Picks the widest embedding kernel this CPU supports.
+ */
+static struct vec_dots (*vec_kernel(void))(const float *, const float *, size_t) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return vec_dot_avx512;
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return vec_dot_avx2;
+#endif
+    return vec_dot_scalar;
+}
+
+/**
+ * @brief Turns a kernel's dot products into a score under metric
+ * (SPLINTER_METRIC_*), and that into a rank: higher is always nearer.
+ * @param qq The query's dot product with itself.
+ */
+static inline float metric_score(int metric, float qq, struct vec_dots d, float *rank) {
+    float score;
+
+    switch (metric) {
+        case SPLINTER_METRIC_COSINE:
+            score = d.vv > 0 && qq > 0 ? d.qv / vec_sqrt(qq * d.vv) : 0;
+            *rank = score;
+            return score;
+        case SPLINTER_METRIC_L2:
+            score = qq - 2 * d.qv + d.vv;
+            if (score < 0) score = 0;
+            *rank = -score;
+            return score;
+        default:
+            *rank = d.qv;
+            return d.qv;
+    }
+}
+
+/**
+ * @brief Masks off group slots past the first never-used one (the chain
+ * ends there) and past the n slots still left to look at.
+ */
+static inline struct ctrl_masks ctrl_window(struct ctrl_masks m, size_t n) {
+    uint32_t keep = n >= CTRL_GROUP ? UINT32_MAX : (1u << n) - 1;
+    uint32_t empty = m.empty & keep;
+
+    // keep everything up to and including the first empty slot
+    if (empty) keep &= empty ^ (empty - 1);
+    m.match &= keep;
+    m.empty = empty;
+    m.full &= keep;
+    return m;
+}
+
+/*
+ * CRC32C (Castagnoli) value checksums. With SSE4.2 the crc32 instruction does
+ * 8 bytes a cycle when three independent streams are kept in flight (it has
+ * a 3 cycle latency), so longer values are checksummed in three interleaved
+ * blocks whose CRCs are then combined by shifting each past the blocks after
+ * it, using tables built once per process. Elsewhere, slicing-by-8 tables.
+ * Both are chainable: crc32c(crc32c(0, a), b) == crc32c(0, a ++ b).
+ */
+#define CRC32C_POLY  0x82f63b78u
+#define CRC32C_LONG  8192
+#define CRC32C_SHORT 256
+
+static uint32_t crc32c_sw_table[8][256];
+static uint32_t crc32c_long_shift[4][256];
+static uint32_t crc32c_short_shift[4][256];
+static pthread_once_t crc32c_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Applies a 32x32 GF(2) matrix to a vector.
+ */
+static uint32_t gf2_matrix_times(const uint32_t *mat, uint32_t vec) {
+    uint32_t sum = 0;
+
+    for (; vec; vec >>= 1, mat++)
+        if (vec & 1) sum ^= *mat;
+    return sum;
+}
+
+/**
+ * @brief Squares a 32x32 GF(2) matrix.
+ */
+static void gf2_matrix_square(uint32_t *square, const uint32_t *mat) {
+    for (int n = 0; n < 32; n++)
+        square[n] = gf2_matrix_times(mat, mat[n]);
+}
+
+/**
+ * @brief Builds tables that move a raw CRC past len zero bytes (len a power
+ * of two), one per byte of the CRC.
+ */
+static void crc32c_zeros(uint32_t zeros[4][256], size_t len) {
+    uint32_t even[32], odd[32], row = 1;
+    int n;
+
+    // one zero bit, then keep squaring: two bits, four, a byte, ... len bytes
+    odd[0] = CRC32C_POLY;
+    for (n = 1; n < 32; n++, row <<= 1)
+        odd[n] = row;
+    gf2_matrix_square(even, odd);
+    gf2_matrix_square(odd, even);
+    for (;;) {
+        gf2_matrix_square(even, odd);
+        if ((len >>= 1) == 0) break;
+        gf2_matrix_square(odd, even);
+        if ((len >>= 1) == 0) {
+            memcpy(even, odd, sizeof(even));
+            break;
+        }
+    }
+    for (n = 0; n < 256; n++) {
+        zeros[0][n] = gf2_matrix_times(even, (uint32_t)n);
+        zeros[1][n] = gf2_matrix_times(even, (uint32_t)n << 8);
+        zeros[2][n] = gf2_matrix_times(even, (uint32_t)n << 16);
+        zeros[3][n] = gf2_matrix_times(even, (uint32_t)n << 24);
+    }
+}
+
+static void crc32c_init(void) {
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++)
+            c = c & 1 ? (c >> 1) ^ CRC32C_POLY : c >> 1;
+        crc32c_sw_table[0][n] = c;
+    }
+    for (uint32_t n = 0; n < 256; n++)
+        for (int k = 1; k < 8; k++)
+            crc32c_sw_table[k][n] = (crc32c_sw_table[k - 1][n] >> 8) ^
+                crc32c_sw_table[0][crc32c_sw_table[k - 1][n] & 0xff];
+    crc32c_zeros(crc32c_long_shift, CRC32C_LONG);
+    crc32c_zeros(crc32c_short_shift, CRC32C_SHORT);
+}
+
+/**
+ * @brief CRC32C with slicing-by-8 tables. Works everywhere.
+ */
+static uint32_t crc32c_sw(uint32_t crc, const void *buf, size_t len) {
+    const uint8_t *p = buf;
+
+    crc = ~crc;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    for (; len >= 8; len -= 8, p += 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        w ^= crc;
+        crc = crc32c_sw_table[7][w & 0xff] ^ crc32c_sw_table[6][(w >> 8) & 0xff] ^
+              crc32c_sw_table[5][(w >> 16) & 0xff] ^ crc32c_sw_table[4][(w >> 24) & 0xff] ^
+              crc32c_sw_table[3][(w >> 32) & 0xff] ^ crc32c_sw_table[2][(w >> 40) & 0xff] ^
+              crc32c_sw_table[1][(w >> 48) & 0xff] ^ crc32c_sw_table[0][w >> 56];
+    }
+#endif
+    for (; len; len--, p++)
+        crc = (crc >> 8) ^ crc32c_sw_table[0][(crc ^ *p) & 0xff];
+    return ~crc;
+}
+
+#if defined(__x86_64__)
+/**
+ * @brief Moves a raw CRC past one block of zeros (see crc32c_zeros()).
+ */
+static inline uint32_t crc32c_shift(uint32_t zeros[4][256], uint32_t crc) {
+    return zeros[0][crc & 0xff] ^ zeros[1][(crc >> 8) & 0xff] ^
+           zeros[2][(crc >> 16) & 0xff] ^ zeros[3][crc >> 24];
+}
+
+/**
+ * @brief CRC32C with the SSE4.2 crc32 instruction, three streams at a time.
+ */
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_hw(uint32_t crc, const void *buf, size_t len) {
+    const uint8_t *p = buf;
+    uint64_t c0 = ~crc, c1, c2, w0, w1, w2;
+
+    for (; len && ((uintptr_t)p & 7); len--, p++)
+        c0 = _mm_crc32_u8((uint32_t)c0, *p);
+
+    // Three blocks at once, then fold the first two forward onto the third.
+    for (int b = 0; b < 2; b++) {
+        size_t blk = b == 0 ? CRC32C_LONG : CRC32C_SHORT;
+        uint32_t (*zeros)[256] = b == 0 ? crc32c_long_shift : crc32c_short_shift;
+        for (; len >= blk * 3; len -= blk * 3, p += blk * 2) {
+            const uint8_t *end = p + blk;
+            c1 = c2 = 0;
+            for (; p < end; p += 8) {
+                memcpy(&w0, p, 8);
+                memcpy(&w1, p + blk, 8);
+                memcpy(&w2, p + blk * 2, 8);
+                c0 = _mm_crc32_u64(c0, w0);
+                c1 = _mm_crc32_u64(c1, w1);
+                c2 = _mm_crc32_u64(c2, w2);
+            }
+            c0 = crc32c_shift(zeros, (uint32_t)c0) ^ c1;
+            c0 = crc32c_shift(zeros, (uint32_t)c0) ^ c2;
+        }
+    }
+
+    for (; len >= 8; len -= 8, p += 8) {
+        memcpy(&w0, p, 8);
+        c0 = _mm_crc32_u64(c0, w0);
+    }
+    for (; len; len--, p++)
+        c0 = _mm_crc32_u8((uint32_t)c0, *p);
+    return ~(uint32_t)c0;
+}
+#endif
+
+/**
+ * @brief Picks the fastest CRC32C this CPU supports (and builds its tables).
+ */
+static uint32_t (*crc32c_impl(void))(uint32_t, const void *, size_t) {
+    pthread_once(&crc32c_once, crc32c_init);
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) return crc32c_hw;
+#endif
+    return crc32c_sw;
+}
+
+/**
+ * @brief Rounds n up to a whole number of cache lines.
+ */
+static inline uint64_t line_align(uint64_t n) {
+    return (n + SPLINTER_CACHE_LINE - 1) & ~(uint64_t)(SPLINTER_CACHE_LINE - 1);
+}
+
+/**
+ * @brief Bytes of timing wheel for a table of the given size.
+ */
+static inline uint64_t wheel_size(uint64_t slots) {
+    return line_align(WHEEL_BUCKETS * sizeof(uint32_t)) + slots * sizeof(struct wheel_link);
+}
+
+/**
+ * @brief Bytes of key index for a table of the given size.
+ */
+static inline uint64_t index_size(uint64_t slots) {
+    return line_align(INDEX_LEVELS * sizeof(uint32_t)) + slots * sizeof(struct index_node);
+}
+
+/**
+ * @brief Bytes of one HNSW node with neighbour lists of m (2 * m on level 0).
+ */
+static inline uint64_t ann_node_size(uint32_t m) {
+    return sizeof(struct ann_node) + 2 * (uint64_t)m * sizeof(uint32_t);
+}
+
+/**
+ * @brief Words in the HNSW list pool for a table of the given size: twice
+ * the (M + 1) / (M - 1) per slot upper levels take on average, plus one
+ * node on every level. A node that finds the pool used up stays on level 0.
+ */
+static inline uint64_t ann_pool_len(uint64_t slots, uint32_t m) {
+    return 1 + slots * 2 * (m + 1) / (m - 1) + ANN_MAX_LEVEL * (uint64_t)(m + 1);
+}
+
+/**
+ * @brief Bytes of HNSW graph for a table of the given size.
+ */
+static inline uint64_t ann_size(uint64_t slots, uint32_t m) {
+    return line_align(sizeof(struct ann_head)) + line_align(slots * ann_node_size(m)) +
+        ann_pool_len(slots, m) * sizeof(uint32_t);
+}
+
+/**
+ * @brief Returns the key belonging to a slot.
+ */
+static inline char *slot_key(const struct table *t, const struct splinter_slot *slot) {
+    return t->KEYS + (size_t)(slot - t->S) * SPLINTER_KEY_MAX;
+}
+
+/**
+ * @brief Returns the embedding belonging to a slot (only meaningful while
+ * slot->embedded is set). Each one starts on a cache line and is padded
+ * with zeros to the next, so kernels run whole vector registers over it.
+ */
+static inline float *slot_vec(const struct table *t, const struct splinter_slot *slot) {
+    return t->VECS + (size_t)(slot - t->S) * t->vec_floats;
+}
+
+/**
+ * @brief Builds the process-local view of table id from its header
+ * geometry, after checking it fits in the mapping.
+ * @return 0 on success, -1 with errno = EINVAL if the geometry is inconsistent.
+ */
+static int bind_table(splinter_store_t *st, uint32_t id, struct table *t) {
+    struct splinter_header *H = st->H;
+    const struct table_geom *g = &H->tables[id & 1];
+    uint64_t slots = g->slots;
+    uint64_t values_sz = H->arena_sz ? H->arena_sz : slots * H->val_stride;
+
+    if (slots == 0 ||
+        g->slots_off < sizeof(*H) || g->slots_off + slots * sizeof(struct splinter_slot) > g->ctrl_off ||
+        g->ctrl_off + slots + CTRL_GROUP > g->keys_off ||
+        g->keys_off + slots * SPLINTER_KEY_MAX > st->total_sz ||
+        g->values_off + values_sz > st->total_sz ||
+        (g->sums_off && (g->sums_off < sizeof(*H) || g->sums_off + slots * sizeof(uint32_t) > st->total_sz)) ||
+        (g->wheel_off && (g->wheel_off < sizeof(*H) || g->wheel_off + wheel_size(slots) > st->total_sz)) ||
+        (g->index_off && (g->index_off < sizeof(*H) || g->index_off + index_size(slots) > st->total_sz)) ||
+        g->tags_off < sizeof(*H) || g->tags_off + slots * sizeof(uint64_t) > st->total_sz ||
+        (g->vecs_off && (g->vecs_off < sizeof(*H) || g->vecs_off + slots * H->embed_stride > st->total_sz)) ||
+        (g->ann_off && (!g->vecs_off || g->ann_off < sizeof(*H) ||
+                        g->ann_off + ann_size(slots, H->ann_m) > st->total_sz))) {
+        errno = EINVAL;
+        return -1;
+    }
+    t->S = (struct splinter_slot *)((uint8_t *)st->base + g->slots_off);
+    t->CTRL = (uint8_t *)st->base + g->ctrl_off;
+    t->KEYS = (char *)st->base + g->keys_off;
+    t->VALUES = (uint8_t *)st->base + g->values_off;
+    t->SUMS = g->sums_off ? (atomic_uint_least32_t *)((uint8_t *)st->base + g->sums_off) : NULL;
+    t->WHEEL = g->wheel_off ? (uint32_t *)((uint8_t *)st->base + g->wheel_off) : NULL;
+    t->LINKS = g->wheel_off ?
+        (struct wheel_link *)((uint8_t *)t->WHEEL + line_align(WHEEL_BUCKETS * sizeof(uint32_t))) : NULL;
+    t->IDX_HEAD = g->index_off ? (atomic_uint_least32_t *)((uint8_t *)st->base + g->index_off) : NULL;
+    t->IDX = g->index_off ?
+        (struct index_node *)((uint8_t *)t->IDX_HEAD + line_align(INDEX_LEVELS * sizeof(uint32_t))) : NULL;
+    t->TAGS = (uint64_t *)((uint8_t *)st->base + g->tags_off);
+    t->VECS = g->vecs_off ? (float *)((uint8_t *)st->base + g->vecs_off) : NULL;
+    t->vec_floats = H->embed_stride / (uint32_t)sizeof(float);
+    t->ANN_HEAD = g->ann_off ? (struct ann_head *)((uint8_t *)st->base + g->ann_off) : NULL;
+    t->ANN = g->ann_off ? (uint8_t *)t->ANN_HEAD + line_align(sizeof(struct ann_head)) : NULL;
+    t->ANN_POOL = g->ann_off ? (atomic_uint_least32_t *)(t->ANN + line_align(slots * ann_node_size(H->ann_m))) : NULL;
+    t->ann_pool_len = g->ann_off ? (uint32_t)ann_pool_len(slots, H->ann_m) : 0;
+    t->values_sz = values_sz;
+    t->slots = (uint32_t)slots;
+    t->id = id;
+    t->slot_mask = (slots & (slots - 1)) == 0 ? slots - 1 : 0;
+    t->slot_recip = UINT64_MAX / slots + 1;
+    t->fixed_blks = H->arena_sz ? 0 : H->val_stride / ARENA_BLOCK;
+    t->max_probe = &H->max_probe[id & 1];
+    t->used = &H->used[id & 1];
+    return 0;
+}
+
+/**
+ * @brief Builds the tables for header generation gen: the current one, and
+ * the one being migrated from if gen is odd.
+ * @return A new map, or NULL with errno set.
+ */
+static struct store_map *build_map(splinter_store_t *st, uint32_t gen) {
+    struct store_map *m = calloc(1, sizeof(*m));
+    if (!m) return NULL;
+    m->gen = gen;
+    if (bind_table(st, (gen + 1) / 2, &m->cur) != 0 ||
+        ((gen & 1) && bind_table(st, gen / 2, &m->old) != 0)) {
+        free(m);
+        return NULL;
+    }
+    return m;
+}
+
+/**
+ * @brief Builds the tables for the header's current generation.
+ *
+ * A resize can start (and rewrite the spare table entry) while we read the
+ * geometry, so check gen didn't move in the meantime, seqlock style.
+ *
+ * @return A new map, or NULL with errno set.
+ */
+static struct store_map *load_map(splinter_store_t *st) {
+    for (;;) {
+        uint32_t gen = atomic_load_explicit(&st->H->gen, memory_order_acquire);
+        struct store_map *m = build_map(st, gen);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&st->H->gen, memory_order_relaxed) == gen) return m;
+        free(m);
+    }
+}
+
+/**
+ * @brief Points st at the regions described by its header, after checking
+ * they fit in the mapping, and caches the hash settings.
+ * @return 0 on success, -1 with errno = EINVAL if the header is inconsistent.
+ */
+static int bind_regions(splinter_store_t *st) {
+    struct splinter_header *H = st->H;
+
+    if (H->val_stride < H->max_val_sz || (H->feed_len & (H->feed_len - 1)) != 0 ||
+        H->feed_off < sizeof(*H) || H->feed_off + H->feed_len * sizeof(struct feed_rec) > st->total_sz ||
+        (H->exp_len & (H->exp_len - 1)) != 0 ||
+        H->exp_off < sizeof(*H) || H->exp_off + H->exp_len * sizeof(struct exp_rec) > st->total_sz ||
+        H->max_size < st->total_sz || H->embed_dim > SPLINTER_EMBED_MAX ||
+        H->embed_stride != line_align((uint64_t)H->embed_dim * sizeof(float)) ||
+        (H->ann_m && (H->ann_m < 2 || H->ann_m > SPLINTER_ANN_M_MAX || !H->embed_dim ||
+                      H->ann_metric > SPLINTER_METRIC_L2))) {
+        errno = EINVAL;
+        return -1;
+    }
+    struct store_map *m = load_map(st);
+    if (!m) return -1;
+    atomic_store_explicit(&st->map, m, memory_order_release);
+    st->ARENA = H->arena_sz ? m->cur.VALUES : NULL;
+    st->FEED = H->feed_len ? (struct feed_rec *)((uint8_t *)st->base + H->feed_off) : NULL;
+    st->feed_mask = H->feed_len - 1;
+    st->EXPLOG = H->exp_len ? (struct exp_rec *)((uint8_t *)st->base + H->exp_off) : NULL;
+    st->exp_mask = H->exp_len - 1;
+
+    st->hash_alg = H->hash_alg;
+    st->hash_seed = H->hash_seed;
+    st->ctrl_match = ctrl_matcher();
+    st->tag_scan = tag_scanner();
+    st->vec_dot = vec_kernel();
+    st->crc32c = m->cur.SUMS ? crc32c_impl() : NULL;
+    return 0;
+}
+
+/**
+ * @brief Picks a random hash seed for a new store.
+ */
+static uint64_t random_seed(void) {
+    uint64_t seed = 0;
+    if (getrandom(&seed, sizeof(seed), 0) != (ssize_t)sizeof(seed)) {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        seed = ((uint64_t)ts.tv_sec << 32) ^ (uint64_t)ts.tv_nsec ^ ((uint64_t)getpid() << 16);
+    }
+    return seed;
+}
+
+/**
+ * @brief Adds a specified number of milliseconds to a timespec struct.
+ * @param ts Pointer to the timespec struct to modify.
+ * @param ms The number of milliseconds to add.
+ */
+static void add_ms(struct timespec *ts, uint64_t ms) {
+    ts->tv_nsec += (ms % 1000) * NS_PER_MS;
+    ts->tv_sec  += ms / 1000;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_nsec -= 1000000000L;
+        ts->tv_sec  += 1;
+    }
+}
+
+/**
+ * @brief Wall-clock time in milliseconds: the clock key expiry is kept in,
+ * since it reads the same in every process (and across reboots, for stores
+ * that outlive one).
+ */
+static inline uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / NS_PER_MS;
+}
+
+/**
+ * @brief Has the key in a slot expired? Only keys with an expiry read the clock.
+ */
+static inline int slot_expired(struct splinter_slot *slot) {
+    uint64_t x = atomic_load_explicit(&slot->expires, memory_order_relaxed);
+    return x && x <= now_ms();
+}
+
+/**
+ * @brief Sets a slot's CLOCK reference bit. Checked first, so a key that's
+ * read over and over only dirties its line once per eviction sweep.
+ */
+static inline void slot_touch(struct splinter_slot *slot) {
+    if (!atomic_load_explicit(&slot->ref, memory_order_relaxed))
+        atomic_store_explicit(&slot->ref, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief Hints the CPU that we're in a spin-wait loop.
+ */
+static inline void cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield" ::: "memory");
+#endif
+}
+
+/**
+ * @brief Returns the 32-bit futex word for a 64-bit slot epoch.
+ *
+ * Futexes operate on 32-bit words, so we wait on the low half of the epoch.
+ * Every write moves the low half, so it changes whenever the epoch does
+ * (short of 2^32 writes landing between two checks).
+ */
+static inline uint32_t *epoch_futex_word(atomic_uint_least64_t *epoch) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return (uint32_t *)epoch + 1;
+#else
+    return (uint32_t *)epoch;
+#endif
+}
+
+/**
+ * @brief Blocks while *word == val, or until the absolute CLOCK_MONOTONIC deadline.
+ *
+ * No FUTEX_PRIVATE_FLAG: waiters and wakers live in different processes.
+ * @return 0 when woken, -1 with errno (EAGAIN, EINTR, ETIMEDOUT) otherwise.
+ */
+static int futex_wait_until(uint32_t *word, uint32_t val, const struct timespec *deadline) {
+    return (int)syscall(SYS_futex, word, FUTEX_WAIT_BITSET, val, deadline, NULL,
+        FUTEX_BITSET_MATCH_ANY);
+}
+
+/**
+ * @brief Tells every watch set on the store that a watched slot changed.
+ *
+ * Watch sets read watch_seq before checking their slots and sleep only if it
+ * hasn't moved, so bumping it before the wake means none can miss this one.
+ */
+static void notify_watch_sets(struct splinter_header *H) {
+    atomic_fetch_add_explicit(&H->watch_seq, 1, memory_order_seq_cst);
+    if (atomic_load_explicit(&H->watch_sleepers, memory_order_seq_cst))
+        syscall(SYS_futex, (uint32_t *)&H->watch_seq, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/**
+ * @brief Wakes everything blocked in splinter_poll on a slot, and any watch
+ * sets that include it, if there are any.
+ *
+ * Called after the writer's final epoch bump. The fence pairs with the
+ * poller's watcher registration so that either we see the watcher, or the
+ * poller sees the new epoch before it sleeps. Writers with no subscribers
+ * pay one load and no syscall (two loads for a new key, in case a watch set
+ * is waiting for it to appear).
+ */
+static inline void wake_watchers(splinter_store_t *st, struct splinter_slot *slot, int created) {
+    atomic_thread_fence(memory_order_seq_cst);
+    uint32_t w = atomic_load_explicit(&slot->watchers, memory_order_relaxed);
+    if (w & WATCH_POLLERS)
+        syscall(SYS_futex, epoch_futex_word(&slot->epoch), FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    if (w >= WATCH_SET_ONE ||
+        (created && atomic_load_explicit(&st->H->watch_orphans, memory_order_relaxed)))
+        notify_watch_sets(st->H);
+}
+
+/**
+ * @brief Records a change to a slot in the store's change feed, if it has one.
+ *
+ * Called once the slot's seqlock is released, with its new epoch. One
+ * fetch_add reserves a position; the record is then filled in behind a zeroed
+ * seq and published by storing seq last, so writers never wait on each other
+ * and readers can spot a record that's still (or again) being written.
+ */
+static inline void feed_append(splinter_store_t *st, const struct table *t,
+    const struct splinter_slot *slot, uint64_t epoch, uint64_t hash, uint32_t op) {
+    if (!st->FEED) return;
+    uint64_t pos = atomic_fetch_add_explicit(&st->H->feed_head, 1, memory_order_relaxed);
+    struct feed_rec *r = &st->FEED[pos & st->feed_mask];
+
+    atomic_store_explicit(&r->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&r->epoch, epoch, memory_order_relaxed);
+    atomic_store_explicit(&r->hash, hash, memory_order_relaxed);
+    atomic_store_explicit(&r->slot_op, (uint64_t)(slot - t->S) | ((uint64_t)op << 32) |
+                          ((uint64_t)t->id << FEED_TABLE_SHIFT), memory_order_relaxed);
+    atomic_store_explicit(&r->seq, pos + 1, memory_order_release);
+}
+
+/**
+ * @brief Tells the reaper a slot was given an expiry, if the store keeps an
+ * expiry log. Appended once the slot is unlocked, the way feed_append() does.
+ */
+static inline void exp_log_append(splinter_store_t *st, const struct table *t,
+    const struct splinter_slot *slot) {
+    if (!st->EXPLOG) return;
+    uint64_t pos = atomic_fetch_add_explicit(&st->H->exp_head, 1, memory_order_relaxed);
+    struct exp_rec *r = &st->EXPLOG[pos & st->exp_mask];
+
+    atomic_store_explicit(&r->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&r->slot, (uint64_t)(slot - t->S) | ((uint64_t)t->id << 32), memory_order_relaxed);
+    atomic_store_explicit(&r->seq, pos + 1, memory_order_release);
+}
+
+/** @brief cpu_relax() rounds (tens of ms) a writer waits for a slot's pins to drain. */
+#define PIN_SPINS (1u << 20)
+
+/**
+ * @brief Waits out integer operations still working on a slot's value.
+ *
+ * Called by writers once they hold the seqlock. Integer operations pin the
+ * slot and then check the epoch; writers flip the epoch and then check the
+ * pins (the fences make it one or the other), so after this returns no
+ * integer operation can touch the value until the seqlock is released.
+ *
+ * An operation holds its pin for a handful of instructions, so one that
+ * outlasts PIN_SPINS belongs to a process that died (or stopped) in there.
+ * Its pin can't be told apart from a live one, so the writer gives up and
+ * puts the epoch back rather than spin forever; the slot answers EAGAIN to
+ * writers from then on, as one whose writer died does.
+ *
+ * @return 0 once the pins drain, -1 with errno = EAGAIN if they don't.
+ */
+static inline int wait_unpinned(struct splinter_slot *slot) {
+    atomic_thread_fence(memory_order_seq_cst);
+    for (uint32_t spins = 0; atomic_load_explicit(&slot->pins, memory_order_acquire); spins++) {
+        if (spins == PIN_SPINS) {
+            errno = EAGAIN;
+            return -1;
+        }
+        cpu_relax();
+    }
+    return 0;
+}
+
+/**
+ * @brief Returns the block a slot's value starts at. Without an arena that's
+ * a function of the slot's index, so val_blk is only meaningful (and only
+ * read) in arena stores.
+ */
+static inline uint32_t value_blk(const struct table *t, const struct splinter_slot *slot,
+                                 memory_order order) {
+    if (t->fixed_blks) return (uint32_t)((size_t)(slot - t->S) * t->fixed_blks);
+    return atomic_load_explicit(&slot->val_blk, order);
+}
+
+/**
+ * @brief Returns a slot's arena size class (ARENA_NO_CLASS if it has no block).
+ */
+static inline unsigned int slot_class(const struct splinter_slot *slot) {
+    return (uint8_t)(slot->val_class - 1);
+}
+
+/**
+ * @brief Records a slot's arena size class (ARENA_NO_CLASS for none).
+ */
+static inline void set_slot_class(struct splinter_slot *slot, unsigned int cls) {
+    slot->val_class = (uint8_t)(cls + 1);
+}
+
+/**
+ * @brief Returns a slot's current value bytes.
+ */
+static inline uint8_t *slot_value(const struct table *t, const struct splinter_slot *slot) {
+    return t->VALUES + (uint64_t)value_blk(t, slot, memory_order_acquire) * ARENA_BLOCK;
+}
+
+/**
+ * @brief Can len bytes starting at block blk be read without leaving the
+ * value region? Readers check this before copying, since a concurrent
+ * writer may have moved the value (the seqlock tells them afterwards).
+ */
+static inline int value_in_bounds(const struct table *t, uint32_t blk, size_t len) {
+    uint64_t off = (uint64_t)blk * ARENA_BLOCK;
+    return off <= t->values_sz && len <= t->values_sz - off;
+}
+
+/**
+ * @brief Smallest arena size class that holds len bytes.
+ */
+static inline unsigned int arena_class(size_t len) {
+    unsigned int c = 0;
+    while (((uint64_t)ARENA_BLOCK << c) < len) c++;
+    return c;
+}
+
+/**
+ * @brief The free list link stored in the first word of a free block.
+ */
+static inline atomic_uint_least64_t *arena_link(const splinter_store_t *st, uint32_t blk) {
+    return (atomic_uint_least64_t *)(st->ARENA + (uint64_t)blk * ARENA_BLOCK);
+}
+
+/**
+ * @brief Allocates an arena block of size class cls.
+ *
+ * Free blocks sit on a per-class lock-free stack in the header. Each head is
+ * (pop count << 32) | (block + 1), so a head that was popped and pushed back
+ * between our load and CAS doesn't compare equal (no ABA). Failing that, the
+ * block is carved off the top of the arena.
+ *
+ * Freed blocks are reused straight away. That's safe because a block is only
+ * freed by a writer holding the owning slot's seqlock, so every reader that
+ * might still be copying out of it will fail its epoch check and retry.
+ *
+ * @return The block index, or ARENA_NO_BLOCK with errno = ENOSPC.
+ */
+static uint32_t arena_alloc(splinter_store_t *st, unsigned int cls) {
+    struct splinter_header *H = st->H;
+    atomic_uint_least64_t *head = &H->arena_free[cls];
+    uint64_t old = atomic_load_explicit(head, memory_order_acquire);
+
+    while ((uint32_t)old) {
+        uint32_t blk = (uint32_t)old - 1;
+        uint64_t next = atomic_load_explicit(arena_link(st, blk), memory_order_relaxed);
+        uint64_t new_head = (((old >> 32) + 1) << 32) | (uint32_t)next;
+        if (atomic_compare_exchange_weak_explicit(head, &old, new_head,
+                                                  memory_order_acq_rel, memory_order_acquire))
+            return blk;
+    }
+
+    uint64_t bytes = (uint64_t)ARENA_BLOCK << cls;
+    uint64_t top = atomic_load_explicit(&H->arena_top, memory_order_relaxed);
+    do {
+        if (top + bytes > H->arena_sz) {
+            errno = ENOSPC;
+            return ARENA_NO_BLOCK;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&H->arena_top, &top, top + bytes,
+                                                    memory_order_relaxed, memory_order_relaxed));
+    return (uint32_t)(top / ARENA_BLOCK);
+}
+
+/**
+ * @brief Returns a block to its size class's free list.
+ */
+static void arena_free(splinter_store_t *st, uint32_t blk, unsigned int cls) {
+    atomic_uint_least64_t *head = &st->H->arena_free[cls];
+    uint64_t old = atomic_load_explicit(head, memory_order_relaxed);
+    uint64_t new_head;
+
+    do {
+        atomic_store_explicit(arena_link(st, blk), (uint32_t)old, memory_order_relaxed);
+        new_head = (old & 0xffffffff00000000ull) | (blk + 1);
+    } while (!atomic_compare_exchange_weak_explicit(head, &old, new_head,
+                                                    memory_order_release, memory_order_relaxed));
+}
+
+/**
+ * @brief Does the slot currently hold this key?
+ */
+static inline int slot_has_key(const struct table *t, struct splinter_slot *slot, uint64_t h,
+    const char *key) {
+    return atomic_load_explicit(&slot->hash, memory_order_acquire) == h &&
+        strncmp(slot_key(t, slot), key, SPLINTER_KEY_MAX) == 0;
+}
+
+/**
+ * @brief Starts pulling in everything a lookup of hash h touches first: its
+ * control bytes, and the metadata and key of its home slot.
+ */
+static inline void prefetch_home(const struct table *t, uint64_t h) {
+    size_t idx = slot_idx(t, h);
+    __builtin_prefetch(t->CTRL + idx);
+    __builtin_prefetch(&t->S[idx]);
+    __builtin_prefetch(t->KEYS + idx * SPLINTER_KEY_MAX);
+}
+
+/**
+ * @brief Finds the slot holding a key.
+ *
+ * Probing scans the control bytes a group at a time and only reads slots
+ * whose tag matches. It stops at the first never-used slot, and never goes
+ * further than the store's recorded max_probe, so a miss costs at most
+ * max_probe + 1 control bytes rather than a walk of the whole table.
+ *
+ * @return The slot, or NULL with errno = ENOENT.
+ */
+static struct splinter_slot *find_slot(const splinter_store_t *st, const struct table *t, const char *key,
+    uint64_t h) {
+    size_t idx = slot_idx(t, h);
+    size_t limit = atomic_load_explicit(t->max_probe, memory_order_acquire);
+    uint8_t tag = ctrl_tag(h);
+    size_t d = 0;
+
+    // Most keys sit at (or right by) their home slot: start pulling in its
+    // metadata and key while the control bytes are still on their way.
+    __builtin_prefetch(&t->S[idx]);
+    __builtin_prefetch(t->KEYS + idx * SPLINTER_KEY_MAX);
+
+    if (limit >= t->slots) limit = t->slots - 1;
+    while (d <= limit) {
+        // Groups never wrap: the tail of the array is finished off by a short group.
+        size_t n = t->slots - idx;
+        if (n > limit + 1 - d) n = limit + 1 - d;
+        struct ctrl_masks m = ctrl_window(st->ctrl_match(t->CTRL + idx, tag), n);
+
+        while (m.match) {
+            struct splinter_slot *slot = &t->S[idx + __builtin_ctz(m.match)];
+            if (atomic_load_explicit(&slot->hash, memory_order_acquire) == h &&
+                strncmp(slot_key(t, slot), key, SPLINTER_KEY_MAX) == 0)
+                return slot;
+            m.match &= m.match - 1;
+        }
+        if (m.empty) break;
+        if (n > CTRL_GROUP) n = CTRL_GROUP;
+        d += n;
+        idx += n;
+        if (idx == t->slots) idx = 0;
+    }
+    errno = ENOENT;
+    return NULL;
+}
+
+/**
+ * @brief Finds where a write for key should land.
+ *
+ * Returns the slot already holding the key if there is one, otherwise the
+ * first free (empty or tombstoned) slot on its probe chain. Once a free slot
+ * has been seen, we only keep looking for the key until the chain ends or
+ * max_probe is exhausted, since it can't live any further out than that.
+ *
+ * @param dist_out Receives the distance of the returned slot from home.
+ * @return The slot, or NULL with errno = ENOSPC if the store is full.
+ */
+static struct splinter_slot *probe_for_write(const splinter_store_t *st, const struct table *t,
+    const char *key, uint64_t h, size_t *dist_out) {
+    size_t idx = slot_idx(t, h);
+    size_t limit = atomic_load_explicit(t->max_probe, memory_order_acquire);
+    uint8_t tag = ctrl_tag(h);
+    struct splinter_slot *free_slot = NULL;
+    size_t free_dist = 0, d = 0;
+
+    while (d < t->slots) {
+        size_t n = t->slots - idx;
+        if (n > t->slots - d) n = t->slots - d;
+        struct ctrl_masks m = ctrl_window(st->ctrl_match(t->CTRL + idx, tag), n);
+
+        while (m.match) {
+            unsigned int i = (unsigned int)__builtin_ctz(m.match);
+            struct splinter_slot *slot = &t->S[idx + i];
+            if (atomic_load_explicit(&slot->hash, memory_order_acquire) == h &&
+                strncmp(slot_key(t, slot), key, SPLINTER_KEY_MAX) == 0) {
+                *dist_out = d + i;
+                return slot;
+            }
+            m.match &= m.match - 1;
+        }
+        if (n > CTRL_GROUP) n = CTRL_GROUP;
+        // Empty or tombstoned slots in this group are candidates for insertion.
+        uint32_t avail = ~m.full & (n >= CTRL_GROUP ? UINT32_MAX : (1u << n) - 1);
+        if (m.empty) avail &= m.empty ^ (m.empty - 1);
+        if (!free_slot && avail) {
+            free_slot = &t->S[idx + __builtin_ctz(avail)];
+            free_dist = d + __builtin_ctz(avail);
+        }
+        // Chain ends at an empty slot; the key can't be any further along.
+        if (m.empty) break;
+        d += n;
+        if (free_slot && d > limit) break;
+        idx += n;
+        if (idx == t->slots) idx = 0;
+    }
+
+    if (!free_slot) errno = ENOSPC;
+    *dist_out = free_dist;
+    return free_slot;
+}
+
+/**
+ * @brief Raises a table's max_probe to at least dist.
+ */
+static void note_probe_dist(const struct table *t, size_t dist) {
+    uint32_t cur = atomic_load_explicit(t->max_probe, memory_order_relaxed);
+    while (dist > cur) {
+        if (atomic_compare_exchange_weak_explicit(t->max_probe, &cur, (uint32_t)dist,
+                                                  memory_order_release, memory_order_relaxed))
+            break;
+    }
+}
+
+/**
+ * @brief Rounds n up to a whole number of pages.
+ */
+static inline uint64_t page_align(uint64_t n) {
+    uint64_t pg = (uint64_t)sysconf(_SC_PAGESIZE);
+    return (n + pg - 1) & ~(pg - 1);
+}
+
+/**
+ * @brief Internal helper to memory-map a file descriptor into a store.
+ *
+ * Address space for the largest the store may grow to is reserved up front
+ * (and never committed), and the object is mapped at its start, so a resize
+ * only has to map the new tail (map_extend()) and nothing already handed
+ * out ever moves. The reservation is huge page aligned, for THP.
+ *
+ * Only the header pointer is set up here; the other regions are located
+ * from the header by bind_regions() once it's known to be valid.
+ *
+ * @param st The store to populate.
+ * @param fd The file descriptor to map. The store owns it on success.
+ * @param size The size of the region to map.
+ * @param reserve Bytes of address space to reserve (at least size).
+ * @param populate Non-zero to fault every page in up front (MAP_POPULATE).
+ * @return 0 on success, -1 on failure.
+ */
+static int map_fd(splinter_store_t *st, int fd, size_t size, size_t reserve, int populate) {
+    reserve = page_align(reserve > size ? reserve : size);
+    size_t span = reserve + HUGE_PAGE_SZ;
+    uint8_t *resv = mmap(NULL, span, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (resv == MAP_FAILED) return -1;
+    uint8_t *base = (uint8_t *)(((uintptr_t)resv + HUGE_PAGE_SZ - 1) & ~(uintptr_t)(HUGE_PAGE_SZ - 1));
+    if (base > resv) munmap(resv, (size_t)(base - resv));
+    if (resv + span > base + reserve) munmap(base + reserve, (size_t)(resv + span - (base + reserve)));
+
+    if (mmap(base, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED | (populate ? MAP_POPULATE : 0),
+             fd, 0) == MAP_FAILED) {
+        munmap(base, reserve);
+        return -1;
+    }
+    st->base = base;
+    st->total_sz = size;
+    st->reserve_sz = reserve;
+    st->fd = fd;
+    st->H = (struct splinter_header *)base;
+    return 0;
+}
+
+/**
+ * @brief Maps the object up to size bytes, after a resize grew it.
+ * @return 0 on success, -1 on failure (ENOMEM past the reservation).
+ */
+static int map_extend(splinter_store_t *st, size_t size) {
+    if (size <= st->total_sz) return 0;
+    if (size > st->reserve_sz) {
+        errno = ENOMEM;
+        return -1;
+    }
+    // whole pages are mapped already, up to the one the old end falls in
+    size_t from = page_align(st->total_sz);
+    if (size > from &&
+        mmap((uint8_t *)st->base + from, size - from, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+             st->fd, (off_t)from) == MAP_FAILED)
+        return -1;
+    st->total_sz = size;
+    return 0;
+}
+
+/**
+ * @brief Applies SPLINTER_MAP_* flags to len bytes of this process's
+ * mapping at off. lock says whether the range is on the probe path (header,
+ * slot metadata, control bytes and keys) that SPLINTER_MAP_LOCK covers.
+ *
+ * Huge pages have to be asked for before anything is faulted in, so a
+ * mapping that wants both is prefaulted here rather than by MAP_POPULATE.
+ * Everything is best-effort: the kernel may have THP disabled, and mlock
+ * is subject to RLIMIT_MEMLOCK, but the store works the same either way.
+ */
+static void map_range_hints(splinter_store_t *st, uint32_t flags, uint64_t off, uint64_t len, int lock) {
+    uint64_t pg = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint8_t *start = (uint8_t *)st->base + (off & ~(pg - 1));
+    len += off & (pg - 1);
+
+#ifdef MADV_HUGEPAGE
+    if (flags & SPLINTER_MAP_HUGEPAGES)
+        madvise(start, len, MADV_HUGEPAGE);
+#endif
+    if (flags & SPLINTER_MAP_PREFAULT) {
+#ifdef MADV_POPULATE_WRITE
+        if (madvise(start, len, MADV_POPULATE_WRITE) != 0)
+#endif
+        {
+            // older kernels: touch a byte per page (reads fault shared pages in too)
+            uint64_t i;
+            for (i = 0; i < len; i += pg)
+                (void)*(volatile uint8_t *)(start + i);
+        }
+    }
+    if ((flags & SPLINTER_MAP_LOCK) && lock)
+        mlock(start, len);
+}
+
+/**
+ * @brief Applies flags to one table's regions (its values only without an arena).
+ */
+static void map_table_hints(splinter_store_t *st, uint32_t flags, const struct table *t) {
+    uint8_t *base = st->base;
+    map_range_hints(st, flags, (uint64_t)((uint8_t *)t->S - base),
+                    (uint64_t)(t->KEYS + (size_t)t->slots * SPLINTER_KEY_MAX - (char *)t->S), 1);
+    if (t->SUMS)
+        map_range_hints(st, flags, (uint64_t)((uint8_t *)t->SUMS - base), (uint64_t)t->slots * sizeof(uint32_t), 0);
+    map_range_hints(st, flags, (uint64_t)((uint8_t *)t->TAGS - base), (uint64_t)t->slots * sizeof(uint64_t), 0);
+    if (t->fixed_blks)
+        map_range_hints(st, flags, (uint64_t)(t->VALUES - base), t->values_sz, 0);
+}
+
+/**
+ * @brief Applies a store's SPLINTER_MAP_* flags to the regions it uses now
+ * (tables left behind by earlier resizes are skipped).
+ *
+ * @param st The store, with regions bound.
+ * @param flags SPLINTER_MAP_* flags.
+ * @param populated Non-zero if map_fd() already prefaulted the mapping.
+ */
+static void map_hints(splinter_store_t *st, uint32_t flags, int populated) {
+    struct splinter_header *H = st->H;
+    const struct store_map *m = atomic_load_explicit(&st->map, memory_order_relaxed);
+    int saved = errno;
+
+    if (populated) flags &= ~(uint32_t)SPLINTER_MAP_PREFAULT;
+    map_range_hints(st, flags, 0, sizeof(*H), 1);
+    if (H->feed_len)
+        map_range_hints(st, flags, H->feed_off, H->feed_len * sizeof(struct feed_rec), 0);
+    if (st->ARENA)
+        map_range_hints(st, flags, (uint64_t)(st->ARENA - (uint8_t *)st->base), H->arena_sz, 0);
+    map_table_hints(st, flags, &m->cur);
+    if (m->old.S) map_table_hints(st, flags, &m->old);
+    errno = saved;
+}
+
+/**
+ * @brief Internal helper to unmap a store and reset its pointers.
+ * @param st The store to tear down.
+ */
+static void unmap_store(splinter_store_t *st) {
+    struct store_map *m = atomic_load_explicit(&st->map, memory_order_relaxed);
+    while (m) {
+        struct store_map *prev = m->prev;
+        free(m);
+        m = prev;
+    }
+    if (st->base) munmap(st->base, st->reserve_sz);
+    if (st->fd >= 0) close(st->fd);
+    st->base = NULL; st->H = NULL; st->ARENA = NULL; st->total_sz = 0; st->reserve_sz = 0;
+    st->fd = -1;
+    atomic_store_explicit(&st->map, NULL, memory_order_relaxed);
+    st->FEED = NULL;
+    st->EXPLOG = NULL;
+}
+
+/**
+ * @brief Catches this process up with a resize: maps the grown object and
+ * publishes a map for the header's current gen (see store_map()).
+ * @return The current map, or NULL with errno set.
+ */
+static const struct store_map *store_remap(splinter_store_t *st) {
+    struct splinter_header *H = st->H;
+    const struct store_map *m;
+
+    pthread_mutex_lock(&st->remap_lock);
+    m = atomic_load_explicit(&st->map, memory_order_acquire);
+    while (m && m->gen != atomic_load_explicit(&H->gen, memory_order_acquire)) {
+        // total_sz is published before gen, so this covers the tables gen names
+        size_t size = (size_t)atomic_load_explicit(&H->total_sz, memory_order_acquire);
+        struct store_map *next = NULL;
+        if (map_extend(st, size) == 0) next = load_map(st);
+        if (!next) {
+            // a newer resize grew the object again while we were at it
+            if (atomic_load_explicit(&H->total_sz, memory_order_acquire) != size) continue;
+            m = NULL;
+            break;
+        }
+        next->prev = (struct store_map *)m;
+        if (next->cur.id != m->cur.id) map_table_hints(st, H->map_flags, &next->cur);
+        atomic_store_explicit(&st->map, next, memory_order_release);
+        m = next;
+    }
+    pthread_mutex_unlock(&st->remap_lock);
+    return m;
+}
+
+/**
+ * @brief Returns the store's tables as of the header's current gen.
+ *
+ * One extra load on every operation: the map is only rebuilt (under a
+ * process-local lock) when a resize has moved gen on.
+ *
+ * @return The map, or NULL with errno set if the grown store can't be mapped.
+ */
+static inline const struct store_map *store_map(splinter_store_t *st) {
+    const struct store_map *m = atomic_load_explicit(&st->map, memory_order_acquire);
+    if (__builtin_expect(m->gen != atomic_load_explicit(&st->H->gen, memory_order_acquire), 0))
+        return store_remap(st);
+    return m;
+}
+
+_Static_assert(HASH_EMPTY == 0 && CTRL_EMPTY == 0 && SLOT_BYTES == 0 && (uint8_t)(ARENA_NO_CLASS + 1) == 0,
+               "a zero-filled slot table must read as empty");
+
+/**
+ * @brief Creates and initializes a new store into st.
+ * @return 0 on success, -1 on failure, -2 on invalid geometry or options.
+ */
+static int store_create(splinter_store_t *st, const char *name_or_path, const splinter_create_opts_t *opts) {
+    int fd;
+    size_t slots = opts->slots, max_value_sz = opts->max_value_sz;
+    uint32_t hash_alg = opts->hash_alg == SPLINTER_HASH_DEFAULT ? SPLINTER_HASH_WY : opts->hash_alg;
+    uint64_t arena_sz = opts->arena_sz & ~(uint64_t)(ARENA_BLOCK - 1);
+    uint64_t feed_len = opts->feed_len, exp_len = opts->expiry_log_len;
+    uint32_t map_flags = opts->map_flags;
+
+    if (slots <= 0 || max_value_sz <= 0 || slots > UINT32_MAX || max_value_sz > UINT32_MAX ||
+        (hash_alg != SPLINTER_HASH_FNV1A && hash_alg != SPLINTER_HASH_WY) ||
+        (opts->arena_sz && (arena_sz < ((uint64_t)ARENA_BLOCK << arena_class(max_value_sz)) ||
+                            arena_sz / ARENA_BLOCK >= ARENA_NO_BLOCK)) ||
+        (!opts->arena_sz && slots * line_align(max_value_sz) / ARENA_BLOCK >= ARENA_NO_BLOCK) ||
+        feed_len > SPLINTER_FEED_MAX || exp_len > SPLINTER_FEED_MAX || opts->max_size > SIZE_MAX / 2 ||
+        opts->evict_policy > SPLINTER_EVICT_OLDEST || opts->embed_dim > SPLINTER_EMBED_MAX ||
+        (opts->ann_m && (opts->ann_m < 2 || opts->ann_m > SPLINTER_ANN_M_MAX || !opts->embed_dim ||
+                         opts->ann_metric > SPLINTER_METRIC_L2)) ||
+        (map_flags & ~(uint32_t)(SPLINTER_MAP_HUGEPAGES | SPLINTER_MAP_PREFAULT | SPLINTER_MAP_LOCK))) {
+        errno = ENOTSUP;
+        return -2;
+    }
+    // round the feed and log up to a power of two so positions map to records by mask
+    while (feed_len & (feed_len - 1)) feed_len += feed_len & -feed_len;
+    while (exp_len & (exp_len - 1)) exp_len += exp_len & -exp_len;
+
+    // Header, slot metadata, control bytes, keys, tag blooms, checksums,
+    // timing wheel, key index, embeddings, HNSW graph, change feed, expiry
+    // log, values; each region starts on a cache line.
+    uint64_t val_stride = line_align(max_value_sz);
+    uint64_t embed_stride = line_align((uint64_t)opts->embed_dim * sizeof(float));
+    uint64_t slots_off = line_align(sizeof(struct splinter_header));
+    uint64_t ctrl_off = line_align(slots_off + slots * sizeof(struct splinter_slot));
+    uint64_t keys_off = line_align(ctrl_off + slots + CTRL_GROUP);
+    uint64_t tags_off = line_align(keys_off + slots * SPLINTER_KEY_MAX);
+    uint64_t end = tags_off + slots * sizeof(uint64_t), sums_off = 0, wheel_off = 0, index_off = 0, vecs_off = 0;
+    uint64_t ann_off = 0;
+    if (opts->checksums) {
+        sums_off = line_align(end);
+        end = sums_off + slots * sizeof(uint32_t);
+    }
+    if (exp_len) {
+        wheel_off = line_align(end);
+        end = wheel_off + wheel_size(slots);
+    }
+    if (opts->key_index) {
+        index_off = line_align(end);
+        end = index_off + index_size(slots);
+    }
+    if (opts->embed_dim) {
+        vecs_off = line_align(end);
+        end = vecs_off + slots * embed_stride;
+    }
+    if (opts->ann_m) {
+        if (ann_pool_len(slots, opts->ann_m) >= UINT32_MAX) {
+            errno = ENOTSUP;
+            return -2;
+        }
+        ann_off = line_align(end);
+        end = ann_off + ann_size(slots, opts->ann_m);
+    }
+    uint64_t feed_off = line_align(end);
+    uint64_t exp_off = line_align(feed_off + feed_len * sizeof(struct feed_rec));
+    uint64_t values_off = line_align(exp_off + exp_len * sizeof(struct exp_rec));
+    size_t total_sz = values_off + (arena_sz ? arena_sz : slots * val_stride);
+    size_t max_size = opts->max_size ? opts->max_size : total_sz * RESIZE_HEADROOM;
+    if (max_size < total_sz) {
+        errno = ENOTSUP;
+        return -2;
+    }
+
+    // O_EXCL ensures this fails if the store already exists: the new one is
+    // only valid because ftruncate() hands us zero-filled pages.
+#ifdef SPLINTER_PERSISTENT
+    fd = open(name_or_path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+#else
+    fd = shm_open(name_or_path, O_RDWR | O_CREAT | O_EXCL, 0666);
+#endif
+    if (fd < 0) return -1;
+
+    if (map_flags & SPLINTER_MAP_HUGEPAGES) {
+        // whole huge pages only; on hugetlbfs (persistent stores placed on
+        // one) the block size is the huge page size and mmap insists on it
+        struct stat st_buf;
+        size_t align = HUGE_PAGE_SZ;
+        if (fstat(fd, &st_buf) == 0 && (size_t)st_buf.st_blksize > align)
+            align = (size_t)st_buf.st_blksize;
+        total_sz = (total_sz + align - 1) & ~(align - 1);
+    }
+    int populate = (map_flags & SPLINTER_MAP_PREFAULT) && !(map_flags & SPLINTER_MAP_HUGEPAGES);
+    if (ftruncate(fd, (off_t)total_sz) != 0 || map_fd(st, fd, total_sz, max_size, populate) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    struct splinter_header *H = st->H;
+    size_t i;
+
+    // Initialize header (everything not set here starts out zero)
+    H->magic = SPLINTER_MAGIC;
+    H->version = SPLINTER_VER;
+    H->max_val_sz = (uint32_t)max_value_sz;
+    H->val_stride = (uint32_t)val_stride;
+    H->tables[0].slots = (uint32_t)slots;
+    H->tables[0].slots_off = slots_off;
+    H->tables[0].ctrl_off = ctrl_off;
+    H->tables[0].keys_off = keys_off;
+    H->tables[0].values_off = values_off;
+    H->tables[0].sums_off = sums_off;
+    H->tables[0].wheel_off = wheel_off;
+    H->tables[0].index_off = index_off;
+    H->tables[0].tags_off = tags_off;
+    H->tables[0].vecs_off = vecs_off;
+    H->embed_dim = opts->embed_dim;
+    H->embed_stride = (uint32_t)embed_stride;
+    H->tables[0].ann_off = ann_off;
+    H->ann_m = opts->ann_m;
+    H->ann_ef_construction = opts->ann_ef_construction ? opts->ann_ef_construction : ANN_EF_CONSTRUCTION;
+    H->ann_ef_search = opts->ann_ef_search ? opts->ann_ef_search : ANN_EF_SEARCH;
+    H->ann_metric = opts->ann_metric;
+    H->arena_sz = arena_sz;
+    H->feed_off = feed_off;
+    H->feed_len = feed_len;
+    H->exp_off = exp_off;
+    H->exp_len = exp_len;
+    H->map_flags = map_flags;
+    H->max_size = st->reserve_sz;
+    atomic_store_explicit(&H->gen, 0, memory_order_relaxed);
+    atomic_store_explicit(&H->total_sz, total_sz, memory_order_relaxed);
+    atomic_store_explicit(&H->feed_head, 0, memory_order_relaxed);
+    atomic_store_explicit(&H->watch_seq, 0, memory_order_relaxed);
+    atomic_store_explicit(&H->watch_sleepers, 0, memory_order_relaxed);
+    atomic_store_explicit(&H->watch_orphans, 0, memory_order_relaxed);
+    atomic_store_explicit(&H->arena_top, 0, memory_order_relaxed);
+    for (i = 0; i < ARENA_CLASSES; i++)
+        atomic_store_explicit(&H->arena_free[i], 0, memory_order_relaxed);
+    atomic_store_explicit(&H->epoch, 1, memory_order_relaxed);
+    atomic_store_explicit(&H->auto_vacuum, 1, memory_order_relaxed);
+    atomic_store_explicit(&H->evict_policy, opts->evict_policy, memory_order_relaxed);
+    atomic_store_explicit(&H->parse_failures, 0, memory_order_relaxed);
+    atomic_store_explicit(&H->last_failure_epoch, 0, memory_order_relaxed);
+    H->hash_alg = hash_alg;
+    H->hash_seed = hash_alg == SPLINTER_HASH_WY ? (opts->hash_seed ? opts->hash_seed : random_seed()) : 0;
+    if (bind_regions(st) != 0) {
+        unmap_store(st);
+        return -1;
+    }
+    // Slots, control bytes, keys, the wheel, the index and the logs start out as the zero pages
+    // ftruncate() gave us, which is what empty looks like; with an arena,
+    // values get a block on first write.
+    map_hints(st, map_flags, populate);
+    return 0;
+}
+
+/**
+ * @brief Opens an existing store into st, validating the header.
+ * @return 0 on success, -1 on failure.
+ */
+static int store_open(splinter_store_t *st, const char *name_or_path) {
+    int fd;
+#ifdef SPLINTER_PERSISTENT
+    fd = open(name_or_path, O_RDWR | O_CLOEXEC);
+#else
+    fd = shm_open(name_or_path, O_RDWR, 0666);
+#endif
+    if (fd < 0) return -1;
+
+    // Read the header first: it says how much address space to reserve.
+    struct splinter_header hdr;
+    struct stat st_buf;
+    if (pread(fd, &hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr) || hdr.magic != SPLINTER_MAGIC ||
+        hdr.version != SPLINTER_VER || fstat(fd, &st_buf) != 0) {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+    if (map_fd(st, fd, (size_t)st_buf.st_size, hdr.max_size, 0) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    // Validate the rest of the header
+    if (atomic_load_explicit(&st->H->total_sz, memory_order_acquire) > st->total_sz ||
+        bind_regions(st) != 0) {
+        unmap_store(st);
+        errno = EINVAL;
+        return -1;
+    }
+    map_hints(st, st->H->map_flags, 0);
+    return 0;
+}
+
+/**
+ * @brief Creates and initializes a new splinter store.
+ *
+ * The store is created as a shared memory object (`/dev/shm/...`) unless the
+ * `SPLINTER_PERSISTENT` macro is defined, in which case it's a regular file.
+ * The function fails if the store already exists.
+ *
+ * @param name_or_path The name of the shared memory object or path to the file.
+ * @param slots The total number of key-value slots to allocate.
+ * @param max_value_sz The maximum size in bytes for any single value.
+ * @return 0 on success, -1 on failure.
+ */
+int splinter_create(const char *name_or_path, size_t slots, size_t max_value_sz) {
+    splinter_create_opts_t opts = { .slots = slots, .max_value_sz = max_value_sz };
+    return store_create(&g_store, name_or_path, &opts);
+}
+
+/**
+ * @brief Creates and initializes a new splinter store with extended options.
+ *
+ * Like splinter_create(), but takes its geometry and layout options from
+ * opts. Zeroed optional fields select the defaults.
+ *
+ * @param name_or_path The name of the shared memory object or path to the file.
+ * @param opts Creation options.
+ * @return 0 on success, -1 on failure, -2 on invalid options (errno = ENOTSUP).
+ */
+int splinter_create_ex(const char *name_or_path, const splinter_create_opts_t *opts) {
+    if (!opts) {
+        errno = EINVAL;
+        return -2;
+    }
+    return store_create(&g_store, name_or_path, opts);
+}
+
+/**
+ * @brief Opens an existing splinter store.
+ *
+ * The function fails if the store does not exist or if the header metadata
+ * (magic number, version) is invalid.
+ *
+ * @param name_or_path The name of the shared memory object or path to the file.
+ * @return 0 on success, -1 on failure.
+ */
+int splinter_open(const char *name_or_path) {
+    return store_open(&g_store, name_or_path);
+}
+
+/**
+ * @brief Creates a new splinter store, or opens it if it already exists.
+ *
+ * Tries to create first, and on failure, tries to open.
+ *
+ * @param name_or_path The name of the shared memory object or path to the file.
+ * @param slots The total number of key-value slots if creating.
+ * @param max_value_sz The maximum value size in bytes if creating.
+ * @return 0 on success, -1 on failure.
+ */
+int splinter_create_or_open(const char *name_or_path, size_t slots, size_t max_value_sz) {
+    int ret = splinter_create(name_or_path, slots, max_value_sz);
+    return (ret == 0 ? ret : splinter_open(name_or_path));
+}
+
+/**
+ * @brief Opens an existing splinter store, or creates it if it does not exist.
+ *
+ * Tries to open first, and on failure, tries to create.
+ *
+ * @param name_or_path The name of the shared memory object or path to the file.
+ * @param slots The total number of key-value slots if creating.
+ * @param max_value_sz The maximum value size in bytes if creating.
+ * @return 0 on success, -1 on failure.
+ */
+int splinter_open_or_create(const char *name_or_path, size_t slots, size_t max_value_sz) {
+    int ret = splinter_open(name_or_path);
+    return (ret == 0 ? ret : splinter_create(name_or_path, slots, max_value_sz));
+}
+
+/**
+ * @brief Returns the slot a watch entry is registered on, or NULL if a
+ * resize has retired its table since (there's nothing left to update).
+ * @param tp Receives the slot's table.
+ */
+static struct splinter_slot *watch_slot(const struct store_map *m, const struct watch_entry *ent,
+    const struct table **tp) {
+    const struct table *t = ent->tab == m->cur.id ? &m->cur :
+                            m->old.S && ent->tab == m->old.id ? &m->old : NULL;
+    *tp = t;
+    return t ? &t->S[ent->slot] : NULL;
+}
+
+/**
+ * @brief Drops a watch entry's registration (slot or orphan count).
+ */
+static void watch_detach(splinter_watch_t *w, const struct store_map *m, struct watch_entry *ent) {
+    const struct table *t;
+    struct splinter_slot *slot;
+
+    if (ent->slot == WATCH_NO_SLOT) {
+        w->orphans--;
+        atomic_fetch_sub_explicit(&w->st->H->watch_orphans, 1, memory_order_relaxed);
+    } else if ((slot = watch_slot(m, ent, &t)) != NULL) {
+        atomic_fetch_sub_explicit(&slot->watchers, WATCH_SET_ONE, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Stops a watch set's notifier thread, if it's running. The fd is
+ * left open for splinter_watch_destroy() to close, so its number can't be
+ * reused under a caller still polling it.
+ */
+static void watch_stop(splinter_watch_t *w) {
+    struct splinter_header *H = w->st->H;
+
+    if (w->efd < 0 || atomic_load_explicit(&w->stop, memory_order_relaxed)) return;
+    atomic_store_explicit(&w->stop, 1, memory_order_seq_cst);
+    // Moving watch_seq means the notifier can't go (back) to sleep on it.
+    atomic_fetch_add_explicit(&H->watch_seq, 1, memory_order_seq_cst);
+    syscall(SYS_futex, (uint32_t *)&H->watch_seq, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    pthread_join(w->notifier, NULL);
+}
+
+/**
+ * @brief Cuts a watch set loose from its store: stops its notifier, drops
+ * its keys' registrations and takes it off st->watches (lock held).
+ */
+static void watch_release(splinter_watch_t *w) {
+    splinter_store_t *st = w->st;
+
+    watch_stop(w);
+    const struct store_map *m = store_map(st);
+    pthread_mutex_lock(&w->lock);
+    for (size_t i = 0; m && i < w->n; i++) watch_detach(w, m, &w->ent[i]);
+    w->n = 0;
+    pthread_mutex_unlock(&w->lock);
+    if (w->prev) w->prev->next = w->next;
+    else st->watches = w->next;
+    if (w->next) w->next->prev = w->prev;
+    w->next = w->prev = NULL;
+    w->st = NULL;
+}
+
+/**
+ * @brief Releases the watch sets still open on a store before it's
+ * unmapped; what's left of them fails with EBADF until destroyed.
+ */
+static void store_drop_watches(splinter_store_t *st) {
+    pthread_mutex_lock(&st->watch_lock);
+    while (st->watches) watch_release(st->watches);
+    pthread_mutex_unlock(&st->watch_lock);
+}
+
+/**
+ * @brief Closes the splinter store and unmaps the shared memory region.
+ * Watch sets on it are released first (see store_drop_watches()).
+ */
+void splinter_close(void) {
+    if (g_store.H) store_drop_watches(&g_store);
+    unmap_store(&g_store);
+}
+
+/**
+ * @brief Allocates an unmapped handle.
+ */
+static splinter_store_t *store_alloc(void) {
+    splinter_store_t *st = calloc(1, sizeof(*st));
+    if (!st) return NULL;
+    st->fd = -1;
+    pthread_mutex_init(&st->remap_lock, NULL);
+    pthread_mutex_init(&st->watch_lock, NULL);
+    return st;
+}
+
+/**
+ * @brief Frees a handle from store_alloc() (unmap it first).
+ */
+static void store_free(splinter_store_t *st) {
+    pthread_mutex_destroy(&st->remap_lock);
+    pthread_mutex_destroy(&st->watch_lock);
+    free(st);
+}
+
+/**
+ * @brief Creates a new store and returns a handle to it.
+ * @return A new handle, or NULL on failure (errno is set).
+ */
+splinter_store_t *splinter_store_create(const char *name_or_path, size_t slots, size_t max_value_sz) {
+    splinter_create_opts_t opts = { .slots = slots, .max_value_sz = max_value_sz };
+    return splinter_store_create_ex(name_or_path, &opts);
+}
+
+/**
+ * @brief Creates a new store with extended options and returns a handle to it.
+ * @return A new handle, or NULL on failure (errno is set).
+ */
+splinter_store_t *splinter_store_create_ex(const char *name_or_path, const splinter_create_opts_t *opts) {
+    if (!opts) {
+        errno = EINVAL;
+        return NULL;
+    }
+    splinter_store_t *st = store_alloc();
+    if (!st) return NULL;
+    if (store_create(st, name_or_path, opts) != 0) {
+        int saved = errno;
+        store_free(st);
+        errno = saved;
+        return NULL;
+    }
+    return st;
+}
+
+/**
+ * @brief Opens an existing store and returns a handle to it.
+ * @return A new handle, or NULL on failure (errno is set).
+ */
+splinter_store_t *splinter_store_open(const char *name_or_path) {
+    splinter_store_t *st = store_alloc();
+    if (!st) return NULL;
+    if (store_open(st, name_or_path) != 0) {
+        int saved = errno;
+        store_free(st);
+        errno = saved;
+        return NULL;
+    }
+    return st;
+}
+
+/**
+ * @brief Creates a store, or opens it if it exists, returning a handle.
+ */
+splinter_store_t *splinter_store_create_or_open(const char *name_or_path, size_t slots, size_t max_value_sz) {
+    splinter_store_t *st = splinter_store_create(name_or_path, slots, max_value_sz);
+    return (st ? st : splinter_store_open(name_or_path));
+}
+
+/**
+ * @brief Opens a store, or creates it if it does not exist, returning a handle.
+ */
+splinter_store_t *splinter_store_open_or_create(const char *name_or_path, size_t slots, size_t max_value_sz) {
+    splinter_store_t *st = splinter_store_open(name_or_path);
+    return (st ? st : splinter_store_create(name_or_path, slots, max_value_sz));
+}
+
+/**
+ * @brief Unmaps the store and frees the handle, releasing any watch sets
+ * still open on it first. NULL is a no-op.
+ */
+void splinter_store_close(splinter_store_t *st) {
+    if (!st) return;
+    if (st->H) store_drop_watches(st);
+    unmap_store(st);
+    store_free(st);
+}
+
+/**
+ * @brief Returns the store the handle-less API operates on.
+ */
+splinter_store_t *splinter_default_store(void) {
+    return &g_store;
+}
+
+/**
+ * @brief Sets the auto_vacuum atomic feature flag of a store (0 or 1)
+ * @return -2 if the bus is unavailable, 0 otherwise.
+ */
+int splinter_store_set_av(splinter_store_t *st, unsigned int mode) {
+    if (!st || !st->H) return -2;
+    atomic_store_explicit(&st->H->auto_vacuum, mode, memory_order_relaxed);
+    return 0;
+}
+
+/**
+ * @brief Get the auto_vacuum atomic feature flag of a store, as int.
+ * @return -2 if the bus is unavailable, value of the (unsigned) flag otherwise.
+ */
+int splinter_store_get_av(splinter_store_t *st) {
+    if (!st || !st->H) return -2;
+    return (int) atomic_load_explicit(&st->H->auto_vacuum, memory_order_acquire);
+}
+
+/**
+ * @brief Sets what writes to a full store do (SPLINTER_EVICT_*).
+ * @return -2 if the bus is unavailable or the policy unknown, 0 otherwise.
+ */
+int splinter_store_set_evict_policy(splinter_store_t *st, uint32_t policy) {
+    if (!st || !st->H || policy > SPLINTER_EVICT_OLDEST) return -2;
+    atomic_store_explicit(&st->H->evict_policy, policy, memory_order_relaxed);
+    return 0;
+}
+
+/**
+ * @brief Gets a store's eviction policy.
+ * @return -2 if the bus is unavailable, SPLINTER_EVICT_* otherwise.
+ */
+int splinter_store_get_evict_policy(splinter_store_t *st) {
+    if (!st || !st->H) return -2;
+    return (int) atomic_load_explicit(&st->H->evict_policy, memory_order_relaxed);
+}
+
+/**
+ * @brief Takes a lock word holding its owner's pid, breaking it if the
+ * process holding it has died.
+ * @return 0 on success, 1 if it was taken from a dead process, -1 with
+ * errno = EBUSY if a live one holds it.
+ */
+static int owner_claim(atomic_uint_least32_t *word) {
+    uint32_t me = (uint32_t)getpid(), owner = 0;
+    int broken = 0;
+
+    while (!atomic_compare_exchange_strong_explicit(word, &owner, me,
+                                                    memory_order_acq_rel, memory_order_acquire)) {
+        if (kill((pid_t)owner, 0) == 0 || errno != ESRCH) {
+            errno = EBUSY;
+            return -1;
+        }
+        broken = 1;
+    }
+    return broken;
+}
+
+/*
+ * Key index updates. A new key goes into its table's index once its hash is
+ * published, and a deleted one comes out before its slot is scrubbed, both
+ * under the slot's seqlock, so an indexed slot's key never changes. Updates
+ * are serialized by index_owner and make index_seq odd for their duration,
+ * which is what scans validate what they read against (see key_scan()).
+ * Links are set bottom up on insert and undone top down on removal, so the
+ * lists are well formed after every store, even if the updater dies.
+ */
+
+/** @brief Spins between looking for a dead index owner (the check is a syscall). */
+#define INDEX_SPINS 1024
+
+/**
+ * @brief Takes the key index lock and makes index_seq odd. A lock broken
+ * from a dead owner can leave index_seq odd already.
+ */
+static void index_lock(struct splinter_header *H) {
+    for (unsigned int spins = 1;; spins++) {
+        if ((atomic_load_explicit(&H->index_owner, memory_order_relaxed) == 0 || spins % INDEX_SPINS == 0) &&
+            owner_claim(&H->index_owner) >= 0)
+            break;
+        cpu_relax();
+    }
+    atomic_store_explicit(&H->index_seq, atomic_load_explicit(&H->index_seq, memory_order_relaxed) | 1,
+                          memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+/**
+ * @brief Makes index_seq even again (a new version) and drops the key index lock.
+ */
+static void index_unlock(struct splinter_header *H) {
+    atomic_store_explicit(&H->index_seq, atomic_load_explicit(&H->index_seq, memory_order_relaxed) + 1,
+                          memory_order_release);
+    atomic_store_explicit(&H->index_owner, 0, memory_order_release);
+}
+
+/**
+ * @brief How many levels of the index a key is on: one, plus one for each
+ * pair of trailing zero bits in its hash.
+ */
+static inline unsigned int index_height(uint64_t h) {
+    unsigned int height = (unsigned int)__builtin_ctzll(h | (1ull << 62)) / 2 + 1;
+    return height < INDEX_LEVELS ? height : INDEX_LEVELS;
+}
+
+/**
+ * @brief Finds, on every level, the link that points to where key belongs
+ * (the last one from a key that sorts before it). Index lock held.
+ */
+static void index_preds(const struct table *t, const char *key, atomic_uint_least32_t **preds) {
+    atomic_uint_least32_t *links = t->IDX_HEAD;
+    uint32_t n;
+
+    for (int l = INDEX_LEVELS - 1; l >= 0; l--) {
+        while ((n = atomic_load_explicit(&links[l], memory_order_relaxed)) &&
+               strncmp(t->KEYS + (size_t)(n - 1) * SPLINTER_KEY_MAX, key, SPLINTER_KEY_MAX) < 0)
+            links = t->IDX[n - 1].next;
+        preds[l] = &links[l];
+    }
+}
+
+/**
+ * @brief Adds the key a writer just published in slot to its table's index.
+ */
+static void index_insert(splinter_store_t *st, const struct table *t, struct splinter_slot *slot, uint64_t h) {
+    atomic_uint_least32_t *preds[INDEX_LEVELS];
+    uint32_t i = (uint32_t)(slot - t->S);
+    unsigned int height = index_height(h);
+
+    index_lock(st->H);
+    index_preds(t, slot_key(t, slot), preds);
+    for (unsigned int l = 0; l < height; l++) {
+        atomic_store_explicit(&t->IDX[i].next[l], atomic_load_explicit(preds[l], memory_order_relaxed),
+                              memory_order_relaxed);
+        atomic_store_explicit(preds[l], i + 1, memory_order_release);
+    }
+    index_unlock(st->H);
+}
+
+/**
+ * @brief Takes the key in slot out of its table's index (before the slot
+ * is scrubbed: finding it needs the key).
+ */
+static void index_remove(splinter_store_t *st, const struct table *t, struct splinter_slot *slot) {
+    atomic_uint_least32_t *preds[INDEX_LEVELS];
+    uint32_t i = (uint32_t)(slot - t->S);
+
+    index_lock(st->H);
+    index_preds(t, slot_key(t, slot), preds);
+    for (int l = INDEX_LEVELS - 1; l >= 0; l--) {
+        if (atomic_load_explicit(preds[l], memory_order_relaxed) == i + 1)
+            atomic_store_explicit(preds[l], atomic_load_explicit(&t->IDX[i].next[l], memory_order_relaxed),
+                                  memory_order_relaxed);
+    }
+    index_unlock(st->H);
+}
+
+/*
+ * HNSW graph updates. Nodes are linked one at a time, by whoever holds
+ * ann_owner, after the write that brought the embedding has released its
+ * slot; searches take no lock at all. A node's lists are rewritten with its
+ * ver odd, which readers check what they copied against, and every slot
+ * index read out of the graph is bounds-checked, so a reader that races a
+ * writer (or follows one that died half way) can at worst be steered
+ * somewhere less useful, never out of the table. What a search returns is
+ * scored again under each slot's seqlock.
+ *
+ * Deleting a key leaves its node where it is: it still routes searches,
+ * with whatever vector its row holds, but is never returned. A key that
+ * later takes the slot with an embedding is linked over it.
+ */
+
+/** @brief Spins between looking for a dead graph owner (the check is a syscall). */
+#define ANN_SPINS 1024
+
+/**
+ * @brief Takes the graph lock.
+ */
+static void ann_lock(struct splinter_header *H) {
+    for (unsigned int spins = 1;; spins++) {
+        if ((atomic_load_explicit(&H->ann_owner, memory_order_relaxed) == 0 || spins % ANN_SPINS == 0) &&
+            owner_claim(&H->ann_owner) >= 0)
+            return;
+        cpu_relax();
+    }
+}
+
+/**
+ * @brief Drops the graph lock.
+ */
+static void ann_unlock(struct splinter_header *H) {
+    atomic_store_explicit(&H->ann_owner, 0, memory_order_release);
+}
+
+/**
+ * @brief Returns slot i's node.
+ */
+static inline struct ann_node *ann_node(const struct table *t, uint32_t m, uint32_t i) {
+    return (struct ann_node *)(t->ANN + (size_t)i * ann_node_size(m));
+}
+
+/**
+ * @brief Returns slot i's embedding row.
+ */
+static inline const float *ann_row(const struct table *t, uint32_t i) {
+    return t->VECS + (size_t)i * t->vec_floats;
+}
+
+/**
+ * @brief Finds a node's list for level l: a count, followed by room for
+ * *cap slot indexes.
+ * @return The list, or NULL if the node isn't on that level.
+ */
+static atomic_uint_least32_t *ann_list(const struct table *t, uint32_t m, struct ann_node *n, unsigned int l,
+    uint32_t *cap) {
+    if (l == 0) {
+        *cap = 2 * m;
+        return &n->n0;
+    }
+    uint32_t level = atomic_load_explicit(&n->level, memory_order_acquire);
+    uint64_t up = atomic_load_explicit(&n->upper, memory_order_relaxed);
+    if (l >= level || !up || up + (uint64_t)l * (m + 1) > t->ann_pool_len) return NULL;
+    *cap = m;
+    return t->ANN_POOL + up + (size_t)(l - 1) * (m + 1);
+}
+
+/**
+ * @brief Copies slot i's list for level l into out (room for 2 * m), as of
+ * one version of the node if a writer lets us, keeping only indexes inside
+ * the table.
+ * @return The number of slot indexes copied.
+ */
+static uint32_t ann_read(const struct table *t, uint32_t m, uint32_t i, unsigned int l, uint32_t *out) {
+    struct ann_node *n = ann_node(t, m, i);
+    uint32_t cap, cnt = 0, j, k = 0;
+    atomic_uint_least32_t *list = ann_list(t, m, n, l, &cap);
+
+    if (!list) return 0;
+    for (int tries = 0; tries < ANN_RETRIES; tries++) {
+        uint32_t v = atomic_load_explicit(&n->ver, memory_order_acquire);
+        if (v & 1) {
+            cpu_relax();
+            continue;
+        }
+        cnt = atomic_load_explicit(&list[0], memory_order_relaxed);
+        if (cnt > cap) cnt = cap;
+        for (j = 0; j < cnt; j++)
+            out[j] = atomic_load_explicit(&list[1 + j], memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&n->ver, memory_order_relaxed) == v) break;
+    }
+    for (j = 0; j < cnt; j++)
+        if (out[j] < t->slots) out[k++] = out[j];
+    return k;
+}
+
+/**
+ * @brief Replaces slot i's list for level l. Graph lock held.
+ */
+static void ann_write(const struct table *t, uint32_t m, uint32_t i, unsigned int l, const uint32_t *ids,
+    uint32_t cnt) {
+    struct ann_node *n = ann_node(t, m, i);
+    uint32_t cap;
+    atomic_uint_least32_t *list = ann_list(t, m, n, l, &cap);
+
+    if (!list) return;
+    if (cnt > cap) cnt = cap;
+    // odd already if an owner died here
+    uint32_t v = atomic_load_explicit(&n->ver, memory_order_relaxed) | 1;
+    atomic_store_explicit(&n->ver, v, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    for (uint32_t j = 0; j < cnt; j++)
+        atomic_store_explicit(&list[1 + j], ids[j], memory_order_relaxed);
+    atomic_store_explicit(&list[0], cnt, memory_order_relaxed);
+    atomic_store_explicit(&n->ver, v + 1, memory_order_release);
+}
+
+/**
+ * @brief A node on the way through a search, and its rank (higher is nearer).
+ */
+struct ann_cand {
+    float rank;
+    uint32_t id;
+};
+
+/**
+ * @brief A growable binary min-heap of candidates, by rank.
+ */
+struct ann_heap {
+    struct ann_cand *v;
+    size_t n, cap;
+};
+
+/**
+ * @brief Adds a candidate to a heap.
+ * @return 0, or -1 if the heap couldn't grow.
+ */
+static int ann_heap_push(struct ann_heap *h, float rank, uint32_t id) {
+    if (h->n == h->cap) {
+        size_t cap = h->cap ? h->cap * 2 : 64;
+        struct ann_cand *v = realloc(h->v, cap * sizeof(*v));
+        if (!v) return -1;
+        h->v = v;
+        h->cap = cap;
+    }
+    size_t i = h->n++;
+    while (i && h->v[(i - 1) / 2].rank > rank) {
+        h->v[i] = h->v[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    h->v[i] = (struct ann_cand){ rank, id };
+    return 0;
+}
+
+/**
+ * @brief Takes the lowest ranked candidate off a heap that isn't empty.
+ */
+static struct ann_cand ann_heap_pop(struct ann_heap *h) {
+    struct ann_cand top = h->v[0], last = h->v[--h->n];
+    size_t i = 0, c;
+
+    if (!h->n) return top;
+    while ((c = 2 * i + 1) < h->n) {
+        if (c + 1 < h->n && h->v[c + 1].rank < h->v[c].rank) c++;
+        if (h->v[c].rank >= last.rank) break;
+        h->v[i] = h->v[c];
+        i = c;
+    }
+    h->v[i] = last;
+    return top;
+}
+
+/**
+ * @brief Slot indexes a search has already looked at: an open-addressed
+ * set that grows as it fills.
+ */
+struct ann_seen {
+    uint32_t *v;
+    size_t mask, n;
+};
+
+/**
+ * @brief Adds id to the set.
+ * @return 1 if it's new, 0 if it was there, -1 if the set couldn't grow.
+ */
+static int ann_seen_add(struct ann_seen *s, uint32_t id) {
+    size_t i;
+
+    if (!s->v || (s->n + 1) * 2 > s->mask + 1) {
+        size_t cap = s->v ? (s->mask + 1) * 2 : 256;
+        uint32_t *v = calloc(cap, sizeof(*v));
+        if (!v) return -1;
+        for (i = 0; s->v && i <= s->mask; i++) {
+            if (!s->v[i]) continue;
+            size_t j = (s->v[i] * 0x9e3779b1u) & (cap - 1);
+            while (v[j]) j = (j + 1) & (cap - 1);
+            v[j] = s->v[i];
+        }
+        free(s->v);
+        s->v = v;
+        s->mask = cap - 1;
+    }
+    for (i = ((id + 1) * 0x9e3779b1u) & s->mask; s->v[i]; i = (i + 1) & s->mask)
+        if (s->v[i] == id + 1) return 0;
+    s->v[i] = id + 1;
+    s->n++;
+    return 1;
+}
+
+/**
+ * @brief One query's way through the graph: the vector, and the working
+ * sets ann_search_level() keeps between levels.
+ */
+struct ann_ctx {
+    splinter_store_t *st;
+    const struct table *t;
+    uint32_t m;
+    int metric;
+    /** @brief The query, one cache-line aligned, zero-padded row (see slot_vec()). */
+    const float *q;
+    float qq;
+    /** @brief Nodes still to expand, ranked negated so the nearest comes off first. */
+    struct ann_heap cand;
+    /** @brief The nearest found so far, the furthest of them on top. */
+    struct ann_heap found;
+    struct ann_seen seen;
+    /** @brief Room for one neighbour list (2 * m) and one more. */
+    uint32_t *ids;
+};
+
+/**
+ * @brief Releases what a search allocated.
+ */
+static void ann_ctx_free(struct ann_ctx *c) {
+    free(c->cand.v);
+    free(c->found.v);
+    free(c->seen.v);
+    free(c->ids);
+}
+
+/**
+ * @brief Ranks slot i's embedding against the query.
+ */
+static inline float ann_rank(const struct ann_ctx *c, uint32_t i) {
+    float rank;
+    metric_score(c->metric, c->qq, c->st->vec_dot(c->q, ann_row(c->t, i), c->t->vec_floats), &rank);
+    return rank;
+}
+
+/**
+ * @brief Searches one level of the graph, best first, from the nodes in
+ * c->found, leaving the ef nearest to the query there.
+ * @return 0, or -1 if memory ran out.
+ */
+static int ann_search_level(struct ann_ctx *c, unsigned int l, size_t ef) {
+    size_t i;
+
+    c->cand.n = 0;
+    c->seen.n = 0;
+    if (c->seen.v) memset(c->seen.v, 0, (c->seen.mask + 1) * sizeof(uint32_t));
+    for (i = 0; i < c->found.n; i++)
+        if (ann_seen_add(&c->seen, c->found.v[i].id) < 0 ||
+            ann_heap_push(&c->cand, -c->found.v[i].rank, c->found.v[i].id) != 0)
+            return -1;
+    while (c->found.n > ef) ann_heap_pop(&c->found);
+
+    while (c->cand.n) {
+        struct ann_cand best = ann_heap_pop(&c->cand);
+        // nothing left to expand is nearer than the furthest we're keeping
+        if (c->found.n >= ef && -best.rank < c->found.v[0].rank) break;
+        uint32_t n = ann_read(c->t, c->m, best.id, l, c->ids);
+        for (uint32_t j = 0; j < n; j++) {
+            int fresh = ann_seen_add(&c->seen, c->ids[j]);
+            if (fresh < 0) return -1;
+            if (!fresh) continue;
+            float r = ann_rank(c, c->ids[j]);
+            if (c->found.n < ef || r > c->found.v[0].rank) {
+                if (ann_heap_push(&c->cand, -r, c->ids[j]) != 0 || ann_heap_push(&c->found, r, c->ids[j]) != 0)
+                    return -1;
+                if (c->found.n > ef) ann_heap_pop(&c->found);
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Empties c->found into out, nearest first.
+ * @return How many there were.
+ */
+static size_t ann_drain(struct ann_ctx *c, struct ann_cand *out) {
+    size_t n = c->found.n, i = n;
+    while (c->found.n) out[--i] = ann_heap_pop(&c->found);
+    return n;
+}
+
+/**
+ * @brief Orders candidates nearest first.
+ */
+static int ann_cmp(const void *a, const void *b) {
+    float x = ((const struct ann_cand *)a)->rank, y = ((const struct ann_cand *)b)->rank;
+    return x < y ? 1 : x > y ? -1 : 0;
+}
+
+/**
+ * @brief Picks up to max neighbours from cands (ranked against the node
+ * being linked, nearest first), passing over any that's nearer to one
+ * already picked than to the node: the HNSW heuristic, which keeps a node's
+ * links pointing in different directions rather than into one cluster.
+ * @return How many were picked into out.
+ */
+static uint32_t ann_select(const struct ann_ctx *c, const struct ann_cand *cands, size_t n, uint32_t max,
+    uint32_t *out) {
+    const struct table *t = c->t;
+    uint32_t k = 0;
+
+    for (size_t i = 0; i < n && k < max; i++) {
+        const float *e = ann_row(t, cands[i].id);
+        float ee = c->st->vec_dot(e, e, t->vec_floats).vv, rank;
+        int keep = 1;
+        for (uint32_t j = 0; j < k && keep; j++) {
+            metric_score(c->metric, ee, c->st->vec_dot(e, ann_row(t, out[j]), t->vec_floats), &rank);
+            keep = rank <= cands[i].rank;
+        }
+        if (keep) out[k++] = cands[i].id;
+    }
+    return k;
+}
+
+/**
+ * @brief Adds a link from slot i to slot to on level l, pruning i's list
+ * with ann_select() if it's full. Graph lock held.
+ * @return 0, or -1 if memory ran out.
+ */
+static int ann_connect(struct ann_ctx *c, uint32_t i, uint32_t to, unsigned int l) {
+    const struct table *t = c->t;
+    uint32_t *ids = c->ids, cap = l ? c->m : 2 * c->m, n = ann_read(t, c->m, i, l, ids), j;
+
+    for (j = 0; j < n; j++)
+        if (ids[j] == to) return 0;
+    if (n < cap) {
+        ids[n++] = to;
+        ann_write(t, c->m, i, l, ids, n);
+        return 0;
+    }
+
+    struct ann_cand *cands = malloc((n + 1) * sizeof(*cands));
+    if (!cands) return -1;
+    const float *v = ann_row(t, i);
+    float vv = c->st->vec_dot(v, v, t->vec_floats).vv;
+    ids[n] = to;
+    for (j = 0; j <= n; j++) {
+        cands[j].id = ids[j];
+        metric_score(c->metric, vv, c->st->vec_dot(v, ann_row(t, ids[j]), t->vec_floats), &cands[j].rank);
+    }
+    qsort(cands, n + 1, sizeof(*cands), ann_cmp);
+    ann_write(t, c->m, i, l, ids, ann_select(c, cands, n + 1, cap, ids));
+    free(cands);
+    return 0;
+}
+
+/**
+ * @brief The level slot i's node is on: each one up is 1/m as likely.
+ * Fixed per slot, so a reused slot keeps its place in the list pool.
+ */
+static unsigned int ann_draw_level(uint32_t m, uint32_t i) {
+    uint64_t x = (uint64_t)i + 1;
+    unsigned int l = 0;
+
+    while (l < ANN_MAX_LEVEL - 1 && (x = wy_mix(x, 0x9e3779b97f4a7c15ull)) % m == 0)
+        l++;
+    return l;
+}
+
+/**
+ * @brief Copies a slot's embedding, as one write left it.
+ * @return 0 on success, -1 if the slot is empty, has no embedding, or kept
+ * changing (its writer links it again).
+ */
+static int ann_copy_vec(const struct table *t, struct splinter_slot *slot, float *out) {
+    for (int tries = 0; tries < ANN_RETRIES; tries++) {
+        uint64_t e = atomic_load_explicit(&slot->epoch, memory_order_acquire);
+        if (e & 1) {
+            cpu_relax();
+            continue;
+        }
+        if (atomic_load_explicit(&slot->hash, memory_order_relaxed) <= HASH_TOMB ||
+            !atomic_load_explicit(&slot->embedded, memory_order_relaxed))
+            return -1;
+        memcpy(out, slot_vec(t, slot), (size_t)t->vec_floats * sizeof(float));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->epoch, memory_order_relaxed) == e) return 0;
+    }
+    return -1;
+}
+
+/**
+ * @brief Links the embedding a write just gave a slot into its table's
+ * graph, or links it again if the slot was linked before.
+ *
+ * HNSW insertion: a greedy descent from the entry point down to the node's
+ * level, then on each level from there to 0 a search for the
+ * ann_ef_construction nearest, of which ann_select() picks ann_m to link
+ * both ways. Best-effort: a table being retired by a resize, or running
+ * out of memory, leaves the node as it was (unlinked nodes are only missed
+ * by searches, never wrong).
+ */
+static void ann_link(splinter_store_t *st, const struct table *t, struct splinter_slot *slot) {
+    struct splinter_header *H = st->H;
+    uint32_t m = H->ann_m, i = (uint32_t)(slot - t->S), level, k;
+    struct ann_ctx c = { .st = st, .t = t, .m = m, .metric = (int)H->ann_metric };
+    struct ann_cand *w = NULL;
+    float *q = aligned_alloc(SPLINTER_CACHE_LINE, (size_t)t->vec_floats * sizeof(float));
+    uint32_t *picked = malloc(m * sizeof(uint32_t));
+    int saved = errno;
+
+    c.ids = malloc((2 * (size_t)m + 1) * sizeof(uint32_t));
+    if (!q || !picked || !c.ids || ann_copy_vec(t, slot, q) != 0) goto out;
+    c.q = q;
+    c.qq = st->vec_dot(q, q, t->vec_floats).vv;
+
+    ann_lock(H);
+    if (t->id != (atomic_load_explicit(&H->gen, memory_order_acquire) + 1) / 2) goto unlock;
+
+    struct ann_node *n = ann_node(t, m, i);
+    if (!(level = atomic_load_explicit(&n->level, memory_order_relaxed))) {
+        unsigned int want = ann_draw_level(m, i);
+        uint32_t used = atomic_load_explicit(&t->ANN_HEAD->pool_used, memory_order_relaxed);
+        uint32_t need = want * (m + 1);
+        if (want && 1 + (uint64_t)used + need <= t->ann_pool_len) {
+            atomic_store_explicit(&n->upper, 1 + used, memory_order_relaxed);
+            atomic_store_explicit(&t->ANN_HEAD->pool_used, used + need, memory_order_relaxed);
+        } else {
+            want = 0;
+        }
+        level = want + 1;
+        atomic_store_explicit(&n->level, level, memory_order_release);
+    }
+    unsigned int L = level - 1, top, l;
+
+    uint64_t entry = atomic_load_explicit(&t->ANN_HEAD->entry, memory_order_acquire);
+    uint32_t ep = (uint32_t)entry - 1;
+    top = (unsigned int)(entry >> 32);
+    if (!entry || ep >= t->slots || top >= ANN_MAX_LEVEL) {
+        atomic_store_explicit(&t->ANN_HEAD->entry, (uint64_t)L << 32 | (i + 1), memory_order_release);
+        goto unlock;
+    }
+
+    if (ann_heap_push(&c.found, ann_rank(&c, ep), ep) != 0) goto unlock;
+    for (l = top; l > L; l--)
+        if (ann_search_level(&c, l, 1) != 0) goto unlock;
+    size_t efc = H->ann_ef_construction > m ? H->ann_ef_construction : m;
+    for (l = L < top ? L : top;; l--) {
+        if (ann_search_level(&c, l, efc) != 0) goto unlock;
+        struct ann_cand *grown = realloc(w, (c.found.n ? c.found.n : 1) * sizeof(*w));
+        if (!grown) goto unlock;
+        w = grown;
+        size_t nw = ann_drain(&c, w), j, kept = 0;
+        for (j = 0; j < nw; j++)
+            if (w[j].id != i) w[kept++] = w[j];
+        k = ann_select(&c, w, kept, m, picked);
+        ann_write(t, m, i, l, picked, k);
+        for (j = 0; j < k; j++)
+            if (ann_connect(&c, picked[j], i, l) != 0) goto unlock;
+        if (l == 0) break;
+        // the next level down starts from everything found on this one
+        for (j = 0; j < kept; j++)
+            if (ann_heap_push(&c.found, w[j].rank, w[j].id) != 0) goto unlock;
+    }
+    if (L > top)
+        atomic_store_explicit(&t->ANN_HEAD->entry, (uint64_t)L << 32 | (i + 1), memory_order_release);
+unlock:
+    ann_unlock(H);
+out:
+    ann_ctx_free(&c);
+    free(w);
+    free(q);
+    free(picked);
+    errno = saved;
+}
+
+/*
+ * Online resize. A resize appends a bigger slot table to the backing object
+ * and publishes it by making gen odd. From then on keys are only written to
+ * the new table, lookups try the old table and then the new one, and keys
+ * are moved across a chunk at a time by whoever has a moment: the resizing
+ * process, and every writer (a few slots per write). Each move happens
+ * under the old slot's seqlock, and the copy is published before the old
+ * slot is tombstoned, so a key is never missing from both tables. Whoever
+ * moves the last chunk makes gen even again, which retires the old table.
+ *
+ * The migration cursors carry the gen they belong to in their top 32 bits,
+ * so a process still working from an older map can't claim or count slots
+ * of a newer migration.
+ */
+#define MIGRATE_CHUNK   256
+#define MIGRATE_HELP    8
+
+/**
+ * @brief Moves the key in one slot of the old table to the new one.
+ *
+ * Takes the old slot's seqlock and drains integer operations, so the key
+ * can't change while it's copied. The copy's epoch is past both the old
+ * slot's and the new one's, and the old slot's epoch moves too, so views,
+ * polls and watch sets on the old slot all see the key change.
+ *
+ * @return 0 if the slot holds nothing to move (any more), -1 with
+ * errno = ENOSPC if the new table is full.
+ */
+static int move_slot(splinter_store_t *st, const struct store_map *m, struct splinter_slot *from) {
+    struct splinter_header *H = st->H;
+    const struct table *src = &m->old, *dst = &m->cur;
+    struct splinter_slot *to;
+    uint64_t e, te, h, th;
+    size_t dist;
+
+    for (;;) {
+        // A writer that locked the slot before the resize started finishes first.
+        e = atomic_load_explicit(&from->epoch, memory_order_seq_cst);
+        if (e & 1) {
+            cpu_relax();
+            continue;
+        }
+        h = atomic_load_explicit(&from->hash, memory_order_acquire);
+        if (h <= HASH_TOMB) return 0;
+        if (atomic_compare_exchange_weak_explicit(&from->epoch, &e, e + 1,
+                                                  memory_order_seq_cst, memory_order_relaxed))
+            break;
+    }
+    if (wait_unpinned(from) != 0) {
+        atomic_store_explicit(&from->epoch, e, memory_order_release);
+        return -1;
+    }
+    const char *key = slot_key(src, from);
+
+    // Writers move a key before writing it to the new table, so it can't be
+    // there already: we're only looking for a free slot.
+    for (;;) {
+        to = probe_for_write(st, dst, key, h, &dist);
+        if (!to) {
+            atomic_store_explicit(&from->epoch, e, memory_order_release);
+            return -1;
+        }
+        te = atomic_load_explicit(&to->epoch, memory_order_relaxed);
+        if (!(te & 1) && atomic_compare_exchange_weak_explicit(&to->epoch, &te, te + 1,
+                                                               memory_order_acq_rel, memory_order_relaxed)) {
+            th = atomic_load_explicit(&to->hash, memory_order_acquire);
+            if (th <= HASH_TOMB) break;
+            atomic_store_explicit(&to->epoch, te, memory_order_release);
+        }
+        cpu_relax();
+    }
+
+    // Fixed values are copied; arena values just change hands.
+    size_t len = atomic_load_explicit(&from->val_len, memory_order_relaxed);
+    if (dst->fixed_blks) {
+        uint8_t *v = slot_value(dst, to);
+        memcpy(v, slot_value(src, from), len);
+        if (atomic_load_explicit(&H->auto_vacuum, memory_order_relaxed) == 1)
+            memset(v + len, 0, H->max_val_sz - len);
+    } else {
+        atomic_store_explicit(&to->val_blk, atomic_load_explicit(&from->val_blk, memory_order_relaxed),
+                              memory_order_relaxed);
+        set_slot_class(to, slot_class(from));
+        set_slot_class(from, ARENA_NO_CLASS);
+    }
+    to->val_type = from->val_type;
+    atomic_store_explicit(&to->expires, atomic_load_explicit(&from->expires, memory_order_relaxed),
+                          memory_order_relaxed);
+    atomic_store_explicit(&to->ref, atomic_load_explicit(&from->ref, memory_order_relaxed),
+                          memory_order_relaxed);
+    atomic_store_explicit(&to->written, atomic_load_explicit(&from->written, memory_order_relaxed),
+                          memory_order_relaxed);
+    __atomic_store_n(&dst->TAGS[to - dst->S], __atomic_load_n(&src->TAGS[from - src->S], __ATOMIC_RELAXED),
+                     __ATOMIC_RELAXED);
+    if (dst->VECS && atomic_load_explicit(&from->embedded, memory_order_relaxed)) {
+        memcpy(slot_vec(dst, to), slot_vec(src, from), (size_t)H->embed_dim * sizeof(float));
+        atomic_store_explicit(&to->embedded, 1, memory_order_relaxed);
+    }
+    if (dst->SUMS)
+        atomic_store_explicit(&dst->SUMS[to - dst->S],
+                              atomic_load_explicit(&src->SUMS[from - src->S], memory_order_relaxed),
+                              memory_order_relaxed);
+    atomic_store_explicit(&to->val_len, (uint32_t)len, memory_order_release);
+    memcpy(slot_key(dst, to), key, SPLINTER_KEY_MAX);
+    note_probe_dist(dst, dist);
+    atomic_thread_fence(memory_order_release);
+    ctrl_store(&dst->CTRL[to - dst->S], ctrl_tag(h));
+    atomic_store_explicit(&to->hash, h, memory_order_release);
+    if (dst->IDX) index_insert(st, dst, to, h);
+    if (th == HASH_EMPTY) atomic_fetch_add_explicit(dst->used, 1, memory_order_relaxed);
+
+    // A move is a write as far as epochs go (see write_key() on the floor).
+    atomic_fetch_add_explicit(&H->epoch, 1, memory_order_relaxed);
+    uint64_t done = (te > e ? te : e) + 2;
+    atomic_store_explicit(&to->epoch, done, memory_order_release);
+
+    atomic_store_explicit(&from->hash, HASH_TOMB, memory_order_release);
+    ctrl_store(&src->CTRL[from - src->S], CTRL_TOMB);
+    atomic_store_explicit(&from->val_len, 0, memory_order_release);
+    atomic_store_explicit(&from->epoch, e + 2, memory_order_release);
+
+    feed_append(st, dst, to, done, h, SPLINTER_CHANGE_SET);
+    wake_watchers(st, from, 0);
+    // The new table's graph is built as keys arrive in it.
+    if (dst->ANN_HEAD && atomic_load_explicit(&to->embedded, memory_order_relaxed)) ann_link(st, dst, to);
+    return 0;
+}
+
+/**
+ * @brief Makes sure a key isn't left in the old table before it's written
+ * to the new one.
+ *
+ * Walks the key's probe chain in the old table to its end, waiting out any
+ * slot a writer holds: one that locked it before the resize started may be
+ * about to publish this very key there. Then moves the key if it's there.
+ *
+ * @return 0 on success, -1 with errno = ENOSPC if the new table is full.
+ */
+static int migrate_key(splinter_store_t *st, const struct store_map *m, const char *key, uint64_t h) {
+    const struct table *t = &m->old;
+    size_t idx = slot_idx(t, h), d;
+
+    for (d = 0; d < t->slots; d++) {
+        struct splinter_slot *slot = &t->S[idx];
+        while (atomic_load_explicit(&slot->epoch, memory_order_seq_cst) & 1)
+            cpu_relax();
+        if (slot_has_key(t, slot, h, key))
+            return move_slot(st, m, slot);
+        if (__atomic_load_n(&t->CTRL[idx], __ATOMIC_ACQUIRE) == CTRL_EMPTY) break;
+        if (++idx == t->slots) idx = 0;
+    }
+    return 0;
+}
+
+/**
+ * @brief Gives the memory behind [from, to) of the mapping back (whole pages
+ * only). Best-effort: the pages read as zeros either way.
+ */
+static void punch_range(splinter_store_t *st, const void *from, const void *to) {
+    uint64_t pg = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t a = ((uint64_t)((const uint8_t *)from - (uint8_t *)st->base) + pg - 1) & ~(pg - 1);
+    uint64_t b = (uint64_t)((const uint8_t *)to - (uint8_t *)st->base) & ~(pg - 1);
+    int saved = errno;
+
+    if (b > a) fallocate(st->fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, (off_t)a, (off_t)(b - a));
+    errno = saved;
+}
+
+/**
+ * @brief Ends a migration whose old table has no keys left: makes gen even
+ * and frees the old table's memory. Only the first caller does anything.
+ */
+static void migrate_finish(splinter_store_t *st, const struct store_map *m) {
+    const struct table *t = &m->old;
+    uint32_t gen = m->gen;
+
+    if (!atomic_compare_exchange_strong_explicit(&st->H->gen, &gen, gen + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed))
+        return;
+    // Anyone still using the old table only finds tombstones there, and
+    // zeros read as empty slots just as well.
+    punch_range(st, t->S, t->KEYS + (size_t)t->slots * SPLINTER_KEY_MAX);
+    punch_range(st, t->TAGS, t->TAGS + t->slots);
+    if (t->SUMS) punch_range(st, t->SUMS, t->SUMS + t->slots);
+    if (t->WHEEL) punch_range(st, t->WHEEL, t->LINKS + t->slots);
+    if (t->IDX) punch_range(st, t->IDX_HEAD, t->IDX + t->slots);
+    if (t->VECS) punch_range(st, t->VECS, t->VECS + (size_t)t->slots * t->vec_floats);
+    if (t->ANN) {
+        // after any link into it that started before gen moved on
+        ann_lock(st->H);
+        punch_range(st, t->ANN_HEAD, t->ANN_POOL + t->ann_pool_len);
+        ann_unlock(st->H);
+    }
+    if (t->fixed_blks) punch_range(st, t->VALUES, t->VALUES + t->values_sz);
+}
+
+/**
+ * @brief Adds n to a migration cursor, if it still belongs to m's gen and
+ * stays within limit (clamping at it).
+ * @return The cursor's previous count, or UINT64_MAX if nothing was added.
+ */
+static uint64_t migrate_cursor_add(atomic_uint_least64_t *cursor, const struct store_map *m, uint64_t n,
+    uint64_t limit) {
+    uint64_t cur = atomic_load_explicit(cursor, memory_order_relaxed);
+    uint64_t count;
+
+    do {
+        count = (uint32_t)cur;
+        if ((cur >> 32) != m->gen || count >= limit) return UINT64_MAX;
+    } while (!atomic_compare_exchange_weak_explicit(cursor, &cur,
+                                                    ((uint64_t)m->gen << 32) | (count + n < limit ? count + n : limit),
+                                                    memory_order_acq_rel, memory_order_relaxed));
+    return count;
+}
+
+/**
+ * @brief Moves the keys in the next n slots of a migration, if any are left
+ * to hand out. Slots whose key can't be moved (the new table is full) are
+ * left for migrate_run()'s sweep.
+ * @return 1 if it did some work, 0 if there was none.
+ */
+static int migrate_step(splinter_store_t *st, const struct store_map *m, size_t n) {
+    struct splinter_header *H = st->H;
+    uint64_t i = migrate_cursor_add(&H->migrate_next, m, n, m->old.slots);
+    uint64_t end, moved = 0;
+
+    if (i == UINT64_MAX) return 0;
+    end = i + n < m->old.slots ? i + n : m->old.slots;
+    for (; i < end; i++)
+        moved += move_slot(st, m, &m->old.S[i]) == 0;
+    uint64_t done = migrate_cursor_add(&H->migrate_done, m, moved, m->old.slots);
+    if (done != UINT64_MAX && done + moved == m->old.slots)
+        migrate_finish(st, m);
+    return 1;
+}
+
+/**
+ * @brief Drives a migration to the end, if one is under way.
+ *
+ * Takes chunks until there are none left, then sweeps the whole old table
+ * once more: that waits for moves still in flight, and picks up keys a
+ * writer couldn't move (or never got to, if its process died). After the
+ * sweep the old table has no keys left.
+ *
+ * @return 0 once the store is stable, -1 on failure (errno = ENOSPC if the
+ * new table filled up before every key could be moved).
+ */
+static int migrate_run(splinter_store_t *st) {
+    const struct store_map *m;
+
+    while ((m = store_map(st)) && (m->gen & 1)) {
+        if (migrate_step(st, m, MIGRATE_CHUNK)) continue;
+        for (size_t i = 0; i < m->old.slots; i++)
+            if (move_slot(st, m, &m->old.S[i]) != 0) return -1;
+        migrate_finish(st, m);
+    }
+    return m ? 0 : -1;
+}
+
+/**
+ * @brief Takes the store's resize lock (held only while a new table is laid
+ * out), breaking it if the process holding it has died.
+ * @return 0 on success, -1 with errno = EBUSY if another resize is starting.
+ */
+static int resize_claim(struct splinter_header *H) {
+    return owner_claim(&H->resize_owner) < 0 ? -1 : 0;
+}
+
+/**
+ * @brief Grows a store's slot table, while other processes keep using it.
+ *
+ * The new table is appended to the backing object (which can grow up to
+ * max_size), and keys are moved over incrementally as described above;
+ * this call returns once they all have been. Readers and writers carry on
+ * throughout. Each moved key gets a new epoch, so pollers and watch sets
+ * see it change once, and it's recorded in the change feed again.
+ *
+ * If the new table fills up with new keys before every old one has been
+ * moved, this fails with ENOSPC and the store stays in its migrating state
+ * (fully usable, lookups just check both tables); calling it again once
+ * keys have been deleted finishes the job.
+ *
+ * @param st The store to operate on.
+ * @param slots The new number of slots (more than it has now).
+ * @return 0 on success, -1 on failure (errno = EBUSY if another resize is
+ * starting, EFBIG past max_size, ENOSPC as above), -2 on invalid arguments.
+ */
+int splinter_store_resize(splinter_store_t *st, size_t slots) {
+    if (!st || !st->H) return -2;
+    struct splinter_header *H = st->H;
+    const struct store_map *m;
+
+    // Finish a migration that's still going (its resizer died, say) first.
+    if (migrate_run(st) != 0 || !(m = store_map(st))) return -1;
+    if (slots <= m->cur.slots || slots > UINT32_MAX ||
+        (!H->arena_sz && slots * H->val_stride / ARENA_BLOCK >= ARENA_NO_BLOCK) ||
+        (H->ann_m && ann_pool_len(slots, H->ann_m) >= UINT32_MAX)) {
+        errno = EINVAL;
+        return -2;
+    }
+    if (resize_claim(H) != 0) return -1;
+    uint32_t gen = atomic_load_explicit(&H->gen, memory_order_acquire);
+    if (gen != m->gen) {
+        // someone else got a resize in first
+        atomic_store_explicit(&H->resize_owner, 0, memory_order_release);
+        errno = EBUSY;
+        return -1;
+    }
+
+    // Slot metadata, control bytes, keys, tag blooms (checksums, timing
+    // wheel, key index, embeddings, HNSW graph and values, if the store has
+    // them) after everything there is so far, starting on a fresh page.
+    uint64_t align = (H->map_flags & SPLINTER_MAP_HUGEPAGES) ? HUGE_PAGE_SZ : (uint64_t)sysconf(_SC_PAGESIZE);
+    struct table_geom g = { .slots = (uint32_t)slots };
+    g.slots_off = (atomic_load_explicit(&H->total_sz, memory_order_relaxed) + align - 1) & ~(align - 1);
+    g.ctrl_off = line_align(g.slots_off + slots * sizeof(struct splinter_slot));
+    g.keys_off = line_align(g.ctrl_off + slots + CTRL_GROUP);
+    g.tags_off = line_align(g.keys_off + slots * SPLINTER_KEY_MAX);
+    uint64_t end = g.tags_off + slots * sizeof(uint64_t);
+    if (m->cur.SUMS) {
+        g.sums_off = line_align(end);
+        end = g.sums_off + slots * sizeof(uint32_t);
+    }
+    if (m->cur.WHEEL) {
+        g.wheel_off = line_align(end);
+        end = g.wheel_off + wheel_size(slots);
+    }
+    if (m->cur.IDX) {
+        g.index_off = line_align(end);
+        end = g.index_off + index_size(slots);
+    }
+    if (m->cur.VECS) {
+        g.vecs_off = line_align(end);
+        end = g.vecs_off + slots * H->embed_stride;
+    }
+    if (m->cur.ANN) {
+        g.ann_off = line_align(end);
+        end = g.ann_off + ann_size(slots, H->ann_m);
+    }
+    if (H->arena_sz) {
+        g.values_off = (uint64_t)(m->cur.VALUES - (uint8_t *)st->base);
+    } else {
+        g.values_off = line_align(end);
+        end = g.values_off + slots * H->val_stride;
+    }
+    end = (end + align - 1) & ~(align - 1);
+
+    struct stat st_buf;
+    int rc = 0;
+    if (end > H->max_size) {
+        errno = EFBIG;
+        rc = -1;
+    } else if (fstat(st->fd, &st_buf) != 0 ||
+               ((uint64_t)st_buf.st_size < end && ftruncate(st->fd, (off_t)end) != 0)) {
+        rc = -1;
+    } else {
+        uint32_t next = (m->cur.id + 1) & 1;
+        H->tables[next] = g;
+        atomic_store_explicit(&H->max_probe[next], 0, memory_order_relaxed);
+        atomic_store_explicit(&H->used[next], 0, memory_order_relaxed);
+        atomic_store_explicit(&H->migrate_next, (uint64_t)(gen + 1) << 32, memory_order_relaxed);
+        atomic_store_explicit(&H->migrate_done, (uint64_t)(gen + 1) << 32, memory_order_relaxed);
+        atomic_store_explicit(&H->total_sz, end, memory_order_release);
+        // Pairs with the gen check writers make after locking a slot.
+        atomic_store_explicit(&H->gen, gen + 1, memory_order_seq_cst);
+    }
+    atomic_store_explicit(&H->resize_owner, 0, memory_order_release);
+    return rc == 0 ? migrate_run(st) : rc;
+}
+
+/**
+ * @brief Finds the slot holding a key in whichever table it's in: the old
+ * table first while a resize is migrating (keys only move from old to new,
+ * so looking the other way round could miss one in both). A miss on tables
+ * a resize has since replaced is retried on the new ones. Keys that have
+ * expired aren't found; a key that is found counts as used (see slot_touch()).
+ * @param tp Receives the table the slot belongs to. Can be NULL.
+ * @return The slot, or NULL with errno = ENOENT.
+ */
+static struct splinter_slot *lookup(splinter_store_t *st, const struct store_map *m, const char *key,
+    uint64_t h, const struct table **tp) {
+    const struct table *t = &m->old;
+    struct splinter_slot *slot = NULL;
+
+    if (!t->S || !(slot = find_slot(st, t, key, h))) {
+        t = &m->cur;
+        slot = find_slot(st, t, key, h);
+    }
+    if (!slot && atomic_load_explicit(&st->H->gen, memory_order_acquire) != m->gen) {
+        // A resize may have moved the key out of the tables we searched.
+        const struct store_map *now = store_map(st);
+        if (now && now != m) return lookup(st, now, key, h, tp);
+    }
+    if (tp) *tp = t;
+    if (slot && slot_expired(slot)) {
+        // gone as far as anyone can tell, until the reaper (or a writer) deletes it
+        errno = ENOENT;
+        return NULL;
+    }
+    if (slot) slot_touch(slot);
+    return slot;
+}
+
+/**
+ * @brief What writers do while a resize is migrating: move their own key to
+ * the new table, and a few more slots besides.
+ * @return 0 on success, -1 with errno = ENOSPC if the new table is full.
+ */
+static int migrate_help(splinter_store_t *st, const struct store_map *m, const char *key, uint64_t h) {
+    if (!m->old.S) return 0;
+    migrate_step(st, m, MIGRATE_HELP);
+    return migrate_key(st, m, key, h);
+}
+
+/**
+ * @brief Deletes the key in a slot its caller has locked (epoch e + 1) and
+ * drained of integer operations: leaves a tombstone in place of the hash,
+ * scrubs the slot and releases the lock.
+ * @return The length of the value deleted.
+ */
+static int clear_slot(splinter_store_t *st, const struct table *t, struct splinter_slot *slot, uint64_t e,
+    uint64_t h) {
+    struct splinter_header *H = st->H;
+    int ret = (int)atomic_load_explicit(&slot->val_len, memory_order_acquire);
+
+    if (t->IDX) index_remove(st, t, slot);
+
+    // Leave a tombstone → slot reusable, chain unbroken
+    atomic_store_explicit(&slot->hash, HASH_TOMB, memory_order_release);
+    ctrl_store(&t->CTRL[slot - t->S], CTRL_TOMB);
+    atomic_fetch_sub_explicit(&H->keys, 1, memory_order_relaxed);
+
+    // Cleanup
+
+    char *slot_k = slot_key(t, slot);
+    if (atomic_load_explicit(&H->auto_vacuum, memory_order_relaxed) == 1) {
+        memset(slot_value(t, slot), 0, slot_class(slot) == ARENA_NO_CLASS ?
+            (size_t)H->max_val_sz : (size_t)ARENA_BLOCK << slot_class(slot));
+        memset(slot_k, 0, SPLINTER_KEY_MAX);
+        if (t->VECS && atomic_load_explicit(&slot->embedded, memory_order_relaxed))
+            memset(slot_vec(t, slot), 0, (size_t)H->embed_dim * sizeof(float));
+    } else {
+        slot_k[0] = '\0';
+    }
+
+    atomic_store_explicit(&slot->val_len, 0, memory_order_release);
+
+    // Arena values give their block back (readers still in it will fail validation)
+    if (slot_class(slot) != ARENA_NO_CLASS) {
+        arena_free(st, value_blk(t, slot, memory_order_relaxed), slot_class(slot));
+        set_slot_class(slot, ARENA_NO_CLASS);
+    }
+    slot->val_type = SLOT_BYTES;
+    atomic_store_explicit(&slot->expires, 0, memory_order_relaxed);
+    atomic_store_explicit(&slot->ref, 0, memory_order_relaxed);
+    __atomic_store_n(&t->TAGS[slot - t->S], 0, __ATOMIC_RELAXED);
+    atomic_store_explicit(&slot->embedded, 0, memory_order_relaxed);
+
+    // Release the seqlock (net +2, leaves the epoch even)
+    atomic_fetch_add_explicit(&slot->epoch, 1, memory_order_release);
+
+    // Deletes are writes too (and keep the global epoch ahead of slot epochs).
+    atomic_fetch_add_explicit(&H->epoch, 1, memory_order_relaxed);
+    feed_append(st, t, slot, e + 2, h, SPLINTER_CHANGE_UNSET);
+    wake_watchers(st, slot, 0);
+    return ret;
+}
+
+/**
+ * @brief "unsets" a key (delete).
+ *
+ * This function takes the slot's seqlock, leaves a tombstone in place of the
+ * hash so probe chains running through the slot stay intact, and scrubs the
+ * slot. If the slot is observed in the middle of a write (odd epoch), it
+ * returns -1 with errno = EAGAIN so the caller can retry. During a resize
+ * the key is deleted from whichever table holds it (deleting keys is how a
+ * migration that ran out of room gets going again).
+ *
+ * @param st The store to operate on.
+ * @param key The null-terminated key string.
+ * @return length of value deleted on success,
+ *         -1 if key not found,
+ *         -2 if store or key are invalid,
+ *         -1 with errno = EAGAIN if writer in progress.
+ */
+int splinter_store_unset(splinter_store_t *st, const char *key) {
+    if (!st || !st->H || !key) return -2;
+    struct splinter_header *H = st->H;
+    uint64_t h = key_hash(st, key);
+    const struct store_map *m;
+    const struct table *t;
+    struct splinter_slot *slot;
+    uint64_t e;
+
+    for (;;) {
+        if (!(m = store_map(st))) return -1;
+        slot = lookup(st, m, key, h, &t);
+        if (!slot) return -1; // didn't find it
+
+        e = atomic_load_explicit(&slot->epoch, memory_order_acquire);
+        if ((e & 1) || !atomic_compare_exchange_strong_explicit(&slot->epoch, &e, e + 1,
+                                                                memory_order_seq_cst, memory_order_relaxed)) {
+            // Writer in progress
+            errno = EAGAIN;
+            return -1;
+        }
+        // See write_key(): a resize that started since we looked would miss this.
+        if (atomic_load_explicit(&H->gen, memory_order_seq_cst) == m->gen) break;
+        atomic_store_explicit(&slot->epoch, e, memory_order_release);
+    }
+    if (!slot_has_key(t, slot, h, key)) {
+        // Deleted or replaced before we got the lock; nothing was written.
+        atomic_store_explicit(&slot->epoch, e, memory_order_release);
+        errno = ENOENT;
+        return -1;
+    }
+
+    if (wait_unpinned(slot) != 0) {
+        atomic_store_explicit(&slot->epoch, e, memory_order_release);
+        return -1;
+    }
+    return clear_slot(st, t, slot, e, h);
+}
+
+/**
+ * @brief Deletes the key in a slot, as splinter_store_unset() would, if the
+ * slot isn't locked by anyone right now.
+ * @param expired_only Only if the key has expired.
+ * @return 1 if the key was deleted, 0 if the slot is free or (with
+ * expired_only) the key hasn't expired, a writer holds the slot, or a resize
+ * has started since m.
+ */
+static int drop_slot(splinter_store_t *st, const struct store_map *m, const struct table *t,
+    struct splinter_slot *slot, int expired_only) {
+    uint64_t e = atomic_load_explicit(&slot->epoch, memory_order_acquire);
+    uint64_t h = atomic_load_explicit(&slot->hash, memory_order_acquire);
+
+    if ((e & 1) || h <= HASH_TOMB || (expired_only && !slot_expired(slot)) ||
+        !atomic_compare_exchange_strong_explicit(&slot->epoch, &e, e + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed))
+        return 0;
+    // As in splinter_store_unset(); and the key may have been rewritten or
+    // given more time before we got the lock.
+    if (atomic_load_explicit(&st->H->gen, memory_order_seq_cst) != m->gen ||
+        atomic_load_explicit(&slot->hash, memory_order_acquire) != h ||
+        (expired_only && !slot_expired(slot))) {
+        atomic_store_explicit(&slot->epoch, e, memory_order_release);
+        return 0;
+    }
+    if (wait_unpinned(slot) != 0) {
+        atomic_store_explicit(&slot->epoch, e, memory_order_release);
+        return 0;
+    }
+    clear_slot(st, t, slot, e, h);
+    return 1;
+}
+
+/**
+ * @brief Deletes an expired key (see drop_slot()), counting it.
+ * @return 1 if the key was deleted, 0 otherwise.
+ */
+static int expire_slot(splinter_store_t *st, const struct store_map *m, const struct table *t,
+    struct splinter_slot *slot) {
+    if (!drop_slot(st, m, t, slot, 1)) return 0;
+    atomic_fetch_add_explicit(&st->H->expired, 1, memory_order_relaxed);
+    return 1;
+}
+
+/** @brief Slots from a key's home a writer checks for expired keys when the table is full. */
+#define RECLAIM_WINDOW 256
+
+/**
+ * @brief Makes room for a key in a full table by deleting an expired key
+ * near its home slot (with no empty slots left, every slot is on its probe
+ * chain, so the one freed is one the key can use).
+ * @return 1 if a slot was freed, 0 with errno = ENOSPC if there was none.
+ */
+static int reclaim_expired(splinter_store_t *st, const struct store_map *m, uint64_t h) {
+    const struct table *t = &m->cur;
+    size_t idx = slot_idx(t, h), d;
+
+    for (d = 0; d < t->slots && d < RECLAIM_WINDOW; d++) {
+        if (expire_slot(st, m, t, &t->S[idx])) return 1;
+        if (++idx == t->slots) idx = 0;
+    }
+    errno = ENOSPC;
+    return 0;
+}
+
+
+/**
+ * @brief Picks a CLOCK victim among the n slots from idx: sweeps them
+ * clearing reference bits, and stops at the first key that had none (it
+ * hasn't been used since the last sweep passed it). If every key had been
+ * used, the first one swept is the victim.
+ */
+static struct splinter_slot *evict_clock(const struct table *t, size_t idx, size_t n) {
+    struct splinter_slot *first = NULL;
+
+    for (size_t d = 0; d < n; d++, idx = idx + 1 == t->slots ? 0 : idx + 1) {
+        struct splinter_slot *slot = &t->S[idx];
+        if ((atomic_load_explicit(&slot->epoch, memory_order_relaxed) & 1) ||
+            atomic_load_explicit(&slot->hash, memory_order_relaxed) <= HASH_TOMB)
+            continue;
+        if (!atomic_load_explicit(&slot->ref, memory_order_relaxed)) return slot;
+        atomic_store_explicit(&slot->ref, 0, memory_order_relaxed);
+        if (!first) first = slot;
+    }
+    return first;
+}
+
+/**
+ * @brief Picks the key among the n slots from idx written longest ago or,
+ * with by_expiry, the one expiring soonest (keys without an expiry don't
+ * count).
+ */
+static struct splinter_slot *evict_min(const struct table *t, size_t idx, size_t n, int by_expiry) {
+    struct splinter_slot *victim = NULL;
+    uint64_t best = UINT64_MAX;
+
+    for (size_t d = 0; d < n; d++, idx = idx + 1 == t->slots ? 0 : idx + 1) {
+        struct splinter_slot *slot = &t->S[idx];
+        uint64_t e = atomic_load_explicit(&slot->epoch, memory_order_relaxed);
+        if ((e & 1) || atomic_load_explicit(&slot->hash, memory_order_relaxed) <= HASH_TOMB)
+            continue;
+        uint64_t v = atomic_load_explicit(by_expiry ? &slot->expires : &slot->written,
+                                          memory_order_relaxed);
+        if ((v || !by_expiry) && (v < best || !victim)) {
+            best = v;
+            victim = slot;
+        }
+    }
+    return victim;
+}
+
+/** @brief Victims a writer to a full table tries before giving up (others can be locking them). */
+#define EVICT_TRIES 4
+
+/**
+ * @brief Makes room for a key in a full table by evicting a live key near
+ * its home slot, as the store's eviction policy picks it. Like
+ * reclaim_expired(), the slot freed is on the key's probe chain.
+ * @return 1 if a slot was freed, 0 with errno = ENOSPC if the policy is
+ * SPLINTER_EVICT_NONE or no victim could be taken.
+ */
+static int evict_one(splinter_store_t *st, const struct store_map *m, uint64_t h) {
+    uint32_t policy = atomic_load_explicit(&st->H->evict_policy, memory_order_relaxed);
+    const struct table *t = &m->cur;
+    size_t idx = slot_idx(t, h), n = t->slots < RECLAIM_WINDOW ? t->slots : RECLAIM_WINDOW;
+
+    for (int i = 0; policy != SPLINTER_EVICT_NONE && i < EVICT_TRIES; i++) {
+        struct splinter_slot *victim =
+            policy == SPLINTER_EVICT_OLDEST ? evict_min(t, idx, n, 0) :
+            policy == SPLINTER_EVICT_TTL ? evict_min(t, idx, n, 1) : NULL;
+        if (!victim) victim = evict_clock(t, idx, n);
+        if (!victim) break;
+        if (drop_slot(st, m, t, victim, 0)) {
+            atomic_fetch_add_explicit(&st->H->evicted, 1, memory_order_relaxed);
+            return 1;
+        }
+    }
+    errno = ENOSPC;
+    return 0;
+}
+
+/**
+ * @brief Total length of an iovec array, saturating at SIZE_MAX.
+ */
+static size_t iov_total(const struct iovec *iov, int iovcnt) {
+    size_t total = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_len > SIZE_MAX - total) return SIZE_MAX;
+        total += iov[i].iov_len;
+    }
+    return total;
+}
+
+/** @brief How a write_op combines its bytes with the value already stored. */
+enum write_mode {
+    WRITE_REPLACE,  /**< The bytes become the whole value. */
+    WRITE_RANGE,    /**< The bytes land at off; the rest of the value is kept. */
+    WRITE_APPEND,   /**< The bytes land at the current end of the value. */
+    WRITE_EXPIRY,   /**< Only the key's expiry changes (ENOENT if there's no key). */
+    WRITE_TAGS,     /**< Only the key's tag bloom changes (ENOENT if there's no key). */
+};
+
+/** @brief write_op.expires: leave the key's expiry as it is (none, for a new key). */
+#define EXPIRES_KEEP  0ull
+/** @brief write_op.expires: take the key's expiry away. */
+#define EXPIRES_NEVER UINT64_MAX
+
+/** @brief What must hold, under the slot lock, for a write_op to go ahead. */
+enum write_cond {
+    COND_NONE,      /**< Always write. */
+    COND_ABSENT,    /**< Only create the key (EEXIST if it's already there). */
+    COND_PRESENT,   /**< Only update the key (ENOENT if it isn't there). */
+    COND_EPOCH,     /**< Slot epoch must equal cond_arg, 0 meaning absent (ESTALE). */
+    COND_INT_EQ,    /**< Integer value must equal cond_arg (ECANCELED). */
+    COND_INT_LT,    /**< Integer value must be less than cond_arg (ECANCELED). */
+    COND_INT_GT,    /**< Integer value must be greater than cond_arg (ECANCELED). */
+};
+
+/**
+ * @brief One write to a key: what to write and where it goes.
+ */
+struct write_op {
+    enum write_mode mode;
+    /** @brief Where the bytes go (WRITE_RANGE only). */
+    size_t off;
+    /** @brief The bytes, gathered in order; their lengths add up to len. */
+    const struct iovec *iov;
+    int iovcnt;
+    size_t len;
+    /** @brief Value type to store (WRITE_REPLACE only; partial writes are to bytes). */
+    uint8_t type;
+    /** @brief Condition checked once the slot is locked, before anything is written. */
+    enum write_cond cond;
+    /** @brief Operand for cond: an expected epoch, or an int64_t to compare with. */
+    uint64_t cond_arg;
+    /** @brief New expiry (CLOCK_REALTIME ms), or EXPIRES_KEEP / EXPIRES_NEVER. */
+    uint64_t expires;
+    /** @brief WRITE_TAGS: bits to clear from the key's tag bloom, then bits to set. */
+    uint64_t tags_clear, tags_set;
+    /** @brief An embedding (embed_dim floats) to store with the write; NULL keeps the key's. */
+    const float *vec;
+};
+
+/**
+ * @brief Checks a write_op's condition against the slot it's about to write.
+ *
+ * Called with the slot locked (odd epoch) and unpinned, so neither the
+ * epoch nor an integer value can change while we look at them.
+ *
+ * @param e The slot epoch as it was before we locked it.
+ * @return 0 if the write can go ahead, otherwise the errno to fail with.
+ */
+static int write_cond_check(const struct table *t, struct splinter_slot *slot, int existing,
+    uint64_t e, const struct write_op *op) {
+    switch (op->cond) {
+        case COND_NONE:
+            return 0;
+        case COND_ABSENT:
+            return existing ? EEXIST : 0;
+        case COND_PRESENT:
+            return existing ? 0 : ENOENT;
+        case COND_EPOCH:
+            return (existing ? e : 0) == op->cond_arg ? 0 : ESTALE;
+        default:
+            break;
+    }
+
+    if (!existing) return ENOENT;
+    uint32_t blk = value_blk(t, slot, memory_order_relaxed);
+    if (slot->val_type != SLOT_INT ||
+        atomic_load_explicit(&slot->val_len, memory_order_relaxed) != sizeof(uint64_t) ||
+        !value_in_bounds(t, blk, sizeof(uint64_t)))
+        return EINVAL;
+
+    int64_t cur = (int64_t)atomic_load_explicit(
+        (atomic_uint_least64_t *)(t->VALUES + (uint64_t)blk * ARENA_BLOCK), memory_order_relaxed);
+    int64_t arg = (int64_t)op->cond_arg;
+    int ok = op->cond == COND_INT_EQ ? cur == arg : op->cond == COND_INT_LT ? cur < arg : cur > arg;
+    return ok ? 0 : ECANCELED;
+}
+
+/**
+ * @brief Writes one key's value under its slot seqlock.
+ *
+ * Everything splinter_store_set() does except argument checks and the global
+ * epoch bump, which batch writers do once for the whole batch.
+ *
+ * Partial writes (WRITE_RANGE / WRITE_APPEND) only copy the new bytes; a key
+ * that doesn't exist yet starts out empty, and a gap between the end of the
+ * value and off reads back as zeros. In an arena store the value moves to a
+ * bigger block only once it outgrows its size class, so growing a value a
+ * piece at a time costs amortised O(1) copies per byte.
+ *
+ * Writes always go to the current table; during a resize the key is first
+ * moved out of the old one (see migrate_key()). A key that has expired is
+ * deleted first and written as a new one, and a full table gives up the
+ * expired keys near the key's home slot before the write fails (or, with an
+ * eviction policy, before it evicts a live one; see evict_one()).
+ *
+ * @return 0 on success, -1 on failure with errno set (EMSGSIZE if the value
+ * would grow past max_val_sz, EINVAL for a partial write to an integer, or
+ * whatever write_cond_check() said if op->cond doesn't hold).
+ */
+static int write_key(splinter_store_t *st, const char *key, uint64_t h, const struct write_op *op) {
+    struct splinter_header *H = st->H;
+    const struct store_map *m;
+    const struct table *t;
+    struct splinter_slot *slot;
+    size_t dist;
+    uint64_t e, slot_hash;
+    int existing;
+
+    for (;;) {
+        if (!(m = store_map(st)) || migrate_help(st, m, key, h) != 0) return -1;
+        t = &m->cur;
+        slot = probe_for_write(st, t, key, h, &dist);
+        if (!slot) {
+            // store full / no suitable slot, unless expired keys (or the
+            // eviction policy) make room; but the key isn't here, and writes
+            // that only change an existing key have nothing to make room for
+            if (errno == ENOSPC && (op->mode == WRITE_EXPIRY || op->mode == WRITE_TAGS)) errno = ENOENT;
+            if (errno == ENOSPC && (reclaim_expired(st, m, h) || evict_one(st, m, h))) continue;
+            return -1;
+        }
+
+        // Try to acquire the slot's seqlock: flip epoch from even -> odd.
+        e = atomic_load_explicit(&slot->epoch, memory_order_relaxed);
+        if (e & 1ull) {
+            if (slot_has_key(t, slot, h, key)) {
+                // Another writer is updating this very key.
+                errno = EAGAIN;
+                return -1;
+            }
+            // Someone is claiming the free slot we picked; look again.
+            cpu_relax();
+            continue;
+        }
+        // attempt to CAS epoch: e -> e+1 (make odd)
+        if (!atomic_compare_exchange_weak_explicit(&slot->epoch, &e, e + 1,
+                                                  memory_order_seq_cst, memory_order_relaxed))
+            continue;
+
+        // A resize that started since we looked would migrate (or already
+        // has migrated) this table without waiting for us; and one that
+        // finished retired it. Either way, put the epoch back and go again
+        // on the tables as they are now. Resizers publish gen before they
+        // look at slots, so between this load and theirs one of us sees
+        // the other.
+        if (atomic_load_explicit(&H->gen, memory_order_seq_cst) != m->gen) {
+            atomic_store_explicit(&slot->epoch, e, memory_order_release);
+            continue;
+        }
+
+        // Now that we own it, make sure the slot is still ours to write: our
+        // key, or still free. Otherwise put the epoch back (nothing was
+        // written, so readers can't tell) and probe again.
+        slot_hash = atomic_load_explicit(&slot->hash, memory_order_acquire);
+        existing = slot_has_key(t, slot, h, key);
+        if (existing && slot_expired(slot)) {
+            // Delete it properly (watchers and the feed see it go) and start
+            // over: the write creates the key afresh.
+            if (wait_unpinned(slot) != 0) {
+                atomic_store_explicit(&slot->epoch, e, memory_order_release);
+                return -1;
+            }
+            clear_slot(st, t, slot, e, h);
+            atomic_fetch_add_explicit(&H->expired, 1, memory_order_relaxed);
+            continue;
+        }
+        if (existing)
+            break;
+        if (slot_hash == HASH_EMPTY || slot_hash == HASH_TOMB) {
+            // Claiming a free slot: move its epoch past twice the global epoch.
+            // No slot epoch ever exceeds that bound, so a key that moves to
+            // a new slot can never come back with an epoch an old view holds.
+            uint64_t floor = 2 * atomic_load_explicit(&H->epoch, memory_order_relaxed);
+            if (floor > e)
+                atomic_store_explicit(&slot->epoch, floor + 1, memory_order_release);
+            break;
+        }
+        atomic_store_explicit(&slot->epoch, e, memory_order_release);
+    }
+
+    if (op->mode == WRITE_EXPIRY || op->mode == WRITE_TAGS) {
+        // Not a change to the value, so the epoch goes back as it was:
+        // views, pollers and the feed have nothing to see.
+        uint64_t *tags = &t->TAGS[slot - t->S];
+        if (existing && op->mode == WRITE_TAGS)
+            __atomic_store_n(tags, (__atomic_load_n(tags, __ATOMIC_RELAXED) & ~op->tags_clear) | op->tags_set,
+                             __ATOMIC_RELAXED);
+        else if (existing)
+            atomic_store_explicit(&slot->expires, op->expires == EXPIRES_NEVER ? 0 : op->expires,
+                                  memory_order_relaxed);
+        atomic_store_explicit(&slot->epoch, e, memory_order_release);
+        if (!existing) {
+            errno = ENOENT;
+            return -1;
+        }
+        if (op->mode == WRITE_EXPIRY && op->expires != EXPIRES_NEVER) exp_log_append(st, t, slot);
+        return 0;
+    }
+
+    // We have the slot in "writer active" (odd epoch) state. Once pinned
+    // integer updates drain, nothing else can touch it until we release.
+    int err = wait_unpinned(slot) != 0 ? EAGAIN : write_cond_check(t, slot, existing, e, op);
+    if (!err && existing && op->mode != WRITE_REPLACE && op->len && slot->val_type == SLOT_INT)
+        err = EINVAL;
+    if (err) {
+        atomic_store_explicit(&slot->epoch, e, memory_order_release);
+        errno = err;
+        return -1;
+    }
+
+    size_t old_len = existing ? atomic_load_explicit(&slot->val_len, memory_order_relaxed) : 0;
+    size_t off = op->mode == WRITE_APPEND ? old_len : op->mode == WRITE_RANGE ? op->off : 0;
+    size_t len = op->len;
+    if (op->mode != WRITE_REPLACE) {
+        if (off > H->max_val_sz || op->len > H->max_val_sz - off) {
+            atomic_store_explicit(&slot->epoch, e, memory_order_release);
+            errno = EMSGSIZE;
+            return -1;
+        }
+        len = off + op->len > old_len ? off + op->len : old_len;
+    }
+
+    uint32_t blk = value_blk(t, slot, memory_order_relaxed);
+    uint32_t old_blk = ARENA_NO_BLOCK;
+    unsigned int cls = ARENA_NO_CLASS, old_cls = slot_class(slot);
+    size_t block_sz = H->max_val_sz;
+    int moved = 0;
+
+    if (H->arena_sz) {
+        // Arena store: keep the current block if it's the right size class,
+        // otherwise move to a new one (falling back to a roomier old block).
+        // Partial writes keep any block that's big enough.
+        cls = arena_class(len);
+        if (op->mode != WRITE_REPLACE && old_cls != ARENA_NO_CLASS && old_cls > cls)
+            cls = old_cls;
+        if (old_cls != cls) {
+            uint32_t fresh = arena_alloc(st, cls);
+            if (fresh != ARENA_NO_BLOCK) {
+                old_blk = old_cls == ARENA_NO_CLASS ? ARENA_NO_BLOCK : blk;
+                blk = fresh;
+                moved = 1;
+            } else if (old_cls != ARENA_NO_CLASS && old_cls > cls) {
+                cls = old_cls;
+            } else {
+                // nothing was written: put the epoch back and fail safely
+                atomic_store_explicit(&slot->epoch, e, memory_order_release);
+                return -1;
+            }
+        }
+        block_sz = (size_t)ARENA_BLOCK << cls;
+    }
+
+    // Now validate the offset/range before touching memory.
+    if (!value_in_bounds(t, blk, block_sz)) {
+        atomic_store_explicit(&slot->epoch, e, memory_order_release);
+        return -1;
+    }
+
+    // Readers must be able to reach the slot before they can find the key in it.
+    note_probe_dist(t, dist);
+
+    // Perform the write: value -> val_len -> key -> publish hash -> complete epoch
+    uint8_t *dst = t->VALUES + (uint64_t)blk * ARENA_BLOCK;
+    int vacuum = atomic_load_explicit(&H->auto_vacuum, memory_order_relaxed) == 1;
+
+    if (op->mode == WRITE_REPLACE) {
+        // Clear full slot value region (keeps old tail bytes from leaking).
+        if (vacuum) memset(dst, 0, block_sz);
+    } else {
+        // Bring what's kept of the old value along, and clear what's past it
+        // (a fresh block may hold anything).
+        if (moved && old_len)
+            memcpy(dst, t->VALUES + (uint64_t)old_blk * ARENA_BLOCK, old_len);
+        if (off > old_len) memset(dst + old_len, 0, off - old_len);
+        if (moved && vacuum) memset(dst + len, 0, block_sz - len);
+    }
+    dst += off;
+    for (int i = 0; i < op->iovcnt; i++) {
+        memcpy(dst, op->iov[i].iov_base, op->iov[i].iov_len);
+        dst += op->iov[i].iov_len;
+    }
+
+    // Checksum what was just written, while it's still in cache. An append
+    // only has to extend the old value's CRC.
+    if (t->SUMS) {
+        atomic_uint_least32_t *sum = &t->SUMS[slot - t->S];
+        uint8_t *val = t->VALUES + (uint64_t)blk * ARENA_BLOCK;
+        uint32_t crc = op->mode == WRITE_APPEND && old_len ?
+            st->crc32c(atomic_load_explicit(sum, memory_order_relaxed), val + old_len, op->len) :
+            st->crc32c(0, val, len);
+        atomic_store_explicit(sum, crc, memory_order_relaxed);
+    }
+
+    // The embedding, if the write brings one, lands under the same seqlock.
+    if (op->vec) {
+        memcpy(slot_vec(t, slot), op->vec, (size_t)H->embed_dim * sizeof(float));
+        atomic_store_explicit(&slot->embedded, 1, memory_order_relaxed);
+    }
+
+    // Publish location and length atomically (release so readers see full bytes)
+    if (!t->fixed_blks) atomic_store_explicit(&slot->val_blk, blk, memory_order_release);
+    set_slot_class(slot, cls);
+    if (op->mode == WRITE_REPLACE) slot->val_type = op->type;
+    slot_touch(slot);
+    atomic_store_explicit(&slot->written, atomic_load_explicit(&H->epoch, memory_order_relaxed),
+                          memory_order_relaxed);
+    // A new key's expiry is in place before its hash can be found.
+    if (op->expires != EXPIRES_KEEP || !existing)
+        atomic_store_explicit(&slot->expires, op->expires == EXPIRES_NEVER ? 0 : op->expires,
+                              memory_order_relaxed);
+    atomic_store_explicit(&slot->val_len, (uint32_t)len, memory_order_release);
+    if (old_blk != ARENA_NO_BLOCK) arena_free(st, old_blk, old_cls);
+
+    // A slot that already holds the key keeps its key, tag and hash as they are.
+    if (!existing) {
+        // Update key (write full key buffer so readers can't see a partial key)
+        char *slot_k = slot_key(t, slot);
+        if (vacuum) {
+            memset(slot_k, 0, SPLINTER_KEY_MAX);
+        } else {
+            slot_k[0] = '\0';
+        }
+        strncpy(slot_k, key, SPLINTER_KEY_MAX - 1);
+        slot_k[SPLINTER_KEY_MAX - 1] = '\0';
+
+        // Ensure prior stores are visible before publishing hash
+        atomic_thread_fence(memory_order_release);
+
+        // Tag first, so a slot with a live hash never shows an empty control byte.
+        ctrl_store(&t->CTRL[slot - t->S], ctrl_tag(h));
+
+        // Only now publish the hash so readers will match only once value+key are in place.
+        atomic_store_explicit(&slot->hash, h, memory_order_release);
+        if (t->IDX) index_insert(st, t, slot, h);
+
+        atomic_fetch_add_explicit(&H->keys, 1, memory_order_relaxed);
+        if (slot_hash == HASH_EMPTY) atomic_fetch_add_explicit(t->used, 1, memory_order_relaxed);
+    }
+
+    // End seqlock: bump epoch to even (writer done). Use release to publish writes.
+    uint64_t done = atomic_fetch_add_explicit(&slot->epoch, 1, memory_order_release) + 1;
+
+    feed_append(st, t, slot, done, h, SPLINTER_CHANGE_SET);
+    if (op->expires != EXPIRES_KEEP && op->expires != EXPIRES_NEVER) exp_log_append(st, t, slot);
+    wake_watchers(st, slot, !existing);
+    if (op->vec && t->ANN_HEAD) ann_link(st, t, slot);
+    return 0;
+}
+
+/**
+ * @brief Sets or updates a key-value pair in the store.
+ *
+ * This function uses linear probing to resolve hash collisions. It updates
+ * the slot already holding the key, or inserts into the first free (empty or
+ * tombstoned) slot on the key's probe chain. If the store is full, the
+ * operation will fail.
+ *
+ * @param st The store to operate on.
+ * @param key The null-terminated key string.
+ * @param val Pointer to the value data.
+ * @param len The length of the value data. Must not exceed `max_val_sz`.
+ * @return 0 on success, -1 on failure (e.g., store is full (errno = ENOSPC),
+ * len is too large, or another writer holds the key's slot (errno = EAGAIN)).
+ */
+int splinter_store_set(splinter_store_t *st, const char *key, const void *val, size_t len) {
+    if (!st || !st->H || !key) return -1;
+    if (len == 0 || len > st->H->max_val_sz) return -1; // require non-zero len
+
+    struct iovec v = { .iov_base = (void *)val, .iov_len = len };
+    struct write_op op = { .mode = WRITE_REPLACE, .iov = &v, .iovcnt = 1, .len = len };
+    if (write_key(st, key, key_hash(st, key), &op) != 0) return -1;
+
+    // Update global epoch (best-effort, relaxed).
+    atomic_fetch_add_explicit(&st->H->epoch, 1, memory_order_relaxed);
+    return 0;
+}
+
+/**
+ * @brief Sets a key to the concatenation of several buffers.
+ *
+ * Behaves exactly like splinter_store_set() on the joined value, but copies
+ * each piece straight into the slot, so callers don't have to assemble it
+ * in a temporary buffer first.
+ *
+ * @param st The store to operate on.
+ * @param key The null-terminated key string.
+ * @param iov The pieces of the value, in order.
+ * @param iovcnt Number of entries in iov.
+ * @return 0 on success, -1 on failure (as splinter_store_set(); the total
+ * length must be non-zero and not exceed `max_val_sz`).
+ */
+int splinter_store_setv(splinter_store_t *st, const char *key, const struct iovec *iov, int iovcnt) {
+    if (!st || !st->H || !key || !iov || iovcnt <= 0) return -1;
+    size_t len = iov_total(iov, iovcnt);
+    if (len == 0 || len > st->H->max_val_sz) return -1; // require non-zero len
+
+    struct write_op op = { .mode = WRITE_REPLACE, .iov = iov, .iovcnt = iovcnt, .len = len };
+    if (write_key(st, key, key_hash(st, key), &op) != 0) return -1;
+
+    // Update global epoch (best-effort, relaxed).
+    atomic_fetch_add_explicit(&st->H->epoch, 1, memory_order_relaxed);
+    return 0;
+}
+
+/**
+ * @brief Sets a key only if nobody has written it since the caller read it.
+ *
+ * The compare happens after the slot seqlock is taken, so it's a true
+ * compare-and-set: of any number of writers racing with the same expected
+ * epoch, at most one succeeds. Take expected_epoch from the view the value
+ * was read through (splinter_store_get_view()) or from a slot snapshot.
+ *
+ * @param st The store to operate on.
+ * @param key The null-terminated key string.
+ * @param expected_epoch The (even) slot epoch the value was read at, or 0 to
+ * write only if the key doesn't exist.
+ * @param val Pointer to the value data.
+ * @param len The length of the value data (as splinter_store_set()).
+ * @return 0 on success, -1 on failure: errno = ESTALE if the key was written,
+ * deleted or created since, EAGAIN if another writer holds the slot right now,
+ * or as splinter_store_set().
+ */
+int splinter_store_set_if_epoch(splinter_store_t *st, const char *key, uint64_t expected_epoch,
+    const void *val, size_t len) {
+    if (!st || !st->H || !key) return -1;
+    if (len == 0 || len > st->H->max_val_sz) return -1; // require non-zero len
+
+    struct iovec v = { .iov_base = (void *)val, .iov_len = len };
+    struct write_op op = { .mode = WRITE_REPLACE, .iov = &v, .iovcnt = 1, .len = len,
+        .cond = COND_EPOCH, .cond_arg = expected_epoch };
+    if (write_key(st, key, key_hash(st, key), &op) != 0) return -1;
+
+    // Update global epoch (best-effort, relaxed).
+    atomic_fetch_add_explicit(&st->H->epoch, 1, memory_order_relaxed);
+    return 0;
+}
+
+/**
+ * @brief Appends bytes to a key's value.
+ *
+ * Only the new bytes are written (auto_vacuum doesn't clear the value
+ * first), so building a value up piece by piece costs what the pieces
+ * do, not the whole value each time. A missing key is created.
+ *
+ * @param st The store to operate on.
+ * @param key The null-terminated key string.
+ * @param data The bytes to append.
+ * @param len Number of bytes (non-zero).
+ * @return 0 on success, -1 on failure (as splinter_store_set(), or
+ * errno = EMSGSIZE if the value would grow past `max_val_sz`).
+ */
+int splinter_store_append(splinter_store_t *st, const char *key, const void *data, size_t len) {
+    if (!st || !st->H || !key || !data || len == 0) return -1;
+
+    struct iovec v = { .iov_base = (void *)data, .iov_len = len };
+    struct write_op op = { .mode = WRITE_APPEND, .iov = &v, .iovcnt = 1, .len = len };
+    if (write_key(st, key, key_hash(st, key), &op) != 0) return -1;
+
+    // Update global epoch (best-effort, relaxed).
+    atomic_fetch_add_explicit(&st->H->epoch, 1, memory_order_relaxed);
+    return 0;
+}
+
+/**
+ * @brief Overwrites part of a key's value, leaving the rest as it is.
+ *
+ * The value grows if the range runs past its end; writing beyond the end
+ * leaves a zero-filled gap. A missing key is created. Only the given bytes
+ * are written, as for splinter_store_append().
+ *
+ * @param st The store to operate on.
+ * @param key The null-terminated key string.
+ * @param off Offset into the value to write at.
+ * @param data The bytes to write.
+ * @param len Number of bytes (non-zero).
+ * @return 0 on success, -1 on failure (as splinter_store_append()).
+ */
+int splinter_store_set_range(splinter_store_t *st, const char *key, size_t off, const void *data,
+    size_t len) {
+    if (!st || !st->H || !key || !data || len == 0) return -1;
+
+    struct iovec v = { .iov_base = (void *)data, .iov_len = len };
+    struct write_op op = { .mode = WRITE_RANGE, .off = off, .iov = &v, .iovcnt = 1, .len = len };
+    if (write_key(st, key, key_hash(st, key), &op) != 0) return -1;
+
+    // Update global epoch (best-effort, relaxed).
+    atomic_fetch_add_explicit(&st->H->epoch, 1, memory_order_relaxed);
+    return 0;
+}
+
+/**
+ * @brief The expiry a key given ttl_ms from now gets (EXPIRES_NEVER for 0).
+ */
+static uint64_t expiry_after(uint64_t ttl_ms) {
+    if (ttl_ms == 0) return EXPIRES_NEVER;
+    uint64_t now = now_ms();
+    return ttl_ms < EXPIRES_NEVER - 1 - now ? now + ttl_ms : EXPIRES_NEVER - 1;
+}
+
+/**
+ * @brief Sets a key, which expires ttl_ms from now.
+ *
+ * Once a key has expired it reads as missing everywhere (get, views, list,
+ * polls, watch sets). Its slot is given back when the reaper deletes it (see
+ * splinter_store_reap()), when the key is written again, or when a write
+ * finds the table full; each of those deletes it the way
+ * splinter_store_unset() would, so pollers, watch sets and the change feed
+ * see it go.
+ *
+ * Writes that don't give an expiry (splinter_store_set() and the rest)
+ * leave a key's expiry as it is.
+ *
+ * @param ttl_ms Time to live in milliseconds; 0 for none (removes one the key has).
+ * @return 0 on success, -1 on failure (as splinter_store_set()).
+ */
+int splinter_store_set_with_ttl(splinter_store_t *st, const char *key, const void *val, size_t len,
+    uint64_t ttl_ms) {
+    if (!st || !st->H || !key) return -1;
+    if (len == 0 || len > st->H->max_val_sz) return -1;
+
+    struct iovec v = { .iov_base = (void *)val, .iov_len = len };
+    struct write_op op = { .mode = WRITE_REPLACE, .iov = &v, .iovcnt = 1, .len = len,
+        .expires = expiry_after(ttl_ms) };
+    if (write_key(st, key, key_hash(st, key), &op) != 0) return -1;
+
+    // Update global epoch (best-effort, relaxed).
+    atomic_fetch_add_explicit(&st->H->epoch, 1, memory_order_relaxed);
+    return 0;
+}
+
+/**
+ * @brief Gives an existing key a new time to live, counted from now.
+ *
+ * Only the expiry changes: the value, and the key's epoch, stay as they
+ * are, so views stay valid and pollers aren't woken.
+ *
+ * @param ttl_ms Time to live in milliseconds; 0 removes the key's expiry.
+ * @return 0 on success, -1 on failure (errno = ENOENT if the key doesn't
+ * exist, EAGAIN if a writer holds its slot).
+ */
+int splinter_store_set_ttl(splinter_store_t *st, const char *key, uint64_t ttl_ms) {
+    if (!st || !st->H || !key) return -1;
+    struct write_op op = { .mode = WRITE_EXPIRY, .expires = expiry_after(ttl_ms) };
+    return write_key(st, key, key_hash(st, key), &op);
+}
+
+/**
+ * @brief Reports how long a key has left to live.
+ * @param ttl_ms Receives the milliseconds left (at least 1), or 0 if the key doesn't expire.
+ * @return 0 on success, -1 if the key doesn't exist (errno = ENOENT).
+ */
+int splinter_store_get_ttl(splinter_store_t *st, const char *key, uint64_t *ttl_ms) {
+    if (!st || !st->H || !key || !ttl_ms) return -1;
+    const struct store_map *m = store_map(st);
+    struct splinter_slot *slot = m ? lookup(st, m, key, key_hash(st, key), NULL) : NULL;
+    if (!slot) return -1;
+
+    uint64_t x = atomic_load_explicit(&slot->expires, memory_order_relaxed), now = now_ms();
+    if (x && x <= now) {
+        errno = ENOENT;
+        return -1;
+    }
+    *ttl_ms = x ? x - now : 0;
+    return 0;
+}
+
+/**
+ * @brief Copies a slot's value from byte off onwards out under its seqlock (see
+ * splinter_store_get()), scattering it across iov in order. A NULL iov only
+ * reports the length.
+ *
+ * h is the hash the slot was found by: the slot can be emptied (by a delete
+ * or a resize moving the key) between finding it and taking the epoch, and
+ * its epoch is even again by then.
+ *
+ * With crc set, a whole byte value copied out is also checked against the
+ * checksum stored with it (EBADMSG if they differ).
+ */
+static int read_slot(const struct table *t, struct splinter_slot *slot, uint64_t h, size_t off,
+    const struct iovec *iov, int iovcnt, size_t *out_sz, uint32_t (*crc)(uint32_t, const void *, size_t)) {
+    uint64_t start = atomic_load_explicit(&slot->epoch, memory_order_acquire);
+    if ((start & 1) || atomic_load_explicit(&slot->hash, memory_order_relaxed) != h) {
+        // writer in progress, or the key left the slot while we found it
+        errno = EAGAIN;
+        return -1;
+    }
+
+    /* load length atomically */
+    size_t len = (size_t)atomic_load_explicit(&slot->val_len, memory_order_acquire);
+    uint32_t blk = value_blk(t, slot, memory_order_acquire);
+    size_t avail = off <= len ? len - off : 0;
+    int check = crc && iov && t->SUMS && off == 0 && slot->val_type != SLOT_INT;
+    uint32_t sum = check ? atomic_load_explicit(&t->SUMS[slot - t->S], memory_order_relaxed) : 0;
+    if (out_sz) *out_sz = avail;
+
+    if (iov && off <= len) {
+        if (iov_total(iov, iovcnt) < avail) {
+            errno = EMSGSIZE;
+            return -1;
+        }
+        if (!value_in_bounds(t, blk, len)) {
+            // torn read of a value that's being moved
+            errno = EAGAIN;
+            return -1;
+        }
+        const uint8_t *src = t->VALUES + (uint64_t)blk * ARENA_BLOCK + off;
+        uint64_t word;
+        if (slot->val_type == SLOT_INT && len == sizeof(word)) {
+            // Integer operations update the word in place; copy it in one piece.
+            word = atomic_load_explicit((atomic_uint_least64_t *)(src - off), memory_order_relaxed);
+            src = (const uint8_t *)&word + off;
+        }
+        for (int i = 0; avail; i++) {
+            size_t n = iov[i].iov_len < avail ? iov[i].iov_len : avail;
+            memcpy(iov[i].iov_base, src, n);
+            src += n;
+            avail -= n;
+        }
+    }
+
+    uint64_t end = atomic_load_explicit(&slot->epoch, memory_order_acquire);
+    if (start == end && !(end & 1)) {
+        // consistent snapshot; a value shorter than off was replaced, not grown
+        if (off > len) {
+            errno = ERANGE;
+            return -1;
+        }
+        if (check) {
+            // what we copied is stable now, so check the copy
+            uint32_t c = 0;
+            size_t done = 0;
+            for (int i = 0; done < len; i++) {
+                size_t n = iov[i].iov_len < len - done ? iov[i].iov_len : len - done;
+                c = crc(c, iov[i].iov_base, n);
+                done += n;
+            }
+            if (c != sum) {
+                errno = EBADMSG;
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    // inconsistent snapshot, ask caller to retry
+    errno = EAGAIN;
+    return -1;
+}
+
+/**
+ * @brief Retrieves the value associated with a key (seqlock aware).
+ *
+ * @param st The store to operate on.
+ * @param key The null-terminated key string.
+ * @param buf The buffer to copy the value data into. Can be NULL to query size.
+ * @param buf_sz The size of the provided buffer.
+ * @param out_sz Pointer to a size_t to store the value's actual length. Can be NULL.
+ * @return 0 on success, -1 on failure. On retry condition, returns -1 and sets
+ * errno = EAGAIN. If the buffer is too small, returns -1 and sets errno = EMSGSIZE.
+ * If the key does not exist, returns -1 and sets errno = ENOENT.
+ */
+int splinter_store_get(splinter_store_t *st, const char *key, void *buf, size_t buf_sz, size_t *out_sz) {
+    if (!st || !st->H || !key) return -1;
+    const struct store_map *m = store_map(st);
+    const struct table *t;
+    uint64_t h = key_hash(st, key);
+    struct splinter_slot *slot = m ? lookup(st, m, key, h, &t) : NULL;
+    if (!slot) return -1; // Not found
+    struct iovec v = { .iov_base = buf, .iov_len = buf_sz };
+    return read_slot(t, slot, h, 0, buf ? &v : NULL, 1, out_sz, NULL);
+}
+
+/**
+ * @brief Retrieves a key's value like splinter_store_get(), and checks it
+ * against the CRC32C stored with it.
+ *
+ * The check runs over the caller's copy once the seqlock says it's
+ * consistent, so a mismatch means the stored bytes themselves are bad.
+ * Integer keys (updated in place by splinter_store_incr() and friends) have
+ * no checksum and always pass.
+ *
+ * @param st The store to operate on.
+ * @param key The null-terminated key string.
+ * @param buf The buffer to copy the value data into.
+ * @param buf_sz The size of the provided buffer.
+ * @param out_sz Pointer to a size_t to store the value's actual length. Can be NULL.
+ * @return 0 on success, -1 on failure, with errno as splinter_store_get(),
+ * or EBADMSG if the value doesn't match its checksum, ENOTSUP if the store
+ * was created without checksums.
+ */
+int splinter_store_get_checked(splinter_store_t *st, const char *key, void *buf, size_t buf_sz,
+    size_t *out_sz) {
+    if (!st || !st->H || !key || !buf) return -1;
+    if (!st->crc32c) {
+        errno = ENOTSUP;
+        return -1;
+    }
+    const struct store_map *m = store_map(st);
+    const struct table *t;
+    uint64_t h = key_hash(st, key);
+    struct splinter_slot *slot = m ? lookup(st, m, key, h, &t) : NULL;
+    if (!slot) return -1; // Not found
+    struct iovec v = { .iov_base = buf, .iov_len = buf_sz };
+    return read_slot(t, slot, h, 0, &v, 1, out_sz, st->crc32c);
+}
+
+/**
+ * @brief Retrieves a key's value, scattering it across several buffers.
+ *
+ * The value fills the buffers in order, each one completely before the
+ * next; *out_sz tells how much of them was used.
+ *
+ * @param st The store to operate on.
+ * @param key The null-terminated key string.
+ * @param iov The buffers to fill.
+ * @param iovcnt Number of entries in iov.
+ * @param out_sz Pointer to a size_t to store the value's actual length. Can be NULL.
+ * @return 0 on success, -1 on failure, with errno as splinter_store_get()
+ * (EMSGSIZE if the buffers can't hold the whole value).
+ */
+int splinter_store_getv(splinter_store_t *st, const char *key, const struct iovec *iov, int iovcnt,
+    size_t *out_sz) {
+    if (!st || !st->H || !key || !iov || iovcnt <= 0) return -1;
+    const struct store_map *m = store_map(st);
+    const struct table *t;
+    uint64_t h = key_hash(st, key);
+    struct splinter_slot *slot = m ? lookup(st, m, key, h, &t) : NULL;
+    if (!slot) return -1; // Not found
+    return read_slot(t, slot, h, 0, iov, iovcnt, out_sz, NULL);
+}
+
+/**
+ * @brief Retrieves the part of a value past a given offset.
+ *
+ * For following a value that's being appended to: pass the number of bytes
+ * already consumed and get only what's new.
+ *
+ * @param st The store to operate on.
+ * @param key The null-terminated key string.
+ * @param off Offset into the value to start from.
+ * @param buf The buffer to copy the data into. Can be NULL to query size.
+ * @param buf_sz The size of the provided buffer.
+ * @param out_sz Receives the number of bytes past off. Can be NULL.
+ * @return 0 on success, -1 on failure, with errno as splinter_store_get(), or
+ * ERANGE if the value is now shorter than off (it was replaced, not grown).
+ */
+int splinter_store_get_from(splinter_store_t *st, const char *key, size_t off, void *buf,
+    size_t buf_sz, size_t *out_sz) {
+    if (!st || !st->H || !key) return -1;
+    const struct store_map *m = store_map(st);
+    const struct table *t;
+    uint64_t h = key_hash(st, key);
+    struct splinter_slot *slot = m ? lookup(st, m, key, h, &t) : NULL;
+    if (!slot) return -1; // Not found
+    struct iovec v = { .iov_base = buf, .iov_len = buf_sz };
+    return read_slot(t, slot, h, off, buf ? &v : NULL, 1, out_sz, NULL);
+}
+
+
+/**
+ * @brief Stores a 64-bit integer under a key, making it an integer key.
+ *
+ * Integer keys are updated in place by splinter_store_incr() and friends.
+ * splinter_store_get() still works on them (8 bytes, host byte order), and
+ * splinter_store_set() turns them back into plain byte values.
+ *
+ * @param st The store to operate on.
+ * @param key The null-terminated key string.
+ * @param value The value.
+ * @return 0 on success, -1 on failure (as splinter_store_set()).
+ */
+int splinter_store_set_int(splinter_store_t *st, const char *key, int64_t value) {
+    if (!st || !st->H || !key) return -1;
+
+    uint64_t word = (uint64_t)value;
+    struct iovec v = { .iov_base = &word, .iov_len = sizeof(word) };
+    struct write_op op = { .mode = WRITE_REPLACE, .iov = &v, .iovcnt = 1, .len = sizeof(word),
+        .type = SLOT_INT };
+    if (write_key(st, key, key_hash(st, key), &op) != 0) return -1;
+
+    // Update global epoch (best-effort, relaxed).
+    atomic_fetch_add_explicit(&st->H->epoch, 1, memory_order_relaxed);
+    return 0;
+}
+
+/**
+ * @brief Reads an integer key.
+ *
+ * @param st The store to operate on.
+ * @param key The null-terminated key string.
+ * @param value Receives the value.
+ * @return 0 on success, -1 on failure: errno = ENOENT if the key does not
+ * exist, EINVAL if it isn't an integer key, EAGAIN if a write is in progress.
+ */
+int splinter_store_get_int(splinter_store_t *st, const char *key, int64_t *value) {
+    if (!st || !st->H || !key || !value) return -1;
+    const struct store_map *m = store_map(st);
+    const struct table *t;
+    uint64_t h = key_hash(st, key);
+    struct splinter_slot *slot = m ? lookup(st, m, key, h, &t) : NULL;
+    if (!slot) return -1;
+
+    uint64_t start = atomic_load_explicit(&slot->epoch, memory_order_acquire);
+    int is_int = slot->val_type == SLOT_INT;
+    uint32_t blk = value_blk(t, slot, memory_order_acquire);
+    uint64_t word = 0;
+    if (is_int && value_in_bounds(t, blk, sizeof(word)))
+        word = atomic_load_explicit((atomic_uint_least64_t *)(t->VALUES + (uint64_t)blk * ARENA_BLOCK),
+                                    memory_order_relaxed);
+
+    atomic_thread_fence(memory_order_acquire);
+    if ((start & 1) || atomic_load_explicit(&slot->epoch, memory_order_relaxed) != start ||
+        atomic_load_explicit(&slot->hash, memory_order_relaxed) != h) {
+        errno = EAGAIN;
+        return -1;
+    }
+    if (!is_int) {
+        errno = EINVAL;
+        return -1;
+    }
+    *value = (int64_t)word;
+    return 0;
+}
+
+/**
+ * @brief Replaces an integer key's value if a comparison with it holds.
+ *
+ * The comparison and the store both happen under the slot seqlock, with
+ * pinned splinter_store_incr() style updates drained first, so nothing can
+ * change the value in between.
+ */
+static int set_int_if(splinter_store_t *st, const char *key, enum write_cond cond, int64_t cmp,
+    int64_t value) {
+    if (!st || !st->H || !key) return -1;
+
+    uint64_t word = (uint64_t)value;
+    struct iovec v = { .iov_base = &word, .iov_len = sizeof(word) };
+    struct write_op op = { .mode = WRITE_REPLACE, .iov = &v, .iovcnt = 1, .len = sizeof(word),
+        .type = SLOT_INT, .cond = cond, .cond_arg = (uint64_t)cmp };
+    if (write_key(st, key, key_hash(st, key), &op) != 0) return -1;
+
+    // Update global epoch (best-effort, relaxed).
+    atomic_fetch_add_explicit(&st->H->epoch, 1, memory_order_relaxed);
+    return 0;
+}
+
+/**
+ * @brief Sets an integer key to value if it currently equals expected.
+ *
+ * @param st The store to operate on.
+ * @param key The null-terminated key string.
+ * @param expected The value the key must hold.
+ * @param value The new value.
+ * @return 0 if the key was set, -1 on failure: errno = ECANCELED if the
+ * comparison failed, ENOENT if the key doesn't exist, EINVAL if it isn't an
+ * integer key, EAGAIN if another writer holds the slot.
+ */
+int splinter_store_set_if_eq(splinter_store_t *st, const char *key, int64_t expected, int64_t value) {
+    return set_int_if(st, key, COND_INT_EQ, expected, value);
+}
+
+/**
+ * @brief Sets an integer key to value if it's currently less than bound
+ * (see splinter_store_set_if_eq()).
+ */
+int splinter_store_set_if_lt(splinter_store_t *st, const char *key, int64_t bound, int64_t value) {
+    return set_int_if(st, key, COND_INT_LT, bound, value);
+}
+
+/**
+ * @brief Sets an integer key to value if it's currently greater than bound
+ * (see splinter_store_set_if_eq()).
+ */
+int splinter_store_set_if_gt(splinter_store_t *st, const char *key, int64_t bound, int64_t value) {
+    return set_int_if(st, key, COND_INT_GT, bound, value);
+}
+
+/** @brief Read-modify-write operations on integer keys. */
+enum int_op {
+    INT_ADD,
+    INT_AND,
+    INT_OR,
+    INT_XOR,
+};
+
+/**
+ * @brief Applies an atomic operation to an integer key's value word.
+ *
+ * The word is updated with a single atomic instruction; there is no seqlock
+ * write cycle, so any number of processes can update the same key without
+ * blocking or retrying each other. The slot is pinned for the duration, so a
+ * writer replacing or deleting the key waits for us (see wait_unpinned()). A
+ * missing key is created as 0 first.
+ *
+ * These updates don't advance the slot epoch: splinter_store_poll() doesn't
+ * wake for them, and they don't invalidate views.
+ *
+ * @param prev Receives the value before the operation.
+ * @return 0 on success, -1 on failure: errno = EINVAL if the key holds bytes,
+ * EAGAIN if a writer holds the slot, or as splinter_store_set() on create.
+ */
+static int int_rmw(splinter_store_t *st, const char *key, enum int_op op, uint64_t arg,
+    uint64_t *prev) {
+    uint64_t h = key_hash(st, key);
+
+    for (;;) {
+        const struct store_map *m = store_map(st);
+        if (!m || migrate_help(st, m, key, h) != 0) return -1;
+        const struct table *t = &m->cur;
+        struct splinter_slot *slot = find_slot(st, t, key, h);
+        if (slot && slot_expired(slot)) slot = NULL; // write_key() deletes it on create
+        if (!slot) {
+            uint64_t zero = 0;
+            struct iovec v = { .iov_base = &zero, .iov_len = sizeof(zero) };
+            struct write_op wop = { .mode = WRITE_REPLACE, .iov = &v, .iovcnt = 1,
+                .len = sizeof(zero), .type = SLOT_INT, .cond = COND_ABSENT };
+            if (write_key(st, key, h, &wop) == 0)
+                atomic_fetch_add_explicit(&st->H->epoch, 1, memory_order_relaxed);
+            else if (errno != EEXIST)
+                return -1;
+            continue; // created (by us or someone else): look again
+        }
+
+        // Pin, then check for a writer (see wait_unpinned() for the pairing).
+        atomic_fetch_add_explicit(&slot->pins, 1, memory_order_seq_cst);
+        uint64_t e = atomic_load_explicit(&slot->epoch, memory_order_seq_cst);
+        uint32_t blk = value_blk(t, slot, memory_order_relaxed);
+        int rc = 0;
+
+        if (e & 1) {
+            errno = EAGAIN;
+            rc = -1;
+        } else if (!slot_has_key(t, slot, h, key)) {
+            rc = 1; // deleted or moved before we pinned it
+        } else if (slot->val_type != SLOT_INT ||
+                   atomic_load_explicit(&slot->val_len, memory_order_relaxed) != sizeof(uint64_t) ||
+                   !value_in_bounds(t, blk, sizeof(uint64_t))) {
+            errno = EINVAL;
+            rc = -1;
+        } else {
+            atomic_uint_least64_t *word =
+                (atomic_uint_least64_t *)(t->VALUES + (uint64_t)blk * ARENA_BLOCK);
+            switch (op) {
+                case INT_ADD: *prev = atomic_fetch_add_explicit(word, arg, memory_order_acq_rel); break;
+                case INT_AND: *prev = atomic_fetch_and_explicit(word, arg, memory_order_acq_rel); break;
+                case INT_OR:  *prev = atomic_fetch_or_explicit(word, arg, memory_order_acq_rel); break;
+                case INT_XOR: *prev = atomic_fetch_xor_explicit(word, arg, memory_order_acq_rel); break;
+            }
+        }
+
+        atomic_fetch_sub_explicit(&slot->pins, 1, memory_order_release);
+        if (rc <= 0) return rc;
+    }
+}
+
+/**
+ * @brief Atomically adds to an integer key (creating it as 0 if missing).
+ *
+ * @param st The store to operate on.
+ * @param key The null-terminated key string.
+ * @param delta Amount to add (wraps around on overflow).
+ * @param result Receives the new value. Can be NULL.
+ * @return 0 on success, -1 on failure: errno = EINVAL if the key holds a
+ * byte value, EAGAIN if it is being written with splinter_store_set().
+ */
+int splinter_store_incr(splinter_store_t *st, const char *key, int64_t delta, int64_t *result) {
+    if (!st || !st->H || !key) return -1;
+    uint64_t prev;
+    if (int_rmw(st, key, INT_ADD, (uint64_t)delta, &prev) != 0) return -1;
+    if (result) *result = (int64_t)(prev + (uint64_t)delta);
+    return 0;
+}
+
+/**
+ * @brief Atomically subtracts from an integer key (see splinter_store_incr()).
+ */
+int splinter_store_decr(splinter_store_t *st, const char *key, int64_t delta, int64_t *result) {
+    if (!st || !st->H || !key) return -1;
+    uint64_t prev;
+    if (int_rmw(st, key, INT_ADD, 0 - (uint64_t)delta, &prev) != 0) return -1;
+    if (result) *result = (int64_t)(prev - (uint64_t)delta);
+    return 0;
+}
+
+/**
+ * @brief Atomically ANDs mask into an integer key (see splinter_store_incr()).
+ * @param prev Receives the value before the operation. Can be NULL.
+ */
+int splinter_store_fetch_and(splinter_store_t *st, const char *key, uint64_t mask, int64_t *prev) {
+    if (!st || !st->H || !key) return -1;
+    uint64_t p;
+    if (int_rmw(st, key, INT_AND, mask, &p) != 0) return -1;
+    if (prev) *prev = (int64_t)p;
+    return 0;
+}
+
+/**
+ * @brief Atomically ORs mask into an integer key (see splinter_store_incr()).
+ * @param prev Receives the value before the operation. Can be NULL.
+ */
+int splinter_store_fetch_or(splinter_store_t *st, const char *key, uint64_t mask, int64_t *prev) {
+    if (!st || !st->H || !key) return -1;
+    uint64_t p;
+    if (int_rmw(st, key, INT_OR, mask, &p) != 0) return -1;
+    if (prev) *prev = (int64_t)p;
+    return 0;
+}
+
+/**
+ * @brief Atomically XORs mask into an integer key (see splinter_store_incr()).
+ * XOR with ~0 is bitwise NOT.
+ * @param prev Receives the value before the operation. Can be NULL.
+ */
+int splinter_store_fetch_xor(splinter_store_t *st, const char *key, uint64_t mask, int64_t *prev) {
+    if (!st || !st->H || !key) return -1;
+    uint64_t p;
+    if (int_rmw(st, key, INT_XOR, mask, &p) != 0) return -1;
+    if (prev) *prev = (int64_t)p;
+    return 0;
+}
+
+/**
+ * @brief Returns a pointer to a key's value in shared memory, without copying.
+ *
+ * This is the first half of splinter_store_get()'s seqlock read, handed to
+ * the caller: consume the bytes in place, then call
+ * splinter_store_view_valid() with the returned epoch. If that fails, a
+ * writer got there in the meantime and whatever was read must be discarded.
+ * Until validated, treat the bytes as untrusted (don't follow offsets found
+ * in them without bounds checks).
+ *
+ * @param st The store to operate on.
+ * @param key The null-terminated key string.
+ * @param ptr Receives a pointer to the value bytes.
+ * @param len Receives the value length.
+ * @param epoch Receives the slot epoch the view belongs to.
+ * @return 0 on success, -1 on failure: errno = ENOENT if the key does not
+ * exist, EAGAIN if a write is in progress.
+ */
+int splinter_store_get_view(splinter_store_t *st, const char *key, const void **ptr, size_t *len,
+    uint64_t *epoch) {
+    if (!st || !st->H || !key || !ptr || !len || !epoch) return -1;
+    const struct store_map *m = store_map(st);
+    const struct table *t;
+    uint64_t h = key_hash(st, key);
+    struct splinter_slot *slot = m ? lookup(st, m, key, h, &t) : NULL;
+    if (!slot) return -1;
+
+    uint64_t start = atomic_load_explicit(&slot->epoch, memory_order_acquire);
+    if ((start & 1) || atomic_load_explicit(&slot->hash, memory_order_relaxed) != h) {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    size_t l = (size_t)atomic_load_explicit(&slot->val_len, memory_order_acquire);
+    uint32_t blk = value_blk(t, slot, memory_order_acquire);
+
+    // Make sure location and length belong together before handing them out.
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&slot->epoch, memory_order_relaxed) != start ||
+        !value_in_bounds(t, blk, l)) {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    *ptr = t->VALUES + (uint64_t)blk * ARENA_BLOCK;
+    *len = l;
+    *epoch = start;
+    return 0;
+}
+
+/**
+ * @brief Checks that nothing has written to a key since a view of it was taken.
+ *
+ * Call after you've finished reading the bytes from splinter_store_get_view().
+ *
+ * @param st The store to operate on.
+ * @param key The key the view was taken of.
+ * @param epoch The epoch returned with the view.
+ * @return 1 if everything read through the view is consistent, 0 if it must
+ * be discarded (the key was updated, deleted, or moved).
+ */
+int splinter_store_view_valid(splinter_store_t *st, const char *key, uint64_t epoch) {
+    if (!st || !st->H || !key) return 0;
+    const struct store_map *m = store_map(st);
+    const struct table *t;
+    struct splinter_slot *slot = m ? lookup(st, m, key, key_hash(st, key), &t) : NULL;
+    if (!slot) return 0;
+
+    // Order the caller's reads of the value before the epoch re-check.
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&slot->epoch, memory_order_relaxed) == epoch;
+}
+
+/**
+ * @brief Keys hashed and prefetched ahead of resolving them in batch calls.
+ * Enough to cover memory latency, few enough that the first lines fetched
+ * are still in cache when we get to them.
+ */
+#define BATCH_AHEAD 32
+
+/**
+ * @brief Retrieves several keys in one call.
+ *
+ * Work is staged across a batch of keys so the cache misses overlap instead
+ * of being paid one after another: hash every key and prefetch its home
+ * slot, then resolve every slot and prefetch its value, then copy the values
+ * out. Each copy is checked exactly like splinter_store_get().
+ *
+ * @param st The store to operate on.
+ * @param keys The null-terminated key strings.
+ * @param n Number of keys.
+ * @param bufs Per-key destination buffers. NULL (or a NULL entry) queries sizes only.
+ * @param buf_szs Per-key buffer sizes (ignored when bufs is NULL).
+ * @param out_szs Receives each value's length. Can be NULL.
+ * @param errs Receives 0 for each key read, or its errno (ENOENT, EMSGSIZE, EAGAIN).
+ * @return The number of keys read successfully, -1 on invalid arguments.
+ */
+int splinter_store_mget(splinter_store_t *st, const char *const *keys, size_t n, void *const *bufs,
+    const size_t *buf_szs, size_t *out_szs, int *errs) {
+    if (!st || !st->H || !keys || !errs || (bufs && !buf_szs)) return -1;
+    const struct store_map *map = store_map(st);
+    if (!map) return -1;
+    uint64_t h[BATCH_AHEAD];
+    struct splinter_slot *slots[BATCH_AHEAD];
+    const struct table *tabs[BATCH_AHEAD];
+    int ok = 0, saved = errno;
+
+    for (size_t base = 0; base < n; base += BATCH_AHEAD) {
+        size_t m = n - base < BATCH_AHEAD ? n - base : BATCH_AHEAD;
+        for (size_t i = 0; i < m; i++) {
+            h[i] = keys[base + i] ? key_hash(st, keys[base + i]) : HASH_EMPTY;
+            prefetch_home(map->old.S ? &map->old : &map->cur, h[i]);
+        }
+        // Resolve the whole batch, then pull in the values the same way.
+        for (size_t i = 0; i < m; i++) {
+            size_t k = base + i;
+            slots[i] = h[i] == HASH_EMPTY ? NULL : lookup(st, map, keys[k], h[i], &tabs[i]);
+            errs[k] = slots[i] ? 0 : h[i] == HASH_EMPTY ? EINVAL : ENOENT;
+            if (slots[i] && bufs && bufs[k])
+                __builtin_prefetch(slot_value(tabs[i], slots[i]));
+        }
+        for (size_t i = 0; i < m; i++) {
+            size_t k = base + i, sz = 0;
+            if (slots[i]) {
+                struct iovec v = { .iov_base = bufs ? bufs[k] : NULL, .iov_len = bufs ? buf_szs[k] : 0 };
+                if (read_slot(tabs[i], slots[i], h[i], 0, v.iov_base ? &v : NULL, 1, &sz, NULL) == 0)
+                    ok++;
+                else
+                    errs[k] = errno;
+            }
+            if (out_szs) out_szs[k] = sz;
+        }
+    }
+    errno = saved;
+    return ok;
+}
+
+/**
+ * @brief Sets several keys in one call.
+ *
+ * Keys are hashed and prefetched in batches as for splinter_store_mget(), and
+ * the slot and value lines each write is going to dirty are requested before
+ * the first one is written. Keys are then written one at a time, each under
+ * its own slot seqlock exactly like
+ * splinter_store_set() (the batch is not atomic as a whole). The global epoch
+ * is bumped once at the end, by the number of keys written.
+ *
+ * @param st The store to operate on.
+ * @param keys The null-terminated key strings.
+ * @param vals Per-key value data.
+ * @param lens Per-key value lengths (non-zero, at most max_val_sz).
+ * @param n Number of keys.
+ * @param errs Receives 0 for each key written, or its errno (ENOSPC, EAGAIN, EINVAL).
+ * @return The number of keys written, -1 on invalid arguments.
+ */
+int splinter_store_mset(splinter_store_t *st, const char *const *keys, const void *const *vals,
+    const size_t *lens, size_t n, int *errs) {
+    if (!st || !st->H || !keys || !vals || !lens || !errs) return -1;
+    struct splinter_header *H = st->H;
+    const struct store_map *map = store_map(st);
+    if (!map) return -1;
+    const struct table *t = &map->cur;
+    uint64_t h[BATCH_AHEAD];
+    int ok = 0, saved = errno;
+
+    for (size_t base = 0; base < n; base += BATCH_AHEAD) {
+        size_t m = n - base < BATCH_AHEAD ? n - base : BATCH_AHEAD;
+        for (size_t i = 0; i < m; i++) {
+            size_t k = base + i;
+            int valid = keys[k] && vals[k] && lens[k] && lens[k] <= H->max_val_sz;
+            h[i] = valid ? key_hash(st, keys[k]) : HASH_EMPTY;
+            if (valid) prefetch_home(t, h[i]);
+        }
+        // Find where each write will most likely land and start pulling in
+        // the lines it will dirty. write_key() probes again for real.
+        for (size_t i = 0; i < m; i++) {
+            size_t dist;
+            struct splinter_slot *slot = h[i] == HASH_EMPTY ? NULL :
+                probe_for_write(st, t, keys[base + i], h[i], &dist);
+            if (!slot) continue;
+            __builtin_prefetch(slot, 1);
+            if (value_in_bounds(t, value_blk(t, slot, memory_order_relaxed), 1))
+                __builtin_prefetch(slot_value(t, slot), 1);
+        }
+        for (size_t i = 0; i < m; i++) {
+            size_t k = base + i;
+            if (h[i] == HASH_EMPTY) {
+                errs[k] = EINVAL;
+                continue;
+            }
+            struct iovec v = { .iov_base = (void *)vals[k], .iov_len = lens[k] };
+            struct write_op op = { .mode = WRITE_REPLACE, .iov = &v, .iovcnt = 1, .len = lens[k] };
+            int rc = write_key(st, keys[k], h[i], &op);
+            errs[k] = rc == 0 ? 0 : errno;
+            ok += rc == 0;
+        }
+    }
+
+    // One update of the shared header line for the whole batch, still by one
+    // per write: fresh slot epochs are derived from the global count.
+    if (ok) atomic_fetch_add_explicit(&H->epoch, (uint64_t)ok, memory_order_relaxed);
+    errno = saved;
+    return ok;
+}
+
+/**
+ * @brief Lists all keys currently in the store.
+ *
+ * @param st The store to operate on.
+ * @param out_keys An array of `char*` to be filled with pointers to the keys
+ * within the shared memory. These pointers are only valid as
+ * long as the store is open, and until the store is next resized. A key
+ * being moved by a resize can be listed twice, or not at all. Keys that have
+ * expired aren't listed.
+ * @param max_keys The maximum number of keys to write to `out_keys`.
+ * @param out_count Pointer to a size_t to store the number of keys found.
+ * @return 0 on success, -1 on failure.
+ */
+int splinter_store_list(splinter_store_t *st, char **out_keys, size_t max_keys, size_t *out_count) {
+    if (!st || !st->H || !out_keys || !out_count) return -1;
+    const struct store_map *m = store_map(st);
+    if (!m) return -1;
+    const struct table *tabs[2] = { &m->old, &m->cur };
+    size_t count = 0, i;
+
+    for (int k = 0; k < 2; k++) {
+        const struct table *t = tabs[k];
+        for (i = 0; t->S && i < t->slots && count < max_keys; ++i) {
+            // A live (non-reserved) hash and value length indicates a valid, active key.
+            if (atomic_load_explicit(&t->S[i].hash, memory_order_acquire) > HASH_TOMB &&
+                atomic_load_explicit(&t->S[i].val_len, memory_order_acquire) > 0 &&
+                !slot_expired(&t->S[i])) {
+                out_keys[count++] = t->KEYS + i * SPLINTER_KEY_MAX;
+            }
+        }
+    }
+    *out_count = count;
+    return 0;
+}
+
+/**
+ * @struct scan_bounds
+ * @brief What a key scan visits: keys from lo (or just past after, once
+ * some have been visited) up to hi, starting with prefix.
+ */
+struct scan_bounds {
+    const char *lo, *hi, *prefix;
+    size_t prefix_len;
+    /** @brief The last key visited; empty until one has been. */
+    char after[SPLINTER_KEY_MAX];
+};
+
+/**
+ * @brief Where a key stands against a scan's bounds.
+ * @return -1 if it's before the start, 0 if it's to be visited, 1 if it's
+ * past the end.
+ */
+static int scan_place(const struct scan_bounds *b, const char *key) {
+    if (b->after[0] ? strcmp(key, b->after) <= 0 : b->lo && strcmp(key, b->lo) < 0) return -1;
+    if ((b->hi && strcmp(key, b->hi) >= 0) ||
+        (b->prefix_len && strncmp(key, b->prefix, b->prefix_len) > 0))
+        return 1;
+    return b->prefix_len && strncmp(key, b->prefix, b->prefix_len) != 0 ? -1 : 0;
+}
+
+/** @brief Index steps a scan takes between checks that the index is still the version it started on. */
+#define SCAN_CHECK 64
+
+/**
+ * @brief Finds the first indexed key of t not before the start of a scan,
+ * reading the index as of version v.
+ * @return Its slot index + 1, 0 if there's none, or UINT32_MAX if the
+ * index changed (or a step led nowhere sensible) and the caller must retry.
+ */
+static uint32_t index_seek(splinter_store_t *st, const struct table *t, const struct scan_bounds *b, uint64_t v) {
+    const char *from = b->after[0] ? b->after : b->lo;
+    const atomic_uint_least32_t *links = t->IDX_HEAD;
+    uint32_t n = 0;
+    unsigned int steps = 0;
+
+    for (int l = INDEX_LEVELS - 1; l >= 0; l--) {
+        while ((n = atomic_load_explicit(&links[l], memory_order_acquire)) != 0) {
+            if (n > t->slots || (++steps % SCAN_CHECK == 0 &&
+                                 atomic_load_explicit(&st->H->index_seq, memory_order_acquire) != v))
+                return UINT32_MAX;
+            int c = from ? strncmp(t->KEYS + (size_t)(n - 1) * SPLINTER_KEY_MAX, from, SPLINTER_KEY_MAX) : 1;
+            if (c > 0 || (c == 0 && !b->after[0])) break;
+            links = t->IDX[n - 1].next;
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief Scans the keys of m's table through its index, optimistically:
+ * each key is read, then checked against the index version (and table
+ * generation) the walk started on. If either moved, the walk starts over
+ * from just past the last key visited.
+ * @return The number of keys visited (b->after is the last), with *done set
+ * if the scan is over; otherwise it stopped because a resize began.
+ */
+static int index_scan(splinter_store_t *st, const struct store_map *m, struct scan_bounds *b,
+    splinter_scan_cb cb, void *arg, int *done) {
+    struct splinter_header *H = st->H;
+    const struct table *t = &m->cur;
+    char key[SPLINTER_KEY_MAX];
+    int count = 0;
+
+    for (;;) {
+        uint64_t v = atomic_load_explicit(&H->index_seq, memory_order_acquire);
+        if (v & 1) {
+            cpu_relax();
+            continue;
+        }
+        if (atomic_load_explicit(&H->gen, memory_order_acquire) != m->gen) return count;
+        uint32_t n = index_seek(st, t, b, v);
+        while (n != UINT32_MAX) {
+            uint32_t next = 0;
+            int expired = 0;
+            if (n) {
+                memcpy(key, t->KEYS + (size_t)(n - 1) * SPLINTER_KEY_MAX, SPLINTER_KEY_MAX);
+                key[SPLINTER_KEY_MAX - 1] = '\0';
+                expired = slot_expired(&t->S[n - 1]);
+                next = atomic_load_explicit(&t->IDX[n - 1].next[0], memory_order_acquire);
+            }
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&H->index_seq, memory_order_relaxed) != v ||
+                atomic_load_explicit(&H->gen, memory_order_relaxed) != m->gen)
+                break;
+            // What we read was the index as of v: the key, and where it leads.
+            int place = n ? scan_place(b, key) : 1;
+            if (place > 0) {
+                *done = 1;
+                return count;
+            }
+            if (place == 0) {
+                memcpy(b->after, key, SPLINTER_KEY_MAX);
+                if (!expired) {
+                    count++;
+                    if (cb(key, arg) != 0) {
+                        *done = 1;
+                        return count;
+                    }
+                }
+            }
+            n = next > t->slots ? UINT32_MAX : next;
+        }
+    }
+}
+
+/**
+ * @brief qsort() comparison for scan_gather()'s keys.
+ */
+static int scan_key_cmp(const void *a, const void *b) {
+    return strcmp((const char *)a, (const char *)b);
+}
+
+/**
+ * @brief Scans without an index: copies every key in bounds out of both
+ * tables, sorts them, and visits them (a key being moved by a resize is
+ * visited once).
+ * @return The number of keys visited, -1 with errno = ENOMEM.
+ */
+static int scan_gather(const struct store_map *m, struct scan_bounds *b,
+    splinter_scan_cb cb, void *arg) {
+    const struct table *tabs[2] = { &m->old, &m->cur };
+    size_t n = 0, cap = 0, i;
+    char (*keys)[SPLINTER_KEY_MAX] = NULL;
+    int count = 0;
+
+    for (int k = 0; k < 2; k++) {
+        const struct table *t = tabs[k];
+        for (i = 0; t->S && i < t->slots; i++) {
+            if (atomic_load_explicit(&t->S[i].hash, memory_order_acquire) <= HASH_TOMB ||
+                slot_expired(&t->S[i]))
+                continue;
+            if (n == cap) {
+                cap = cap ? cap * 2 : 64;
+                void *grown = realloc(keys, cap * sizeof(*keys));
+                if (!grown) {
+                    free(keys);
+                    errno = ENOMEM;
+                    return -1;
+                }
+                keys = grown;
+            }
+            memcpy(keys[n], t->KEYS + i * SPLINTER_KEY_MAX, SPLINTER_KEY_MAX);
+            keys[n][SPLINTER_KEY_MAX - 1] = '\0';
+            if (keys[n][0] && scan_place(b, keys[n]) == 0) n++;
+        }
+    }
+    qsort(keys, n, sizeof(*keys), scan_key_cmp);
+    for (i = 0; i < n; i++) {
+        if (i && strcmp(keys[i], keys[i - 1]) == 0) continue;
+        count++;
+        if (cb(keys[i], arg) != 0) break;
+    }
+    free(keys);
+    return count;
+}
+
+/**
+ * @brief Visits the keys in bounds in order: through the current table's
+ * index while there is one and no resize is migrating keys, by gathering
+ * them from every slot otherwise.
+ */
+static int key_scan(splinter_store_t *st, struct scan_bounds *b, splinter_scan_cb cb, void *arg) {
+    const struct store_map *m;
+    int count = 0, done = 0;
+
+    while ((m = store_map(st)) && m->cur.IDX && !(m->gen & 1)) {
+        count += index_scan(st, m, b, cb, arg, &done);
+        if (done) return count;
+    }
+    if (!m) return -1;
+    int rest = scan_gather(m, b, cb, arg);
+    return rest < 0 ? -1 : count + rest;
+}
+
+/**
+ * @brief Visits the keys in [lo, hi) in strcmp() order; see splinter_scan_range().
+ *
+ * @param st The store to operate on.
+ * @param lo First key to visit; NULL for no lower bound.
+ * @param hi Key to stop at (not visited); NULL for no upper bound.
+ * @param cb Called with each key; returning non-zero ends the scan.
+ * @param arg Passed to cb.
+ * @return The number of keys passed to cb, -1 on failure, -2 on invalid arguments.
+ */
+int splinter_store_scan_range(splinter_store_t *st, const char *lo, const char *hi, splinter_scan_cb cb, void *arg) {
+    if (!st || !st->H || !cb) return -2;
+    struct scan_bounds b = { .lo = lo, .hi = hi };
+    return key_scan(st, &b, cb, arg);
+}
+
+/**
+ * @brief Visits the keys starting with prefix in strcmp() order; see
+ * splinter_scan_range(). An empty prefix visits every key.
+ *
+ * @param st The store to operate on.
+ * @param prefix The prefix keys must start with.
+ * @param cb Called with each key; returning non-zero ends the scan.
+ * @param arg Passed to cb.
+ * @return The number of keys passed to cb, -1 on failure, -2 on invalid arguments.
+ */
+int splinter_store_scan_prefix(splinter_store_t *st, const char *prefix, splinter_scan_cb cb, void *arg) {
+    if (!st || !st->H || !prefix || !cb) return -2;
+    struct scan_bounds b = { .lo = prefix, .prefix = prefix, .prefix_len = strnlen(prefix, SPLINTER_KEY_MAX) };
+    return key_scan(st, &b, cb, arg);
+}
+
+/** @brief Bloom bits each tag sets (out of 64). */
+#define TAG_BITS    3
+/** @brief Times a slot whose key keeps changing is re-read before it's skipped. */
+#define TAG_COPY_RETRIES 16
+
+/**
+ * @brief Computes the tag bloom bits for a tag. The same in every store, so
+ * masks can be computed once and kept.
+ *
+ * Masks for several tags OR together; a key has all of them if its bloom
+ * holds every bit of the result. Like any bloom filter, a key can seem to
+ * have a tag it was never given (more likely the more tags it has), but
+ * never the other way round.
+ *
+ * @param tag The null-terminated tag, e.g. "session:42".
+ * @return The tag's bits, or 0 if tag is NULL.
+ */
+uint64_t splinter_tag_mask(const char *tag) {
+    if (!tag) return 0;
+    uint64_t h = wyhash_str(tag, 0), mask = 0;
+    for (int i = 0; i < TAG_BITS; i++, h >>= 6)
+        mask |= 1ull << (h & 63);
+    return mask;
+}
+
+/**
+ * @brief Changes a key's tag bloom under its seqlock (see write_key()).
+ */
+static int write_tags(splinter_store_t *st, const char *key, uint64_t clear, uint64_t set) {
+    struct write_op op = { .mode = WRITE_TAGS, .tags_clear = clear, .tags_set = set };
+    return write_key(st, key, key_hash(st, key), &op);
+}
+
+/**
+ * @brief Adds tags (see splinter_tag_mask()) to an existing key.
+ *
+ * Tags belong to the key rather than its value: they stay through writes
+ * and are dropped when the key is deleted. Like splinter_store_set_ttl(),
+ * changing them isn't a write to the value (the epoch doesn't move).
+ *
+ * @param st The store to operate on.
+ * @param key The null-terminated key string.
+ * @param mask Tag bits to add.
+ * @return 0 on success, -1 on failure (errno = ENOENT if the key doesn't
+ * exist, EAGAIN if a writer holds its slot).
+ */
+int splinter_store_add_tags(splinter_store_t *st, const char *key, uint64_t mask) {
+    if (!st || !st->H || !key) return -1;
+    return write_tags(st, key, 0, mask);
+}
+
+/**
+ * @brief Replaces an existing key's tags. Since tags share bits, this (with
+ * the masks of the tags that are left) is how a tag is taken away.
+ * @return As splinter_store_add_tags().
+ */
+int splinter_store_set_tags(splinter_store_t *st, const char *key, uint64_t mask) {
+    if (!st || !st->H || !key) return -1;
+    return write_tags(st, key, UINT64_MAX, mask);
+}
+
+/**
+ * @brief Reads a key's tag bloom.
+ * @param mask Receives the bloom (0 if the key has no tags).
+ * @return 0 on success, -1 if the key doesn't exist (errno = ENOENT).
+ */
+int splinter_store_get_tags(splinter_store_t *st, const char *key, uint64_t *mask) {
+    if (!st || !st->H || !key || !mask) return -1;
+    const struct store_map *m = store_map(st);
+    const struct table *t;
+    struct splinter_slot *slot = m ? lookup(st, m, key, key_hash(st, key), &t) : NULL;
+    if (!slot) return -1;
+    *mask = __atomic_load_n(&t->TAGS[slot - t->S], __ATOMIC_RELAXED);
+    return 0;
+}
+
+/**
+ * @brief Finds every key tagged with all of mask's bits, as a slot bitmap.
+ *
+ * Tag blooms sit in their own dense array, one word per slot, so this is a
+ * single pass over slots * 8 bytes with as many words compared per
+ * instruction as the CPU allows (see tag_scanner()); only the slots that
+ * match are looked at any further, to drop keys that have expired. A
+ * resize that is migrating keys is driven to the end first, so every key is
+ * in the table the bitmap describes.
+ *
+ * The bitmap is a snapshot: pass it to splinter_store_list_slots() or
+ * splinter_watch_add_slots() for the keys.
+ *
+ * @param st The store to operate on.
+ * @param mask Tag bits to look for (see splinter_tag_mask()); not 0.
+ * @param bits Receives bit i % 64 of word i / 64 set for each matching slot i.
+ * @param words Capacity of bits: at least (slots + 63) / 64, slots being the
+ * header snapshot's.
+ * @return The number of keys found, -1 on failure (errno = ERANGE if bits
+ * is too small for the table, or ENOSPC if a stuck migration can't finish),
+ * -2 on invalid arguments.
+ */
+int splinter_store_find_tagged(splinter_store_t *st, uint64_t mask, uint64_t *bits, size_t words) {
+    if (!st || !st->H || !mask || !bits) return -2;
+    if (migrate_run(st) != 0) return -1;
+    const struct store_map *m = store_map(st);
+    if (!m) return -1;
+    const struct table *t = &m->cur;
+    size_t n = t->slots, need = (n + 63) / 64, i;
+
+    if (words < need) {
+        errno = ERANGE;
+        return -1;
+    }
+    uint64_t hits = st->tag_scan(t->TAGS, n, mask, bits);
+    memset(bits + need, 0, (words - need) * sizeof(uint64_t));
+
+    for (i = 0; i < need && hits; i++) {
+        uint64_t w = bits[i];
+        while (w) {
+            size_t j = (size_t)__builtin_ctzll(w);
+            struct splinter_slot *slot = &t->S[i * 64 + j];
+            w &= w - 1;
+            if (atomic_load_explicit(&slot->hash, memory_order_acquire) <= HASH_TOMB || slot_expired(slot)) {
+                bits[i] &= ~(1ull << j);
+                hits--;
+            }
+        }
+    }
+    return (int)hits;
+}
+
+/**
+ * @brief Copies the key a slot holds, if it holds one and no writer changes
+ * it while we copy.
+ * @return 0 on success, -1 if the slot is empty, expired or kept changing.
+ */
+static int copy_slot_key(const struct table *t, struct splinter_slot *slot, char *out) {
+    for (int tries = 0; tries < TAG_COPY_RETRIES; tries++) {
+        uint64_t e = atomic_load_explicit(&slot->epoch, memory_order_acquire);
+        if (e & 1) {
+            cpu_relax();
+            continue;
+        }
+        uint64_t h = atomic_load_explicit(&slot->hash, memory_order_acquire);
+        if (h <= HASH_TOMB || slot_expired(slot)) return -1;
+        memcpy(out, slot_key(t, slot), SPLINTER_KEY_MAX);
+        out[SPLINTER_KEY_MAX - 1] = '\0';
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->epoch, memory_order_relaxed) == e) return 0;
+    }
+    return -1;
+}
+
+/**
+ * @brief Lists the keys in the slots of a bitmap from
+ * splinter_store_find_tagged(), like splinter_store_list() (pointers into
+ * the store). Slots that have been emptied since are skipped; bits past the
+ * end of the table are ignored.
+ *
+ * @return 0 on success, -1 on failure.
+ */
+int splinter_store_list_slots(splinter_store_t *st, const uint64_t *bits, size_t words, char **out_keys,
+    size_t max_keys, size_t *out_count) {
+    if (!st || !st->H || !bits || !out_keys || !out_count) return -1;
+    const struct store_map *m = store_map(st);
+    if (!m) return -1;
+    const struct table *t = &m->cur;
+    size_t count = 0, i;
+
+    if (words > (t->slots + 63) / 64) words = (t->slots + 63) / 64;
+    for (i = 0; i < words && count < max_keys; i++) {
+        uint64_t w = bits[i];
+        while (w && count < max_keys) {
+            struct splinter_slot *slot = &t->S[i * 64 + (size_t)__builtin_ctzll(w)];
+            w &= w - 1;
+            if (slot < t->S + t->slots &&
+                atomic_load_explicit(&slot->hash, memory_order_acquire) > HASH_TOMB &&
+                atomic_load_explicit(&slot->val_len, memory_order_acquire) > 0 && !slot_expired(slot))
+                out_keys[count++] = slot_key(t, slot);
+        }
+    }
+    *out_count = count;
+    return 0;
+}
+
+/** @brief Slots a splinter_store_verify() thread takes at a time. */
+#define VERIFY_CHUNK    1024
+/** @brief Times a slot that keeps changing is re-read before it's skipped. */
+#define VERIFY_RETRIES  4
+#define VERIFY_MAX_THREADS 256
+
+/**
+ * @brief One splinter_store_verify() scan, shared by its threads. Slots are
+ * numbered across the old table (while migrating) and then the current one.
+ */
+struct verify_scan {
+    splinter_store_t *st;
+    const struct table *tabs[2];
+    size_t total;
+    atomic_size_t next;
+    atomic_size_t bad;
+    char **out_keys;
+    size_t max_keys;
+};
+
+/**
+ * @brief Checks one slot's value against its checksum, in place, under the
+ * slot's seqlock.
+ * @return 1 if the value is corrupt, 0 if it checks out, is empty or an
+ * integer, or kept changing (a writer is replacing it, checksum and all).
+ */
+static int verify_slot(splinter_store_t *st, const struct table *t, struct splinter_slot *slot) {
+    for (int tries = 0; tries < VERIFY_RETRIES; tries++) {
+        uint64_t start = atomic_load_explicit(&slot->epoch, memory_order_acquire);
+        if (start & 1) {
+            cpu_relax();
+            continue;
+        }
+        if (atomic_load_explicit(&slot->hash, memory_order_relaxed) <= HASH_TOMB ||
+            slot->val_type == SLOT_INT)
+            return 0;
+        size_t len = atomic_load_explicit(&slot->val_len, memory_order_acquire);
+        uint32_t blk = value_blk(t, slot, memory_order_acquire);
+        uint32_t sum = atomic_load_explicit(&t->SUMS[slot - t->S], memory_order_relaxed);
+        if (!value_in_bounds(t, blk, len)) continue;
+        uint32_t c = st->crc32c(0, t->VALUES + (uint64_t)blk * ARENA_BLOCK, len);
+
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->epoch, memory_order_relaxed) == start) return c != sum;
+    }
+    return 0;
+}
+
+/**
+ * @brief splinter_store_verify() thread: checks chunks of slots until none
+ * are left.
+ */
+static void *verify_worker(void *arg) {
+    struct verify_scan *v = arg;
+
+    for (;;) {
+        size_t i = atomic_fetch_add_explicit(&v->next, VERIFY_CHUNK, memory_order_relaxed);
+        if (i >= v->total) break;
+        size_t end = v->total - i < VERIFY_CHUNK ? v->total : i + VERIFY_CHUNK;
+        for (; i < end; i++) {
+            const struct table *t = i < v->tabs[0]->slots ? v->tabs[0] : v->tabs[1];
+            struct splinter_slot *slot = &t->S[t == v->tabs[0] ? i : i - v->tabs[0]->slots];
+            if (!verify_slot(v->st, t, slot)) continue;
+            size_t n = atomic_fetch_add_explicit(&v->bad, 1, memory_order_relaxed);
+            if (n < v->max_keys) v->out_keys[n] = slot_key(t, slot);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Checks every value in the store against its checksum, using
+ * several threads.
+ *
+ * Values are checksummed where they lie (no copies), so a scan costs about
+ * what reading the store once does, spread over the threads. Slots being
+ * written during the scan are skipped, as are integer keys.
+ *
+ * @param st The store to operate on.
+ * @param threads Threads to scan with; 0 uses one per online CPU.
+ * @param out_keys Receives pointers to the keys of corrupt values, in the
+ * shared memory (valid as for splinter_store_list()). Can be NULL if
+ * max_keys is 0.
+ * @param max_keys Capacity of out_keys.
+ * @param out_count Receives the number of keys written to out_keys. Can be NULL.
+ * @return The number of corrupt values found (0 if the store is clean), or
+ * -1 on failure (errno = ENOTSUP if the store was created without checksums).
+ */
+int splinter_store_verify(splinter_store_t *st, unsigned int threads, char **out_keys, size_t max_keys,
+    size_t *out_count) {
+    if (!st || !st->H || (!out_keys && max_keys)) return -1;
+    if (!st->crc32c) {
+        errno = ENOTSUP;
+        return -1;
+    }
+    const struct store_map *m = store_map(st);
+    if (!m) return -1;
+
+    struct verify_scan v = { .st = st, .tabs = { &m->old, &m->cur }, .out_keys = out_keys, .max_keys = max_keys };
+    v.total = (size_t)m->old.slots + m->cur.slots;
+    atomic_init(&v.next, 0);
+    atomic_init(&v.bad, 0);
+
+    if (threads == 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = n > 0 ? (unsigned int)n : 1;
+    }
+    if (threads > VERIFY_MAX_THREADS) threads = VERIFY_MAX_THREADS;
+    if (threads > v.total / VERIFY_CHUNK + 1) threads = (unsigned int)(v.total / VERIFY_CHUNK + 1);
+
+    // This thread scans too; helpers that can't be started just leave it more to do.
+    pthread_t tids[VERIFY_MAX_THREADS];
+    unsigned int started = 0;
+    while (started + 1 < threads && pthread_create(&tids[started], NULL, verify_worker, &v) == 0)
+        started++;
+    verify_worker(&v);
+    while (started) pthread_join(tids[--started], NULL);
+
+    size_t bad = atomic_load_explicit(&v.bad, memory_order_relaxed);
+    if (out_count) *out_count = bad < max_keys ? bad : max_keys;
+    return bad > INT_MAX ? INT_MAX : (int)bad;
+}
+
+/**
+ * @brief Checks that a store keeps embeddings.
+ * @return 0 if it does, -1 (errno = ENOTSUP) if not.
+ */
+static int embeds_ok(const splinter_store_t *st) {
+    if (st->H->embed_dim) return 0;
+    errno = ENOTSUP;
+    return -1;
+}
+
+/**
+ * @brief Sets a key along with its embedding vector.
+ *
+ * The vector goes into the key's row of the embeddings region under the
+ * same seqlock as the value, so a reader never sees one without the other.
+ *
+ * @param vec embed_dim floats.
+ * @return 0 on success, -1 on failure (as splinter_store_set(), or errno =
+ * ENOTSUP if the store keeps no embeddings), -2 on invalid arguments.
+ */
+int splinter_store_set_with_embeddings(splinter_store_t *st, const char *key, const void *val, size_t len,
+    const float *vec) {
+    if (!st || !st->H || !key || !vec) return -2;
+    if (len == 0 || len > st->H->max_val_sz) return -2;
+    if (embeds_ok(st) != 0) return -1;
+
+    struct iovec v = { .iov_base = (void *)val, .iov_len = len };
+    struct write_op op = { .mode = WRITE_REPLACE, .iov = &v, .iovcnt = 1, .len = len, .vec = vec };
+    if (write_key(st, key, key_hash(st, key), &op) != 0) return -1;
+
+    atomic_fetch_add_explicit(&st->H->epoch, 1, memory_order_relaxed);
+    return 0;
+}
+
+/**
+ * @brief Replaces an existing key's embedding and leaves its value as it is.
+ *
+ * A zero-length range write that brings a vector: the epoch moves (so views,
+ * pollers and the feed see a change), the value's bytes don't.
+ *
+ * @return 0 on success, -1 on failure (errno = ENOENT if the key doesn't
+ * exist, ENOTSUP if the store keeps no embeddings), -2 on invalid arguments.
+ */
+int splinter_store_set_embeddings(splinter_store_t *st, const char *key, const float *vec) {
+    if (!st || !st->H || !key || !vec) return -2;
+    if (embeds_ok(st) != 0) return -1;
 
-    size_t i;
-    for (i = 0; i < H->slots; ++i) {
-        struct splinter_slot *slot = &S[(idx + i) % H->slots];
-        uint64_t slot_hash = atomic_load_explicit(&slot->hash, memory_order_acquire);
-
-        if (slot_hash == 0 || (slot_hash == h && strncmp(slot->key, key, SPLINTER_KEY_MAX) == 0)) {
-            // Try to acquire the slot's seqlock: flip epoch from even -> odd.
-            uint64_t e = atomic_load_explicit(&slot->epoch, memory_order_relaxed);
-            if (e & 1ull) {
-                // writer already in progress for this slot; skip and continue probing
+    struct write_op op = { .mode = WRITE_RANGE, .cond = COND_PRESENT, .vec = vec };
+    if (write_key(st, key, key_hash(st, key), &op) != 0) return -1;
+
+    atomic_fetch_add_explicit(&st->H->epoch, 1, memory_order_relaxed);
+    return 0;
+}
+
+/**
+ * @brief Copies a key's embedding out under its slot seqlock.
+ * @param out Receives embed_dim floats.
+ * @return 0 on success, -1 on failure (errno = ENOENT if the key doesn't
+ * exist, ENODATA if it has no embedding, ENOTSUP if the store keeps none,
+ * EAGAIN if writers kept changing it).
+ */
+int splinter_store_get_embeddings(splinter_store_t *st, const char *key, float *out) {
+    if (!st || !st->H || !key || !out) return -1;
+    if (embeds_ok(st) != 0) return -1;
+    const struct store_map *m = store_map(st);
+    const struct table *t;
+    uint64_t h = key_hash(st, key);
+    struct splinter_slot *slot = m ? lookup(st, m, key, h, &t) : NULL;
+    if (!slot) return -1;
+
+    for (int tries = 0; tries < TAG_COPY_RETRIES; tries++) {
+        uint64_t e = atomic_load_explicit(&slot->epoch, memory_order_acquire);
+        if (e & 1) {
+            cpu_relax();
+            continue;
+        }
+        if (atomic_load_explicit(&slot->hash, memory_order_acquire) != h) {
+            errno = ENOENT;
+            return -1;
+        }
+        int has = atomic_load_explicit(&slot->embedded, memory_order_relaxed);
+        if (has) memcpy(out, slot_vec(t, slot), (size_t)st->H->embed_dim * sizeof(float));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->epoch, memory_order_relaxed) != e) continue;
+        if (has) return 0;
+        errno = ENODATA;
+        return -1;
+    }
+    errno = EAGAIN;
+    return -1;
+}
+
+/**
+ * @brief Reads a key's value and its embedding as they were at one moment.
+ *
+ * Like splinter_store_get() (a single attempt: EAGAIN if a writer got in
+ * the way), with the embedding copied inside the same seqlock read.
+ *
+ * @param vec Receives embed_dim floats.
+ * @return 0 on success, -1 on failure with errno as splinter_store_get(), or
+ * ENODATA if the key has no embedding (the value is still copied out),
+ * ENOTSUP if the store keeps none.
+ */
+int splinter_store_get_with_embeddings(splinter_store_t *st, const char *key, void *buf, size_t buf_sz,
+    size_t *out_sz, float *vec) {
+    if (!st || !st->H || !key || !vec) return -1;
+    if (embeds_ok(st) != 0) return -1;
+    const struct store_map *m = store_map(st);
+    const struct table *t;
+    uint64_t h = key_hash(st, key);
+    struct splinter_slot *slot = m ? lookup(st, m, key, h, &t) : NULL;
+    if (!slot) return -1;
+
+    uint64_t e = atomic_load_explicit(&slot->epoch, memory_order_acquire);
+    struct iovec v = { .iov_base = buf, .iov_len = buf_sz };
+    if (read_slot(t, slot, h, 0, buf ? &v : NULL, 1, out_sz, NULL) != 0) return -1;
+    int has = atomic_load_explicit(&slot->embedded, memory_order_relaxed);
+    if (has) memcpy(vec, slot_vec(t, slot), (size_t)st->H->embed_dim * sizeof(float));
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&slot->epoch, memory_order_relaxed) != e) {
+        errno = EAGAIN;
+        return -1;
+    }
+    if (has) return 0;
+    errno = ENODATA;
+    return -1;
+}
+
+/** @brief Slots a splinter_store_knn() thread takes at a time. */
+#define KNN_CHUNK       1024
+
+/**
+ * @brief A k-NN candidate: where it is and how near. rank is the score
+ * turned so that higher is always nearer.
+ */
+struct knn_cand {
+    float rank, score;
+    uint32_t slot;
+    uint64_t epoch;
+};
+
+/**
+ * @brief One splinter_store_knn() scan, shared by its threads. Each thread
+ * keeps its own k best in heaps[thread * k ...].
+ */
+struct knn_scan {
+    splinter_store_t *st;
+    const struct table *t;
+    const float *q;
+    float qq;
+    int metric;
+    size_t k;
+    atomic_size_t next;
+    atomic_uint workers;
+    struct knn_cand *heaps;
+    size_t *counts;
+};
+
+/**
+ * @brief Turns a kernel's dot products into a score, and that into a rank.
+ */
+static inline float knn_score(const struct knn_scan *s, struct vec_dots d, float *rank) {
+    return metric_score(s->metric, s->qq, d, rank);
+}
+
+/**
+ * @brief Restores the min-heap property below position i (worst on top).
+ */
+static void knn_sift_down(struct knn_cand *h, size_t n, size_t i) {
+    for (;;) {
+        size_t l = 2 * i + 1, min = i;
+        if (l < n && h[l].rank < h[min].rank) min = l;
+        if (l + 1 < n && h[l + 1].rank < h[min].rank) min = l + 1;
+        if (min == i) return;
+        struct knn_cand tmp = h[i];
+        h[i] = h[min];
+        h[min] = tmp;
+        i = min;
+    }
+}
+
+/**
+ * @brief Offers a candidate to a heap of at most k.
+ */
+static void knn_offer(struct knn_cand *h, size_t *n, size_t k, struct knn_cand c) {
+    if (*n < k) {
+        size_t i = (*n)++;
+        h[i] = c;
+        while (i && h[(i - 1) / 2].rank > h[i].rank) {
+            struct knn_cand tmp = h[i];
+            h[i] = h[(i - 1) / 2];
+            h[(i - 1) / 2] = tmp;
+            i = (i - 1) / 2;
+        }
+    } else if (c.rank > h[0].rank) {
+        h[0] = c;
+        knn_sift_down(h, *n, 0);
+    }
+}
+
+/**
+ * @brief splinter_store_knn() thread: scores chunks of slots until none are
+ * left. A slot being written while it's scored is skipped.
+ */
+static void *knn_worker(void *arg) {
+    struct knn_scan *s = arg;
+    const struct table *t = s->t;
+    unsigned int me = atomic_fetch_add_explicit(&s->workers, 1, memory_order_relaxed);
+    struct knn_cand *heap = s->heaps + (size_t)me * s->k;
+    size_t n = 0;
+
+    for (;;) {
+        size_t i = atomic_fetch_add_explicit(&s->next, KNN_CHUNK, memory_order_relaxed);
+        if (i >= t->slots) break;
+        size_t end = t->slots - i < KNN_CHUNK ? t->slots : i + KNN_CHUNK;
+        for (; i < end; i++) {
+            struct splinter_slot *slot = &t->S[i];
+            if (!atomic_load_explicit(&slot->embedded, memory_order_relaxed)) continue;
+            uint64_t e = atomic_load_explicit(&slot->epoch, memory_order_acquire);
+            if ((e & 1) || atomic_load_explicit(&slot->hash, memory_order_relaxed) <= HASH_TOMB ||
+                slot_expired(slot))
                 continue;
-            }
-            // attempt to CAS epoch: e -> e+1 (make odd)
-            uint64_t want = e + 1;
-            if (!atomic_compare_exchange_weak_explicit(&slot->epoch, &e, want,
-                                                      memory_order_acq_rel, memory_order_relaxed)) {
-                // CAS failed (epoch changed), retry next slot
+            struct knn_cand c = { .slot = (uint32_t)i, .epoch = e };
+            c.score = knn_score(s, s->st->vec_dot(s->q, slot_vec(t, slot), t->vec_floats), &c.rank);
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&slot->epoch, memory_order_relaxed) != e ||
+                !atomic_load_explicit(&slot->embedded, memory_order_relaxed))
                 continue;
-            }
+            knn_offer(heap, &n, s->k, c);
+        }
+    }
+    s->counts[me] = n;
+    return NULL;
+}
 
-            // We have the slot in "writer active" (odd epoch) state.
-            // Now validate the offset/range before touching memory.
-            if ((size_t)slot->val_off >= arena_sz || (size_t)slot->val_off + len > arena_sz) {
-                // leave epoch balanced (make it even again) and fail safely
-                atomic_fetch_add_explicit(&slot->epoch, 1, memory_order_release);
-                return -1;
-            }
+/**
+ * @brief Orders candidates nearest first.
+ */
+static int knn_cmp(const void *a, const void *b) {
+    float x = ((const struct knn_cand *)a)->rank, y = ((const struct knn_cand *)b)->rank;
+    return x < y ? 1 : x > y ? -1 : 0;
+}
 
-            // Perform the write: value -> val_len -> key -> publish hash -> complete epoch
-            uint8_t *dst = (uint8_t *)VALUES + slot->val_off;
+/**
+ * @brief Finds the k keys whose embeddings are nearest to a query, by
+ * scoring every one of them.
+ *
+ * Embeddings sit in a dense region of their own, a cache-line aligned row
+ * per slot, so the scan streams through slots * embed_stride bytes doing
+ * nothing but fused multiply-adds (see vec_kernel()); every metric comes
+ * from the same two dot products per row. Threads split the table into
+ * chunks as splinter_store_verify() does and keep their own k best, merged
+ * at the end. A hit's key is copied only then, and only if its slot hasn't
+ * been written since it was scored. A resize that is migrating keys is
+ * driven to the end first.
+ *
+ * @param st The store to operate on.
+ * @param query embed_dim floats.
+ * @param k Most hits wanted.
+ * @param metric SPLINTER_METRIC_*.
+ * @param threads Threads to scan with; 0 uses one per online CPU.
+ * @param out Receives up to k hits, nearest first.
+ * @return The number of hits, -1 on failure (errno = ENOTSUP if the store
+ * keeps no embeddings, ENOMEM), -2 on invalid arguments.
+ */
+int splinter_store_knn(splinter_store_t *st, const float *query, size_t k, int metric, unsigned int threads,
+    splinter_knn_hit_t *out) {
+    if (!st || !st->H || !query || !k || !out || metric < SPLINTER_METRIC_DOT || metric > SPLINTER_METRIC_L2)
+        return -2;
+    if (embeds_ok(st) != 0 || migrate_run(st) != 0) return -1;
+    const struct store_map *m = store_map(st);
+    if (!m) return -1;
+    const struct table *t = &m->cur;
+    if (k > t->slots) k = t->slots;
 
-            // Clear full slot value region (keeps old tail bytes from leaking).
-            if (atomic_load_explicit(&H->auto_vacuum, memory_order_relaxed) == 1) {
-                memset(VALUES + slot->val_off, 0, H->max_val_sz);
-            }
-            memcpy(dst, val, len);
+    if (threads == 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = n > 0 ? (unsigned int)n : 1;
+    }
+    if (threads > VERIFY_MAX_THREADS) threads = VERIFY_MAX_THREADS;
+    if (threads > t->slots / KNN_CHUNK + 1) threads = (unsigned int)(t->slots / KNN_CHUNK + 1);
 
-            // Publish length atomically (release so readers see full bytes)
-            atomic_store_explicit(&slot->val_len, (uint32_t)len, memory_order_release);
+    // The kernels read whole rows with aligned loads; give the query the same shape.
+    float *q = aligned_alloc(SPLINTER_CACHE_LINE, (size_t)t->vec_floats * sizeof(float));
+    struct knn_cand *heaps = malloc((size_t)threads * k * sizeof(*heaps));
+    size_t *counts = calloc(threads, sizeof(*counts));
+    int found = -1;
+    if (!q || !heaps || !counts) {
+        errno = ENOMEM;
+        goto out;
+    }
+    memset(q, 0, (size_t)t->vec_floats * sizeof(float));
+    memcpy(q, query, (size_t)st->H->embed_dim * sizeof(float));
 
-            // Update key (write full key buffer so readers can't see a partial key)
-            if (atomic_load_explicit(&H->auto_vacuum, memory_order_relaxed) == 1) {
-                memset(slot->key, 0, SPLINTER_KEY_MAX);
-            } else {
-                slot->key[0] = '\0';
+    struct knn_scan s = { .st = st, .t = t, .q = q, .metric = metric, .k = k, .heaps = heaps, .counts = counts };
+    s.qq = st->vec_dot(q, q, t->vec_floats).vv;
+    atomic_init(&s.next, 0);
+    atomic_init(&s.workers, 0);
+
+    pthread_t tids[VERIFY_MAX_THREADS];
+    unsigned int started = 0;
+    while (started + 1 < threads && pthread_create(&tids[started], NULL, knn_worker, &s) == 0)
+        started++;
+    knn_worker(&s);
+    while (started) pthread_join(tids[--started], NULL);
+
+    // Gather every thread's heap, best first, and keep the hits whose slots
+    // still hold what was scored.
+    size_t total = 0, i;
+    unsigned int w, workers = atomic_load_explicit(&s.workers, memory_order_relaxed);
+    for (w = 0; w < workers; w++) {
+        memmove(heaps + total, heaps + (size_t)w * k, counts[w] * sizeof(*heaps));
+        total += counts[w];
+    }
+    qsort(heaps, total, sizeof(*heaps), knn_cmp);
+    found = 0;
+    for (i = 0; i < total && (size_t)found < k; i++) {
+        struct splinter_slot *slot = &t->S[heaps[i].slot];
+        splinter_knn_hit_t *hit = &out[found];
+        memcpy(hit->key, slot_key(t, slot), SPLINTER_KEY_MAX);
+        hit->key[SPLINTER_KEY_MAX - 1] = '\0';
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->epoch, memory_order_relaxed) != heaps[i].epoch) continue;
+        hit->score = heaps[i].score;
+        hit->epoch = heaps[i].epoch;
+        found++;
+    }
+out:
+    free(q);
+    free(heaps);
+    free(counts);
+    return found;
+}
+
+/**
+ * @brief Finds about the k keys whose embeddings are nearest to a query,
+ * from the HNSW graph.
+ *
+ * A greedy descent from the entry point through the upper levels, then a
+ * best-first search of level 0 for the ef nearest (see ann_search_level()).
+ * Nothing is locked: the graph may be mid-update, so what the search turns
+ * up is scored again like splinter_store_knn() scores a slot, as of one
+ * write to it, and slots that are empty, expired or being written are
+ * passed over.
+ *
+ * @param ef Candidates to keep while searching level 0 (at least k); 0 for
+ * the store's ann_ef_search.
+ * @param out Receives up to k hits, nearest first.
+ * @return The number of hits, -1 on failure (errno = ENOTSUP if the store
+ * keeps no graph, ENOMEM), -2 on invalid arguments.
+ */
+int splinter_store_ann(splinter_store_t *st, const float *query, size_t k, unsigned int ef,
+    splinter_knn_hit_t *out) {
+    if (!st || !st->H || !query || !k || !out) return -2;
+    if (embeds_ok(st) != 0) return -1;
+    struct splinter_header *H = st->H;
+    if (!H->ann_m) {
+        errno = ENOTSUP;
+        return -1;
+    }
+    if (migrate_run(st) != 0) return -1;
+    const struct store_map *m = store_map(st);
+    if (!m) return -1;
+    const struct table *t = &m->cur;
+    if (!t->ANN_HEAD) {
+        errno = ENOTSUP;
+        return -1;
+    }
+    size_t width = ef ? ef : H->ann_ef_search;
+    if (width < k) width = k;
+
+    struct ann_ctx c = { .st = st, .t = t, .m = H->ann_m, .metric = (int)H->ann_metric };
+    float *q = aligned_alloc(SPLINTER_CACHE_LINE, (size_t)t->vec_floats * sizeof(float));
+    struct ann_cand *w = NULL;
+    struct knn_cand *hits = NULL;
+    int found = -1;
+    c.ids = malloc((2 * (size_t)c.m + 1) * sizeof(uint32_t));
+    if (!q || !c.ids) {
+        errno = ENOMEM;
+        goto out;
+    }
+    memset(q, 0, (size_t)t->vec_floats * sizeof(float));
+    memcpy(q, query, (size_t)H->embed_dim * sizeof(float));
+    c.q = q;
+    c.qq = st->vec_dot(q, q, t->vec_floats).vv;
+
+    uint64_t entry = atomic_load_explicit(&t->ANN_HEAD->entry, memory_order_acquire);
+    uint32_t ep = (uint32_t)entry - 1;
+    unsigned int l = (unsigned int)(entry >> 32);
+    found = 0;
+    if (!entry || ep >= t->slots || l >= ANN_MAX_LEVEL) goto out;
+    if (ann_heap_push(&c.found, ann_rank(&c, ep), ep) != 0) goto nomem;
+    for (; l > 0; l--)
+        if (ann_search_level(&c, l, 1) != 0) goto nomem;
+    if (ann_search_level(&c, 0, width) != 0) goto nomem;
+    w = malloc((c.found.n ? c.found.n : 1) * sizeof(*w));
+    hits = malloc((c.found.n ? c.found.n : 1) * sizeof(*hits));
+    if (!w || !hits) goto nomem;
+
+    size_t nw = ann_drain(&c, w), n = 0, i;
+    for (i = 0; i < nw; i++) {
+        struct splinter_slot *slot = &t->S[w[i].id];
+        if (!atomic_load_explicit(&slot->embedded, memory_order_relaxed)) continue;
+        uint64_t e = atomic_load_explicit(&slot->epoch, memory_order_acquire);
+        if ((e & 1) || atomic_load_explicit(&slot->hash, memory_order_relaxed) <= HASH_TOMB || slot_expired(slot))
+            continue;
+        struct knn_cand h = { .slot = w[i].id, .epoch = e };
+        h.score = metric_score(c.metric, c.qq, st->vec_dot(q, slot_vec(t, slot), t->vec_floats), &h.rank);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->epoch, memory_order_relaxed) != e ||
+            !atomic_load_explicit(&slot->embedded, memory_order_relaxed))
+            continue;
+        hits[n++] = h;
+    }
+    // a vector that changed since the search ranked it can move
+    qsort(hits, n, sizeof(*hits), knn_cmp);
+    for (i = 0; i < n && (size_t)found < k; i++) {
+        struct splinter_slot *slot = &t->S[hits[i].slot];
+        splinter_knn_hit_t *hit = &out[found];
+        memcpy(hit->key, slot_key(t, slot), SPLINTER_KEY_MAX);
+        hit->key[SPLINTER_KEY_MAX - 1] = '\0';
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&slot->epoch, memory_order_relaxed) != hits[i].epoch) continue;
+        hit->score = hits[i].score;
+        hit->epoch = hits[i].epoch;
+        found++;
+    }
+    goto out;
+nomem:
+    errno = ENOMEM;
+    found = -1;
+out:
+    ann_ctx_free(&c);
+    free(q);
+    free(w);
+    free(hits);
+    return found;
+}
+
+/*
+ * Reaper. Expired keys read as gone straight away; the reaper is what gives
+ * their slots back before a writer has to. It files every key with an expiry
+ * in a hierarchical timing wheel kept with the table: level l has WHEEL_SIZE
+ * buckets WHEEL_SIZE^l ms wide, and a key sits at the lowest level whose
+ * span around the wheel's clock takes in its expiry, so moving the clock on
+ * only visits buckets that came due (and the keys in them), cascading keys
+ * that aren't due yet down to finer levels.
+ *
+ * Writers never touch the wheel: they append the slot to the expiry log, and
+ * the next pass files it. Passes hold reap_owner, so the wheel needs no
+ * atomics; a pass that died half way, a log that wrapped before the reaper
+ * got to it, or a resize just means the next pass rebuilds the wheel from
+ * one scan of the table.
+ */
+
+/**
+ * @brief Takes slot i out of the timing wheel, if it's filed there.
+ */
+static void wheel_unlink(const struct table *t, uint32_t i) {
+    struct wheel_link *l = &t->LINKS[i];
+
+    if (!l->bucket) return;
+    if (l->prev) t->LINKS[l->prev - 1].next = l->next;
+    else t->WHEEL[l->bucket - 1] = l->next;
+    if (l->next) t->LINKS[l->next - 1].prev = l->prev;
+    l->next = l->prev = l->bucket = 0;
+}
+
+/**
+ * @brief Files slot i in the bucket for when (later than the wheel's clock,
+ * now): the lowest level at which the two only differ in that level's digit,
+ * or the last bucket of the top level if they differ above it.
+ */
+static void wheel_insert(const struct table *t, uint64_t now, uint32_t i, uint64_t when) {
+    unsigned int lvl = (unsigned int)(63 - __builtin_clzll(when ^ now)) / WHEEL_BITS;
+    uint32_t b = lvl < WHEEL_LEVELS ?
+        lvl * WHEEL_SIZE + (uint32_t)((when >> (lvl * WHEEL_BITS)) & (WHEEL_SIZE - 1)) : WHEEL_BUCKETS - 1;
+    struct wheel_link *l = &t->LINKS[i];
+
+    l->bucket = b + 1;
+    l->prev = 0;
+    l->next = t->WHEEL[b];
+    if (l->next) t->LINKS[l->next - 1].prev = i + 1;
+    t->WHEEL[b] = i + 1;
+}
+
+/**
+ * @brief Files slot i by the expiry it has now: deletes its key if that's
+ * due already, and leaves it out of the wheel if it has none.
+ * @param now The wheel's clock.
+ * @param reaped Incremented for a key deleted.
+ */
+static void wheel_file(splinter_store_t *st, const struct store_map *m, uint32_t i, uint64_t now,
+    uint64_t *reaped) {
+    const struct table *t = &m->cur;
+    struct splinter_slot *slot = &t->S[i];
+    uint64_t when = atomic_load_explicit(&slot->expires, memory_order_acquire);
+
+    wheel_unlink(t, i);
+    if (!when || atomic_load_explicit(&slot->hash, memory_order_acquire) <= HASH_TOMB) return;
+    if (when <= now) {
+        if (expire_slot(st, m, t, slot)) {
+            (*reaped)++;
+            return;
+        }
+        // A writer holds the slot (or just gave the key more time): look again next pass.
+        if (!(when = atomic_load_explicit(&slot->expires, memory_order_acquire))) return;
+        if (when <= now) when = now + 1;
+    }
+    wheel_insert(t, now, i, when);
+}
+
+/**
+ * @brief Empties the timing wheel and files every key with an expiry again.
+ * @return The number of keys deleted on the way.
+ */
+static uint64_t wheel_rebuild(splinter_store_t *st, const struct store_map *m, uint64_t now) {
+    struct splinter_header *H = st->H;
+    const struct table *t = &m->cur;
+    uint64_t reaped = 0;
+
+    // Log records from here on are filed again after the scan; refiling is harmless.
+    H->reap_cursor = atomic_load_explicit(&H->exp_head, memory_order_acquire);
+    memset(t->WHEEL, 0, WHEEL_BUCKETS * sizeof(uint32_t));
+    memset(t->LINKS, 0, (size_t)t->slots * sizeof(struct wheel_link));
+    H->wheel_now = now;
+    H->wheel_table = t->id + 1;
+    for (uint32_t i = 0; i < t->slots; i++)
+        if (atomic_load_explicit(&t->S[i].expires, memory_order_relaxed))
+            wheel_file(st, m, i, now, &reaped);
+    return reaped;
+}
+
+/**
+ * @brief Files the slots the expiry log has named since the last pass.
+ * @return 0 on success, -1 if records were lost (the log wrapped) and the
+ * wheel has to be rebuilt.
+ */
+static int wheel_ingest(splinter_store_t *st, const struct store_map *m, uint64_t *reaped) {
+    struct splinter_header *H = st->H;
+    uint64_t c = H->reap_cursor, head = atomic_load_explicit(&H->exp_head, memory_order_acquire);
+
+    if (c > head || head - c > H->exp_len) return -1;
+    for (; c < head; c++) {
+        struct exp_rec *r = &st->EXPLOG[c & st->exp_mask];
+        uint64_t seq = atomic_load_explicit(&r->seq, memory_order_acquire);
+        if (seq != c + 1) {
+            if (seq > c + 1) return -1; // overwritten already
+            break;                      // not published yet: next pass
+        }
+        uint64_t s = atomic_load_explicit(&r->slot, memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&r->seq, memory_order_relaxed) != seq) return -1;
+        if ((uint32_t)(s >> 32) == m->cur.id && (uint32_t)s < m->cur.slots)
+            wheel_file(st, m, (uint32_t)s, H->wheel_now, reaped);
+    }
+    H->reap_cursor = c;
+    return 0;
+}
+
+/**
+ * @brief Moves the wheel's clock on to now, deleting the keys that came due
+ * and refiling the rest of the buckets it passed.
+ * @return The number of keys deleted.
+ */
+static uint64_t wheel_advance(splinter_store_t *st, const struct store_map *m, uint64_t now) {
+    struct splinter_header *H = st->H;
+    const struct table *t = &m->cur;
+    uint64_t from = H->wheel_now, reaped = 0;
+    uint32_t due = 0; // slot + 1, chained through next
+
+    if (now <= from) return 0;
+    for (unsigned int lvl = 0; lvl < WHEEL_LEVELS; lvl++) {
+        unsigned int shift = lvl * WHEEL_BITS;
+        uint32_t df = (uint32_t)(from >> shift) & (WHEEL_SIZE - 1), dt = (uint32_t)(now >> shift) & (WHEEL_SIZE - 1);
+        uint32_t first = df + 1, n = dt - df;
+        // The clock left the level's span altogether: every bucket in it is due.
+        if ((from >> shift >> WHEEL_BITS) != (now >> shift >> WHEEL_BITS)) {
+            first = 0;
+            n = WHEEL_SIZE;
+        }
+        for (uint32_t k = 0; k < n; k++) {
+            uint32_t b = lvl * WHEEL_SIZE + ((first + k) & (WHEEL_SIZE - 1)), i = t->WHEEL[b];
+            t->WHEEL[b] = 0;
+            while (i) {
+                struct wheel_link *l = &t->LINKS[i - 1];
+                uint32_t next = l->next;
+                l->next = due;
+                l->prev = l->bucket = 0;
+                due = i;
+                i = next;
             }
-            strncpy(slot->key, key, SPLINTER_KEY_MAX - 1);
-            slot->key[SPLINTER_KEY_MAX - 1] = '\0';
+        }
+    }
+    H->wheel_now = now;
+    while (due) {
+        uint32_t next = t->LINKS[due - 1].next;
+        t->LINKS[due - 1].next = 0;
+        wheel_file(st, m, due - 1, now, &reaped);
+        due = next;
+    }
+    return reaped;
+}
 
-            // Ensure prior stores are visible before publishing hash
-            atomic_thread_fence(memory_order_release);
+/**
+ * @brief Deletes expired keys, giving their slots back.
+ *
+ * Expired keys read as missing already; this reclaims their space before
+ * writers need it, and tells pollers, watch sets and the change feed they
+ * are gone (each deletion is an unset to them). With an expiry log
+ * (expiry_log_len in splinter_create_opts_t) a pass moves the store's timing
+ * wheel on, costing O(keys due + expiries set since the last pass); without
+ * one it looks at every slot.
+ *
+ * Run it every so often, from any process (the CLI's reap command can do it
+ * in the background). One process reaps at a time; a reaper that dies is
+ * taken over by the next one. Nothing is reaped while a resize is moving keys.
+ *
+ * @param st The store to operate on.
+ * @return The number of keys deleted, or -1 on failure (errno = EBUSY if
+ * another process is reaping).
+ */
+int splinter_store_reap(splinter_store_t *st) {
+    if (!st || !st->H) return -1;
+    struct splinter_header *H = st->H;
+    const struct store_map *m;
+    uint64_t reaped = 0;
+    int broken;
 
-            // Only now publish the hash so readers will match only once value+key are in place.
-            atomic_store_explicit(&slot->hash, h, memory_order_release);
+    if ((broken = owner_claim(&H->reap_owner)) < 0) return -1;
+    if (!(m = store_map(st))) {
+        atomic_store_explicit(&H->reap_owner, 0, memory_order_release);
+        return -1;
+    }
+    const struct table *t = &m->cur;
+    uint64_t now = now_ms();
+    if (m->gen & 1) {
+        // keys are on the move; the next pass after the resize catches up
+    } else if (!t->WHEEL) {
+        for (uint32_t i = 0; i < t->slots; i++)
+            if (slot_expired(&t->S[i])) reaped += (uint64_t)expire_slot(st, m, t, &t->S[i]);
+    } else {
+        if (broken || H->wheel_table != t->id + 1 || wheel_ingest(st, m, &reaped) != 0)
+            reaped += wheel_rebuild(st, m, now);
+        reaped += wheel_advance(st, m, now);
+    }
+    atomic_store_explicit(&H->reap_owner, 0, memory_order_release);
+    return reaped > INT_MAX ? INT_MAX : (int)reaped;
+}
 
-            // End seqlock: bump epoch to even (writer done). Use release to publish writes.
-            atomic_fetch_add_explicit(&slot->epoch, 1, memory_order_release);
+/**
+ * @brief Waits for a key's value to be changed (updated).
+ *
+ * This function provides a publish-subscribe mechanism. It blocks until the
+ * per-slot epoch for the given key is incremented by a `splinter_set` call.
+ *
+ * The wait optionally spins for a bounded number of epoch checks (see
+ * splinter_store_set_poll_spin()), then registers as a watcher of the slot
+ * and sleeps in FUTEX_WAIT on the epoch word until a writer wakes it or the
+ * CLOCK_MONOTONIC deadline passes.
+ *
+ * With seqlock semantics, if the slot is observed in the middle of a write
+ * (odd epoch), this call returns immediately with errno = EAGAIN so the
+ * caller can retry cleanly.
+ *
+ * A resize moving the key to a new slot counts as a change (it wakes us),
+ * and so does deleting it.
+ *
+ * @param st The store to operate on.
+ * @param key The key to monitor for changes.
+ * @param timeout_ms The maximum time to wait in milliseconds.
+ * @return 0 if the value changed, -1 if the key doesn't exist, -2 with
+ *         errno = ETIMEDOUT on timeout, -2 with errno = EAGAIN if a write
+ *         was observed in progress.
+ */
+int splinter_store_poll(splinter_store_t *st, const char *key, uint64_t timeout_ms) {
+    if (!st || !st->H || !key) return -1;
+    const struct store_map *m = store_map(st);
+    struct splinter_slot *slot = m ? lookup(st, m, key, key_hash(st, key), NULL) : NULL;
+    if (!slot) return -1; // Key does not exist.
 
-            // Update global epoch (best-effort, relaxed).
-            atomic_fetch_add_explicit(&H->epoch, 1, memory_order_relaxed);
+    uint64_t start_epoch = atomic_load_explicit(&slot->epoch, memory_order_acquire);
+    if (start_epoch & 1) {
+        // Writer in progress
+        errno = EAGAIN;
+        return -2;
+    }
 
+    // Bounded busy-spin for ultra-low-latency consumers.
+    unsigned int n;
+    for (n = 0; n < st->poll_spin; n++) {
+        uint64_t cur_epoch = atomic_load_explicit(&slot->epoch, memory_order_acquire);
+        if (cur_epoch != start_epoch) {
+            if (cur_epoch & 1) {
+                errno = EAGAIN;
+                return -2;
+            }
             return 0;
         }
+        cpu_relax();
+    }
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    add_ms(&deadline, timeout_ms);
+
+    int rc;
+    atomic_fetch_add_explicit(&slot->watchers, 1, memory_order_seq_cst);
+    while (1) {
+        uint64_t cur_epoch = atomic_load_explicit(&slot->epoch, memory_order_seq_cst);
+        if (cur_epoch & 1) {
+            errno = EAGAIN;
+            rc = -2; // Writer still in progress
+            break;
+        }
+        if (cur_epoch != start_epoch) {
+            rc = 0; // Value changed
+            break;
+        }
+        if (futex_wait_until(epoch_futex_word(&slot->epoch), (uint32_t)start_epoch, &deadline) != 0 &&
+            errno == ETIMEDOUT) {
+            rc = -2;
+            break;
+        }
+        // Woken, interrupted, or the word moved before we slept: re-check.
     }
-    return -1; // store full / no suitable slot
+    atomic_fetch_sub_explicit(&slot->watchers, 1, memory_order_relaxed);
+    return rc;
 }
 
 /**
- * @brief Retrieves the value associated with a key (seqlock aware).
+ * @brief Sets how many epoch checks splinter_poll spins through before it
+ * sleeps. 0 (the default) goes straight to the futex wait.
+ * @return -2 if the handle is invalid, 0 otherwise.
+ */
+int splinter_store_set_poll_spin(splinter_store_t *st, unsigned int spins) {
+    if (!st) return -2;
+    st->poll_spin = spins;
+    return 0;
+}
+
+/**
+ * @brief Marks a watch entry as waiting for its key to exist.
  *
- * @param key The null-terminated key string.
- * @param buf The buffer to copy the value data into. Can be NULL to query size.
- * @param buf_sz The size of the provided buffer.
- * @param out_sz Pointer to a size_t to store the value's actual length. Can be NULL.
- * @return 0 on success, -1 on failure. On retry condition, returns -1 and sets
- * errno = EAGAIN. If the buffer is too small, returns -1 and sets errno = EMSGSIZE.
+ * While any entry on the store is an orphan, writers notify watch sets on
+ * every key they create. Counting ourselves before looking the key up
+ * (watch_attach()) means a key created in between can't be missed.
  */
-int splinter_get(const char *key, void *buf, size_t buf_sz, size_t *out_sz) {
-    if (!H || !key) return -1;
-    uint64_t h = fnv1a(key);
-    size_t idx = slot_idx(h, H->slots);
+static void watch_orphan(splinter_watch_t *w, struct watch_entry *ent) {
+    ent->slot = WATCH_NO_SLOT;
+    w->orphans++;
+    atomic_fetch_add_explicit(&w->st->H->watch_orphans, 1, memory_order_seq_cst);
+}
 
-    size_t i;
-    for (i = 0; i < H->slots; ++i) {
-        struct splinter_slot *slot = &S[(idx + i) % H->slots];
-
-        if (atomic_load_explicit(&slot->hash, memory_order_acquire) == h &&
-            strncmp(slot->key, key, SPLINTER_KEY_MAX) == 0) {
-            uint64_t start = atomic_load_explicit(&slot->epoch, memory_order_acquire);
-            if (start & 1) {
-                // writer in progress
-                errno = EAGAIN;
-                return -1;
+/**
+ * @brief Points an orphaned watch entry at its key's slot, if the key exists.
+ *
+ * Registers before checking the slot, so a writer either sees our count or
+ * we see its epoch.
+ *
+ * @return 1 if the entry is now registered on a slot, 0 if it's still an orphan.
+ */
+static int watch_attach(splinter_watch_t *w, const struct store_map *m, struct watch_entry *ent) {
+    splinter_store_t *st = w->st;
+    const struct table *t;
+
+    for (;;) {
+        struct splinter_slot *slot = lookup(st, m, ent->key, ent->hash, &t);
+        if (!slot) return 0;
+        atomic_fetch_add_explicit(&slot->watchers, WATCH_SET_ONE, memory_order_seq_cst);
+        uint64_t e = atomic_load_explicit(&slot->epoch, memory_order_seq_cst);
+        if (slot_has_key(t, slot, ent->hash, ent->key)) {
+            ent->slot = (uint32_t)(slot - t->S);
+            ent->tab = t->id;
+            ent->seen = e;
+            w->orphans--;
+            atomic_fetch_sub_explicit(&st->H->watch_orphans, 1, memory_order_relaxed);
+            return 1;
+        }
+        // deleted or moved while we registered
+        atomic_fetch_sub_explicit(&slot->watchers, WATCH_SET_ONE, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Collects up to max changed keys from a watch set (lock held).
+ *
+ * A key changed if its slot's epoch moved since it was last reported, it
+ * was deleted (reported with epoch 0), or it was missing and now exists.
+ * Keys mid-write are left for the writer's own notification. Keys past max
+ * stay pending for the next call. A key moved by a resize is reported once.
+ */
+static size_t watch_collect(splinter_watch_t *w, splinter_watch_event_t *out, size_t max) {
+    const struct store_map *m = store_map(w->st);
+    size_t i, n = 0;
+
+    for (i = 0; m && i < w->n && n < max; i++) {
+        struct watch_entry *ent = &w->ent[i];
+        if (ent->slot == WATCH_NO_SLOT) {
+            if (!watch_attach(w, m, ent)) continue;
+        } else {
+            const struct table *t;
+            struct splinter_slot *slot = watch_slot(m, ent, &t);
+            uint64_t e = slot ? atomic_load_explicit(&slot->epoch, memory_order_acquire) : 0;
+            if (slot && (e == ent->seen || (e & 1))) continue;
+            if (slot && slot_has_key(t, slot, ent->hash, ent->key)) {
+                ent->seen = e;
+            } else {
+                // Gone (or moved): report it, then follow it if it still exists.
+                watch_detach(w, m, ent);
+                watch_orphan(w, ent);
+                watch_attach(w, m, ent);
             }
+        }
+        memcpy(out[n].key, ent->key, SPLINTER_KEY_MAX);
+        out[n].epoch = ent->slot == WATCH_NO_SLOT ? 0 : ent->seen;
+        n++;
+    }
+    return n;
+}
+
+/**
+ * @brief Read-only watch_collect(): is anything waiting to be collected?
+ */
+static int watch_pending(splinter_watch_t *w) {
+    const struct store_map *m = store_map(w->st);
+    size_t i;
+
+    for (i = 0; m && i < w->n; i++) {
+        struct watch_entry *ent = &w->ent[i];
+        const struct table *t;
+        if (ent->slot == WATCH_NO_SLOT) {
+            if (lookup(w->st, m, ent->key, ent->hash, NULL)) return 1;
+            continue;
+        }
+        struct splinter_slot *slot = watch_slot(m, ent, &t);
+        if (!slot) return 1;
+        uint64_t e = atomic_load_explicit(&slot->epoch, memory_order_acquire);
+        if (e != ent->seen && !(e & 1)) return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Sleeps until watch_seq moves off seq, or the deadline (NULL = none) passes.
+ * @return 0 when woken (or it had already moved), -1 with errno = ETIMEDOUT.
+ */
+static int watch_sleep(struct splinter_header *H, uint32_t seq, const struct timespec *deadline) {
+    int rc = 0;
+    atomic_fetch_add_explicit(&H->watch_sleepers, 1, memory_order_seq_cst);
+    if (futex_wait_until((uint32_t *)&H->watch_seq, seq, deadline) != 0 && errno == ETIMEDOUT)
+        rc = -1;
+    atomic_fetch_sub_explicit(&H->watch_sleepers, 1, memory_order_relaxed);
+    return rc;
+}
+
+/**
+ * @brief Checks a watch set is usable: non-NULL, and its store still open.
+ * @return 0 if so, -1 with errno = EINVAL or EBADF if not.
+ */
+static int watch_ok(const splinter_watch_t *w) {
+    if (!w) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!w->st) {
+        errno = EBADF;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Creates an empty watch set on a store.
+ * @return The watch set, or NULL on failure (errno is set).
+ */
+splinter_watch_t *splinter_store_watch_create(splinter_store_t *st) {
+    if (!st || !st->H) {
+        errno = EINVAL;
+        return NULL;
+    }
+    splinter_watch_t *w = calloc(1, sizeof(*w));
+    if (!w) return NULL;
+    w->st = st;
+    w->efd = -1;
+    pthread_mutex_init(&w->lock, NULL);
+    pthread_mutex_lock(&st->watch_lock);
+    w->next = st->watches;
+    if (w->next) w->next->prev = w;
+    st->watches = w;
+    pthread_mutex_unlock(&st->watch_lock);
+    return w;
+}
+
+/**
+ * @brief Adds keys to a watch set.
+ *
+ * Keys don't have to exist yet: a missing key is reported when it's
+ * created. Keys already in the set are skipped.
+ *
+ * @param w The watch set.
+ * @param keys The keys to add.
+ * @param n Number of keys.
+ * @return 0 on success, -1 on failure (errno = ENOMEM; keys before the
+ * failing one were added).
+ */
+int splinter_watch_add(splinter_watch_t *w, const char *const *keys, size_t n) {
+    if (watch_ok(w) != 0 || (!keys && n)) return -1;
+    const struct store_map *m = store_map(w->st);
+    int rc = 0;
+    size_t i, j;
 
-            /* load length atomically */
-            size_t len = (size_t)atomic_load_explicit(&slot->val_len, memory_order_acquire);
-            if (out_sz) *out_sz = len;
+    if (!m) return -1;
+    pthread_mutex_lock(&w->lock);
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < w->n; j++)
+            if (strncmp(w->ent[j].key, keys[i], SPLINTER_KEY_MAX - 1) == 0) break;
+        if (j < w->n) continue;
 
-            if (buf) {
-                if (buf_sz < len) {
-                    errno = EMSGSIZE;
-                    return -1;
-                }
-                memcpy(buf, VALUES + slot->val_off, len);
+        if (w->n == w->cap) {
+            size_t cap = w->cap ? w->cap * 2 : 16;
+            struct watch_entry *ent = realloc(w->ent, cap * sizeof(*ent));
+            if (!ent) {
+                rc = -1;
+                break;
             }
+            w->ent = ent;
+            w->cap = cap;
+        }
+        struct watch_entry *ent = &w->ent[w->n++];
+        memset(ent->key, 0, SPLINTER_KEY_MAX);
+        strncpy(ent->key, keys[i], SPLINTER_KEY_MAX - 1);
+        ent->hash = key_hash(w->st, ent->key);
+        watch_orphan(w, ent);
+        watch_attach(w, m, ent);
+    }
+    pthread_mutex_unlock(&w->lock);
+    return rc;
+}
 
-            uint64_t end = atomic_load_explicit(&slot->epoch, memory_order_acquire);
-            if (start == end && !(end & 1)) {
-                // consistent snapshot
-                return 0;
-            }
+/**
+ * @brief Adds the keys in the slots of a bitmap from
+ * splinter_store_find_tagged() to a watch set. Slots emptied since are
+ * skipped; bits past the end of the table are ignored.
+ * @return The number of keys found in the bitmap (some may already have
+ * been in the set), or -1 on failure (errno = ENOMEM).
+ */
+int splinter_watch_add_slots(splinter_watch_t *w, const uint64_t *bits, size_t words) {
+    if (watch_ok(w) != 0 || !bits) return -1;
+    const struct store_map *m = store_map(w->st);
+    if (!m) return -1;
+    const struct table *t = &m->cur;
+    size_t n = 0, cap = 0, i;
 
-            // inconsistent snapshot, ask caller to retry
-            errno = EAGAIN;
-            return -1;
+    if (words > (t->slots + 63) / 64) words = (t->slots + 63) / 64;
+    for (i = 0; i < words; i++) cap += (size_t)__builtin_popcountll(bits[i]);
+    char (*keys)[SPLINTER_KEY_MAX] = cap ? malloc(cap * SPLINTER_KEY_MAX) : NULL;
+    const char **ptrs = cap ? malloc(cap * sizeof(*ptrs)) : NULL;
+    if (cap && (!keys || !ptrs)) {
+        free(keys);
+        free(ptrs);
+        errno = ENOMEM;
+        return -1;
+    }
+    for (i = 0; i < words; i++) {
+        uint64_t b = bits[i];
+        while (b) {
+            size_t s = i * 64 + (size_t)__builtin_ctzll(b);
+            b &= b - 1;
+            if (s < t->slots && copy_slot_key(t, &t->S[s], keys[n]) == 0) {
+                ptrs[n] = keys[n];
+                n++;
+            }
         }
     }
-
-    return -1; // Not found
+    int rc = splinter_watch_add(w, ptrs, n);
+    free(keys);
+    free(ptrs);
+    return rc == 0 ? (int)n : -1;
 }
 
-
 /**
- * @brief Lists all keys currently in the store.
- *
- * @param out_keys An array of `char*` to be filled with pointers to the keys
- * within the shared memory. These pointers are only valid as
- * long as the store is open.
- * @param max_keys The maximum number of keys to write to `out_keys`.
- * @param out_count Pointer to a size_t to store the number of keys found.
- * @return 0 on success, -1 on failure.
+ * @brief Adds every key tagged with all of tags (see splinter_tag_mask())
+ * to a watch set: splinter_store_find_tagged() and
+ * splinter_watch_add_slots() in one. Keys tagged later aren't added.
+ * @return The number of keys found, or -1 on failure (errno is set).
  */
-int splinter_list(char **out_keys, size_t max_keys, size_t *out_count) {
-    if (!H || !out_keys || !out_count) return -1;
-    size_t count = 0, i;
-    
-    for (i = 0; i < H->slots && count < max_keys; ++i) {
-        // A non-zero hash and value length indicates a valid, active key.
-        if (atomic_load_explicit(&S[i].hash, memory_order_acquire) &&
-            atomic_load_explicit(&S[i].val_len, memory_order_acquire) > 0) {
-            out_keys[count++] = S[i].key;
+int splinter_watch_add_tagged(splinter_watch_t *w, const char *const *tags, size_t n) {
+    if (watch_ok(w) != 0 || !tags || !n) return -1;
+    uint64_t mask = 0;
+    size_t i;
+
+    for (i = 0; i < n; i++) mask |= splinter_tag_mask(tags[i]);
+    for (;;) {
+        const struct store_map *m = store_map(w->st);
+        if (!m) return -1;
+        size_t words = ((size_t)m->cur.slots + 63) / 64;
+        uint64_t *bits = malloc(words * sizeof(uint64_t));
+        if (!bits) {
+            errno = ENOMEM;
+            return -1;
         }
+        int rc = splinter_store_find_tagged(w->st, mask, bits, words);
+        if (rc >= 0) rc = splinter_watch_add_slots(w, bits, words);
+        free(bits);
+        if (rc >= 0 || errno != ERANGE) return rc < 0 ? -1 : rc;
+        // resized in between: size the bitmap again
     }
-    *out_count = count;
-    return 0;
 }
 
 /**
- * @brief Waits for a key's value to be changed (updated).
- *
- * This function provides a publish-subscribe mechanism. It blocks until the
- * per-slot epoch for the given key is incremented by a `splinter_set` call.
- *
- * With seqlock semantics, if the slot is observed in the middle of a write
- * (odd epoch), this call returns immediately with errno = EAGAIN so the
- * caller can retry cleanly.
- *
- * @param key The key to monitor for changes.
- * @param timeout_ms The maximum time to wait in milliseconds.
- * @return 0 if the value changed, -1 on timeout, -1 with errno = EAGAIN
- *         if a write was observed in progress.
+ * @brief Removes keys from a watch set. Keys that aren't in it are ignored.
+ * @return The number of keys removed, or -1 if w is invalid.
  */
-int splinter_poll(const char *key, uint64_t timeout_ms) {
-    if (!H || !key) return -1;
-    uint64_t h = fnv1a(key);
-    size_t idx = slot_idx(h, H->slots);
-    struct splinter_slot *slot = NULL;
+int splinter_watch_eject(splinter_watch_t *w, const char *const *keys, size_t n) {
+    if (watch_ok(w) != 0 || (!keys && n)) return -1;
+    const struct store_map *m = store_map(w->st);
+    int removed = 0;
+    size_t i, j;
 
-    // Find the slot corresponding to the key
-    size_t i;
-    for (i = 0; i < H->slots; ++i) {
-        struct splinter_slot *s = &S[(idx + i) % H->slots];
-        if (atomic_load_explicit(&s->hash, memory_order_acquire) == h &&
-            strncmp(s->key, key, SPLINTER_KEY_MAX) == 0) {
-            slot = s;
+    if (!m) return -1;
+    pthread_mutex_lock(&w->lock);
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < w->n; j++) {
+            if (strncmp(w->ent[j].key, keys[i], SPLINTER_KEY_MAX - 1) != 0) continue;
+            watch_detach(w, m, &w->ent[j]);
+            w->ent[j] = w->ent[--w->n];
+            removed++;
             break;
         }
     }
-    if (!slot) return -1; // Key does not exist.
+    pthread_mutex_unlock(&w->lock);
+    return removed;
+}
 
-    uint64_t start_epoch = atomic_load_explicit(&slot->epoch, memory_order_acquire);
-    if (start_epoch & 1) {
-        // Writer in progress
-        errno = EAGAIN;
-        return -2;
-    }
+/**
+ * @brief Waits until keys in a watch set change, and returns them as a batch.
+ *
+ * However many keys are watched, this blocks on a single futex (the store's
+ * watch_seq); every change since the last call is returned at once. Each
+ * change is reported once, however many times the key was written since.
+ *
+ * @param w The watch set.
+ * @param timeout_ms How long to wait; 0 just collects what's pending.
+ * @param out Receives the changed keys, with their new slot epochs (0 if
+ * the key was deleted).
+ * @param max Capacity of out; further changes are kept for the next call.
+ * @return The number of keys in out, or -2 with errno = ETIMEDOUT if nothing
+ * changed in time, -1 on invalid arguments.
+ */
+int splinter_watch_wait(splinter_watch_t *w, uint64_t timeout_ms, splinter_watch_event_t *out, size_t max) {
+    if (watch_ok(w) != 0 || !out || !max) return -1;
+    struct splinter_header *H = w->st->H;
+    if (max > INT_MAX) max = INT_MAX;
 
     struct timespec deadline;
-    clock_gettime(CLOCK_REALTIME, &deadline);
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
     add_ms(&deadline, timeout_ms);
 
-    struct timespec sleep_ts = {0, 10 * NS_PER_MS}; // 10ms sleep
-    while (1) {
-        uint64_t cur_epoch = atomic_load_explicit(&slot->epoch, memory_order_acquire);
-        if (cur_epoch & 1) {
-            errno = EAGAIN;
-            return -2; // Writer still in progress
-        }
-        if (cur_epoch != start_epoch) {
-            return 0; // Value changed
-        }
+    for (int timed_out = 0;; ) {
+        uint32_t seq = atomic_load_explicit(&H->watch_seq, memory_order_seq_cst);
+        pthread_mutex_lock(&w->lock);
+        size_t n = watch_collect(w, out, max);
+        pthread_mutex_unlock(&w->lock);
+        if (n) return (int)n;
+        if (timed_out || timeout_ms == 0) break;
+        timed_out = watch_sleep(H, seq, &deadline) != 0;
+    }
+    errno = ETIMEDOUT;
+    return -2;
+}
 
-        struct timespec now;
-        clock_gettime(CLOCK_REALTIME, &now);
-        if ((now.tv_sec > deadline.tv_sec) ||
-            (now.tv_sec == deadline.tv_sec && now.tv_nsec >= deadline.tv_nsec)) {
-            errno = ETIMEDOUT;
-            return -2;
+/**
+ * @brief Body of the thread behind splinter_watch_fd(): turns watch_seq
+ * wake-ups that concern this set into eventfd writes.
+ */
+static void *watch_notifier(void *arg) {
+    splinter_watch_t *w = arg;
+    struct splinter_header *H = w->st->H;
+
+    for (;;) {
+        uint32_t seq = atomic_load_explicit(&H->watch_seq, memory_order_seq_cst);
+        // checked after reading seq: destroy sets stop, then moves seq
+        if (atomic_load_explicit(&w->stop, memory_order_seq_cst)) break;
+        pthread_mutex_lock(&w->lock);
+        int pending = watch_pending(w);
+        pthread_mutex_unlock(&w->lock);
+        if (pending) {
+            uint64_t one = 1;
+            if (write(w->efd, &one, sizeof(one)) < 0 && errno != EAGAIN) break;
         }
-        nanosleep(&sleep_ts, NULL);
+        watch_sleep(H, seq, NULL);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Returns a file descriptor that becomes readable when the watch set
+ * has changes to collect, for use with poll() / epoll alongside other fds.
+ *
+ * The first call starts a notifier thread that waits on the store for the
+ * set; it's stopped by splinter_watch_destroy(), which also closes the fd.
+ * Once readable, read() the 8-byte counter to reset it and collect with
+ * splinter_watch_wait(w, 0, ...).
+ *
+ * @return The fd (an eventfd), or -1 on failure (errno is set).
+ */
+int splinter_watch_fd(splinter_watch_t *w) {
+    if (watch_ok(w) != 0) return -1;
+    if (w->efd >= 0) return w->efd;
+
+    int efd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (efd < 0) return -1;
+    w->efd = efd;
+    int err = pthread_create(&w->notifier, NULL, watch_notifier, w);
+    if (err != 0) {
+        close(efd);
+        w->efd = -1;
+        errno = err;
+        return -1;
+    }
+    return efd;
+}
+
+/**
+ * @brief Unregisters every key, stops the notifier thread (if any) and frees
+ * the watch set. NULL is a no-op.
+ */
+void splinter_watch_destroy(splinter_watch_t *w) {
+    if (!w) return;
+    splinter_store_t *st = w->st;
+
+    if (st) {
+        pthread_mutex_lock(&st->watch_lock);
+        watch_release(w);
+        pthread_mutex_unlock(&st->watch_lock);
     }
+    if (w->efd >= 0) close(w->efd);
+    pthread_mutex_destroy(&w->lock);
+    free(w->ent);
+    free(w);
 }
 
 /**
  * @brief Copy the current atomic Splinter header structure into a corresponding
  * non-atomic client version.
+ * @param st The store to operate on.
  * @param snapshot A splinter_header_snaphshot_t structure to receive the values.
- * @return void
+ * @return -1 on failure, 0 on success.
  */
-int splinter_get_header_snapshot(splinter_header_snapshot_t *snapshot) {
-    if (!H) return -1;
+int splinter_store_get_header_snapshot(splinter_store_t *st, splinter_header_snapshot_t *snapshot) {
+    if (!st || !st->H) return -1;
+    struct splinter_header *H = st->H;
+    const struct store_map *m = store_map(st);
+    if (!m) return -1;
     snapshot->magic = H->magic;
     snapshot->version = H->version;
-    snapshot->slots = H->slots;
+    snapshot->slots = m->cur.slots;
     snapshot->max_val_sz = H->max_val_sz;
     snapshot->epoch = atomic_load_explicit(&H->epoch, memory_order_acquire);
     snapshot->auto_vacuum = atomic_load_explicit(&H->auto_vacuum, memory_order_acquire);
     snapshot->parse_failures = atomic_load_explicit(&H->parse_failures, memory_order_relaxed);
     snapshot->last_failure_epoch = atomic_load_explicit(&H->last_failure_epoch, memory_order_relaxed);
+    snapshot->max_probe = atomic_load_explicit(m->cur.max_probe, memory_order_relaxed);
+    snapshot->hash_alg = H->hash_alg;
+    snapshot->hash_seed = H->hash_seed;
+    snapshot->arena_sz = H->arena_sz;
+    snapshot->arena_used = atomic_load_explicit(&H->arena_top, memory_order_relaxed);
+    snapshot->feed_len = H->feed_len;
+    snapshot->feed_head = atomic_load_explicit(&H->feed_head, memory_order_relaxed);
+    snapshot->map_flags = H->map_flags;
+    snapshot->used_slots = atomic_load_explicit(m->cur.used, memory_order_relaxed);
+    snapshot->keys = atomic_load_explicit(&H->keys, memory_order_relaxed);
+    snapshot->max_size = H->max_size;
+    snapshot->gen = (uint32_t)m->gen;
+    snapshot->checksums = m->cur.SUMS != NULL;
+    snapshot->expiry_log_len = H->exp_len;
+    snapshot->expired = atomic_load_explicit(&H->expired, memory_order_relaxed);
+    snapshot->evicted = atomic_load_explicit(&H->evicted, memory_order_relaxed);
+    snapshot->evict_policy = atomic_load_explicit(&H->evict_policy, memory_order_relaxed);
+    snapshot->key_index = m->cur.IDX != NULL;
+    snapshot->embed_dim = H->embed_dim;
+    snapshot->ann_m = H->ann_m;
+    snapshot->ann_ef_construction = H->ann_ef_construction;
+    snapshot->ann_ef_search = H->ann_ef_search;
+    snapshot->ann_metric = H->ann_metric;
     return 0;
 }
 
@@ -598,35 +6767,381 @@ int splinter_get_header_snapshot(splinter_header_snapshot_t *snapshot) {
 /**
  * @brief Copy the current atomic Splinter slot header to a corresponding client
  * structure.
+ * @param st The store to operate on.
  * @param snapshot A splinter_slot_snaphshot_t structure to receive the values.
  * @return -1 on failure, 0 on success.
  */
-int splinter_get_slot_snapshot(const char *key, splinter_slot_snapshot_t *snapshot) {
-    if (!H || !key) return -1;
-    uint64_t h = fnv1a(key);
-    size_t idx = slot_idx(h, H->slots);
-    struct splinter_slot *slot = NULL;
-    size_t i;
-
-    for (i = 0; i < H->slots; ++i) {
-        struct splinter_slot *s = &S[(idx + i) % H->slots];
-        if (atomic_load_explicit(&s->hash, memory_order_acquire) == h &&
-            strncmp(s->key, key, SPLINTER_KEY_MAX) == 0) {
-            slot = s;
-            break;
-        }
-    }
+int splinter_store_get_slot_snapshot(splinter_store_t *st, const char *key, splinter_slot_snapshot_t *snapshot) {
+    if (!st || !st->H || !key) return -1;
+    const struct store_map *m = store_map(st);
+    const struct table *t;
+    struct splinter_slot *slot = m ? lookup(st, m, key, key_hash(st, key), &t) : NULL;
 
     if (!slot) {
         errno = EINVAL;
         return -1;
     }
 
-    strncpy(snapshot->key, slot->key, SPLINTER_KEY_MAX);
-    snapshot->val_off = slot->val_off;
+    memcpy(snapshot->key, slot_key(t, slot), SPLINTER_KEY_MAX);
+    snapshot->val_off = (uint64_t)value_blk(t, slot, memory_order_relaxed) * ARENA_BLOCK;
     snapshot->hash = atomic_load_explicit(&slot->hash, memory_order_acquire);
     snapshot->epoch = atomic_load_explicit(&slot->epoch, memory_order_acquire);
     snapshot->val_len = atomic_load_explicit(&slot->val_len, memory_order_acquire);
 
     return 0;
 }
+
+/**
+ * @brief Returns the change feed's write cursor: where a reader that wants
+ * only changes from now on starts.
+ *
+ * @param st The store to operate on.
+ * @param cursor Receives the cursor.
+ * @return 0 on success, -1 on failure (errno = ENOTSUP if the store was
+ * created without a change feed).
+ */
+int splinter_store_feed_cursor(splinter_store_t *st, uint64_t *cursor) {
+    if (!st || !st->H || !cursor) return -1;
+    if (!st->FEED) {
+        errno = ENOTSUP;
+        return -1;
+    }
+    *cursor = atomic_load_explicit(&st->H->feed_head, memory_order_acquire);
+    return 0;
+}
+
+/**
+ * @brief Fills in a change's key from its slot, if the slot still holds what
+ * the change wrote (the same seqlock check splinter_store_get() makes). A
+ * slot in a table a resize has since retired is left keyless; the move that
+ * retired it has its own record further on.
+ */
+static void feed_key(splinter_store_t *st, splinter_change_t *ch, uint32_t tab) {
+    const struct store_map *m = store_map(st);
+    const struct table *t = NULL;
+
+    ch->key[0] = '\0';
+    if (!m || ch->op != SPLINTER_CHANGE_SET) return;
+    if (tab == m->cur.id) t = &m->cur;
+    else if (m->old.S && tab == m->old.id) t = &m->old;
+    if (!t || ch->slot >= t->slots) return;
+
+    struct splinter_slot *slot = &t->S[ch->slot];
+    if (atomic_load_explicit(&slot->epoch, memory_order_acquire) != ch->epoch) return;
+    memcpy(ch->key, slot_key(t, slot), SPLINTER_KEY_MAX);
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&slot->epoch, memory_order_relaxed) != ch->epoch)
+        ch->key[0] = '\0';
+    ch->key[SPLINTER_KEY_MAX - 1] = '\0';
+}
+
+/**
+ * @brief Reads changes from the change feed, starting at *cursor.
+ *
+ * Every set (of any kind) and unset appends a record naming the slot and its
+ * new epoch, so a consumer that keeps its own cursor does work in proportion
+ * to what changed rather than to the size of the store. Integer updates made
+ * in place (splinter_store_incr() and friends) don't move epochs and aren't
+ * recorded.
+ *
+ * Changes come back in the order they were made. A set's key is filled in if
+ * the slot hasn't changed since; if it has, key is empty and a later change
+ * in the feed covers the slot. An unset's key is gone from the store, so only
+ * its hash is given.
+ *
+ * The feed is a fixed-size ring: a reader that falls more than feed_len
+ * changes behind gets EOVERFLOW and must take a new cursor with
+ * splinter_store_feed_cursor() and rescan the store (take the cursor first,
+ * so nothing written during the scan is missed).
+ *
+ * @param st The store to operate on.
+ * @param cursor The reader's position; advanced past the changes returned.
+ * @param out Receives up to max changes.
+ * @param max Capacity of out.
+ * @return The number of changes read (0 if there's nothing new yet), or -1 on
+ * failure: errno = EOVERFLOW if changes since *cursor were overwritten,
+ * ENOTSUP if the store has no change feed, EINVAL if *cursor is past the end.
+ */
+int splinter_store_feed_read(splinter_store_t *st, uint64_t *cursor, splinter_change_t *out, size_t max) {
+    if (!st || !st->H || !cursor || (!out && max)) return -1;
+    if (!st->FEED) {
+        errno = ENOTSUP;
+        return -1;
+    }
+    struct splinter_header *H = st->H;
+    uint64_t start = *cursor, c = start;
+    uint64_t head = atomic_load_explicit(&H->feed_head, memory_order_acquire);
+    size_t n = 0;
+
+    if (max > INT_MAX) max = INT_MAX;
+    if (start > head) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (head - start > H->feed_len) {
+        errno = EOVERFLOW;
+        return -1;
+    }
+
+    for (; n < max && c < head; n++, c++) {
+        struct feed_rec *r = &st->FEED[c & st->feed_mask];
+        uint64_t seq = atomic_load_explicit(&r->seq, memory_order_acquire);
+        if (seq != c + 1) {
+            if (seq > c + 1) {
+                errno = EOVERFLOW; // already reused for a later change
+                return -1;
+            }
+            break; // reserved, not published yet; later changes wait behind it
+        }
+        splinter_change_t *ch = &out[n];
+        ch->epoch = atomic_load_explicit(&r->epoch, memory_order_relaxed);
+        ch->hash = atomic_load_explicit(&r->hash, memory_order_relaxed);
+        uint64_t slot_op = atomic_load_explicit(&r->slot_op, memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&r->seq, memory_order_relaxed) != seq) {
+            errno = EOVERFLOW; // overwritten while we copied it
+            return -1;
+        }
+        ch->seq = seq;
+        ch->slot = (uint32_t)slot_op;
+        ch->op = (uint32_t)(slot_op >> 32) & 0xff;
+        feed_key(st, ch, (uint32_t)(slot_op >> FEED_TABLE_SHIFT));
+    }
+
+    // Two writers a whole ring apart filling in the same record at once could
+    // have mixed their fields under a seq we accepted. That can only happen
+    // once the ring has wrapped past start, so be conservative.
+    if (atomic_load_explicit(&H->feed_head, memory_order_acquire) - start > H->feed_len) {
+        errno = EOVERFLOW;
+        return -1;
+    }
+    *cursor = c;
+    return (int)n;
+}
+
+/*
+ * Handle-less API: thin wrappers over the default store so existing callers
+ * (and the Rust / Deno bindings) keep working unchanged.
+ */
+
+int splinter_set_av(unsigned int mode) {
+    return splinter_store_set_av(&g_store, mode);
+}
+
+int splinter_set_evict_policy(uint32_t policy) {
+    return splinter_store_set_evict_policy(&g_store, policy);
+}
+
+int splinter_get_evict_policy(void) {
+    return splinter_store_get_evict_policy(&g_store);
+}
+
+int splinter_get_av(void) {
+    return splinter_store_get_av(&g_store);
+}
+
+int splinter_unset(const char *key) {
+    return splinter_store_unset(&g_store, key);
+}
+
+int splinter_set(const char *key, const void *val, size_t len) {
+    return splinter_store_set(&g_store, key, val, len);
+}
+
+int splinter_get(const char *key, void *buf, size_t buf_sz, size_t *out_sz) {
+    return splinter_store_get(&g_store, key, buf, buf_sz, out_sz);
+}
+
+int splinter_setv(const char *key, const struct iovec *iov, int iovcnt) {
+    return splinter_store_setv(&g_store, key, iov, iovcnt);
+}
+
+int splinter_set_if_epoch(const char *key, uint64_t expected_epoch, const void *val, size_t len) {
+    return splinter_store_set_if_epoch(&g_store, key, expected_epoch, val, len);
+}
+
+int splinter_getv(const char *key, const struct iovec *iov, int iovcnt, size_t *out_sz) {
+    return splinter_store_getv(&g_store, key, iov, iovcnt, out_sz);
+}
+
+int splinter_append(const char *key, const void *data, size_t len) {
+    return splinter_store_append(&g_store, key, data, len);
+}
+
+int splinter_set_range(const char *key, size_t off, const void *data, size_t len) {
+    return splinter_store_set_range(&g_store, key, off, data, len);
+}
+
+int splinter_get_from(const char *key, size_t off, void *buf, size_t buf_sz, size_t *out_sz) {
+    return splinter_store_get_from(&g_store, key, off, buf, buf_sz, out_sz);
+}
+
+int splinter_set_int(const char *key, int64_t value) {
+    return splinter_store_set_int(&g_store, key, value);
+}
+
+int splinter_get_int(const char *key, int64_t *value) {
+    return splinter_store_get_int(&g_store, key, value);
+}
+
+int splinter_set_if_eq(const char *key, int64_t expected, int64_t value) {
+    return splinter_store_set_if_eq(&g_store, key, expected, value);
+}
+
+int splinter_set_if_lt(const char *key, int64_t bound, int64_t value) {
+    return splinter_store_set_if_lt(&g_store, key, bound, value);
+}
+
+int splinter_set_if_gt(const char *key, int64_t bound, int64_t value) {
+    return splinter_store_set_if_gt(&g_store, key, bound, value);
+}
+
+int splinter_incr(const char *key, int64_t delta, int64_t *result) {
+    return splinter_store_incr(&g_store, key, delta, result);
+}
+
+int splinter_decr(const char *key, int64_t delta, int64_t *result) {
+    return splinter_store_decr(&g_store, key, delta, result);
+}
+
+int splinter_fetch_and(const char *key, uint64_t mask, int64_t *prev) {
+    return splinter_store_fetch_and(&g_store, key, mask, prev);
+}
+
+int splinter_fetch_or(const char *key, uint64_t mask, int64_t *prev) {
+    return splinter_store_fetch_or(&g_store, key, mask, prev);
+}
+
+int splinter_fetch_xor(const char *key, uint64_t mask, int64_t *prev) {
+    return splinter_store_fetch_xor(&g_store, key, mask, prev);
+}
+
+int splinter_get_view(const char *key, const void **ptr, size_t *len, uint64_t *epoch) {
+    return splinter_store_get_view(&g_store, key, ptr, len, epoch);
+}
+
+int splinter_view_valid(const char *key, uint64_t epoch) {
+    return splinter_store_view_valid(&g_store, key, epoch);
+}
+
+int splinter_mget(const char *const *keys, size_t n, void *const *bufs, const size_t *buf_szs,
+    size_t *out_szs, int *errs) {
+    return splinter_store_mget(&g_store, keys, n, bufs, buf_szs, out_szs, errs);
+}
+
+int splinter_mset(const char *const *keys, const void *const *vals, const size_t *lens, size_t n,
+    int *errs) {
+    return splinter_store_mset(&g_store, keys, vals, lens, n, errs);
+}
+
+int splinter_list(char **out_keys, size_t max_keys, size_t *out_count) {
+    return splinter_store_list(&g_store, out_keys, max_keys, out_count);
+}
+
+int splinter_scan_range(const char *lo, const char *hi, splinter_scan_cb cb, void *arg) {
+    return splinter_store_scan_range(&g_store, lo, hi, cb, arg);
+}
+
+int splinter_scan_prefix(const char *prefix, splinter_scan_cb cb, void *arg) {
+    return splinter_store_scan_prefix(&g_store, prefix, cb, arg);
+}
+
+int splinter_add_tags(const char *key, uint64_t mask) {
+    return splinter_store_add_tags(&g_store, key, mask);
+}
+
+int splinter_set_tags(const char *key, uint64_t mask) {
+    return splinter_store_set_tags(&g_store, key, mask);
+}
+
+int splinter_get_tags(const char *key, uint64_t *mask) {
+    return splinter_store_get_tags(&g_store, key, mask);
+}
+
+int splinter_find_tagged(uint64_t mask, uint64_t *bits, size_t words) {
+    return splinter_store_find_tagged(&g_store, mask, bits, words);
+}
+
+int splinter_list_slots(const uint64_t *bits, size_t words, char **out_keys, size_t max_keys, size_t *out_count) {
+    return splinter_store_list_slots(&g_store, bits, words, out_keys, max_keys, out_count);
+}
+
+int splinter_set_with_embeddings(const char *key, const void *val, size_t len, const float *vec) {
+    return splinter_store_set_with_embeddings(&g_store, key, val, len, vec);
+}
+
+int splinter_set_embeddings(const char *key, const float *vec) {
+    return splinter_store_set_embeddings(&g_store, key, vec);
+}
+
+int splinter_get_embeddings(const char *key, float *out) {
+    return splinter_store_get_embeddings(&g_store, key, out);
+}
+
+int splinter_get_with_embeddings(const char *key, void *buf, size_t buf_sz, size_t *out_sz, float *vec) {
+    return splinter_store_get_with_embeddings(&g_store, key, buf, buf_sz, out_sz, vec);
+}
+
+int splinter_knn(const float *query, size_t k, int metric, unsigned int threads, splinter_knn_hit_t *out) {
+    return splinter_store_knn(&g_store, query, k, metric, threads, out);
+}
+
+int splinter_ann(const float *query, size_t k, unsigned int ef, splinter_knn_hit_t *out) {
+    return splinter_store_ann(&g_store, query, k, ef, out);
+}
+
+int splinter_poll(const char *key, uint64_t timeout_ms) {
+    return splinter_store_poll(&g_store, key, timeout_ms);
+}
+
+int splinter_set_poll_spin(unsigned int spins) {
+    return splinter_store_set_poll_spin(&g_store, spins);
+}
+
+splinter_watch_t *splinter_watch_create(void) {
+    return splinter_store_watch_create(&g_store);
+}
+
+int splinter_feed_cursor(uint64_t *cursor) {
+    return splinter_store_feed_cursor(&g_store, cursor);
+}
+
+int splinter_feed_read(uint64_t *cursor, splinter_change_t *out, size_t max) {
+    return splinter_store_feed_read(&g_store, cursor, out, max);
+}
+
+int splinter_get_header_snapshot(splinter_header_snapshot_t *snapshot) {
+    return splinter_store_get_header_snapshot(&g_store, snapshot);
+}
+
+int splinter_get_slot_snapshot(const char *key, splinter_slot_snapshot_t *snapshot) {
+    return splinter_store_get_slot_snapshot(&g_store, key, snapshot);
+}
+
+int splinter_resize(size_t slots) {
+    return splinter_store_resize(&g_store, slots);
+}
+
+int splinter_get_checked(const char *key, void *buf, size_t buf_sz, size_t *out_sz) {
+    return splinter_store_get_checked(&g_store, key, buf, buf_sz, out_sz);
+}
+
+int splinter_verify(unsigned int threads, char **out_keys, size_t max_keys, size_t *out_count) {
+    return splinter_store_verify(&g_store, threads, out_keys, max_keys, out_count);
+}
+
+int splinter_set_with_ttl(const char *key, const void *val, size_t len, uint64_t ttl_ms) {
+    return splinter_store_set_with_ttl(&g_store, key, val, len, ttl_ms);
+}
+
+int splinter_set_ttl(const char *key, uint64_t ttl_ms) {
+    return splinter_store_set_ttl(&g_store, key, ttl_ms);
+}
+
+int splinter_get_ttl(const char *key, uint64_t *ttl_ms) {
+    return splinter_store_get_ttl(&g_store, key, ttl_ms);
+}
+
+int splinter_reap(void) {
+    return splinter_store_reap(&g_store);
+}
@@ -12,6 +12,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <sys/uio.h>
 
 
 #ifdef __cplusplus
@@ -25,12 +26,62 @@ extern "C" {
 #define SPLINTER_MAGIC 0x534C4E54
 
 /** @brief Version of the splinter data format (not the library version). */
-#define SPLINTER_VER   2
+#define SPLINTER_VER   21
 /** @brief Maximum length of a key string, including null terminator. */
 #define SPLINTER_KEY_MAX        64
 /** @brief Nanoseconds per millisecond for time calculations. */
 #define NS_PER_MS      1000000ULL
 
+/** @brief Key hash selection at creation time: use the library default (SPLINTER_HASH_WY). */
+#define SPLINTER_HASH_DEFAULT   0
+/** @brief Byte-at-a-time FNV-1a (unseeded). */
+#define SPLINTER_HASH_FNV1A     1
+/** @brief Seeded word-at-a-time hash (wyhash family). */
+#define SPLINTER_HASH_WY        2
+
+/** @brief Largest change feed (in records) splinter_create_ex() accepts. */
+#define SPLINTER_FEED_MAX       (1ULL << 30)
+/** @brief Change feed record kinds: a key was set (by any write function). */
+#define SPLINTER_CHANGE_SET     1
+/** @brief Change feed record kinds: a key was deleted. */
+#define SPLINTER_CHANGE_UNSET   2
+
+/** @brief Mapping flags: ask for transparent huge pages (size rounded to 2 MB). */
+#define SPLINTER_MAP_HUGEPAGES  0x1
+/** @brief Mapping flags: fault the whole store in when it's mapped. */
+#define SPLINTER_MAP_PREFAULT   0x2
+/** @brief Mapping flags: mlock the header, slot table, control bytes and keys. */
+#define SPLINTER_MAP_LOCK       0x4
+
+/** @brief Eviction policies: a write to a full store fails with ENOSPC (the default). */
+#define SPLINTER_EVICT_NONE     0
+/** @brief Eviction policies: CLOCK (second chance), an approximation of LRU. */
+#define SPLINTER_EVICT_CLOCK    1
+/** @brief Eviction policies: the key closest to expiring goes first; CLOCK if none have a TTL. */
+#define SPLINTER_EVICT_TTL      2
+/** @brief Eviction policies: the key written longest ago goes first. */
+#define SPLINTER_EVICT_OLDEST   3
+
+/** @brief Largest embedding dimension splinter_create_ex() accepts. */
+#define SPLINTER_EMBED_MAX      8192
+/** @brief k-NN metrics: dot product (higher is nearer). */
+#define SPLINTER_METRIC_DOT     0
+/** @brief k-NN metrics: cosine similarity (higher is nearer). */
+#define SPLINTER_METRIC_COSINE  1
+/** @brief k-NN metrics: squared Euclidean distance (lower is nearer). */
+#define SPLINTER_METRIC_L2      2
+/** @brief Most graph neighbours per node splinter_create_ex() accepts (see ann_m). */
+#define SPLINTER_ANN_M_MAX      64
+
+/**
+ * @brief Opaque handle to a mapped splinter store.
+ *
+ * Every operation has a `splinter_store_*` form taking a handle, so a single
+ * process can keep any number of stores mapped at once. The handle-less
+ * functions operate on a default store (see splinter_default_store()).
+ */
+typedef struct splinter_store splinter_store_t;
+
 /**
  * @brief structure to hold splinter bus snapshots
  */
@@ -51,6 +102,53 @@ typedef struct splinter_header_snapshot {
     /* Diagnostics: counts of parse failures reported by clients / harnesses */
     uint64_t parse_failures;
     uint64_t last_failure_epoch;
+
+    /** @brief Longest probe distance of any key; a miss reads at most max_probe + 1 slots. */
+    uint32_t max_probe;
+    /** @brief Key hash function (SPLINTER_HASH_*). */
+    uint32_t hash_alg;
+    /** @brief Hash seed (0 for unseeded hash functions). */
+    uint64_t hash_seed;
+    /** @brief Size of the shared value arena (0 = fixed per-slot values). */
+    uint64_t arena_sz;
+    /** @brief Arena bytes carved into blocks so far (freed blocks are recycled, not returned). */
+    uint64_t arena_used;
+    /** @brief Records in the change feed ring (0 = no feed). */
+    uint64_t feed_len;
+    /** @brief Changes appended to the feed so far (its write cursor). */
+    uint64_t feed_head;
+    /** @brief Mapping flags the store was created with (SPLINTER_MAP_*). */
+    uint32_t map_flags;
+    /** @brief Slots in use, counting deleted-key tombstones (see splinter_resize()). */
+    uint32_t used_slots;
+    /** @brief Keys stored. */
+    uint64_t keys;
+    /** @brief Size the store's backing object may grow to by resizing. */
+    uint64_t max_size;
+    /** @brief Resize generation; odd while keys are being moved to a new table. */
+    uint32_t gen;
+    /** @brief Non-zero if values carry CRC32C checksums (see splinter_verify()). */
+    uint32_t checksums;
+    /** @brief Records in the expiry log (0 = none; see splinter_reap()). */
+    uint64_t expiry_log_len;
+    /** @brief Expired keys deleted so far. */
+    uint64_t expired;
+    /** @brief Keys evicted to make room so far (see splinter_set_evict_policy()). */
+    uint64_t evicted;
+    /** @brief Eviction policy (SPLINTER_EVICT_*). */
+    uint32_t evict_policy;
+    /** @brief Non-zero if the store keeps an ordered key index (see splinter_scan_range()). */
+    uint32_t key_index;
+    /** @brief Floats per key embedding (0 = no embeddings; see splinter_knn()). */
+    uint32_t embed_dim;
+    /** @brief HNSW neighbours per node (0 = no graph; see splinter_ann()). */
+    uint32_t ann_m;
+    /** @brief Candidates each graph insert searches. */
+    uint32_t ann_ef_construction;
+    /** @brief Candidates splinter_ann() searches when not told. */
+    uint32_t ann_ef_search;
+    /** @brief The metric the graph is built for (SPLINTER_METRIC_*). */
+    uint32_t ann_metric;
 } splinter_header_snapshot_t;
 
 /**
@@ -62,12 +160,12 @@ typedef struct splinter_header_snapshot {
 int splinter_get_header_snapshot(splinter_header_snapshot_t *snapshot);
 
 typedef struct splinter_slot_snapshot {
-    /** @brief The FNV-1a hash of the key. 0 indicates an empty slot. */
+    /** @brief The hash of the key. 0 = never used, 1 = deleted (tombstone). */
     uint64_t hash;
     /** @brief Per-slot epoch, incremented on write to this slot. Used for polling. */
     uint64_t epoch;
     /** @brief Offset into the VALUES region where the value data is stored. */
-    uint32_t val_off;
+    uint64_t val_off;
     /** @brief The actual length of the stored value data (atomic). */
     uint32_t val_len;
     /** @brief The null-terminated key string. */
@@ -82,6 +180,50 @@ typedef struct splinter_slot_snapshot {
  */
 int splinter_get_slot_snapshot(const char *key, splinter_slot_snapshot_t *snapshot);
 
+/**
+ * @brief One entry read from the change feed.
+ */
+typedef struct splinter_change {
+    /** @brief Position in the feed, counting from 1. */
+    uint64_t seq;
+    /** @brief The slot's epoch right after the change. */
+    uint64_t epoch;
+    /** @brief Hash of the key that changed. */
+    uint64_t hash;
+    /** @brief Index of the slot that changed. */
+    uint32_t slot;
+    /** @brief SPLINTER_CHANGE_SET or SPLINTER_CHANGE_UNSET. */
+    uint32_t op;
+    /** @brief The key, for a set the slot still holds; empty otherwise. */
+    char key[SPLINTER_KEY_MAX];
+} splinter_change_t;
+
+/**
+ * @brief Gets the change feed's current write cursor. Take it before a full
+ * scan of the store, then follow the feed from it with splinter_feed_read().
+ * @param cursor Receives the cursor.
+ * @return 0 on success, -1 on failure (errno = ENOTSUP if the store has no
+ * change feed; see feed_len in splinter_create_opts_t).
+ */
+int splinter_feed_cursor(uint64_t *cursor);
+
+/**
+ * @brief Reads up to max changes made since *cursor and advances it.
+ *
+ * Every set and unset is recorded, in order, so following the feed costs
+ * O(changes) instead of a scan of every slot. A set's key is filled in if
+ * the slot still holds it (otherwise a later change covers the slot);
+ * in-place integer updates (splinter_incr() etc.) are not recorded.
+ *
+ * @param cursor The reader's position in the feed.
+ * @param out Receives the changes.
+ * @param max Capacity of out.
+ * @return Number of changes read (0 if there are none yet), or -1 on failure:
+ * errno = EOVERFLOW if the reader fell more than a ring behind (take a new
+ * cursor and rescan), ENOTSUP if the store has no change feed.
+ */
+int splinter_feed_read(uint64_t *cursor, splinter_change_t *out, size_t max);
+
 /**
  * @brief Creates and initializes a new splinter store.
  * @param name_or_path The name of the shared memory object or path to the file.
@@ -91,6 +233,104 @@ int splinter_get_slot_snapshot(const char *key, splinter_slot_snapshot_t *snapsh
  */
 int splinter_create(const char *name_or_path, size_t slots, size_t max_value_sz);
 
+/**
+ * @brief Options for splinter_create_ex(). Zero any field you don't care
+ * about to get the default.
+ */
+typedef struct splinter_create_opts {
+    /** @brief The total number of key-value slots to allocate. */
+    size_t slots;
+    /** @brief The maximum size in bytes for any single value. */
+    size_t max_value_sz;
+    /** @brief Key hash function (SPLINTER_HASH_*). */
+    uint32_t hash_alg;
+    /** @brief Seed for SPLINTER_HASH_WY; 0 picks a random one. */
+    uint64_t hash_seed;
+    /**
+     * @brief Bytes of shared value storage. 0 reserves max_value_sz for every
+     * slot up front; anything else is a pool that values are allocated from
+     * as they're written (64 bytes to max_value_sz, in power-of-two classes),
+     * so memory tracks the data actually stored.
+     */
+    size_t arena_sz;
+    /**
+     * @brief Records in the change feed (rounded up to a power of two, at
+     * most SPLINTER_FEED_MAX); 0 for no feed. See splinter_feed_read().
+     */
+    size_t feed_len;
+    /**
+     * @brief SPLINTER_MAP_* flags. They're kept in the header, so every
+     * process that opens the store maps it the same way. Huge pages and
+     * locking are best-effort: a store still opens if the kernel or
+     * RLIMIT_MEMLOCK won't allow them.
+     */
+    uint32_t map_flags;
+    /**
+     * @brief Largest size in bytes the store may grow to with
+     * splinter_resize(); this much address space is reserved by every
+     * process that maps it. 0 allows 16 times the initial size.
+     */
+    uint64_t max_size;
+    /**
+     * @brief Non-zero to keep a CRC32C of every value, computed as it's
+     * written and checked by splinter_get_checked() and splinter_verify().
+     * Costs 4 bytes per slot and roughly one extra pass over each value
+     * written (with SSE4.2, a fraction of the copy).
+     */
+    uint32_t checksums;
+    /**
+     * @brief Records in the expiry log (rounded up to a power of two, at most
+     * SPLINTER_FEED_MAX); 0 for none. With a log, writers giving keys a TTL
+     * tell the reaper about them and splinter_reap() keeps a timing wheel, so
+     * a pass costs what's expiring rather than a scan of every slot. Size it
+     * for the expiries set between two passes; if it wraps, the next pass
+     * rescans once.
+     */
+    size_t expiry_log_len;
+    /** @brief Eviction policy to start with (SPLINTER_EVICT_*); see splinter_set_evict_policy(). */
+    uint32_t evict_policy;
+    /**
+     * @brief Non-zero to keep an ordered index of the keys, so
+     * splinter_scan_range() and splinter_scan_prefix() cost O(log n + k)
+     * rather than a pass over every slot. Costs 48 bytes per slot, and
+     * creating or deleting a key (not updating one) takes a store-wide lock
+     * for the O(log n) it takes to link or unlink it.
+     */
+    uint32_t key_index;
+    /**
+     * @brief Floats in each key's embedding vector (at most
+     * SPLINTER_EMBED_MAX); 0 for no embeddings. Every slot reserves a row of
+     * this many floats, rounded up to a cache line, for
+     * splinter_set_with_embeddings() and splinter_knn().
+     */
+    uint32_t embed_dim;
+    /**
+     * @brief Non-zero to keep an HNSW graph over the embeddings for
+     * splinter_ann(), with this many neighbours per node (2 to
+     * SPLINTER_ANN_M_MAX; 16 is a good start). Needs embed_dim. Costs about
+     * 8 * ann_m + 24 bytes per slot, and every write that brings an
+     * embedding links it into the graph under a store-wide lock.
+     */
+    uint32_t ann_m;
+    /** @brief Candidates each graph insert searches; 0 for 100. Higher builds a better graph, slower. */
+    uint32_t ann_ef_construction;
+    /** @brief Candidates splinter_ann() searches by default; 0 for 64. */
+    uint32_t ann_ef_search;
+    /**
+     * @brief The metric the graph is built for (SPLINTER_METRIC_*). Dot
+     * product only makes a good graph for normalized vectors.
+     */
+    uint32_t ann_metric;
+} splinter_create_opts_t;
+
+/**
+ * @brief Creates and initializes a new splinter store with extended options.
+ * @param name_or_path The name of the shared memory object or path to the file.
+ * @param opts Geometry and layout options.
+ * @return 0 on success, -1 on failure, -2 on invalid options.
+ */
+int splinter_create_ex(const char *name_or_path, const splinter_create_opts_t *opts);
+
 /**
  * @brief Opens an existing splinter store.
  * @param name_or_path The name of the shared memory object or path to the file.
@@ -118,6 +358,7 @@ int splinter_create_or_open(const char *name_or_path, size_t slots, size_t max_v
 
 /**
  * @brief Closes the splinter store and unmaps the shared memory region.
+ * Watch sets still open on it stop watching (see splinter_watch_create()).
  */
 void splinter_close(void);
 
@@ -131,20 +372,41 @@ void splinter_close(void);
   */
 int splinter_get_av(void);
 
+/**
+ * @brief Sets what a write does when the store is full.
+ *
+ * With SPLINTER_EVICT_NONE it fails with ENOSPC. Otherwise it deletes a key
+ * on its own probe chain (within a bounded window of its home slot), picked
+ * by the policy, and takes its slot; the evicted key is an unset to pollers,
+ * watch sets and the change feed. Expired keys are always reclaimed first.
+ * Every lookup marks the key's slot as recently used for SPLINTER_EVICT_CLOCK.
+ * The policy is kept in the store and applies to every process.
+ *
+ * @param policy SPLINTER_EVICT_*.
+ * @return 0 on success, -2 if the store isn't open or the policy is unknown.
+ */
+int splinter_set_evict_policy(uint32_t policy);
+
+/**
+ * @brief Gets the store's eviction policy (SPLINTER_EVICT_*), or -2 if no store is open.
+ */
+int splinter_get_evict_policy(void);
+
 /**
  * @brief Sets or updates a key-value pair in the store.
  * @param key The null-terminated key string.
  * @param val Pointer to the value data.
  * @param len The length of the value data. Must not exceed `max_val_sz`.
- * @return 0 on success, -1 on failure (e.g., store is full).
+ * @return 0 on success, -1 on failure (e.g., store is full; EAGAIN if an
+ * integer update pinned the key's slot and never finished).
  */
 int splinter_set(const char *key, const void *val, size_t len);
 
 /**
  * @brief "unsets" a key. 
- * This function does one atomic operation to zero the slot hash, which marks the
- * slot available for write. It then zeroes out the used key and value regions,
- * and resets the slot.
+ * This function replaces the slot hash with a tombstone, which marks the slot
+ * available for write without breaking the probe chains of other keys. It then
+ * zeroes out the used key and value regions, and resets the slot.
  *
  * @param key The null-terminated key string.
  * @return length of value deleted, -1 if key not found, - 2 if null key/store
@@ -157,10 +419,235 @@ int splinter_unset(const char *key);
  * @param buf The buffer to copy the value data into. Can be NULL to query size.
  * @param buf_sz The size of the provided buffer.
  * @param out_sz Pointer to a size_t to store the value's actual length. Can be NULL.
- * @return 0 on success, -1 on failure. If buf_sz is too small, sets errno to EMSGSIZE.
+ * @return 0 on success, -1 on failure. If buf_sz is too small, sets errno to EMSGSIZE;
+ * if the key does not exist, sets errno to ENOENT.
  */
 int splinter_get(const char *key, void *buf, size_t buf_sz, size_t *out_sz);
 
+/**
+ * @brief Sets a key to the concatenation of several buffers, without joining
+ * them first. Otherwise identical to splinter_set().
+ * @param key The null-terminated key string.
+ * @param iov The pieces of the value, in order.
+ * @param iovcnt Number of entries in iov.
+ * @return 0 on success, -1 on failure (e.g., store is full).
+ */
+int splinter_setv(const char *key, const struct iovec *iov, int iovcnt);
+
+/**
+ * @brief Retrieves a value, scattering it across several buffers in order.
+ * Otherwise identical to splinter_get().
+ * @param key The null-terminated key string.
+ * @param iov The buffers to fill.
+ * @param iovcnt Number of entries in iov.
+ * @param out_sz Pointer to a size_t to store the value's actual length. Can be NULL.
+ * @return 0 on success, -1 on failure. If the buffers are too small in total,
+ * sets errno to EMSGSIZE; if the key does not exist, sets errno to ENOENT.
+ */
+int splinter_getv(const char *key, const struct iovec *iov, int iovcnt, size_t *out_sz);
+
+/**
+ * @brief Sets a key only if its slot epoch is still expected_epoch, i.e.
+ * nobody wrote it since it was read (optimistic read-modify-write).
+ *
+ * Take the epoch from splinter_get_view() or a slot snapshot. The check is
+ * made under the slot's write lock, so of several racing writers with the
+ * same expected epoch at most one wins.
+ *
+ * @param key The null-terminated key string.
+ * @param expected_epoch The epoch the value was read at, or 0 to only create
+ * the key if it doesn't exist.
+ * @param val Pointer to the value data.
+ * @param len The length of the value data.
+ * @return 0 on success, -1 on failure (errno = ESTALE if the key changed,
+ * EAGAIN if it's being written right now).
+ */
+int splinter_set_if_epoch(const char *key, uint64_t expected_epoch, const void *val, size_t len);
+
+/**
+ * @brief Appends bytes to a key's value, creating the key if needed.
+ *
+ * Only the new bytes are written, so streaming a value in N pieces costs
+ * O(N) rather than rewriting it every time.
+ *
+ * @param key The null-terminated key string.
+ * @param data The bytes to append.
+ * @param len Number of bytes.
+ * @return 0 on success, -1 on failure (errno = EMSGSIZE if the value would
+ * grow past `max_val_sz`).
+ */
+int splinter_append(const char *key, const void *data, size_t len);
+
+/**
+ * @brief Overwrites part of a key's value, creating the key if needed.
+ *
+ * The value grows if the range runs past its end (any gap reads as zeros).
+ *
+ * @param key The null-terminated key string.
+ * @param off Offset into the value to write at.
+ * @param data The bytes to write.
+ * @param len Number of bytes.
+ * @return 0 on success, -1 on failure (errno = EMSGSIZE if the value would
+ * grow past `max_val_sz`).
+ */
+int splinter_set_range(const char *key, size_t off, const void *data, size_t len);
+
+/**
+ * @brief Retrieves only the part of a value past off (for tail-following a
+ * value that's being appended to).
+ * @param key The null-terminated key string.
+ * @param off Offset into the value to start from.
+ * @param buf The buffer to copy the data into. Can be NULL to query size.
+ * @param buf_sz The size of the provided buffer.
+ * @param out_sz Receives the number of bytes past off. Can be NULL.
+ * @return 0 on success, -1 on failure, with errno as splinter_get(), or
+ * ERANGE if the value is now shorter than off (it was replaced).
+ */
+int splinter_get_from(const char *key, size_t off, void *buf, size_t buf_sz, size_t *out_sz);
+
+/**
+ * @brief Stores a 64-bit integer under a key, making it an integer key.
+ *
+ * Integer keys can be updated in place with splinter_incr() and friends.
+ * splinter_get() still reads them (8 bytes, host byte order); splinter_set()
+ * turns them back into ordinary values.
+ *
+ * @param key The null-terminated key string.
+ * @param value The value.
+ * @return 0 on success, -1 on failure (e.g., store is full).
+ */
+int splinter_set_int(const char *key, int64_t value);
+
+/**
+ * @brief Reads an integer key.
+ * @param key The null-terminated key string.
+ * @param value Receives the value.
+ * @return 0 on success, -1 on failure (errno = ENOENT if the key does not
+ * exist, EINVAL if it isn't an integer key, EAGAIN if a write is in progress).
+ */
+int splinter_get_int(const char *key, int64_t *value);
+
+/**
+ * @brief Sets an integer key to value if it currently holds expected.
+ * @param key The null-terminated key string.
+ * @param expected The value the key must hold.
+ * @param value The new value.
+ * @return 0 if the key was set, -1 on failure (errno = ECANCELED if the
+ * comparison failed, ENOENT if the key does not exist, EINVAL if it isn't an
+ * integer key, EAGAIN if a write is in progress).
+ */
+int splinter_set_if_eq(const char *key, int64_t expected, int64_t value);
+
+/**
+ * @brief Sets an integer key to value if it is currently less than bound
+ * (errors as splinter_set_if_eq()).
+ */
+int splinter_set_if_lt(const char *key, int64_t bound, int64_t value);
+
+/**
+ * @brief Sets an integer key to value if it is currently greater than bound
+ * (errors as splinter_set_if_eq()).
+ */
+int splinter_set_if_gt(const char *key, int64_t bound, int64_t value);
+
+/**
+ * @brief Atomically adds to an integer key, creating it as 0 if it doesn't exist.
+ *
+ * Integer operations are single atomic instructions on the value in shared
+ * memory: concurrent updates from any number of processes never lose counts
+ * or wait on each other. They don't advance the slot epoch, so
+ * splinter_poll() does not wake for them. A process that dies partway
+ * through one leaves the key's slot pinned: writes to that key then fail
+ * with EAGAIN rather than wait forever.
+ *
+ * @param key The null-terminated key string.
+ * @param delta Amount to add (wraps around on overflow).
+ * @param result Receives the new value. Can be NULL.
+ * @return 0 on success, -1 on failure (errno = EINVAL if the key holds a
+ * non-integer value, EAGAIN if it's being replaced at that moment).
+ */
+int splinter_incr(const char *key, int64_t delta, int64_t *result);
+
+/** @brief Atomically subtracts from an integer key (see splinter_incr()). */
+int splinter_decr(const char *key, int64_t delta, int64_t *result);
+
+/**
+ * @brief Atomically ANDs mask into an integer key (see splinter_incr()).
+ * @param prev Receives the value before the operation. Can be NULL.
+ */
+int splinter_fetch_and(const char *key, uint64_t mask, int64_t *prev);
+
+/**
+ * @brief Atomically ORs mask into an integer key (see splinter_incr()).
+ * @param prev Receives the value before the operation. Can be NULL.
+ */
+int splinter_fetch_or(const char *key, uint64_t mask, int64_t *prev);
+
+/**
+ * @brief Atomically XORs mask into an integer key (see splinter_incr()).
+ * XOR with ~0 gives bitwise NOT.
+ * @param prev Receives the value before the operation. Can be NULL.
+ */
+int splinter_fetch_xor(const char *key, uint64_t mask, int64_t *prev);
+
+/**
+ * @brief Gets a pointer straight to a key's value in shared memory (no copy).
+ *
+ * Read the value in place, then confirm with splinter_view_valid() that no
+ * writer touched it meanwhile; if that fails, discard what you read and
+ * retry. The bytes are untrusted until validated.
+ *
+ * @param key The null-terminated key string.
+ * @param ptr Receives a pointer to the value bytes.
+ * @param len Receives the value length.
+ * @param epoch Receives the epoch to pass to splinter_view_valid().
+ * @return 0 on success, -1 on failure (errno = ENOENT if the key does not
+ * exist, EAGAIN if a write is in progress).
+ */
+int splinter_get_view(const char *key, const void **ptr, size_t *len, uint64_t *epoch);
+
+/**
+ * @brief Checks whether a view from splinter_get_view() is still consistent.
+ * @param key The key the view was taken of.
+ * @param epoch The epoch returned by splinter_get_view().
+ * @return 1 if everything read through the view is good, 0 if it must be discarded.
+ */
+int splinter_view_valid(const char *key, uint64_t epoch);
+
+/**
+ * @brief Retrieves several keys in one call.
+ *
+ * Hashes every key and prefetches their slots before resolving any of them,
+ * so a batch costs roughly one round of cache misses instead of one per key.
+ *
+ * @param keys The null-terminated key strings.
+ * @param n Number of keys.
+ * @param bufs Per-key destination buffers. NULL (or a NULL entry) queries sizes only.
+ * @param buf_szs Per-key buffer sizes (ignored when bufs is NULL).
+ * @param out_szs Receives each value's length. Can be NULL.
+ * @param errs Receives 0 for each key read, or what splinter_get() would have
+ * set errno to (ENOENT, EMSGSIZE, EAGAIN).
+ * @return The number of keys read successfully, -1 on invalid arguments.
+ */
+int splinter_mget(const char *const *keys, size_t n, void *const *bufs, const size_t *buf_szs,
+    size_t *out_szs, int *errs);
+
+/**
+ * @brief Sets several keys in one call.
+ *
+ * Each key is written as by splinter_set() (the batch is not atomic as a
+ * whole); the header's global epoch is updated once for the batch.
+ *
+ * @param keys The null-terminated key strings.
+ * @param vals Per-key value data.
+ * @param lens Per-key value lengths.
+ * @param n Number of keys.
+ * @param errs Receives 0 for each key written, or its errno (ENOSPC, EAGAIN, EINVAL).
+ * @return The number of keys written, -1 on invalid arguments.
+ */
+int splinter_mset(const char *const *keys, const void *const *vals, const size_t *lens, size_t n,
+    int *errs);
+
 /**
  * @brief Lists all keys currently in the store.
  * @param out_keys An array of `char*` to be filled with pointers to the keys.
@@ -170,14 +657,571 @@ int splinter_get(const char *key, void *buf, size_t buf_sz, size_t *out_sz);
  */
 int splinter_list(char **out_keys, size_t max_keys, size_t *out_count);
 
+/**
+ * @brief Called by splinter_scan_range() and splinter_scan_prefix() with
+ * each key, in order.
+ * @param key The key (a copy, valid until the callback returns).
+ * @param arg The caller's argument.
+ * @return 0 to carry on, anything else to stop the scan.
+ */
+typedef int (*splinter_scan_cb)(const char *key, void *arg);
+
+/**
+ * @brief Visits the keys in [lo, hi) in strcmp() order.
+ *
+ * With an ordered key index (splinter_create_opts_t.key_index) this costs
+ * O(log n + k) for k keys visited. Scans read the index optimistically and
+ * never block writers: if it changes under them they pick up again after
+ * the last key visited, so every key present for the whole scan is visited
+ * exactly once, and keys created or deleted meanwhile may or may not be.
+ * Without an index, or while a resize is migrating keys, the keys in range
+ * are gathered from every slot and sorted first. Expired keys are skipped.
+ * The callback may use the store (keys it writes are subject to the same
+ * rule as other writers').
+ *
+ * @param lo First key to visit (inclusive); NULL starts at the first key.
+ * @param hi Where to stop (exclusive); NULL runs to the last key.
+ * @param cb Called with each key; returning non-zero ends the scan.
+ * @param arg Passed to cb.
+ * @return The number of keys passed to cb, -1 on failure (errno = ENOMEM),
+ * -2 if no store is open or cb is NULL.
+ */
+int splinter_scan_range(const char *lo, const char *hi, splinter_scan_cb cb, void *arg);
+
+/**
+ * @brief Visits the keys starting with prefix in order (see splinter_scan_range()),
+ * e.g. every key in a "namespace::" in O(log n + k).
+ * @return The number of keys passed to cb, -1 on failure, -2 on invalid arguments.
+ */
+int splinter_scan_prefix(const char *prefix, splinter_scan_cb cb, void *arg);
+
+/**
+ * @brief Computes the bloom bits for a tag, e.g. "session:42" (the same in
+ * every store). OR masks together to work with several tags at once.
+ *
+ * Every slot keeps a 64-bit bloom of its key's tags. Being a bloom filter,
+ * a key can seem to have a tag it was never given (roughly 1 in 200 for a
+ * key with four tags), never the other way round.
+ *
+ * @return The tag's bits, or 0 if tag is NULL.
+ */
+uint64_t splinter_tag_mask(const char *tag);
+
+/**
+ * @brief Adds tags to an existing key. Tags stay with the key through
+ * writes to its value and go when it's deleted; changing them doesn't count
+ * as a write (the slot epoch doesn't move).
+ * @param mask Tag bits to add (see splinter_tag_mask()).
+ * @return 0 on success, -1 on failure (errno = ENOENT if the key doesn't
+ * exist, EAGAIN if a writer holds its slot).
+ */
+int splinter_add_tags(const char *key, uint64_t mask);
+
+/**
+ * @brief Replaces an existing key's tags. Tags share bits, so a tag is taken
+ * away by setting the masks of the ones that are left.
+ * @return As splinter_add_tags().
+ */
+int splinter_set_tags(const char *key, uint64_t mask);
+
+/**
+ * @brief Reads a key's tag bloom.
+ * @return 0 on success, -1 if the key doesn't exist.
+ */
+int splinter_get_tags(const char *key, uint64_t *mask);
+
+/**
+ * @brief Finds every key whose tags include all of mask, as a bitmap of
+ * slots.
+ *
+ * Tag blooms are kept in a dense array of their own, so this is one pass
+ * over 8 bytes per slot, compared four words per instruction with AVX2
+ * (two with SSE4.1, one at a time elsewhere): bound by memory bandwidth,
+ * not by probing keys. A resize that is migrating keys is finished first.
+ * The bitmap feeds splinter_list_slots() and splinter_watch_add_slots().
+ *
+ * @param mask Tag bits to look for; not 0.
+ * @param bits Receives bit i % 64 of word i / 64 set for each matching slot i.
+ * @param words Capacity of bits: at least (slots + 63) / 64, slots being the
+ * header snapshot's.
+ * @return The number of keys found, -1 on failure (errno = ERANGE if bits
+ * is too small, as after a resize), -2 on invalid arguments.
+ */
+int splinter_find_tagged(uint64_t mask, uint64_t *bits, size_t words);
+
+/**
+ * @brief Lists the keys in a slot bitmap from splinter_find_tagged(), like
+ * splinter_list() (pointers into the store). Slots emptied since are skipped.
+ * @return 0 on success, -1 on failure.
+ */
+int splinter_list_slots(const uint64_t *bits, size_t words, char **out_keys, size_t max_keys,
+    size_t *out_count);
+
+/**
+ * @brief Sets a key like splinter_set(), along with its embedding vector.
+ * Readers see the value and the vector change together.
+ * @param vec embed_dim floats (see splinter_create_opts_t).
+ * @return 0 on success, -1 on failure (errno = ENOTSUP if the store keeps no
+ * embeddings), -2 on invalid arguments.
+ */
+int splinter_set_with_embeddings(const char *key, const void *val, size_t len, const float *vec);
+
+/**
+ * @brief Replaces an existing key's embedding, leaving its value alone. Counts
+ * as a write (the slot epoch moves). A plain splinter_set() keeps the
+ * embedding a key already has.
+ * @return 0 on success, -1 on failure (errno = ENOENT if the key doesn't
+ * exist, ENOTSUP if the store keeps no embeddings), -2 on invalid arguments.
+ */
+int splinter_set_embeddings(const char *key, const float *vec);
+
+/**
+ * @brief Reads a key's embedding.
+ * @param out Receives embed_dim floats.
+ * @return 0 on success, -1 on failure (errno = ENOENT if the key doesn't
+ * exist, ENODATA if it has no embedding, ENOTSUP if the store keeps none,
+ * EAGAIN if writers kept changing it).
+ */
+int splinter_get_embeddings(const char *key, float *out);
+
+/**
+ * @brief Reads a key's value like splinter_get(), and its embedding as it was
+ * alongside that value.
+ * @param vec Receives embed_dim floats.
+ * @return 0 on success, -1 on failure with errno as splinter_get(), or
+ * ENODATA if the key has no embedding (the value is still copied out),
+ * ENOTSUP if the store keeps none.
+ */
+int splinter_get_with_embeddings(const char *key, void *buf, size_t buf_sz, size_t *out_sz, float *vec);
+
+/**
+ * @brief One result of splinter_knn().
+ */
+typedef struct splinter_knn_hit {
+    /** @brief The key. */
+    char key[SPLINTER_KEY_MAX];
+    /** @brief Its score under the metric asked for (a distance for SPLINTER_METRIC_L2). */
+    float score;
+    /** @brief The slot epoch the embedding was read at. */
+    uint64_t epoch;
+} splinter_knn_hit_t;
+
+/**
+ * @brief Finds the k keys whose embeddings are nearest to query, by brute force.
+ *
+ * Embeddings live in a dense, cache-line aligned array of their own, so this
+ * is one pass over embed_dim floats per slot, 16 floats per fused
+ * multiply-add with AVX-512 (8 with AVX2 + FMA, scalar elsewhere), split
+ * across threads like splinter_verify(). Keys being written while they're
+ * scored are skipped. A resize that is migrating keys is finished first.
+ *
+ * @param query embed_dim floats.
+ * @param k Most hits wanted.
+ * @param metric SPLINTER_METRIC_*.
+ * @param threads Threads to use; 0 for one per online CPU.
+ * @param out Receives up to k hits, nearest first.
+ * @return Number of hits, -1 on failure (errno = ENOTSUP if the store keeps
+ * no embeddings), -2 on invalid arguments.
+ */
+int splinter_knn(const float *query, size_t k, int metric, unsigned int threads, splinter_knn_hit_t *out);
+
+/**
+ * @brief Finds about the k keys whose embeddings are nearest to query, from
+ * the store's HNSW graph (see ann_m in splinter_create_opts_t).
+ *
+ * The graph lives in the mapped store, so every process searches the same
+ * one, without locks: what a search finds is scored again as of one write
+ * to each key, and keys being written or deleted meanwhile are skipped.
+ * Scores are under the metric the graph was built for. A resize that is
+ * migrating keys is finished first.
+ *
+ * @param query embed_dim floats.
+ * @param k Most hits wanted.
+ * @param ef Candidates to search, at least k; 0 for the store's
+ * ann_ef_search. Higher finds more of the true nearest, slower.
+ * @param out Receives up to k hits, nearest first.
+ * @return Number of hits, -1 on failure (errno = ENOTSUP if the store keeps
+ * no graph, ENOMEM), -2 on invalid arguments.
+ */
+int splinter_ann(const float *query, size_t k, unsigned int ef, splinter_knn_hit_t *out);
+
 /**
  * @brief Waits for a key's value to be changed.
+ *
+ * Sleeps in the kernel (futex) rather than polling, so subscribers wake as
+ * soon as the writer finishes and cost nothing while idle.
+ *
  * @param key The key to monitor for changes.
  * @param timeout_ms The maximum time to wait in milliseconds.
- * @return 0 if the value changed, -1 on timeout or if the key doesn't exist.
+ * @return 0 if the value changed, -1 if the key doesn't exist, -2 on timeout
+ * (errno = ETIMEDOUT) or if a write was in progress (errno = EAGAIN).
  */
 int splinter_poll(const char *key, uint64_t timeout_ms);
 
+/**
+ * @brief Sets how many times splinter_poll re-checks the epoch in a busy loop
+ * before sleeping. Useful for ultra-low-latency consumers that can afford to
+ * burn a core; 0 (the default) sleeps immediately. Process-local.
+ * @param spins Number of spin iterations.
+ * @return 0 on success, -2 if the store handle is invalid.
+ */
+int splinter_set_poll_spin(unsigned int spins);
+
+/**
+ * @brief Grows the store to the given number of slots without taking it
+ * offline.
+ *
+ * A new slot table is added to the store and keys are moved into it a few
+ * at a time; readers and writers in every process keep going, and writers
+ * help move keys along. Returns once every key has moved and the old table's
+ * memory has been released. Only the slot count grows; max_value_sz stays.
+ * Each moved key counts as one change to pollers, watch sets and the change
+ * feed.
+ *
+ * @param slots The new slot count; must be more than the store has now.
+ * @return 0 on success, -1 on failure (errno = EBUSY if another process is
+ * resizing, EFBIG if the store would outgrow max_size, ENOSPC if the new
+ * table filled up before every key moved; calling it again finishes, EAGAIN
+ * if a key's slot is held by an integer update that never finished), -2 on
+ * invalid arguments.
+ */
+int splinter_resize(size_t slots);
+
+/**
+ * @brief Gets a key's value like splinter_get(), checking it against its
+ * CRC32C on the way out.
+ * @param key The key to read.
+ * @param buf The buffer to copy the value into.
+ * @param buf_sz The size of the buffer.
+ * @param out_sz Receives the value's length. Can be NULL.
+ * @return 0 on success, -1 on failure: errno as splinter_get(), or EBADMSG
+ * if the value is corrupt, ENOTSUP if the store keeps no checksums (see
+ * checksums in splinter_create_opts_t). Integer keys always pass.
+ */
+int splinter_get_checked(const char *key, void *buf, size_t buf_sz, size_t *out_sz);
+
+/**
+ * @brief Checks every value in the store against its checksum, in parallel.
+ * @param threads Threads to use; 0 for one per online CPU.
+ * @param out_keys Receives pointers to the keys of corrupt values (into the
+ * store, like splinter_list()). Can be NULL if max_keys is 0.
+ * @param max_keys Capacity of out_keys.
+ * @param out_count Receives how many keys were written to out_keys. Can be NULL.
+ * @return Number of corrupt values (0 if the store is clean), or -1 on
+ * failure (errno = ENOTSUP if the store keeps no checksums).
+ */
+int splinter_verify(unsigned int threads, char **out_keys, size_t max_keys, size_t *out_count);
+
+/**
+ * @brief Sets a key like splinter_set(), to expire ttl_ms from now.
+ *
+ * An expired key reads as missing to everything (get, views, list, poll,
+ * watch sets); its slot is reclaimed by splinter_reap(), by the next write
+ * to the key, or by a write that finds the store full. Each reclaim is a
+ * delete to pollers, watch sets and the change feed. Other writes leave a
+ * key's expiry as it is.
+ *
+ * @param ttl_ms Time to live in milliseconds; 0 for none.
+ * @return 0 on success, -1 on failure (as splinter_set()).
+ */
+int splinter_set_with_ttl(const char *key, const void *val, size_t len, uint64_t ttl_ms);
+
+/**
+ * @brief Gives an existing key a new time to live, counted from now. Its
+ * value and epoch don't change.
+ * @param ttl_ms Time to live in milliseconds; 0 makes the key permanent.
+ * @return 0 on success, -1 on failure (errno = ENOENT if the key doesn't
+ * exist, EAGAIN if a writer holds its slot).
+ */
+int splinter_set_ttl(const char *key, uint64_t ttl_ms);
+
+/**
+ * @brief Reports how long a key has left to live.
+ * @param ttl_ms Receives the milliseconds left, or 0 if the key doesn't expire.
+ * @return 0 on success, -1 if the key doesn't exist.
+ */
+int splinter_get_ttl(const char *key, uint64_t *ttl_ms);
+
+/**
+ * @brief Deletes expired keys so their slots can be reused. Call it
+ * periodically from any process; one process reaps at a time.
+ * @return The number of keys deleted, or -1 on failure (errno = EBUSY if
+ * another process is reaping).
+ */
+int splinter_reap(void);
+
+/**
+ * @brief Opaque handle to a watch set: keys waited on together (see
+ * splinter_watch_create()). Watch sets are process-local.
+ */
+typedef struct splinter_watch splinter_watch_t;
+
+/**
+ * @brief A key reported by splinter_watch_wait().
+ */
+typedef struct splinter_watch_event {
+    /** @brief The key that changed. */
+    char key[SPLINTER_KEY_MAX];
+    /** @brief Its slot epoch now, or 0 if it was deleted. */
+    uint64_t epoch;
+} splinter_watch_event_t;
+
+/**
+ * @brief Creates an empty watch set on the default store.
+ *
+ * A watch set sleeps on one futex for the whole store however many keys it
+ * holds, and hands back every key that changed since the last call at once,
+ * replacing a thread (or a timeout loop) per key with splinter_poll().
+ *
+ * A set belongs to its store's handle: closing the store stops the set's
+ * notifier and unregisters its keys, after which every call on it but
+ * splinter_watch_destroy() fails with errno = EBADF. It still has to be
+ * destroyed, before or after.
+ *
+ * @return The watch set, or NULL on failure. Free with splinter_watch_destroy().
+ */
+splinter_watch_t *splinter_watch_create(void);
+
+/**
+ * @brief Adds keys to a watch set. Keys that don't exist yet are reported
+ * when they're created.
+ * @param w The watch set.
+ * @param keys The keys to add.
+ * @param n Number of keys.
+ * @return 0 on success, -1 on failure (errno = ENOMEM).
+ */
+int splinter_watch_add(splinter_watch_t *w, const char *const *keys, size_t n);
+
+/**
+ * @brief Adds the keys in a slot bitmap from splinter_find_tagged() to a
+ * watch set. Slots emptied since are skipped.
+ * @return The number of keys found in the bitmap, or -1 on failure (errno = ENOMEM).
+ */
+int splinter_watch_add_slots(splinter_watch_t *w, const uint64_t *bits, size_t words);
+
+/**
+ * @brief Adds every key tagged with all of tags to a watch set
+ * (splinter_find_tagged() and splinter_watch_add_slots() in one). Keys
+ * tagged later aren't added.
+ * @return The number of keys found, or -1 on failure (errno is set).
+ */
+int splinter_watch_add_tagged(splinter_watch_t *w, const char *const *tags, size_t n);
+
+/**
+ * @brief Removes keys from a watch set.
+ * @return The number of keys removed, or -1 on invalid arguments.
+ */
+int splinter_watch_eject(splinter_watch_t *w, const char *const *keys, size_t n);
+
+/**
+ * @brief Waits for keys in a watch set to change, returning all of them.
+ *
+ * Each key is reported once per call however often it was written since,
+ * along with its new epoch (0 if it was deleted). Like splinter_poll(),
+ * in-place integer updates (splinter_incr() etc.) don't count as changes.
+ *
+ * @param w The watch set.
+ * @param timeout_ms How long to wait; 0 only collects what's already changed.
+ * @param out Receives the changed keys.
+ * @param max Capacity of out (the rest wait for the next call).
+ * @return The number of changed keys, -2 with errno = ETIMEDOUT if there
+ * were none in time, -1 on invalid arguments (errno = EBADF if the store
+ * has been closed).
+ */
+int splinter_watch_wait(splinter_watch_t *w, uint64_t timeout_ms, splinter_watch_event_t *out, size_t max);
+
+/**
+ * @brief Gets a file descriptor that polls readable when the watch set has
+ * changes, so it can sit in a poll() / epoll loop next to sockets.
+ *
+ * Read the 8-byte counter to reset it, then collect with
+ * splinter_watch_wait(w, 0, ...). A helper thread does the waiting; it runs
+ * until splinter_watch_destroy(), which also closes the fd.
+ *
+ * @return The fd, or -1 on failure (errno is set).
+ */
+int splinter_watch_fd(splinter_watch_t *w);
+
+/**
+ * @brief Frees a watch set (and its fd and thread, if any). NULL is a no-op.
+ */
+void splinter_watch_destroy(splinter_watch_t *w);
+
+/*
+ * Handle-based API. These mirror the functions above one-for-one, but take
+ * the store to operate on as the first argument. Handles are created by
+ * splinter_store_create() / splinter_store_open() (and the combined forms)
+ * and must be released with splinter_store_close().
+ */
+
+/**
+ * @brief Creates and initializes a new splinter store.
+ * @return A new handle, or NULL on failure (errno is set).
+ */
+splinter_store_t *splinter_store_create(const char *name_or_path, size_t slots, size_t max_value_sz);
+
+/**
+ * @brief Creates and initializes a new splinter store with extended options.
+ * @return A new handle, or NULL on failure (errno is set).
+ */
+splinter_store_t *splinter_store_create_ex(const char *name_or_path, const splinter_create_opts_t *opts);
+
+/**
+ * @brief Opens an existing splinter store.
+ * @return A new handle, or NULL on failure (errno is set).
+ */
+splinter_store_t *splinter_store_open(const char *name_or_path);
+
+/**
+ * @brief Opens an existing splinter store, or creates it if it does not exist.
+ * @return A new handle, or NULL on failure (errno is set).
+ */
+splinter_store_t *splinter_store_open_or_create(const char *name_or_path, size_t slots, size_t max_value_sz);
+
+/**
+ * @brief Creates a new splinter store, or opens it if it already exists.
+ * @return A new handle, or NULL on failure (errno is set).
+ */
+splinter_store_t *splinter_store_create_or_open(const char *name_or_path, size_t slots, size_t max_value_sz);
+
+/**
+ * @brief Unmaps the store and releases the handle. Passing NULL is a no-op.
+ * Watch sets still open on it stop watching, and fail with EBADF until
+ * they're destroyed (see splinter_watch_create()).
+ */
+void splinter_store_close(splinter_store_t *st);
+
+/**
+ * @brief Returns the store used by the handle-less API. It is never NULL, but
+ * may not be open; handle functions fail cleanly on a closed store.
+ */
+splinter_store_t *splinter_default_store(void);
+
+/** @brief Handle form of splinter_set_av(). */
+int splinter_store_set_av(splinter_store_t *st, unsigned int mode);
+/** @brief Handle form of splinter_get_av(). */
+int splinter_store_get_av(splinter_store_t *st);
+/** @brief Handle form of splinter_set_evict_policy(). */
+int splinter_store_set_evict_policy(splinter_store_t *st, uint32_t policy);
+/** @brief Handle form of splinter_get_evict_policy(). */
+int splinter_store_get_evict_policy(splinter_store_t *st);
+/** @brief Handle form of splinter_set(). */
+int splinter_store_set(splinter_store_t *st, const char *key, const void *val, size_t len);
+/** @brief Handle form of splinter_unset(). */
+int splinter_store_unset(splinter_store_t *st, const char *key);
+/** @brief Handle form of splinter_get(). */
+int splinter_store_get(splinter_store_t *st, const char *key, void *buf, size_t buf_sz, size_t *out_sz);
+/** @brief Handle form of splinter_setv(). */
+int splinter_store_setv(splinter_store_t *st, const char *key, const struct iovec *iov, int iovcnt);
+/** @brief Handle form of splinter_set_if_epoch(). */
+int splinter_store_set_if_epoch(splinter_store_t *st, const char *key, uint64_t expected_epoch,
+    const void *val, size_t len);
+/** @brief Handle form of splinter_getv(). */
+int splinter_store_getv(splinter_store_t *st, const char *key, const struct iovec *iov, int iovcnt,
+    size_t *out_sz);
+/** @brief Handle form of splinter_append(). */
+int splinter_store_append(splinter_store_t *st, const char *key, const void *data, size_t len);
+/** @brief Handle form of splinter_set_range(). */
+int splinter_store_set_range(splinter_store_t *st, const char *key, size_t off, const void *data,
+    size_t len);
+/** @brief Handle form of splinter_get_from(). */
+int splinter_store_get_from(splinter_store_t *st, const char *key, size_t off, void *buf,
+    size_t buf_sz, size_t *out_sz);
+/** @brief Handle form of splinter_set_int(). */
+int splinter_store_set_int(splinter_store_t *st, const char *key, int64_t value);
+/** @brief Handle form of splinter_get_int(). */
+int splinter_store_get_int(splinter_store_t *st, const char *key, int64_t *value);
+/** @brief Handle form of splinter_set_if_eq(). */
+int splinter_store_set_if_eq(splinter_store_t *st, const char *key, int64_t expected, int64_t value);
+/** @brief Handle form of splinter_set_if_lt(). */
+int splinter_store_set_if_lt(splinter_store_t *st, const char *key, int64_t bound, int64_t value);
+/** @brief Handle form of splinter_set_if_gt(). */
+int splinter_store_set_if_gt(splinter_store_t *st, const char *key, int64_t bound, int64_t value);
+/** @brief Handle form of splinter_incr(). */
+int splinter_store_incr(splinter_store_t *st, const char *key, int64_t delta, int64_t *result);
+/** @brief Handle form of splinter_decr(). */
+int splinter_store_decr(splinter_store_t *st, const char *key, int64_t delta, int64_t *result);
+/** @brief Handle form of splinter_fetch_and(). */
+int splinter_store_fetch_and(splinter_store_t *st, const char *key, uint64_t mask, int64_t *prev);
+/** @brief Handle form of splinter_fetch_or(). */
+int splinter_store_fetch_or(splinter_store_t *st, const char *key, uint64_t mask, int64_t *prev);
+/** @brief Handle form of splinter_fetch_xor(). */
+int splinter_store_fetch_xor(splinter_store_t *st, const char *key, uint64_t mask, int64_t *prev);
+/** @brief Handle form of splinter_get_view(). */
+int splinter_store_get_view(splinter_store_t *st, const char *key, const void **ptr, size_t *len,
+    uint64_t *epoch);
+/** @brief Handle form of splinter_view_valid(). */
+int splinter_store_view_valid(splinter_store_t *st, const char *key, uint64_t epoch);
+/** @brief Handle form of splinter_mget(). */
+int splinter_store_mget(splinter_store_t *st, const char *const *keys, size_t n, void *const *bufs,
+    const size_t *buf_szs, size_t *out_szs, int *errs);
+/** @brief Handle form of splinter_mset(). */
+int splinter_store_mset(splinter_store_t *st, const char *const *keys, const void *const *vals,
+    const size_t *lens, size_t n, int *errs);
+/** @brief Handle form of splinter_list(). */
+int splinter_store_list(splinter_store_t *st, char **out_keys, size_t max_keys, size_t *out_count);
+/** @brief Handle form of splinter_scan_range(). */
+int splinter_store_scan_range(splinter_store_t *st, const char *lo, const char *hi, splinter_scan_cb cb, void *arg);
+/** @brief Handle form of splinter_scan_prefix(). */
+int splinter_store_scan_prefix(splinter_store_t *st, const char *prefix, splinter_scan_cb cb, void *arg);
+/** @brief Handle form of splinter_add_tags(). */
+int splinter_store_add_tags(splinter_store_t *st, const char *key, uint64_t mask);
+/** @brief Handle form of splinter_set_tags(). */
+int splinter_store_set_tags(splinter_store_t *st, const char *key, uint64_t mask);
+/** @brief Handle form of splinter_get_tags(). */
+int splinter_store_get_tags(splinter_store_t *st, const char *key, uint64_t *mask);
+/** @brief Handle form of splinter_find_tagged(). */
+int splinter_store_find_tagged(splinter_store_t *st, uint64_t mask, uint64_t *bits, size_t words);
+/** @brief Handle form of splinter_list_slots(). */
+int splinter_store_list_slots(splinter_store_t *st, const uint64_t *bits, size_t words, char **out_keys,
+    size_t max_keys, size_t *out_count);
+/** @brief Handle form of splinter_set_with_embeddings(). */
+int splinter_store_set_with_embeddings(splinter_store_t *st, const char *key, const void *val, size_t len,
+    const float *vec);
+/** @brief Handle form of splinter_set_embeddings(). */
+int splinter_store_set_embeddings(splinter_store_t *st, const char *key, const float *vec);
+/** @brief Handle form of splinter_get_embeddings(). */
+int splinter_store_get_embeddings(splinter_store_t *st, const char *key, float *out);
+/** @brief Handle form of splinter_get_with_embeddings(). */
+int splinter_store_get_with_embeddings(splinter_store_t *st, const char *key, void *buf, size_t buf_sz,
+    size_t *out_sz, float *vec);
+/** @brief Handle form of splinter_knn(). */
+int splinter_store_knn(splinter_store_t *st, const float *query, size_t k, int metric, unsigned int threads,
+    splinter_knn_hit_t *out);
+/** @brief Handle form of splinter_ann(). */
+int splinter_store_ann(splinter_store_t *st, const float *query, size_t k, unsigned int ef, splinter_knn_hit_t *out);
+/** @brief Handle form of splinter_poll(). */
+int splinter_store_poll(splinter_store_t *st, const char *key, uint64_t timeout_ms);
+/** @brief Handle form of splinter_set_poll_spin(). */
+int splinter_store_set_poll_spin(splinter_store_t *st, unsigned int spins);
+/** @brief Handle form of splinter_get_header_snapshot(). */
+int splinter_store_get_header_snapshot(splinter_store_t *st, splinter_header_snapshot_t *snapshot);
+/** @brief Handle form of splinter_get_slot_snapshot(). */
+int splinter_store_get_slot_snapshot(splinter_store_t *st, const char *key, splinter_slot_snapshot_t *snapshot);
+/** @brief Handle form of splinter_watch_create(). */
+splinter_watch_t *splinter_store_watch_create(splinter_store_t *st);
+/** @brief Handle form of splinter_feed_cursor(). */
+int splinter_store_feed_cursor(splinter_store_t *st, uint64_t *cursor);
+/** @brief Handle form of splinter_feed_read(). */
+int splinter_store_feed_read(splinter_store_t *st, uint64_t *cursor, splinter_change_t *out, size_t max);
+/** @brief Handle form of splinter_resize(). */
+int splinter_store_resize(splinter_store_t *st, size_t slots);
+/** @brief Handle form of splinter_get_checked(). */
+int splinter_store_get_checked(splinter_store_t *st, const char *key, void *buf, size_t buf_sz,
+    size_t *out_sz);
+/** @brief Handle form of splinter_verify(). */
+int splinter_store_verify(splinter_store_t *st, unsigned int threads, char **out_keys, size_t max_keys,
+    size_t *out_count);
+/** @brief Handle form of splinter_set_with_ttl(). */
+int splinter_store_set_with_ttl(splinter_store_t *st, const char *key, const void *val, size_t len,
+    uint64_t ttl_ms);
+/** @brief Handle form of splinter_set_ttl(). */
+int splinter_store_set_ttl(splinter_store_t *st, const char *key, uint64_t ttl_ms);
+/** @brief Handle form of splinter_get_ttl(). */
+int splinter_store_get_ttl(splinter_store_t *st, const char *key, uint64_t *ttl_ms);
+/** @brief Handle form of splinter_reap(). */
+int splinter_store_reap(splinter_store_t *st);
+
 #ifdef __cplusplus
 }
 #endif
@@ -16,10 +16,16 @@
 // Hard cap on viewable history length
 #define CLI_HISTORY_MAX_LEN 1024
 
+// Hits knn / ann show when no count is given
+#define CLI_NEAREST_K 10
+
 // Types for module command entry and help 
 typedef int (*mod_entry_t)(int, char *[]);
 typedef void (*mod_help_t)(unsigned int);
 
+// A nearest-neighbour search for cli_nearest(): fills hits, returns how many or -1
+typedef int (*cli_search_t)(const float *query, size_t k, splinter_knn_hit_t *hits, void *arg);
+
 // A command (module)
 typedef struct cli_module {
     // correlates to array position for easy lookup
@@ -69,6 +75,14 @@ char *cli_rejoin_args(char *const src[]);
 void cli_show_modules(void);
 void cli_show_key_config(const char *key, const char *caller);
 int cli_safer_atoi(const char *string);
+int cli_evict_policy(const char *name);
+const char *cli_evict_name(unsigned int policy);
+int cli_metric(const char *name);
+const char *cli_metric_name(unsigned int metric);
+int cli_parse_vector(const char *csv, float *out, unsigned int dim);
+int cli_query_vector(const char *target, float *query, unsigned int dim, const char *caller);
+int cli_nearest(const char *target, const char *count, unsigned int dim, cli_search_t search,
+    void *arg, const char *caller);
 
 // Prototypes for individual command entry points
 int cmd_help(int argc, char *argv[]);
@@ -110,6 +124,33 @@ void help_cmd_init(unsigned int level);
 int cmd_export(int argc, char *argv[]);
 void help_cmd_export(unsigned int level);
 
+int cmd_math(int argc, char *argv[]);
+void help_cmd_math(unsigned int level);
+
+int cmd_resize(int argc, char *argv[]);
+void help_cmd_resize(unsigned int level);
+
+int cmd_verify(int argc, char *argv[]);
+void help_cmd_verify(unsigned int level);
+
+int cmd_ttl(int argc, char *argv[]);
+void help_cmd_ttl(unsigned int level);
+
+int cmd_reap(int argc, char *argv[]);
+void help_cmd_reap(unsigned int level);
+
+int cmd_tag(int argc, char *argv[]);
+void help_cmd_tag(unsigned int level);
+
+int cmd_embed(int argc, char *argv[]);
+void help_cmd_embed(unsigned int level);
+
+int cmd_knn(int argc, char *argv[]);
+void help_cmd_knn(unsigned int level);
+
+int cmd_ann(int argc, char *argv[]);
+void help_cmd_ann(unsigned int level);
+
 // And finally an array of modules to hold them all
 extern cli_module_t command_modules[];
 
@@ -0,0 +1,56 @@
+/**
+ * Copyright 2025 Tim Post
+ * License: Apache 2 (MIT available upon request to timthepost@protonmail.com)
+ *
+ * @file splinter_cli_cmd_ann.c
+ * @brief Implements the CLI 'ann' command.
+ */
+
+#include <stdio.h>
+#include "splinter_cli.h"
+
+static const char *modname = "ann";
+
+void help_cmd_ann(unsigned int level) {
+    printf("%s finds about the nearest keys to a key's embedding, or to a vector, from the graph.\n",
+        modname);
+    printf("Usage: %s <key_name | x,y,...> [count] [ef]\n", modname);
+    if (level) {
+        printf("\nLists up to count (default %d) keys, nearest first, with their scores under\n",
+            CLI_NEAREST_K);
+        puts("the metric the store's HNSW graph was built for (see 'init --ann'). ef is how");
+        puts("many candidates to search: more finds more of the true nearest, slower. 0 or");
+        puts("none uses the store's default. 'knn' gives the exact answer, by brute force.");
+    }
+    return;
+}
+
+static int ann_search(const float *query, size_t k, splinter_knn_hit_t *hits, void *arg) {
+    return splinter_ann(query, k, *(unsigned int *) arg, hits);
+}
+
+int cmd_ann(int argc, char *argv[]) {
+    splinter_header_snapshot_t snap = { 0 };
+    unsigned int ef = 0;
+
+    if (argc < 2 || argc > 4) {
+        help_cmd_ann(1);
+        return 1;
+    }
+    if (argc == 4) {
+        int n = cli_safer_atoi(argv[3]);
+        if (n < 0) {
+            fprintf(stderr, "%s: ef must be a number.\n", modname);
+            return 1;
+        }
+        ef = (unsigned int) n;
+    }
+
+    splinter_get_header_snapshot(&snap);
+    if (!snap.ann_m) {
+        fprintf(stderr, "%s: this store keeps no graph (see 'init --ann').\n", modname);
+        return 1;
+    }
+    return cli_nearest(argv[1], argc >= 3 ? argv[2] : NULL, snap.embed_dim, ann_search, &ef,
+        modname);
+}
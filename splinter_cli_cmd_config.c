@@ -16,7 +16,8 @@ void help_cmd_config(unsigned int level) {
     (void) level;
     printf("Usage: %s\n       %s [feature_flag] [flag_value]\n", modname, modname);
     printf("If no other arguments are given, %s displays the current bus settings.\n", modname);
-    printf("Supported flags:\n\t\"av\" -> 1 or 0\n\n");
+    printf("Supported flags:\n\t\"av\" -> 1 or 0\n");
+    printf("\t\"evict\" -> none, clock, ttl or oldest (what writes to a full store do)\n\n");
     return;
 }
 
@@ -31,6 +32,34 @@ static void show_bus_config(void) {
     printf("max_val_sz:  %u\n", snap.max_val_sz);
     printf("epoch:       %lu\n", snap.epoch);
     printf("auto_vacuum: %u\n", snap.auto_vacuum);
+    printf("max_probe:   %u\n", snap.max_probe);
+    printf("keys:        %lu (%u slots used, %u%% load)\n", snap.keys, snap.used_slots,
+        snap.slots ? (unsigned)((uint64_t)snap.used_slots * 100 / snap.slots) : 0);
+    printf("max_size:    %lu bytes%s\n", snap.max_size, snap.gen & 1 ? " (resize in progress)" : "");
+    printf("hash:        %s\n", snap.hash_alg == SPLINTER_HASH_FNV1A ? "fnv1a" : "wyhash (seeded)");
+    if (snap.arena_sz)
+        printf("arena:       %lu / %lu bytes carved\n", snap.arena_used, snap.arena_sz);
+    if (snap.feed_len)
+        printf("feed:        %lu changes (%lu records)\n", snap.feed_head, snap.feed_len);
+    if (snap.checksums)
+        printf("checksums:   crc32c\n");
+    if (snap.key_index)
+        printf("key index:   ordered (prefix and range scans)\n");
+    if (snap.embed_dim)
+        printf("embeddings:  %u floats per key\n", snap.embed_dim);
+    if (snap.ann_m)
+        printf("ann graph:   HNSW, M=%u, ef %u (build) / %u (search), %s\n", snap.ann_m,
+            snap.ann_ef_construction, snap.ann_ef_search, cli_metric_name(snap.ann_metric));
+    if (snap.expiry_log_len || snap.expired)
+        printf("expiry:      %lu keys expired (%s)\n", snap.expired,
+            snap.expiry_log_len ? "timing wheel" : "sweeping reaper");
+    if (snap.evict_policy || snap.evicted)
+        printf("eviction:    %s, %lu keys evicted\n", cli_evict_name(snap.evict_policy), snap.evicted);
+    if (snap.map_flags)
+        printf("mapping:    %s%s%s\n",
+            snap.map_flags & SPLINTER_MAP_HUGEPAGES ? " hugepages" : "",
+            snap.map_flags & SPLINTER_MAP_PREFAULT ? " prefault" : "",
+            snap.map_flags & SPLINTER_MAP_LOCK ? " mlock" : "");
     puts("");
     
     return;
@@ -48,6 +77,14 @@ int cmd_config(int argc, char *argv[]) {
         // okay for now, but will need more robust argument parsing here.
         // ideally we can get current values by passing just the key, for instance.
         // later on ...
+        if (!strcmp(argv[1], "evict")) {
+            int policy = cli_evict_policy(argv[2]);
+            if (policy < 0) {
+                fprintf(stderr, "Invalid eviction policy (none, clock, ttl or oldest)\n");
+                return 1;
+            }
+            return splinter_set_evict_policy((uint32_t) policy);
+        }
         int opt = cli_safer_atoi(argv[2]);
         if (!strncmp(argv[1], "av", 2)) {
             if (opt > 1 || opt < 0) {
@@ -0,0 +1,79 @@
+/**
+ * Copyright 2025 Tim Post
+ * License: Apache 2 (MIT available upon request to timthepost@protonmail.com)
+ *
+ * @file splinter_cli_cmd_embed.c
+ * @brief Implements the CLI 'embed' command.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "splinter_cli.h"
+
+static const char *modname = "embed";
+
+void help_cmd_embed(unsigned int level) {
+    printf("%s shows or sets a key's embedding vector.\n", modname);
+    printf("Usage: %s <key_name> [x,y,... [value]]\n", modname);
+    if (level) {
+        puts("\nWith no vector, prints the key's embedding. Otherwise the vector (exactly as");
+        puts("many comma-separated floats as the store was created with; see 'init --embed')");
+        puts("replaces it, leaving the value alone, or is set along with a new value if one");
+        puts("is given. Find nearby keys with 'knn'.");
+    }
+    return;
+}
+
+int cmd_embed(int argc, char *argv[]) {
+    char key[SPLINTER_KEY_MAX] = { 0 };
+    char *tmp = getenv("SPLINTER_NS_PREFIX");
+    splinter_header_snapshot_t snap = { 0 };
+    float *vec = NULL;
+    unsigned int i;
+    int rc = 1;
+
+    if (argc < 2 || argc > 4) {
+        help_cmd_embed(1);
+        return 1;
+    }
+    splinter_get_header_snapshot(&snap);
+    if (!snap.embed_dim) {
+        fprintf(stderr, "%s: this store keeps no embeddings (see 'init --embed').\n", modname);
+        return 1;
+    }
+    vec = calloc(snap.embed_dim, sizeof(float));
+    if (vec == NULL) {
+        fprintf(stderr, "%s: unable to allocate memory for the vector.\n", modname);
+        return 1;
+    }
+    snprintf(key, sizeof(key) -1, "%s%s", tmp == NULL ? "" : tmp, argv[1]);
+
+    if (argc == 2) {
+        if (splinter_get_embeddings(key, vec) != 0) {
+            fprintf(stderr, "%s: unable to read the embedding of '%s': %s\n", modname, key,
+                errno == ENODATA ? "it has none" : strerror(errno));
+            goto out;
+        }
+        for (i = 0; i < snap.embed_dim; i++)
+            printf("%s%g", i ? "," : "", vec[i]);
+        puts("");
+        rc = 0;
+        goto out;
+    }
+
+    if (cli_parse_vector(argv[2], vec, snap.embed_dim) != 0) {
+        fprintf(stderr, "%s: expected %u comma-separated floats.\n", modname, snap.embed_dim);
+        goto out;
+    }
+    if ((argc == 4 ? splinter_set_with_embeddings(key, argv[3], strlen(argv[3]), vec) :
+                     splinter_set_embeddings(key, vec)) != 0) {
+        fprintf(stderr, "%s: unable to set the embedding of '%s': %s\n", modname, key, strerror(errno));
+        goto out;
+    }
+    rc = 0;
+out:
+    free(vec);
+    return rc;
+}
@@ -23,6 +23,7 @@ void help_cmd_export(unsigned int level) {
     printf("%s exports the store in various formats to standard output.\n", modname);
     printf("Usage: %s [format (default=json)] [max_lines (default=0/unlimited)]\n", modname);
     printf("Format can be one of: json (more coming soon)\n");
+    printf("'--tag <tag>' (repeatable) exports only keys that have all the tags given.\n");
     return;
 }
 
@@ -87,14 +88,21 @@ int cmd_export(int argc, char *argv[]) {
     };
 
     splinter_slot_snapshot_t *slots = NULL;
-    char **keynames = NULL;
+    char **keynames = NULL, *pattern = NULL;
+    uint64_t *bits = NULL, mask = 0;
     size_t entry_count = 0;
     size_t max_keys = 0;
     int rc = -1, i, x = 0;
 
-    if (argc > 2) {
-        help_cmd_list(1);
-        return -1;
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--tag") == 0 && i + 1 < argc) {
+            mask |= splinter_tag_mask(argv[++i]);
+        } else if (pattern == NULL) {
+            pattern = argv[i];
+        } else {
+            help_cmd_export(1);
+            return -1;
+        }
     }
 
     // Get header snapshot to determine allocation size
@@ -121,7 +129,22 @@ int cmd_export(int argc, char *argv[]) {
         return -1;
     }
 
-    rc = splinter_list(keynames, max_keys, &entry_count);
+    if (mask) {
+        // one scan of the tag blooms picks the slots, rather than every key
+        bits = (uint64_t *)calloc((max_keys + 63) / 64, sizeof(uint64_t));
+        if (bits == NULL) {
+            fprintf(stderr, "%s: unable to allocate memory for the tag scan.\n", modname);
+            errno = ENOMEM;
+            rc = -1;
+            goto cleanup;
+        }
+        rc = splinter_find_tagged(mask, bits, (max_keys + 63) / 64) < 0 ? -1 :
+             splinter_list_slots(bits, (max_keys + 63) / 64, keynames, max_keys, &entry_count);
+        if (rc != 0)
+            fprintf(stderr, "%s: unable to find tagged keys: %s\n", modname, strerror(errno));
+    } else {
+        rc = splinter_list(keynames, max_keys, &entry_count);
+    }
     if (rc == 0) {
         g = grawk_init();
         if (g == NULL) {
@@ -132,8 +155,8 @@ int cmd_export(int argc, char *argv[]) {
         }
         
         grawk_set_options(g, &opts);
-        if (argc == 2) {
-            filter = grawk_build_pattern(argv[1]);
+        if (pattern != NULL) {
+            filter = grawk_build_pattern(pattern);
             grawk_set_pattern(g, filter);
         }
 
@@ -172,6 +195,10 @@ cleanup:
     if (slots != NULL) {
         free(slots);
     }
+
+    if (bits != NULL) {
+        free(bits);
+    }
     
     if (keynames != NULL) {
         free(keynames);
@@ -9,6 +9,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <inttypes.h>
 #include "splinter_cli.h"
 
 static const char *modname = "get";
@@ -26,6 +27,7 @@ int cmd_get(int argc, char *argv[]) {
     char key[SPLINTER_KEY_MAX] = { 0 };
     char *tmp = getenv("SPLINTER_NS_PREFIX");
     size_t received = 0;
+    int64_t ival;
     int rc = -1;
 
     if (argc != 2) {
@@ -35,6 +37,14 @@ int cmd_get(int argc, char *argv[]) {
     
     snprintf(key, sizeof(key) -1, "%s%s", tmp == NULL ? "" : tmp, argv[1]);
 
+    // integer keys hold raw 64-bit words; show them as numbers
+    if (splinter_get_int(key, &ival) == 0) {
+        received = (size_t)snprintf(buf, sizeof(buf), "%" PRId64, ival);
+        printf("%lu:%s\n", received, buf);
+        puts("");
+        return 0;
+    }
+
     rc = splinter_get(key, buf, sizeof(buf), &received);
     if (rc != 0) {
         fprintf(stderr, "%s: unable to retrieve key '%s'\n", modname, key);
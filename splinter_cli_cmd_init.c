@@ -21,7 +21,25 @@ void help_cmd_init(unsigned int level) {
     (void) level;
 
     printf("Usage: %s [store_name] [--slots num_slots] [--maxlen max_val_len]\n", modname);
+    printf("       %*s [--hugepages] [--prefault] [--checksums] [--reaper]\n", (int) strlen(modname), "");
+    printf("       %*s [--evict none|clock|ttl|oldest] [--index] [--embed dim]\n", (int) strlen(modname), "");
+    printf("       %*s [--ann M] [--metric dot|cosine|l2]\n", (int) strlen(modname), "");
     printf("%s creates a Splinter store to default or specific geometry.\n", modname);
+    puts("--hugepages backs the store with transparent huge pages (rounding it up to 2 MB),");
+    puts("--prefault faults it all in up front and locks the slot table in memory.");
+    puts("Both are remembered by the store and applied by everything that opens it.");
+    puts("--checksums keeps a CRC32C of every value, checked by 'verify'.");
+    printf("--reaper keeps a %d record expiry log, so 'reap' only visits keys that expire.\n",
+        DEFAULT_EXPIRY_LOG);
+    puts("--evict makes writes to a full store evict a key near the new one's slot instead");
+    puts("of failing: the least recently used by CLOCK, the soonest to expire, or the oldest.");
+    puts("--index keeps the keys in order, so 'list ^prefix' needn't look at every slot.");
+    printf("--embed gives every key room for a vector of dim floats (at most %d), set with\n",
+        SPLINTER_EMBED_MAX);
+    puts("'embed' and searched by 'knn'.");
+    puts("--ann also keeps an HNSW graph of the embeddings with M links per node (16 is a");
+    puts("good start), searched by 'ann'; --metric is what it's built for (cosine if not");
+    puts("given).");
     puts("If arguments are omitted, these compiled-in defaults are used:");
     printf("\nname:  %s\nslots:  %lu\nmaxlen: %lu\n",
         DEFAULT_BUS,
@@ -35,16 +53,28 @@ static const struct option long_options[] = {
     { "help", no_argument, NULL, 'h' },
     { "slots", required_argument, NULL, 's' },
     { "maxlen", required_argument, NULL, 'l' },
+    { "hugepages", no_argument, NULL, 'H' },
+    { "prefault", no_argument, NULL, 'P' },
+    { "checksums", no_argument, NULL, 'C' },
+    { "reaper", no_argument, NULL, 'R' },
+    { "evict", required_argument, NULL, 'E' },
+    { "index", no_argument, NULL, 'I' },
+    { "embed", required_argument, NULL, 'D' },
+    { "ann", required_argument, NULL, 'A' },
+    { "metric", required_argument, NULL, 'M' },
     { NULL, 0, NULL, 0 }
 };
 
-static const char *optstring = "hs:l:";
+static const char *optstring = "hs:l:HPCRE:ID:A:M:";
 
 int cmd_init(int argc, char *argv[]) {
     char *buff = NULL, save[64] = { 0 }, store[64] = { 0 };
     int rc = 0, opt = 0;
     unsigned int prev_conn = 0;
     unsigned long max_slots = DEFAULT_SLOTS, max_val = DEFAULT_VAL_MAXLEN;
+    uint32_t map_flags = 0, checksums = 0, key_index = 0, embed_dim = 0, ann_m = 0;
+    size_t expiry_log_len = 0;
+    int evict_policy = SPLINTER_EVICT_NONE, metric = SPLINTER_METRIC_COSINE;
 
     if (thisuser.store_conn) {
         strncpy(save, thisuser.store, 64);
@@ -59,12 +89,49 @@ int cmd_init(int argc, char *argv[]) {
                 rc = 0;
                 goto restore_conn;
                 break;
-            case 'o':
+            case 's':
                 max_slots = strtoul(optarg, &buff, 10);
                 break;
             case 'l':
                 max_val = strtoul(optarg, &buff, 10);
                 break;
+            case 'H':
+                map_flags |= SPLINTER_MAP_HUGEPAGES;
+                break;
+            case 'P':
+                map_flags |= SPLINTER_MAP_PREFAULT | SPLINTER_MAP_LOCK;
+                break;
+            case 'C':
+                checksums = 1;
+                break;
+            case 'R':
+                expiry_log_len = DEFAULT_EXPIRY_LOG;
+                break;
+            case 'I':
+                key_index = 1;
+                break;
+            case 'D':
+                embed_dim = (uint32_t) strtoul(optarg, &buff, 10);
+                break;
+            case 'A':
+                ann_m = (uint32_t) strtoul(optarg, &buff, 10);
+                break;
+            case 'M':
+                metric = cli_metric(optarg);
+                if (metric < 0) {
+                    fprintf(stderr, "%s: unknown metric: %s (dot, cosine or l2)\n", modname, optarg);
+                    rc = 1;
+                    goto restore_conn;
+                }
+                break;
+            case 'E':
+                evict_policy = cli_evict_policy(optarg);
+                if (evict_policy < 0) {
+                    fprintf(stderr, "%s: unknown eviction policy: %s\n", modname, optarg);
+                    rc = 1;
+                    goto restore_conn;
+                }
+                break;
         }
     }
 
@@ -80,10 +147,22 @@ int cmd_init(int argc, char *argv[]) {
         max_val
     );
 
-    rc = splinter_create(store, max_slots, max_val);
+    splinter_create_opts_t opts = {
+        .slots = max_slots,
+        .max_value_sz = max_val,
+        .map_flags = map_flags,
+        .checksums = checksums,
+        .expiry_log_len = expiry_log_len,
+        .evict_policy = (uint32_t) evict_policy,
+        .key_index = key_index,
+        .embed_dim = embed_dim,
+        .ann_m = ann_m,
+        .ann_metric = (uint32_t) metric
+    };
+    rc = splinter_create_ex(store, &opts);
 
     if (rc < 0)
-        perror("splinter_create");
+        perror("splinter_create_ex");
   
     splinter_close();
     goto restore_conn;
@@ -0,0 +1,53 @@
+/**
+ * Copyright 2025 Tim Post
+ * License: Apache 2 (MIT available upon request to timthepost@protonmail.com)
+ *
+ * @file splinter_cli_cmd_knn.c
+ * @brief Implements the CLI 'knn' command.
+ */
+
+#include <stdio.h>
+#include "splinter_cli.h"
+
+static const char *modname = "knn";
+
+void help_cmd_knn(unsigned int level) {
+    printf("%s finds the keys whose embeddings are nearest to a key's, or to a vector.\n", modname);
+    printf("Usage: %s <key_name | x,y,...> [count] [dot|cosine|l2]\n", modname);
+    if (level) {
+        printf("\nLists up to count (default %d) keys, nearest first, with their scores:\n",
+            CLI_NEAREST_K);
+        puts("cosine similarity unless another metric is named (l2 is the squared distance,");
+        puts("so lower is nearer). Every embedding in the store is scored, on all CPUs.");
+    }
+    return;
+}
+
+static int knn_search(const float *query, size_t k, splinter_knn_hit_t *hits, void *arg) {
+    return splinter_knn(query, k, *(int *) arg, 0, hits);
+}
+
+int cmd_knn(int argc, char *argv[]) {
+    splinter_header_snapshot_t snap = { 0 };
+    int metric = SPLINTER_METRIC_COSINE;
+
+    if (argc < 2 || argc > 4) {
+        help_cmd_knn(1);
+        return 1;
+    }
+    if (argc == 4) {
+        metric = cli_metric(argv[3]);
+        if (metric < 0) {
+            fprintf(stderr, "%s: unknown metric: %s (dot, cosine or l2)\n", modname, argv[3]);
+            return 1;
+        }
+    }
+
+    splinter_get_header_snapshot(&snap);
+    if (!snap.embed_dim) {
+        fprintf(stderr, "%s: this store keeps no embeddings (see 'init --embed').\n", modname);
+        return 1;
+    }
+    return cli_nearest(argv[1], argc >= 3 ? argv[2] : NULL, snap.embed_dim, knn_search, &metric,
+        modname);
+}
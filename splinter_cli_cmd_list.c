@@ -22,9 +22,39 @@ void help_cmd_list(unsigned int level) {
     (void) level;
     printf("%s lists keys in the currently selected store.\n", modname);
     printf("Usage: %s [pattern] [max_lines]\n", modname);
+    printf("The pattern is an extended regular expression, matched anywhere in the key.\n");
+    printf("One that's just '^' and a literal prefix (e.g. ^namespace::) is answered by an\n");
+    printf("ordered key scan, which stores made with 'init --index' do without looking at\n");
+    printf("every slot. Either way, the most recently written keys are listed first.\n");
     return;
 }
 
+struct prefix_listing {
+    splinter_slot_snapshot_t *slots;
+    size_t count, max;
+};
+
+static int list_scanned(const char *key, void *arg) {
+    struct prefix_listing *l = arg;
+
+    if (l->count == l->max)
+        return 1;
+    splinter_get_slot_snapshot(key, &l->slots[l->count]);
+    if (l->slots[l->count].epoch)
+        l->count++;
+    return 0;
+}
+
+// a pattern like "^namespace::" matches a literal prefix, which a key scan can answer
+static int literal_prefix(const char *pattern, char *prefix, size_t sz) {
+    size_t len = strlen(pattern);
+
+    if (len < 2 || len > sz || pattern[0] != '^' || strcspn(pattern + 1, ".[]()*+?^$|\\{}") != len - 1)
+        return 0;
+    memcpy(prefix, pattern + 1, len);
+    return 1;
+}
+
 static int compare_slots_by_epoch(const void *a, const void *b) {
     const splinter_slot_snapshot_t *slot_a = (const splinter_slot_snapshot_t *)a;
     const splinter_slot_snapshot_t *slot_b = (const splinter_slot_snapshot_t *)b;
@@ -80,6 +110,15 @@ int cmd_list(int argc, char *argv[]) {
         return -1;
     }
 
+    char prefix[SPLINTER_KEY_MAX];
+    if (argc == 2 && literal_prefix(argv[1], prefix, sizeof(prefix))) {
+        struct prefix_listing l = { .slots = slots, .max = max_keys };
+        rc = splinter_scan_prefix(prefix, list_scanned, &l) < 0 ? -1 : 0;
+        x = (int) l.count;
+        qsort(slots, x, sizeof(splinter_slot_snapshot_t), compare_slots_by_epoch);
+        goto print;
+    }
+
     rc = splinter_list(keynames, max_keys, &entry_count);
     if (rc == 0) {
         g = grawk_init();
@@ -114,7 +153,10 @@ int cmd_list(int argc, char *argv[]) {
 
         // Sort so the most-updated keys are at the top of the list
         qsort(slots, x, sizeof(splinter_slot_snapshot_t), compare_slots_by_epoch);
+    }
 
+print:
+    if (rc == 0) {
         printf("%-33s | %-15s | %-15s\n",
             "Key Name",
             "Epoch",
@@ -0,0 +1,99 @@
+/**
+ * Copyright 2025 Tim Post
+ * License: Apache 2 (MIT available upon request to timthepost@protonmail.com)
+ *
+ * @file splinter_cli_cmd_math.c
+ * @brief Implements the CLI 'math' command (atomic integer keys).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include "splinter_cli.h"
+
+static const char *modname = "math";
+
+void help_cmd_math(unsigned int level) {
+    printf("%s operates atomically on integer keys in the store.\n", modname);
+    printf("Usage: %s <incr|decr> <key_name> [amount]\n", modname);
+    printf("       %s <and|or|xor> <key_name> <mask>\n", modname);
+    printf("       %s <not|get> <key_name>\n", modname);
+    printf("       %s set <key_name> <value>\n", modname);
+    if (level) {
+        puts("\nincr and decr default to 1, and create a missing key as 0 first.");
+        puts("Numbers can be given in decimal, hex (0x..) or octal (0..).");
+        puts("Keys must hold integers; use 'math set' to turn a key into one.");
+    }
+    return;
+}
+
+// parse a whole argument as a 64-bit number, in any base strtoull knows
+static int parse_num(const char *arg, uint64_t *out) {
+    char *end;
+
+    errno = 0;
+    *out = arg[0] == '-' ? (uint64_t)strtoll(arg, &end, 0) : strtoull(arg, &end, 0);
+    if (errno || end == arg || *end != '\0') {
+        fprintf(stderr, "%s: '%s' is not a number\n", modname, arg);
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+int cmd_math(int argc, char *argv[]) {
+    char key[SPLINTER_KEY_MAX] = { 0 };
+    char *tmp = getenv("SPLINTER_NS_PREFIX");
+    const char *op;
+    uint64_t arg = 1;
+    int64_t val = 0;
+    int rc;
+
+    if (argc < 3 || argc > 4) {
+        help_cmd_math(1);
+        return 1;
+    }
+
+    op = argv[1];
+    snprintf(key, sizeof(key) - 1, "%s%s", tmp == NULL ? "" : tmp, argv[2]);
+    if (argc == 4 && parse_num(argv[3], &arg) != 0)
+        return 1;
+
+    if (!strcmp(op, "incr")) {
+        rc = splinter_incr(key, (int64_t)arg, &val);
+    } else if (!strcmp(op, "decr")) {
+        rc = splinter_decr(key, (int64_t)arg, &val);
+    } else if (!strcmp(op, "get")) {
+        rc = splinter_get_int(key, &val);
+    } else if (argc == 4 && !strcmp(op, "set")) {
+        val = (int64_t)arg;
+        rc = splinter_set_int(key, val);
+    } else if (argc == 4 && (!strcmp(op, "and") || !strcmp(op, "or") || !strcmp(op, "xor"))) {
+        int64_t prev;
+        rc = op[0] == 'a' ? splinter_fetch_and(key, arg, &prev) :
+             op[0] == 'o' ? splinter_fetch_or(key, arg, &prev) :
+                            splinter_fetch_xor(key, arg, &prev);
+        val = (int64_t)(op[0] == 'a' ? (uint64_t)prev & arg :
+                        op[0] == 'o' ? (uint64_t)prev | arg : (uint64_t)prev ^ arg);
+    } else if (argc == 3 && !strcmp(op, "not")) {
+        int64_t prev;
+        rc = splinter_fetch_xor(key, UINT64_MAX, &prev);
+        val = ~prev;
+    } else {
+        help_cmd_math(1);
+        return 1;
+    }
+
+    if (rc != 0) {
+        if (errno == EINVAL)
+            fprintf(stderr, "%s: key '%s' does not hold an integer\n", modname, key);
+        else
+            fprintf(stderr, "%s: unable to update key '%s'\n", modname, key);
+        return rc;
+    }
+
+    printf("%s:%" PRId64 "\n", key, val);
+    return 0;
+}
@@ -0,0 +1,66 @@
+/**
+ * Copyright 2025 Tim Post
+ * License: Apache 2 (MIT available upon request to timthepost@protonmail.com)
+ *
+ * @file splinter_cli_cmd_reap.c
+ * @brief Implements the CLI 'reap' command.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "splinter_cli.h"
+
+static const char *modname = "reap";
+
+void help_cmd_reap(unsigned int level) {
+    printf("%s deletes expired keys so their slots can be reused.\n", modname);
+    printf("Usage: %s [interval_ms]\n", modname);
+    if (level) {
+        puts("\nWith no interval, makes one pass and reports how many keys it deleted.");
+        puts("With one, keeps reaping at that interval until sent SIGUSR1. Only one");
+        puts("process reaps a store at a time. Stores created with 'init --reaper' keep");
+        puts("a timing wheel, so each pass only costs what is expiring.");
+    }
+    return;
+}
+
+int cmd_reap(int argc, char *argv[]) {
+    unsigned long long interval = 0;
+    unsigned long total = 0;
+    char *end;
+    int n;
+
+    if (argc > 2) {
+        help_cmd_reap(1);
+        return 1;
+    }
+    if (argc == 2) {
+        errno = 0;
+        interval = strtoull(argv[1], &end, 10);
+        if (errno || end == argv[1] || *end != '\0' || interval == 0) {
+            fprintf(stderr, "%s: '%s' is not an interval in milliseconds\n", modname, argv[1]);
+            return 1;
+        }
+    }
+
+    do {
+        n = splinter_reap();
+        if (n < 0 && errno != EBUSY) {
+            fprintf(stderr, "%s: unable to reap: %s\n", modname, strerror(errno));
+            return 1;
+        }
+        if (n < 0 && !interval) {
+            fprintf(stderr, "%s: another process is reaping the store\n", modname);
+            return 1;
+        }
+        if (n > 0) total += (unsigned long)n;
+        if (interval) usleep((useconds_t)(interval * 1000));
+    } while (interval && !thisuser.abort);
+
+    thisuser.abort = 0;
+    printf("%s: %lu expired keys deleted\n", modname, total);
+    return 0;
+}
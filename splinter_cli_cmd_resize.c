@@ -0,0 +1,70 @@
+/**
+ * Copyright 2025 Tim Post
+ * License: Apache 2 (MIT available upon request to timthepost@protonmail.com)
+ *
+ * @file splinter_cli_cmd_resize.c
+ * @brief Implements the CLI 'resize' command.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "splinter_cli.h"
+
+static const char *modname = "resize";
+
+void help_cmd_resize(unsigned int level) {
+    printf("%s grows the store's slot table without taking it offline.\n", modname);
+    printf("Usage: %s <slots>\n", modname);
+    if (level) {
+        puts("\nKeys are moved to the new table while other processes keep reading and");
+        puts("writing. Stores only grow, up to the max_size shown by 'config'; the");
+        puts("maximum value size stays the same.");
+    }
+    return;
+}
+
+int cmd_resize(int argc, char *argv[]) {
+    splinter_header_snapshot_t snap = { 0 };
+    char *end;
+    unsigned long long slots;
+
+    if (argc != 2) {
+        help_cmd_resize(1);
+        return 1;
+    }
+
+    errno = 0;
+    slots = strtoull(argv[1], &end, 10);
+    if (errno || end == argv[1] || *end != '\0') {
+        fprintf(stderr, "%s: '%s' is not a slot count\n", modname, argv[1]);
+        return 1;
+    }
+
+    if (splinter_get_header_snapshot(&snap) != 0) {
+        fprintf(stderr, "%s: no store is open\n", modname);
+        return 1;
+    }
+    if (slots <= snap.slots) {
+        fprintf(stderr, "%s: the store already has %u slots, and can only grow\n", modname, snap.slots);
+        return 1;
+    }
+
+    if (splinter_resize((size_t)slots) != 0) {
+        if (errno == EFBIG)
+            fprintf(stderr, "%s: %llu slots would take the store past its max_size\n", modname, slots);
+        else if (errno == EBUSY)
+            fprintf(stderr, "%s: another process is resizing the store\n", modname);
+        else if (errno == ENOSPC)
+            fprintf(stderr, "%s: the new table filled up before every key moved; delete some and run %s again\n",
+                modname, modname);
+        else
+            fprintf(stderr, "%s: unable to resize: %s\n", modname, strerror(errno));
+        return 1;
+    }
+
+    splinter_get_header_snapshot(&snap);
+    printf("%s: %u slots, %lu keys\n", modname, snap.slots, snap.keys);
+    return 0;
+}
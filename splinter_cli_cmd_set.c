@@ -10,15 +10,18 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include "config.h"
 #include "splinter_cli.h"
 
 static const char *modname = "set";
 
 void help_cmd_set(unsigned int level) {
     printf("%s sets the value of a key in the store\n", modname);
-    printf("Usage: %s <key_name> \"<value>\"\n", modname);
-    if (level)
+    printf("Usage: %s <key_name> \"<value>\" [ttl_ms]\n", modname);
+    if (level) {
         puts("\nKeys without spaces do not need to be quoted.");
+        puts("With ttl_ms, the key expires that many milliseconds from now (see 'ttl').");
+    }
     return;
 }
 
@@ -32,5 +35,24 @@ int cmd_set(int argc, char *argv[]) {
     }
 
     snprintf(key, sizeof(key) -1, "%s%s", tmp == NULL ? "" : tmp, argv[1]);
-    return splinter_set(key, argv[2], strnlen(argv[2], 4096));
+    int rc;
+    if (argc > 3) {
+        char *end;
+        unsigned long long ttl = strtoull(argv[3], &end, 10);
+        if (end == argv[3] || *end != '\0') {
+            fprintf(stderr, "%s: '%s' is not a number of milliseconds\n", modname, argv[3]);
+            return 1;
+        }
+        rc = splinter_set_with_ttl(key, argv[2], strnlen(argv[2], 4096), (uint64_t)ttl);
+    } else {
+        rc = splinter_set(key, argv[2], strnlen(argv[2], 4096));
+    }
+
+    splinter_header_snapshot_t snap = { 0 };
+    if (splinter_get_header_snapshot(&snap) == 0 && snap.slots &&
+        (uint64_t)snap.used_slots * 100 >= (uint64_t)snap.slots * LOAD_WARN_PCT)
+        fprintf(stderr, "%s: warning: store is %u%% full%s; consider 'resize'\n", modname,
+            (unsigned)((uint64_t)snap.used_slots * 100 / snap.slots),
+            (uint64_t)snap.used_slots * 100 >= (uint64_t)snap.slots * LOAD_HIGH_PCT ? " and lookups are slowing" : "");
+    return rc;
 }
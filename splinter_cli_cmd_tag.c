@@ -0,0 +1,108 @@
+/**
+ * Copyright 2025 Tim Post
+ * License: Apache 2 (MIT available upon request to timthepost@protonmail.com)
+ *
+ * @file splinter_cli_cmd_tag.c
+ * @brief Implements the CLI 'tag' command.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "splinter_cli.h"
+
+static const char *modname = "tag";
+
+void help_cmd_tag(unsigned int level) {
+    printf("%s shows or changes a key's tags, or finds the keys that have them.\n", modname);
+    printf("Usage: %s <key_name> [tag ...]\n", modname);
+    printf("       %s --set <key_name> [tag ...]\n", modname);
+    printf("       %s --find <tag> [tag ...]\n", modname);
+    if (level) {
+        puts("\nWith no tags, shows the key's tag bloom. Otherwise the tags are added to");
+        puts("it; --set replaces them instead (with none, the key loses its tags).");
+        puts("--find lists every key that has all the tags given, from one scan of the");
+        puts("store's tag blooms. Tags are bloom filter bits, so now and then a key turns");
+        puts("up for a tag it was never given. Try 'export --tag' and 'watch --tag' too.");
+    }
+    return;
+}
+
+/**
+ * @brief Lists the keys that have every tag in mask.
+ */
+static int find_tagged(uint64_t mask) {
+    splinter_header_snapshot_t snap = { 0 };
+    uint64_t *bits = NULL;
+    char **keys = NULL;
+    size_t words, count = 0, i;
+    int rc = 1;
+
+    splinter_get_header_snapshot(&snap);
+    words = ((size_t)snap.slots + 63) / 64;
+    bits = calloc(words ? words : 1, sizeof(uint64_t));
+    keys = calloc(snap.slots ? snap.slots : 1, sizeof(char *));
+    if (bits == NULL || keys == NULL) {
+        fprintf(stderr, "%s: unable to allocate memory for the tag scan.\n", modname);
+        goto out;
+    }
+    if (splinter_find_tagged(mask, bits, words) < 0 ||
+        splinter_list_slots(bits, words, keys, snap.slots, &count) != 0) {
+        fprintf(stderr, "%s: unable to find tagged keys: %s\n", modname, strerror(errno));
+        goto out;
+    }
+    for (i = 0; i < count; i++)
+        puts(keys[i]);
+    // Empty line is intentional (and uniform throughout commands)
+    puts("");
+    rc = 0;
+out:
+    free(bits);
+    free(keys);
+    return rc;
+}
+
+int cmd_tag(int argc, char *argv[]) {
+    char key[SPLINTER_KEY_MAX] = { 0 };
+    char *tmp = getenv("SPLINTER_NS_PREFIX");
+    uint64_t mask = 0, tags = 0;
+    int i, first = 1, set = 0;
+
+    if (argc >= 2 && strcmp(argv[1], "--find") == 0) {
+        for (i = 2; i < argc; i++)
+            mask |= splinter_tag_mask(argv[i]);
+        if (!mask) {
+            help_cmd_tag(1);
+            return 1;
+        }
+        return find_tagged(mask);
+    }
+    if (argc >= 2 && strcmp(argv[1], "--set") == 0) {
+        set = 1;
+        first = 2;
+    }
+    if (argc <= first) {
+        help_cmd_tag(1);
+        return 1;
+    }
+
+    snprintf(key, sizeof(key) -1, "%s%s", tmp == NULL ? "" : tmp, argv[first]);
+    for (i = first + 1; i < argc; i++)
+        mask |= splinter_tag_mask(argv[i]);
+
+    if (set || mask) {
+        if ((set ? splinter_set_tags(key, mask) : splinter_add_tags(key, mask)) != 0) {
+            fprintf(stderr, "%s: unable to tag '%s': %s\n", modname, key, strerror(errno));
+            return 1;
+        }
+        return 0;
+    }
+
+    if (splinter_get_tags(key, &tags) != 0) {
+        fprintf(stderr, "%s: no such key: %s\n", modname, key);
+        return 1;
+    }
+    printf("0x%016llx\n", (unsigned long long)tags);
+    return 0;
+}
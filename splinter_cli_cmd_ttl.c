@@ -0,0 +1,63 @@
+/**
+ * Copyright 2025 Tim Post
+ * License: Apache 2 (MIT available upon request to timthepost@protonmail.com)
+ *
+ * @file splinter_cli_cmd_ttl.c
+ * @brief Implements the CLI 'ttl' command.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "splinter_cli.h"
+
+static const char *modname = "ttl";
+
+void help_cmd_ttl(unsigned int level) {
+    printf("%s shows or changes how long a key has left to live.\n", modname);
+    printf("Usage: %s <key_name> [milliseconds]\n", modname);
+    if (level) {
+        puts("\nWith no milliseconds, shows the time left. Otherwise the key expires that");
+        puts("long from now; 0 makes it permanent. Expired keys read as missing until");
+        puts("'reap' (or a later write) clears them out.");
+    }
+    return;
+}
+
+int cmd_ttl(int argc, char *argv[]) {
+    char key[SPLINTER_KEY_MAX] = { 0 };
+    char *tmp = getenv("SPLINTER_NS_PREFIX"), *end;
+    unsigned long long ms;
+    uint64_t left = 0;
+
+    if (argc < 2 || argc > 3) {
+        help_cmd_ttl(1);
+        return 1;
+    }
+
+    snprintf(key, sizeof(key) -1, "%s%s", tmp == NULL ? "" : tmp, argv[1]);
+    if (argc == 3) {
+        errno = 0;
+        ms = strtoull(argv[2], &end, 10);
+        if (errno || end == argv[2] || *end != '\0') {
+            fprintf(stderr, "%s: '%s' is not a number of milliseconds\n", modname, argv[2]);
+            return 1;
+        }
+        if (splinter_set_ttl(key, (uint64_t)ms) != 0) {
+            fprintf(stderr, "%s: unable to set the TTL of '%s': %s\n", modname, key, strerror(errno));
+            return 1;
+        }
+        return 0;
+    }
+
+    if (splinter_get_ttl(key, &left) != 0) {
+        fprintf(stderr, "%s: no such key: %s\n", modname, key);
+        return 1;
+    }
+    if (left)
+        printf("%lu ms\n", (unsigned long)left);
+    else
+        puts("no expiry");
+    return 0;
+}
@@ -0,0 +1,77 @@
+/**
+ * Copyright 2025 Tim Post
+ * License: Apache 2 (MIT available upon request to timthepost@protonmail.com)
+ *
+ * @file splinter_cli_cmd_verify.c
+ * @brief Implements the CLI 'verify' command.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "splinter_cli.h"
+
+static const char *modname = "verify";
+
+void help_cmd_verify(unsigned int level) {
+    printf("%s checks every value in the store against its checksum.\n", modname);
+    printf("Usage: %s [threads]\n", modname);
+    if (level) {
+        puts("\nThe scan uses one thread per CPU unless told otherwise, and prints the key");
+        puts("of every corrupt value it finds. Only stores created with 'init --checksums'");
+        puts("keep checksums. Keys being written during the scan are skipped.");
+    }
+    return;
+}
+
+int cmd_verify(int argc, char *argv[]) {
+    splinter_header_snapshot_t snap = { 0 };
+    char **keys = NULL, *end;
+    unsigned long threads = 0;
+    size_t count = 0, i;
+    int bad;
+
+    if (argc > 2) {
+        help_cmd_verify(1);
+        return 1;
+    }
+
+    if (argc == 2) {
+        errno = 0;
+        threads = strtoul(argv[1], &end, 10);
+        if (errno || end == argv[1] || *end != '\0') {
+            fprintf(stderr, "%s: '%s' is not a thread count\n", modname, argv[1]);
+            return 1;
+        }
+    }
+
+    if (splinter_get_header_snapshot(&snap) != 0) {
+        fprintf(stderr, "%s: no store is open\n", modname);
+        return 1;
+    }
+    if (!snap.checksums) {
+        fprintf(stderr, "%s: this store keeps no checksums (see 'init --checksums')\n", modname);
+        return 1;
+    }
+
+    keys = calloc(snap.slots ? snap.slots : 1, sizeof(char *));
+    if (keys == NULL) {
+        fprintf(stderr, "%s: unable to allocate memory for key names.\n", modname);
+        return 1;
+    }
+
+    bad = splinter_verify((unsigned int)threads, keys, snap.slots, &count);
+    if (bad < 0) {
+        fprintf(stderr, "%s: unable to verify: %s\n", modname, strerror(errno));
+        free(keys);
+        return 1;
+    }
+
+    for (i = 0; i < count; i++)
+        printf("corrupt: %.*s\n", SPLINTER_KEY_MAX, keys[i]);
+    printf("%s: %d corrupt value%s\n", modname, bad, bad == 1 ? "" : "s");
+
+    free(keys);
+    return bad ? 1 : 0;
+}
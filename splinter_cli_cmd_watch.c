@@ -13,12 +13,16 @@
 #include <stdlib.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <poll.h>
 
 #include "splinter_cli.h"
 #include "splinter.h"
 
 static const char *modname = "watch";
 
+/** @brief Most keys one watch command takes. */
+#define WATCH_MAX_KEYS 64
+
 // make terminal non-blocking
 void setup_terminal(void) {
     struct termios temp_tio;
@@ -53,10 +57,12 @@ void restore_terminal(void) {
 void help_cmd_watch(unsigned int level) {
     (void) level;
 
-    printf("Usage: %s <key_name_to_watch> [--oneshot]\n", modname);
-    printf("%s watches a single key in the current store for changes.\n", modname);
+    printf("Usage: %s <key_name_to_watch> [more keys ...] [--tag <tag> ...] [--oneshot]\n", modname);
+    printf("%s watches keys in the current store for changes.\n", modname);
     puts("If --oneshot is specified, watch will exit after one event.");
-    puts("\nMulti-key watches are coming in Splinter 0.9.4, anticipated May 2026.");
+    puts("--tag also watches every key that has all the tags given (see 'tag').");
+    puts("With more than one key (or any tag), each update is printed as key:length:value.");
+    puts("Keys that don't exist yet are reported once they're created.");
     puts("\nPressing CTRL-] will terminate a waiting watch.\n");
     
     return;
@@ -65,17 +71,22 @@ void help_cmd_watch(unsigned int level) {
 static const struct option long_options[] = {
     { "help", optional_argument, NULL, 'h' },
     { "oneshot", no_argument, NULL, 'o' },
+    { "tag", required_argument, NULL, 't' },
     {NULL, 0, NULL, 0}
 };
 
-static const char *optstring = "h:o";
+static const char *optstring = "h:ot:";
 
 int cmd_watch(int argc, char *argv[]) {
     size_t msg_sz = 0;
-    char c, msg[4096], key[SPLINTER_KEY_MAX] = { 0 };
+    char c, msg[4096];
+    char keys[WATCH_MAX_KEYS][SPLINTER_KEY_MAX];
+    const char *key_ptrs[WATCH_MAX_KEYS], *tags[WATCH_MAX_KEYS];
+    splinter_watch_event_t ev[WATCH_MAX_KEYS];
     char *tmp = getenv("SPLINTER_NS_PREFIX");
-    int rc = -1, opt = 0;
+    int i, n, nkeys = 0, ntags = 0, opt = 0;
     unsigned int oneshot = 0;
+    splinter_watch_t *w;
 
     while ((opt = getopt_long(argc, argv, optstring, long_options, NULL)) != -1) {
         switch (opt) {
@@ -85,6 +96,10 @@ int cmd_watch(int argc, char *argv[]) {
             case 'o':
                 oneshot = 1;
                 break;
+            case 't':
+                if (ntags < WATCH_MAX_KEYS)
+                    tags[ntags++] = optarg;
+                break;
             case '?':
                 help_cmd_watch(1);
                 break;
@@ -94,53 +109,82 @@ int cmd_watch(int argc, char *argv[]) {
         }
     }
 
-    if (optind < argc)
-        snprintf(key, sizeof(key) -1, "%s%s", tmp == NULL ? "" : tmp, argv[optind++]);
+    for (; optind < argc && nkeys < WATCH_MAX_KEYS; optind++, nkeys++) {
+        snprintf(keys[nkeys], sizeof(keys[nkeys]) - 1, "%s%s", tmp == NULL ? "" : tmp, argv[optind]);
+        key_ptrs[nkeys] = keys[nkeys];
+    }
 
-    if (! key[0]) {
-        fprintf(stderr, "Usage: %s <key> [--oneshot]\nTry 'help ext watch' for help.\n", modname);
+    if (! nkeys && ! ntags) {
+        fprintf(stderr, "Usage: %s <key> [more keys ...] [--tag <tag> ...] [--oneshot]\nTry 'help ext watch' for help.\n", modname);
+        return -1;
+    }
+
+    w = splinter_watch_create();
+    if (w == NULL || splinter_watch_add(w, key_ptrs, (size_t)nkeys) != 0 ||
+        (ntags && splinter_watch_add_tagged(w, tags, (size_t)ntags) < 0)) {
+        perror(modname);
+        splinter_watch_destroy(w);
+        return -1;
+    }
+
+    // one poll() covers the keyboard and every key we watch
+    struct pollfd fds[2] = {
+        { .fd = STDIN_FILENO, .events = POLLIN },
+        { .fd = splinter_watch_fd(w), .events = POLLIN },
+    };
+    if (fds[1].fd < 0) {
+        perror(modname);
+        splinter_watch_destroy(w);
         return -1;
     }
 
     setup_terminal();
     
     while (! thisuser.abort) {
-        if (read(STDIN_FILENO, &c, 1) == 1) {
-            if (c == 29) {  // Ctrl-] is ASCII 29
+        if (poll(fds, 2, -1) < 0 && errno != EINTR)
+            break;
+
+        if (fds[0].revents) {
+            ssize_t got = read(STDIN_FILENO, &c, 1);
+            if (got == 1 && c == 29) {  // Ctrl-] is ASCII 29
                 tcflush(STDERR_FILENO, TCIFLUSH);
                 thisuser.abort = 1;
                 break;
             }
-        }
-        
-        rc = splinter_poll(key, 100);
-        if (rc == -1) {
-            fprintf(stderr, "%s: invalid key: '%s'\n", modname, key);
-            restore_terminal();
-            return -1;
+            if (got == 0 || fds[0].revents & (POLLHUP | POLLERR))
+                fds[0].fd = -1; // not a terminal (or closed); stop polling it
         }
 
-        if (rc == 0) {
-            if (splinter_get(key, msg, sizeof(msg), &msg_sz) != 0) {
-                fprintf(stderr,
-                        "splinter_logtee: failed to read key %s after update.\n",
-                        key);
-                return -1;
-            }
+        if (!(fds[1].revents & POLLIN))
+            continue;
+        uint64_t count;
+        if (read(fds[1].fd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+            break;
+
+        n = splinter_watch_wait(w, 0, ev, WATCH_MAX_KEYS);
+        for (i = 0; i < n; i++) {
+            if (ev[i].epoch == 0)
+                continue; // deleted; we'll see it again if it comes back
+            if (splinter_get(ev[i].key, msg, sizeof(msg), &msg_sz) != 0)
+                continue; // deleted again already
+            if (nkeys > 1 || ntags)
+                fprintf(stdout, "%s:", ev[i].key);
             fprintf(stdout, "%lu:", msg_sz);
             fwrite(msg, 1, msg_sz, stdout);
             fputc('\n', stdout);
-            fflush(stdout);
             if (oneshot) {
                 // just raise it on behalf of the user since they specified it
                 thisuser.abort = 1;
+                break;
             }
         }
+        fflush(stdout);
     }
 
     puts(""); // GET ends with one blank line, so we emulate that here as well.
     thisuser.abort = 0;
     restore_terminal();
+    splinter_watch_destroy(w);
     
     return 0;
 }
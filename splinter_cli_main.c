@@ -166,6 +166,87 @@ cli_module_t command_modules[] = {
         &cmd_export,
         &help_cmd_export
     },
+    {
+        14,
+        "math",
+        4,
+        "Atomic arithmetic and bitwise ops on integer keys.",
+        -1,
+        &cmd_math,
+        &help_cmd_math
+    },
+    {
+        15,
+        "resize",
+        6,
+        "Grow the store's slot table while it stays in use.",
+        -1,
+        &cmd_resize,
+        &help_cmd_resize
+    },
+    {
+        16,
+        "verify",
+        6,
+        "Check every value in the store against its checksum.",
+        -1,
+        &cmd_verify,
+        &help_cmd_verify
+    },
+    {
+        17,
+        "ttl",
+        3,
+        "Show or change how long a key has left to live.",
+        -1,
+        &cmd_ttl,
+        &help_cmd_ttl
+    },
+    {
+        18,
+        "reap",
+        4,
+        "Delete expired keys, once or at an interval.",
+        -1,
+        &cmd_reap,
+        &help_cmd_reap
+    },
+    {
+        19,
+        "tag",
+        3,
+        "Show or change a key's tags, or find the keys that have them.",
+        -1,
+        &cmd_tag,
+        &help_cmd_tag
+    },
+    {
+        20,
+        "embed",
+        5,
+        "Show or set a key's embedding vector.",
+        -1,
+        &cmd_embed,
+        &help_cmd_embed
+    },
+    {
+        21,
+        "knn",
+        3,
+        "Find the keys whose embeddings are nearest to a key's or a vector.",
+        -1,
+        &cmd_knn,
+        &help_cmd_knn
+    },
+    {
+        22,
+        "ann",
+        3,
+        "Find about the nearest keys to a key's embedding or a vector, from the graph.",
+        -1,
+        &cmd_ann,
+        &help_cmd_ann
+    },
     // The last null-filled element 
     { 0, NULL, 0, NULL, -1,  NULL , NULL }
 };
@@ -277,12 +358,16 @@ static void completion(const char *buf, linenoiseCompletions *lc) {
     if (buf[0] == '\0') return;
 
     switch (buf[0]) {
+        case 'a':
+            linenoiseAddCompletion(lc, "ann");
+            break;
         case 'c':
             linenoiseAddCompletion(lc, "clear");
             linenoiseAddCompletion(lc, "config");
             break;
         case 'e':
             linenoiseAddCompletion(lc, "export");
+            linenoiseAddCompletion(lc, "embed");
             break;
         case 'g':
             linenoiseAddCompletion(lc, "get");
@@ -295,16 +380,33 @@ static void completion(const char *buf, linenoiseCompletions *lc) {
         case 'i':
             linenoiseAddCompletion(lc, "init");
             break;
+        case 'k':
+            linenoiseAddCompletion(lc, "knn");
+            break;
         case 'l':
             linenoiseAddCompletion(lc, "list");
             break;
+        case 'm':
+            linenoiseAddCompletion(lc, "math");
+            break;
+        case 'r':
+            linenoiseAddCompletion(lc, "resize");
+            linenoiseAddCompletion(lc, "reap");
+            break;
         case 's':
             linenoiseAddCompletion(lc, "set");
             break;
+        case 't':
+            linenoiseAddCompletion(lc, "ttl");
+            linenoiseAddCompletion(lc, "tag");
+            break;
         case 'u':
             linenoiseAddCompletion(lc, "use");
             linenoiseAddCompletion(lc, "unset");
             break;
+        case 'v':
+            linenoiseAddCompletion(lc, "verify");
+            break;
         case 'w':
             linenoiseAddCompletion(lc, "watch");
             break;
@@ -365,6 +467,12 @@ static char *hints(const char *buf, int *color, int *bold) {
         return "ist ";
     }
 
+    if (!strncasecmp(buf, "m", 4)) {
+        *color = 36;
+        *bold = 1;
+        return "ath ";
+    }
+
     if (!strncasecmp(buf, "hi", 4)) {
         *color = 36;
         *bold = 1;
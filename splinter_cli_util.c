@@ -10,6 +10,7 @@
 #include <errno.h>
 #include <string.h>
 #include <limits.h>
+#include <unistd.h>
 
 #include "splinter_cli.h"
 
@@ -51,6 +52,8 @@ int cli_run_module(int idx, int argc, char *argv[]) {
         errno = EINVAL;
         return -1;
     }
+    // modules parse their own argv with getopt; make each one start afresh
+    optind = 0;
     return command_modules[idx].entry(argc, argv);
 }
 
@@ -101,7 +104,7 @@ void cli_show_key_config(const char *key, const char *caller) {
 
     printf("hash:     %lu\n", snap.hash);
     printf("epoch:    %lu\n", snap.epoch);
-    printf("val_off:  %u\n", snap.val_off);
+    printf("val_off:  %lu\n", snap.val_off);
     printf("val_len:  %u\n", snap.val_len);
     printf("key:      %s\n", snap.key);
     puts("");
@@ -123,3 +126,106 @@ int cli_safer_atoi(const char *string) {
         exit(EXIT_FAILURE);
     }
 }
+
+static const char *evict_names[] = { "none", "clock", "ttl", "oldest" };
+
+// SPLINTER_EVICT_* for a policy name, or -1 if there's no such policy.
+int cli_evict_policy(const char *name) {
+    for (int i = 0; i < (int) (sizeof(evict_names) / sizeof(evict_names[0])); i++) {
+        if (!strcmp(name, evict_names[i]))
+            return i;
+    }
+    return -1;
+}
+
+const char *cli_evict_name(unsigned int policy) {
+    return policy < sizeof(evict_names) / sizeof(evict_names[0]) ? evict_names[policy] : "unknown";
+}
+
+static const char *metric_names[] = { "dot", "cosine", "l2" };
+
+// SPLINTER_METRIC_* for a metric name, or -1 if there's no such metric.
+int cli_metric(const char *name) {
+    for (int i = 0; i < (int) (sizeof(metric_names) / sizeof(metric_names[0])); i++) {
+        if (!strcmp(name, metric_names[i]))
+            return i;
+    }
+    return -1;
+}
+
+const char *cli_metric_name(unsigned int metric) {
+    return metric < sizeof(metric_names) / sizeof(metric_names[0]) ? metric_names[metric] : "unknown";
+}
+
+// Parses "x,y,..." into exactly dim floats; 0 on success, -1 if it isn't that.
+int cli_parse_vector(const char *csv, float *out, unsigned int dim) {
+    const char *p = csv;
+    char *end;
+
+    for (unsigned int i = 0; i < dim; i++) {
+        out[i] = strtof(p, &end);
+        if (end == p || (*end != (i + 1 < dim ? ',' : '\0')))
+            return -1;
+        p = end + 1;
+    }
+    return 0;
+}
+
+// Fills query from target: a vector if it parses as one, otherwise the
+// embedding of the key it names. 0 on success, -1 (after saying why) if not.
+int cli_query_vector(const char *target, float *query, unsigned int dim, const char *caller) {
+    char key[SPLINTER_KEY_MAX] = { 0 };
+    char *tmp = getenv("SPLINTER_NS_PREFIX");
+
+    if (cli_parse_vector(target, query, dim) == 0)
+        return 0;
+    snprintf(key, sizeof(key) -1, "%s%s", tmp == NULL ? "" : tmp, target);
+    if (splinter_get_embeddings(key, query) != 0) {
+        fprintf(stderr, "%s: unable to read the embedding of '%s': %s\n", caller, key,
+            errno == ENODATA ? "it has none" : strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+// The body of knn and ann: runs search for count (or CLI_NEAREST_K) hits
+// nearest target and prints them, nearest first. Returns the exit status.
+int cli_nearest(const char *target, const char *count, unsigned int dim, cli_search_t search,
+    void *arg, const char *caller) {
+    splinter_knn_hit_t *hits = NULL;
+    float *query = NULL;
+    int rc = 1, found, i;
+    size_t k = CLI_NEAREST_K;
+
+    if (count != NULL) {
+        int n = cli_safer_atoi(count);
+        if (n <= 0) {
+            fprintf(stderr, "%s: count must be a positive number.\n", caller);
+            return 1;
+        }
+        k = (size_t) n;
+    }
+    query = calloc(dim, sizeof(float));
+    hits = calloc(k, sizeof(*hits));
+    if (query == NULL || hits == NULL) {
+        fprintf(stderr, "%s: unable to allocate memory for the search.\n", caller);
+        goto out;
+    }
+    if (cli_query_vector(target, query, dim, caller) != 0)
+        goto out;
+
+    found = search(query, k, hits, arg);
+    if (found < 0) {
+        fprintf(stderr, "%s: search failed: %s\n", caller, strerror(errno));
+        goto out;
+    }
+    for (i = 0; i < found; i++)
+        printf("%-*s %g\n", 32, hits[i].key, hits[i].score);
+    // Empty line is intentional (and uniform throughout commands)
+    puts("");
+    rc = 0;
+out:
+    free(query);
+    free(hits);
+    return rc;
+}
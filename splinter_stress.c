@@ -29,6 +29,7 @@ typedef struct {
     int test_duration_ms;
     int num_keys;
     int writer_period_us;
+    int evict_policy;
 } cfg_t;
 
 typedef struct {
@@ -44,6 +45,7 @@ typedef struct {
     atomic_int get_oversize;
     atomic_int set_full;
     atomic_int set_too_big;
+    uint64_t evicted;
 } counters_t;
 
 typedef struct {
@@ -227,6 +229,8 @@ static void print_stats(cfg_t *cfg, counters_t *c, long ms) {
     printf("Throughput         : %.0f ops/sec\n", ops);
     printf("Get                : ok=%d fail=%d (miss=%d, oversize=%d)\n", okg, fget, gmiss, goversize);
     printf("Set                : ok=%d fail=%d (full=%d, too_big=%d)\n", oks, fset, sfull, stbig);
+    if (cfg->evict_policy != SPLINTER_EVICT_NONE)
+        printf("Evicted            : %lu keys\n", (unsigned long) c->evicted);
     printf("Integrity failures : %d\n", bad);
     printf("Retries (EAGAIN)   : %d (%.2f%% of gets, %.2f per successful get)\n\n",
            retries,
@@ -249,7 +253,14 @@ static void usage(const char *prog) {
     fprintf(stderr,
         "usage: %s [--threads N] [--duration-ms D] [--keys K] [--store NAME]\n"
         "          [--slots S] [--max-value B] [--writer-us U]\n"
-        "          [--quiet] [--keep-test-store]\n", prog);
+        "          [--evict none|clock|ttl|oldest] [--quiet] [--keep-test-store]\n", prog);
+}
+
+static int evict_policy(const char *name) {
+    static const char *names[] = { "none", "clock", "ttl", "oldest" };
+    for (int i = 0; i < 4; i++)
+        if (!strcmp(name, names[i])) return i;
+    return -1;
 }
 
 int main(int argc, char **argv) {
@@ -296,6 +307,8 @@ int main(int argc, char **argv) {
         else if (!strcmp(argv[i], "--slots") && i+1 < argc) cfg.slots = atoi(argv[++i]);
         else if (!strcmp(argv[i], "--max-value") && i+1 < argc) cfg.max_value_size = atoi(argv[++i]);
         else if (!strcmp(argv[i], "--writer-us") && i+1 < argc) cfg.writer_period_us = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--evict") && i+1 < argc &&
+                 (cfg.evict_policy = evict_policy(argv[++i])) >= 0) continue;
         else if (!strcmp(argv[i], "--quiet")) quiet = 1;
         else if (!strcmp(argv[i], "--keep-test-store")) keep_store = 1;
         else { usage(argv[0]); return 2; }
@@ -308,6 +321,7 @@ int main(int argc, char **argv) {
     }
 
     splinter_set_av(0);
+    splinter_set_evict_policy((uint32_t) cfg.evict_policy);
 
     char **keys = calloc((size_t)cfg.num_keys, sizeof(char*));
     if (!keys) { perror("calloc"); return 1; }
@@ -402,6 +416,8 @@ int main(int argc, char **argv) {
 
     for (i = 0; i < cfg.num_threads; i++) pthread_join(th[i], NULL);
     long elapsed = now_ms() - start;
+    splinter_header_snapshot_t snap = {0};
+    if (splinter_get_header_snapshot(&snap) == 0) ctr.evicted = snap.evicted;
     splinter_close();
     if (! keep_store) {
 #ifndef SPLINTER_PERSISTENT
@@ -7,6 +7,10 @@
 #include <errno.h>
 #include <unistd.h>
 #include <linux/limits.h>
+#include <sys/wait.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <time.h>
 #include "splinter.h"
 #include "config.h"
 
@@ -33,10 +37,53 @@ static pid_t pid = 0;
 #define PATH_MAX 4096
 #endif
 
+// Key scans: counts the keys visited (keeping the first 64 and the last), noting any out of order
+struct scan_log {
+  char keys[64][SPLINTER_KEY_MAX];
+  char last[SPLINTER_KEY_MAX];
+  int n, sorted, stable, stop_at;
+};
+
+// Embeddings: a repeatable pseudo-random vector for key number n
+#define EMBED_DIM 37
+static void embed_fill(float *v, int n) {
+  uint32_t x = 2654435761u * (uint32_t)(n + 1);
+  for (int j = 0; j < EMBED_DIM; j++) {
+    x = x * 1664525u + 1013904223u;
+    v[j] = (float)(x >> 8) / (float)(1u << 24) - 0.5f;
+  }
+}
+
+// The score splinter_knn() should give v against q, worked out the slow way
+static double embed_score(const float *q, const float *v, int metric) {
+  double qv = 0, qq = 0, vv = 0;
+  for (int j = 0; j < EMBED_DIM; j++) {
+    qv += (double)q[j] * v[j];
+    qq += (double)q[j] * q[j];
+    vv += (double)v[j] * v[j];
+  }
+  if (metric == SPLINTER_METRIC_COSINE) {
+    double x = qq * vv, r = x > 1 ? x : 1;
+    for (int i = 0; i < 64; i++) r = (r + x / r) / 2; // sqrt, without libm
+    return qv / r;
+  }
+  if (metric == SPLINTER_METRIC_L2) return qq - 2 * qv + vv;
+  return qv;
+}
+
+static int scan_collect(const char *key, void *arg) {
+  struct scan_log *log = arg;
+  if (log->n && strcmp(log->last, key) >= 0) log->sorted = 0;
+  snprintf(log->last, SPLINTER_KEY_MAX, "%s", key);
+  if (log->n < 64) snprintf(log->keys[log->n], SPLINTER_KEY_MAX, "%s", key);
+  log->stable += strchr(key, '~') == NULL;
+  return ++log->n == log->stop_at;
+}
+
 int main(void) {
   char bus[16] = { 0 };
   char buspath[PATH_MAX] = { 0 };
-  printf("1..26\n");
+  printf("1..109\n");
   pid = getpid();
 
   snprintf(bus, 16, "%d-tap-test", pid);
@@ -114,8 +161,943 @@ int main(void) {
   TEST("length of header_snap is 5: h e l l o", snap1.val_len == 5);
   splinter_unset("header_snap");
 
+  // Test 27 - 29: Poll sleeps until a writer in another process wakes it
+  struct timespec t0, t1;
+  TEST("set poll key", splinter_set("poll_key", "v0", 2) == 0);
+  errno = 0;
+  TEST("poll times out with ETIMEDOUT", splinter_poll("poll_key", 20) == -2 && errno == ETIMEDOUT);
+  pid_t child = fork();
+  if (child == 0) {
+    usleep(50000);
+    splinter_set("poll_key", "v1", 2);
+    _exit(0);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  int poll_rc = splinter_poll("poll_key", 5000);
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  waitpid(child, NULL, 0);
+  TEST("poll wakes on cross-process set well before timeout",
+    poll_rc == 0 && (t1.tv_sec - t0.tv_sec) < 2);
+  splinter_unset("poll_key");
+
+  // Test 30 - 34: Handle API (second mapping of the same store + a second store)
+  char bus2[32] = { 0 };
+  snprintf(bus2, sizeof(bus2), "%d-tap-test-2", pid);
+  splinter_store_t *st1 = splinter_store_open(bus);
+  splinter_store_t *st2 = splinter_store_create(bus2, 100, 256);
+  TEST("open existing store as a handle", st1 != NULL);
+  TEST("create second store as a handle", st2 != NULL);
+  TEST("handle sees default store writes",
+    splinter_store_get(st1, test_key, buf, sizeof(buf), &out_sz) == 0 && out_sz == strlen(new_value));
+  TEST("set through second handle", splinter_store_set(st2, "only_in_2", "x", 1) == 0);
+  TEST("stores are isolated", splinter_get("only_in_2", NULL, 0, NULL) != 0);
+  splinter_store_close(st1);
+  splinter_store_close(st2);
+
+  // Test 35 - 39: Tombstones keep probe chains intact in a tiny, colliding store
+  char bus3[32] = { 0 }, k[16];
+  snprintf(bus3, sizeof(bus3), "%d-tap-test-3", pid);
+  splinter_store_t *st3 = splinter_store_create(bus3, 4, 16);
+  int i, chain_ok = 1;
+  for (i = 0; i < 4; i++) {
+    snprintf(k, sizeof(k), "chain-%d", i);
+    if (splinter_store_set(st3, k, k, strlen(k)) != 0) chain_ok = 0;
+  }
+  errno = 0;
+  TEST("full store rejects new key with ENOSPC",
+    chain_ok && splinter_store_set(st3, "one-too-many", "x", 1) == -1 && errno == ENOSPC);
+  splinter_store_unset(st3, "chain-0");
+  for (i = 1; i < 4; i++) {
+    snprintf(k, sizeof(k), "chain-%d", i);
+    if (splinter_store_get(st3, k, NULL, 0, NULL) != 0) chain_ok = 0;
+  }
+  TEST("keys past a deleted slot are still found", chain_ok);
+  errno = 0;
+  TEST("miss reports ENOENT", splinter_store_get(st3, "chain-0", NULL, 0, NULL) == -1 && errno == ENOENT);
+  TEST("tombstoned slot is reused", splinter_store_set(st3, "chain-4", "y", 1) == 0);
+  size_t nkeys = 0;
+  char *keys[8];
+  splinter_store_set(st3, "chain-2", "z", 1);
+  splinter_store_list(st3, keys, 8, &nkeys);
+  TEST("updating a key behind a tombstone does not duplicate it", nkeys == 4);
+  splinter_store_close(st3);
+
+  // Test 40 - 42: Hash selection and slot indexing
+  splinter_header_snapshot_t hsnap = { 0 };
+  splinter_get_header_snapshot(&hsnap);
+  TEST("default hash is the seeded word-at-a-time hash",
+    hsnap.hash_alg == SPLINTER_HASH_WY && hsnap.hash_seed != 0);
+#ifndef SPLINTER_PERSISTENT
+  snprintf(buspath, sizeof(buspath) -1, "/dev/shm/%s", bus3);
+#else
+  snprintf(buspath, sizeof(buspath) -1, "./%s", bus3);
+#endif /* SPLINTER_PERSISTENT */
+  unlink(buspath);
+  splinter_create_opts_t opts = { .slots = 1024, .max_value_sz = 16, .hash_alg = SPLINTER_HASH_FNV1A };
+  st3 = splinter_store_create_ex(bus3, &opts);
+  memset(&hsnap, 0, sizeof(hsnap));
+  TEST("create_ex honours the hash option",
+    st3 && splinter_store_get_header_snapshot(st3, &hsnap) == 0 && hsnap.hash_alg == SPLINTER_HASH_FNV1A);
+  chain_ok = 1;
+  for (i = 0; i < 500; i++) {
+    snprintf(k, sizeof(k), "key-%d", i);
+    if (splinter_store_set(st3, k, "v", 1) != 0) chain_ok = 0;
+  }
+  for (i = 0; i < 500; i++) {
+    snprintf(k, sizeof(k), "key-%d", i);
+    if (splinter_store_get(st3, k, NULL, 0, NULL) != 0) chain_ok = 0;
+  }
+  splinter_store_get_header_snapshot(st3, &hsnap);
+  TEST("500 keys in a power-of-two store stay on short probe chains", chain_ok && hsnap.max_probe < 64);
+  splinter_slot_snapshot_t ksnap = { 0 };
+  TEST("values start on cache-line boundaries",
+    splinter_store_get_slot_snapshot(st3, "key-7", &ksnap) == 0 && ksnap.val_off % 64 == 0 &&
+    strcmp(ksnap.key, "key-7") == 0);
+  splinter_store_close(st3);
+
+  // Test 44 - 48: Shared value arena
+#ifndef SPLINTER_PERSISTENT
+  snprintf(buspath, sizeof(buspath) -1, "/dev/shm/%s", bus3);
+#else
+  snprintf(buspath, sizeof(buspath) -1, "./%s", bus3);
+#endif /* SPLINTER_PERSISTENT */
+  unlink(buspath);
+  static char big[16384];
+  memset(big, 'b', sizeof(big));
+  splinter_create_opts_t aopts = { .slots = 64, .max_value_sz = sizeof(big), .arena_sz = 64 * 1024 };
+  st3 = splinter_store_create_ex(bus3, &aopts);
+  chain_ok = st3 != NULL;
+  for (i = 0; st3 && i < 32; i++) {
+    snprintf(k, sizeof(k), "small-%d", i);
+    if (splinter_store_set(st3, k, k, strlen(k)) != 0) chain_ok = 0;
+  }
+  TEST("arena store holds small values without reserving max_value_sz each", chain_ok);
+  TEST("arena store holds a large value",
+    splinter_store_set(st3, "small-0", big, sizeof(big)) == 0 &&
+    splinter_store_get(st3, "small-0", buf, sizeof(buf), &out_sz) == -1 && errno == EMSGSIZE &&
+    out_sz == sizeof(big));
+  TEST("value shrinks back into a small block",
+    splinter_store_set(st3, "small-0", "tiny", 4) == 0 &&
+    splinter_store_get(st3, "small-0", buf, sizeof(buf), &out_sz) == 0 && out_sz == 4 &&
+    memcmp(buf, "tiny", 4) == 0);
+  memset(&hsnap, 0, sizeof(hsnap));
+  splinter_store_get_header_snapshot(st3, &hsnap);
+  uint64_t used = hsnap.arena_used;
+  splinter_store_unset(st3, "small-1");
+  splinter_store_set(st3, "reuse", "r", 1);
+  splinter_store_get_header_snapshot(st3, &hsnap);
+  TEST("freed blocks are reused", hsnap.arena_used == used);
+  chain_ok = 1;
+  for (i = 0; i < 5 && chain_ok; i++)
+    chain_ok = splinter_store_append(st3, "grow", "0123456789abcdefghijklmnopqrstuvwxyz", 36) == 0;
+  chain_ok = chain_ok && splinter_store_get(st3, "grow", buf, sizeof(buf), &out_sz) == 0 &&
+    out_sz == 180 && memcmp(buf + 144, "0123456789", 10) == 0 && memcmp(buf + 36, "0123", 4) == 0;
+  TEST("append keeps the value intact as it moves up size classes", chain_ok);
+  int set_rc = 0;
+  for (i = 0; i < 8 && set_rc == 0; i++) {
+    snprintf(k, sizeof(k), "huge-%d", i);
+    set_rc = splinter_store_set(st3, k, big, sizeof(big));
+  }
+  TEST("exhausted arena reports ENOSPC", set_rc == -1 && errno == ENOSPC);
+
+  const void *vptr = NULL;
+  size_t vlen = 0;
+  uint64_t vepoch = 0;
+  TEST("get_view points at the value in place",
+    splinter_store_get_view(st3, "reuse", &vptr, &vlen, &vepoch) == 0 &&
+    vlen == 1 && memcmp(vptr, "r", 1) == 0 && (vepoch & 1) == 0);
+  TEST("view is valid until the key is written",
+    splinter_store_view_valid(st3, "reuse", vepoch) == 1);
+  splinter_store_set(st3, "reuse", "R", 1);
+  TEST("view is invalid after an update",
+    splinter_store_view_valid(st3, "reuse", vepoch) == 0);
+  splinter_store_get_view(st3, "reuse", &vptr, &vlen, &vepoch);
+  splinter_store_unset(st3, "reuse");
+  splinter_store_set(st3, "reuse", "R", 1);
+  TEST("view is invalid after delete and re-insert",
+    splinter_store_view_valid(st3, "reuse", vepoch) == 0 &&
+    splinter_store_get_view(st3, "nope", &vptr, &vlen, &vepoch) == -1 && errno == ENOENT);
+  splinter_store_close(st3);
+
+  // Change feed
+#ifndef SPLINTER_PERSISTENT
+  snprintf(buspath, sizeof(buspath) -1, "/dev/shm/%s", bus3);
+#else
+  snprintf(buspath, sizeof(buspath) -1, "./%s", bus3);
+#endif /* SPLINTER_PERSISTENT */
+  unlink(buspath);
+  splinter_create_opts_t fopts = { .slots = 64, .max_value_sz = 64, .feed_len = 6 };
+  st3 = splinter_store_create_ex(bus3, &fopts);
+  uint64_t cursor = 0;
+  splinter_change_t changes[8];
+  memset(&hsnap, 0, sizeof(hsnap));
+  TEST("feed length rounds up to a power of two; stores without one say ENOTSUP",
+    st3 && splinter_store_get_header_snapshot(st3, &hsnap) == 0 && hsnap.feed_len == 8 &&
+    splinter_store_feed_cursor(st3, &cursor) == 0 && cursor == 0 &&
+    splinter_feed_cursor(&cursor) == -1 && errno == ENOTSUP);
+  cursor = 0;
+  splinter_store_set(st3, "a", "1", 1);
+  splinter_store_set(st3, "b", "2", 1);
+  splinter_store_unset(st3, "a");
+  TEST("feed returns sets and unsets in order, with keys the slots still hold",
+    splinter_store_feed_read(st3, &cursor, changes, 8) == 3 && cursor == 3 &&
+    changes[0].op == SPLINTER_CHANGE_SET && changes[0].key[0] == '\0' &&
+    changes[1].op == SPLINTER_CHANGE_SET && strcmp(changes[1].key, "b") == 0 &&
+    changes[2].op == SPLINTER_CHANGE_UNSET && changes[2].hash == changes[0].hash &&
+    changes[2].slot == changes[0].slot && changes[2].seq == 3 &&
+    splinter_store_feed_read(st3, &cursor, changes, 8) == 0);
+  for (i = 0; i < 9; i++) splinter_store_set(st3, "b", "3", 1);
+  TEST("a reader lapped by the ring gets EOVERFLOW, and can resume from a new cursor",
+    splinter_store_feed_read(st3, &cursor, changes, 8) == -1 && errno == EOVERFLOW &&
+    splinter_store_feed_cursor(st3, &cursor) == 0 && cursor == 12 &&
+    splinter_store_set(st3, "c", "4", 1) == 0 &&
+    splinter_store_feed_read(st3, &cursor, changes, 8) == 1 && strcmp(changes[0].key, "c") == 0);
+  splinter_store_close(st3);
+
+  // Mapping flags (huge pages and mlock are best-effort, so only the layout is checked)
+  unlink(buspath);
+  splinter_create_opts_t mopts = { .slots = 64, .max_value_sz = 64, .map_flags = 0x80 };
+  TEST("unknown mapping flags are rejected",
+    splinter_store_create_ex(bus3, &mopts) == NULL && errno == ENOTSUP);
+  mopts.map_flags = SPLINTER_MAP_HUGEPAGES | SPLINTER_MAP_PREFAULT | SPLINTER_MAP_LOCK;
+  st3 = splinter_store_create_ex(bus3, &mopts);
+  struct stat mst;
+  chain_ok = st3 && splinter_store_set(st3, "m", "mapped", 6) == 0;
+  splinter_store_close(st3);
+  st3 = splinter_store_open(bus3);
+  memset(&hsnap, 0, sizeof(hsnap));
+  TEST("hugepage stores are sized in whole huge pages, and reopen with their flags",
+    chain_ok && st3 && stat(buspath, &mst) == 0 && mst.st_size % (2 << 20) == 0 &&
+    splinter_store_get_header_snapshot(st3, &hsnap) == 0 && hsnap.map_flags == mopts.map_flags &&
+    splinter_store_get(st3, "m", buf, sizeof(buf), &out_sz) == 0 && out_sz == 6);
+  splinter_store_close(st3);
+  mopts.map_flags = 0;
+  st3 = splinter_store_create_ex(bus3, &mopts);
+  TEST("create refuses to clobber an existing store",
+    st3 == NULL && errno == EEXIST && (st3 = splinter_store_open(bus3)) != NULL &&
+    splinter_store_get(st3, "m", buf, sizeof(buf), &out_sz) == 0 && out_sz == 6);
+  splinter_store_close(st3);
+
+  // Batches span more than one prefetch window
+  const char *mkeys[40];
+  const void *mvals[40];
+  size_t mlens[40], msz[40];
+  void *mbufs[40];
+  int merrs[40];
+  char mkbuf[40][16], mvbuf[40][16], mout[40][16];
+  for (i = 0; i < 40; i++) {
+    snprintf(mkbuf[i], sizeof(mkbuf[i]), "batch-%d", i);
+    snprintf(mvbuf[i], sizeof(mvbuf[i]), "value-%d", i);
+    mkeys[i] = mkbuf[i];
+    mvals[i] = mvbuf[i];
+    mlens[i] = strlen(mvbuf[i]);
+    mbufs[i] = mout[i];
+    msz[i] = sizeof(mout[i]);
+  }
+  splinter_get_header_snapshot(&hsnap);
+  uint64_t batch_epoch = hsnap.epoch;
+  mlens[39] = 0;
+  TEST("mset writes every valid key and flags the bad one",
+    splinter_mset(mkeys, mvals, mlens, 40, merrs) == 39 && merrs[0] == 0 && merrs[39] == EINVAL);
+  splinter_get_header_snapshot(&hsnap);
+  TEST("mset counts every write in the global epoch", hsnap.epoch == batch_epoch + 39);
+  size_t mout_sz[40];
+  chain_ok = splinter_mget(mkeys, 40, mbufs, msz, mout_sz, merrs) == 39 && merrs[39] == ENOENT;
+  for (i = 0; i < 39 && chain_ok; i++)
+    chain_ok = merrs[i] == 0 && mout_sz[i] == strlen(mvbuf[i]) &&
+      memcmp(mout[i], mvbuf[i], mout_sz[i]) == 0;
+  TEST("mget reads back each key with its own length and result", chain_ok);
+
+  uint32_t tokens[3] = { 101, 202, 303 };
+  struct iovec parts[3] = {
+    { .iov_base = "head:", .iov_len = 5 },
+    { .iov_base = tokens, .iov_len = sizeof(tokens) },
+    { .iov_base = ":tail", .iov_len = 5 },
+  };
+  TEST("setv stores the joined pieces",
+    splinter_setv("gather", parts, 3) == 0 &&
+    splinter_get("gather", buf, sizeof(buf), &out_sz) == 0 && out_sz == 10 + sizeof(tokens) &&
+    memcmp(buf, "head:", 5) == 0 && memcmp(buf + 5 + sizeof(tokens), ":tail", 5) == 0);
+  char vhead[5];
+  uint32_t vtokens[3] = { 0 };
+  char vtail[16];
+  struct iovec outs[3] = {
+    { .iov_base = vhead, .iov_len = sizeof(vhead) },
+    { .iov_base = vtokens, .iov_len = sizeof(vtokens) },
+    { .iov_base = vtail, .iov_len = sizeof(vtail) },
+  };
+  TEST("getv scatters the value across buffers",
+    splinter_getv("gather", outs, 3, &out_sz) == 0 && out_sz == 10 + sizeof(tokens) &&
+    memcmp(vhead, "head:", 5) == 0 && vtokens[2] == 303 && memcmp(vtail, ":tail", 5) == 0);
+  TEST("getv reports EMSGSIZE when the buffers are too small",
+    splinter_getv("gather", outs, 2, &out_sz) == -1 && errno == EMSGSIZE);
+
+  TEST("append creates, then extends a value",
+    splinter_append("stream", "The", 3) == 0 && splinter_append("stream", " quick", 6) == 0 &&
+    splinter_get("stream", buf, sizeof(buf), &out_sz) == 0 && out_sz == 9 &&
+    memcmp(buf, "The quick", 9) == 0);
+  TEST("get_from returns only the bytes past the offset",
+    splinter_append("stream", " fox", 4) == 0 &&
+    splinter_get_from("stream", 9, buf, sizeof(buf), &out_sz) == 0 && out_sz == 4 &&
+    memcmp(buf, " fox", 4) == 0);
+  TEST("set_range patches in place and zero-fills a gap",
+    splinter_set_range("stream", 4, "slick", 5) == 0 &&
+    splinter_set_range("stream", 15, "!", 1) == 0 &&
+    splinter_get("stream", buf, sizeof(buf), &out_sz) == 0 && out_sz == 16 &&
+    memcmp(buf, "The slick fox\0\0!", 16) == 0);
+  TEST("writes past max_value_sz fail with EMSGSIZE, get_from past the end with ERANGE",
+    splinter_set_range("stream", 4095, "xy", 2) == -1 && errno == EMSGSIZE &&
+    splinter_get_from("stream", 17, buf, sizeof(buf), &out_sz) == -1 && errno == ERANGE);
+
+  int64_t ival = 0, iprev = 0;
+  TEST("incr creates a missing counter",
+    splinter_incr("counter", 5, &ival) == 0 && ival == 5 &&
+    splinter_decr("counter", 7, &ival) == 0 && ival == -2);
+  TEST("bitwise ops return the previous value",
+    splinter_set_int("flags", 0x0f) == 0 &&
+    splinter_fetch_or("flags", 0xf0, &iprev) == 0 && iprev == 0x0f &&
+    splinter_fetch_and("flags", 0x3c, &iprev) == 0 && iprev == 0xff &&
+    splinter_fetch_xor("flags", ~0ull, &iprev) == 0 && iprev == 0x3c &&
+    splinter_get_int("flags", &ival) == 0 && ival == ~(int64_t)0x3c);
+  TEST("integer keys read back as 8 bytes through get",
+    splinter_get("counter", buf, sizeof(buf), &out_sz) == 0 && out_sz == sizeof(int64_t) &&
+    memcmp(buf, &(int64_t){ -2 }, sizeof(int64_t)) == 0);
+  TEST("integer ops reject byte values, partial writes reject integers",
+    splinter_incr("stream", 1, NULL) == -1 && errno == EINVAL &&
+    splinter_append("counter", "x", 1) == -1 && errno == EINVAL &&
+    splinter_get_int("stream", &ival) == -1 && errno == EINVAL);
+  splinter_set_int("counter", 0);
+  for (i = 0; i < 4; i++) {
+    if (fork() == 0) {
+      for (int n = 0; n < 10000; n++) splinter_incr("counter", 1, NULL);
+      _exit(0);
+    }
+  }
+  for (i = 0; i < 4; i++) wait(NULL);
+  TEST("concurrent increments from several processes are never lost",
+    splinter_get_int("counter", &ival) == 0 && ival == 40000);
+  TEST("set turns an integer key back into bytes",
+    splinter_set("counter", "n/a", 3) == 0 &&
+    splinter_incr("counter", 1, NULL) == -1 && errno == EINVAL);
+
+  const void *cptr;
+  size_t clen;
+  uint64_t cepoch;
+  splinter_get_view("stream", &cptr, &clen, &cepoch);
+  TEST("set_if_epoch succeeds once per epoch and fails with ESTALE after",
+    splinter_set_if_epoch("stream", cepoch, "mine", 4) == 0 &&
+    splinter_set_if_epoch("stream", cepoch, "late", 4) == -1 && errno == ESTALE &&
+    splinter_set_if_epoch("stream", 0, "new", 3) == -1 && errno == ESTALE &&
+    splinter_set_if_epoch("fresh", 0, "new", 3) == 0 &&
+    splinter_get("stream", buf, sizeof(buf), &out_sz) == 0 && out_sz == 4 &&
+    memcmp(buf, "mine", 4) == 0);
+  TEST("set_if_eq/lt/gt only write when the comparison holds",
+    splinter_set_int("level", 10) == 0 &&
+    splinter_set_if_eq("level", 9, 1) == -1 && errno == ECANCELED &&
+    splinter_set_if_lt("level", 10, 1) == -1 && errno == ECANCELED &&
+    splinter_set_if_gt("level", 5, 20) == 0 &&
+    splinter_set_if_lt("level", 21, 7) == 0 &&
+    splinter_set_if_eq("level", 7, -3) == 0 &&
+    splinter_get_int("level", &ival) == 0 && ival == -3 &&
+    splinter_set_if_eq("stream", 0, 1) == -1 && errno == EINVAL &&
+    splinter_set_if_eq("nobody", 0, 1) == -1 && errno == ENOENT);
+  splinter_set_int("level", 0);
+  for (i = 0; i < 4; i++) {
+    if (fork() == 0) {
+      for (int n = 0; n < 2000; n++) {
+        int64_t cur;
+        do {
+          splinter_get_int("level", &cur);
+        } while (splinter_set_if_eq("level", cur, cur + 1) != 0);
+      }
+      _exit(0);
+    }
+  }
+  for (i = 0; i < 4; i++) wait(NULL);
+  TEST("compare-and-set loops from several processes lose no updates",
+    splinter_get_int("level", &ival) == 0 && ival == 8000);
+
+  splinter_watch_t *w = splinter_watch_create();
+  splinter_watch_event_t wev[8];
+  const char *wkeys[] = { "w1", "w2", "w3" };
+  splinter_set("w1", "a", 1);
+  splinter_set("w2", "b", 1);
+  splinter_unset("w3");
+  TEST("watch set reports each changed key once, including keys created later",
+    w && splinter_watch_add(w, wkeys, 3) == 0 &&
+    splinter_watch_wait(w, 0, wev, 8) == -2 && errno == ETIMEDOUT &&
+    splinter_set("w1", "c", 1) == 0 && splinter_set("w1", "d", 1) == 0 &&
+    splinter_set("w3", "e", 1) == 0 &&
+    splinter_watch_wait(w, 0, wev, 8) == 2 &&
+    strcmp(wev[0].key, "w1") == 0 && strcmp(wev[1].key, "w3") == 0 && wev[1].epoch != 0 &&
+    splinter_watch_wait(w, 0, wev, 8) == -2);
+  TEST("watch set reports deletes with epoch 0 and forgets ejected keys",
+    splinter_unset("w2") > 0 &&
+    splinter_watch_wait(w, 0, wev, 8) == 1 && strcmp(wev[0].key, "w2") == 0 && wev[0].epoch == 0 &&
+    splinter_watch_eject(w, wkeys, 1) == 1 && splinter_set("w1", "f", 1) == 0 &&
+    splinter_watch_wait(w, 0, wev, 8) == -2);
+  int wfd = splinter_watch_fd(w);
+  if (fork() == 0) {
+    usleep(50000);
+    splinter_set("w3", "g", 1);
+    _exit(0);
+  }
+  struct pollfd pfd = { .fd = wfd, .events = POLLIN };
+  uint64_t wcount = 0;
+  TEST("watch fd wakes poll() for a write from another process",
+    wfd >= 0 && poll(&pfd, 1, 2000) == 1 && read(wfd, &wcount, sizeof(wcount)) == sizeof(wcount) &&
+    splinter_watch_wait(w, 0, wev, 8) == 1 && strcmp(wev[0].key, "w3") == 0);
+  wait(NULL);
+  splinter_watch_destroy(w);
+
+  // Online resize: fixed values, then an arena store with writers in other processes
+#ifndef SPLINTER_PERSISTENT
+  snprintf(buspath, sizeof(buspath) -1, "/dev/shm/%s", bus3);
+#else
+  snprintf(buspath, sizeof(buspath) -1, "./%s", bus3);
+#endif /* SPLINTER_PERSISTENT */
+  unlink(buspath);
+  char rkey[32], rval[32];
+  splinter_create_opts_t ropts = { .slots = 64, .max_value_sz = 64, .feed_len = 128 };
+  st3 = splinter_store_create_ex(bus3, &ropts);
+  chain_ok = st3 != NULL;
+  for (i = 0; chain_ok && i < 60; i++) {
+    snprintf(rkey, sizeof(rkey), "r%d", i);
+    chain_ok = splinter_store_set(st3, rkey, rkey, strlen(rkey)) == 0;
+  }
+  splinter_store_unset(st3, "r0");
+  chain_ok = chain_ok && splinter_store_resize(st3, 200) == 0;
+  for (i = 1; chain_ok && i < 60; i++) {
+    snprintf(rkey, sizeof(rkey), "r%d", i);
+    chain_ok = splinter_store_get(st3, rkey, buf, sizeof(buf), &out_sz) == 0 &&
+               out_sz == strlen(rkey) && memcmp(buf, rkey, out_sz) == 0;
+  }
+  memset(&hsnap, 0, sizeof(hsnap));
+  TEST("resize moves every key to the bigger table",
+    chain_ok && splinter_store_get_header_snapshot(st3, &hsnap) == 0 &&
+    hsnap.slots == 200 && hsnap.keys == 59 && hsnap.used_slots == 59 && hsnap.gen == 2 &&
+    splinter_store_set(st3, "r0", "back", 4) == 0);
+  TEST("resize only grows, and stops at max_size",
+    splinter_store_resize(st3, 200) == -2 && errno == EINVAL &&
+    splinter_store_resize(st3, 1 << 20) == -1 && errno == EFBIG &&
+    splinter_store_get(st3, "r0", buf, sizeof(buf), &out_sz) == 0 && out_sz == 4);
+  splinter_store_close(st3);
+  unlink(buspath);
+
+  ropts.arena_sz = 1 << 20;
+  ropts.slots = 512;
+  st3 = splinter_store_create_ex(bus3, &ropts);
+  chain_ok = st3 != NULL;
+  for (i = 0; chain_ok && i < 200; i++) {
+    snprintf(rkey, sizeof(rkey), "base%d", i);
+    chain_ok = splinter_store_set(st3, rkey, rkey, strlen(rkey)) == 0;
+  }
+  for (i = 0; i < 2; i++) {
+    if (fork() == 0) {
+      int bad = 0;
+      for (int n = 0; n < 20000; n++) {
+        snprintf(rkey, sizeof(rkey), "c%d-%d", i, n % 100);
+        snprintf(rval, sizeof(rval), "%d", n);
+        while (splinter_store_set(st3, rkey, rval, strlen(rval)) != 0)
+          if (errno != EAGAIN) bad++;
+        if (splinter_store_get(st3, "base7", buf, sizeof(buf), &out_sz) == 0 &&
+            (out_sz != 5 || memcmp(buf, "base7", 5) != 0))
+          bad++;
+      }
+      _exit(bad != 0);
+    }
+  }
+  usleep(2000); // let the writers get going
+  chain_ok = chain_ok && splinter_store_resize(st3, 1024) == 0 && splinter_store_resize(st3, 4096) == 0;
+  int rstatus, rfail = 0;
+  for (i = 0; i < 2; i++) {
+    wait(&rstatus);
+    rfail |= !WIFEXITED(rstatus) || WEXITSTATUS(rstatus) != 0;
+  }
+  for (i = 0; chain_ok && i < 200; i++) {
+    snprintf(rkey, sizeof(rkey), "c%d-%d", i / 100, i % 100);
+    snprintf(rval, sizeof(rval), "%d", 19900 + i % 100);
+    chain_ok = splinter_store_get(st3, rkey, buf, sizeof(buf), &out_sz) == 0 &&
+               out_sz == strlen(rval) && memcmp(buf, rval, out_sz) == 0;
+    snprintf(rkey, sizeof(rkey), "base%d", i);
+    chain_ok = chain_ok && splinter_store_get(st3, rkey, buf, sizeof(buf), &out_sz) == 0;
+  }
+  memset(&hsnap, 0, sizeof(hsnap));
+  TEST("arena store resizes twice while other processes write, losing nothing",
+    chain_ok && !rfail && splinter_store_get_header_snapshot(st3, &hsnap) == 0 &&
+    hsnap.slots == 4096 && hsnap.keys == 400 && hsnap.gen == 4);
+  splinter_store_close(st3);
+  st3 = splinter_store_open(bus3);
+  TEST("a resized store reopens with its keys",
+    st3 && splinter_store_get(st3, "base199", buf, sizeof(buf), &out_sz) == 0 && out_sz == 7);
+  splinter_store_close(st3);
+  unlink(buspath);
+
+  // Value checksums: appends extend the sum, large values take the interleaved CRC path
+  static char cval[40000];
+  for (i = 0; i < (int)sizeof(cval); i++) cval[i] = (char)(i * 7 + 3);
+  splinter_create_opts_t copts = { .slots = 64, .max_value_sz = 1 << 16, .arena_sz = 1 << 20, .checksums = 1 };
+  st3 = splinter_store_create_ex(bus3, &copts);
+  chain_ok = st3 && splinter_store_set(st3, "c1", "hello", 5) == 0 &&
+             splinter_store_append(st3, "c1", " world", 6) == 0 &&
+             splinter_store_append(st3, "c1", cval, sizeof(cval)) == 0 &&
+             splinter_store_set(st3, "c2", cval, 1000) == 0 &&
+             splinter_store_set_int(st3, "c3", 42) == 0 && splinter_store_incr(st3, "c3", 1, NULL) == 0;
+  static char cbuf[sizeof(cval) + 16];
+  TEST("checksummed values read back through get_checked; other stores say ENOTSUP",
+    chain_ok && splinter_store_get_checked(st3, "c1", cbuf, sizeof(cbuf), &out_sz) == 0 &&
+    out_sz == sizeof(cval) + 11 && memcmp(cbuf + 11, cval, sizeof(cval)) == 0 &&
+    splinter_store_get_checked(st3, "c3", cbuf, sizeof(cbuf), &out_sz) == 0 &&
+    splinter_store_verify(st3, 2, NULL, 0, NULL) == 0 &&
+    splinter_get_checked(test_key, buf, sizeof(buf), &out_sz) == -1 && errno == ENOTSUP);
+  const void *cview;
+  char *ckeys[4];
+  size_t ccount = 0;
+  chain_ok = splinter_store_get_view(st3, "c2", &cview, &out_sz, &cepoch) == 0;
+  if (chain_ok) ((char *)cview)[500] ^= 1; // flip a bit behind the library's back
+  TEST("a corrupted value fails get_checked with EBADMSG, and verify names it",
+    chain_ok && splinter_store_get_checked(st3, "c2", cbuf, sizeof(cbuf), &out_sz) == -1 && errno == EBADMSG &&
+    splinter_store_verify(st3, 0, ckeys, 4, &ccount) == 1 && ccount == 1 && strcmp(ckeys[0], "c2") == 0 &&
+    splinter_store_get(st3, "c2", cbuf, sizeof(cbuf), &out_sz) == 0);
+  memset(&hsnap, 0, sizeof(hsnap));
+  chain_ok = splinter_store_set(st3, "c2", "fixed", 5) == 0 && splinter_store_resize(st3, 256) == 0;
+  TEST("rewriting a value repairs its checksum, and checksums survive a resize",
+    chain_ok && splinter_store_verify(st3, 0, NULL, 0, NULL) == 0 &&
+    splinter_store_get_checked(st3, "c1", cbuf, sizeof(cbuf), &out_sz) == 0 &&
+    splinter_store_get_header_snapshot(st3, &hsnap) == 0 && hsnap.checksums == 1);
+  splinter_store_close(st3);
+  unlink(buspath);
+
+  // TTLs: lazy expiry, reclaiming full tables, and the reaper
+  splinter_create_opts_t topts = { .slots = 16, .max_value_sz = 64 };
+  uint64_t ttl = 0, tepoch = 0;
+  char *tkeys[32];
+  size_t tcount = 0;
+  st3 = splinter_store_create_ex(bus3, &topts);
+  chain_ok = st3 && splinter_store_set_with_ttl(st3, "t1", "soon", 4, 30) == 0 &&
+             splinter_store_get_ttl(st3, "t1", &ttl) == 0 && ttl > 0 && ttl <= 30 &&
+             splinter_store_get(st3, "t1", buf, sizeof(buf), &out_sz) == 0;
+  usleep(50000);
+  memset(&hsnap, 0, sizeof(hsnap));
+  TEST("an expired key reads as missing, and writing it again starts it afresh",
+    chain_ok && splinter_store_get(st3, "t1", buf, sizeof(buf), &out_sz) == -1 && errno == ENOENT &&
+    splinter_store_list(st3, tkeys, 32, &tcount) == 0 && tcount == 0 &&
+    splinter_store_incr(st3, "t1", 5, NULL) == 0 && splinter_store_get_ttl(st3, "t1", &ttl) == 0 && ttl == 0 &&
+    splinter_store_get_header_snapshot(st3, &hsnap) == 0 && hsnap.keys == 1 && hsnap.expired == 1);
+  chain_ok = splinter_store_set(st3, "t2", "v", 1) == 0 &&
+             splinter_store_get_view(st3, "t2", &cview, &out_sz, &tepoch) == 0 &&
+             splinter_store_set_ttl(st3, "t2", 100000) == 0 &&
+             splinter_store_get_ttl(st3, "t2", &ttl) == 0 && ttl > 90000 &&
+             splinter_store_view_valid(st3, "t2", tepoch) == 1 &&
+             splinter_store_set(st3, "t2", "w", 1) == 0 &&
+             splinter_store_get_ttl(st3, "t2", &ttl) == 0 && ttl > 90000;
+  TEST("set_ttl only changes the expiry, plain sets keep it, and 0 makes a key permanent",
+    chain_ok && splinter_store_set_ttl(st3, "t2", 0) == 0 && splinter_store_get_ttl(st3, "t2", &ttl) == 0 && ttl == 0 &&
+    splinter_store_set_ttl(st3, "nope", 10) == -1 && errno == ENOENT);
+  for (i = 0; i < 14; i++) {
+    snprintf(rkey, sizeof(rkey), "f%d", i);
+    splinter_store_set_with_ttl(st3, rkey, "x", 1, 20);
+  }
+  chain_ok = splinter_store_set(st3, "full", "x", 1) == -1 && errno == ENOSPC;
+  usleep(40000);
+  TEST("a full table gives up expired slots to writers, and the reaper sweeps the rest",
+    chain_ok && splinter_store_set(st3, "full", "x", 1) == 0 &&
+    splinter_store_reap(st3) == 13 && splinter_store_reap(st3) == 0 &&
+    splinter_store_list(st3, tkeys, 32, &tcount) == 0 && tcount == 3);
+  splinter_store_close(st3);
+  unlink(buspath);
+
+  topts = (splinter_create_opts_t){ .slots = 64, .max_value_sz = 64, .feed_len = 64, .expiry_log_len = 16 };
+  st3 = splinter_store_create_ex(bus3, &topts);
+  chain_ok = st3 != NULL;
+  for (i = 0; chain_ok && i < 15; i++) {
+    snprintf(rkey, sizeof(rkey), "%s%d", i < 10 ? "short" : "long", i);
+    chain_ok = splinter_store_set_with_ttl(st3, rkey, "x", 1, i < 10 ? 60 : 100000) == 0;
+  }
+  chain_ok = chain_ok && splinter_store_set_with_ttl(st3, "mid", "x", 1, 200) == 0 &&
+             splinter_store_set(st3, "keep", "x", 1) == 0 &&
+             splinter_store_reap(st3) == 0 && splinter_store_set_ttl(st3, "long10", 1) == 0;
+  usleep(100000);
+  int reaped_due = splinter_store_reap(st3);
+  usleep(150000);
+  int reaped_mid = splinter_store_reap(st3);
+  static splinter_change_t tchanges[64];
+  int tfeed = 0, tunsets = 0;
+  cursor = 0;
+  if (chain_ok) tfeed = splinter_store_feed_read(st3, &cursor, tchanges, 64);
+  for (i = 0; i < tfeed; i++) tunsets += tchanges[i].op == SPLINTER_CHANGE_UNSET;
+  memset(&hsnap, 0, sizeof(hsnap));
+  TEST("the reaper's timing wheel deletes keys as they come due, and the feed sees them go",
+    chain_ok && reaped_due == 11 && reaped_mid == 1 && tunsets == 12 &&
+    splinter_store_get_header_snapshot(st3, &hsnap) == 0 && hsnap.expiry_log_len == 16 &&
+    hsnap.keys == 5 && hsnap.expired == 12 &&
+    splinter_store_get(st3, "long11", buf, sizeof(buf), &out_sz) == 0);
+  splinter_store_close(st3);
+  unlink(buspath);
+
+  // Eviction: full stores make room instead of failing, by policy
+  splinter_create_opts_t eopts = { .slots = 16, .max_value_sz = 64, .evict_policy = SPLINTER_EVICT_CLOCK };
+  int ehot = 0;
+  st3 = splinter_store_create_ex(bus3, &eopts);
+  chain_ok = st3 != NULL;
+  for (i = 0; chain_ok && i < 16; i++) {
+    snprintf(rkey, sizeof(rkey), "e%d", i);
+    chain_ok = splinter_store_set(st3, rkey, "x", 1) == 0;
+  }
+  // every key starts out recently used, so the first eviction can take any of them
+  chain_ok = chain_ok && splinter_store_set(st3, "new0", "x", 1) == 0;
+  for (int round = 1; chain_ok && round <= 6; round++) {
+    ehot = 0;
+    for (i = 0; i < 6; i++) {
+      snprintf(rkey, sizeof(rkey), "e%d", i);
+      ehot += splinter_store_get(st3, rkey, buf, sizeof(buf), &out_sz) == 0;
+    }
+    snprintf(rkey, sizeof(rkey), "new%d", round);
+    chain_ok = splinter_store_set(st3, rkey, "x", 1) == 0;
+  }
+  int ehot_after = 0;
+  for (i = 0; i < 6; i++) {
+    snprintf(rkey, sizeof(rkey), "e%d", i);
+    ehot_after += splinter_store_get(st3, rkey, buf, sizeof(buf), &out_sz) == 0;
+  }
+  memset(&hsnap, 0, sizeof(hsnap));
+  TEST("a CLOCK store evicts instead of filling up, sparing keys that are being read",
+    chain_ok && ehot >= 5 && ehot_after == ehot &&
+    splinter_store_get(st3, "new6", buf, sizeof(buf), &out_sz) == 0 &&
+    splinter_store_get_header_snapshot(st3, &hsnap) == 0 && hsnap.keys == 16 && hsnap.evicted == 7 &&
+    hsnap.evict_policy == SPLINTER_EVICT_CLOCK && splinter_store_get_evict_policy(st3) == SPLINTER_EVICT_CLOCK);
+  chain_ok = splinter_store_set_evict_policy(st3, SPLINTER_EVICT_OLDEST) == 0 &&
+             splinter_store_set_evict_policy(st3, 99) == -2 &&
+             splinter_store_set(st3, "new6", "y", 1) == 0;
+  // the oldest write left is whichever of e0..e15 survived with the lowest number
+  char eoldest[sizeof(rkey)] = { 0 };
+  for (i = 0; chain_ok && i < 16 && !eoldest[0]; i++) {
+    snprintf(rkey, sizeof(rkey), "e%d", i);
+    if (splinter_store_get(st3, rkey, buf, sizeof(buf), &out_sz) == 0) snprintf(eoldest, sizeof(eoldest), "%s", rkey);
+  }
+  TEST("an OLDEST store evicts the key written longest ago",
+    chain_ok && eoldest[0] && splinter_store_set(st3, "newer", "x", 1) == 0 &&
+    splinter_store_get(st3, eoldest, buf, sizeof(buf), &out_sz) == -1 && errno == ENOENT &&
+    splinter_store_get(st3, "new6", buf, sizeof(buf), &out_sz) == 0);
+  TEST("with eviction off, a full store still says ENOSPC",
+    splinter_store_set_evict_policy(st3, SPLINTER_EVICT_NONE) == 0 &&
+    splinter_store_set(st3, "last", "x", 1) == -1 && errno == ENOSPC &&
+    splinter_store_get(st3, "newer", buf, sizeof(buf), &out_sz) == 0);
+  splinter_store_close(st3);
+  unlink(buspath);
+
+  // Ordered key index: prefix and range scans, with and without an index
+  splinter_create_opts_t iopts = { .slots = 512, .max_value_sz = 32, .key_index = 1 };
+  struct scan_log slog;
+  st3 = splinter_store_create_ex(bus3, &iopts);
+  chain_ok = st3 != NULL;
+  for (i = 0; chain_ok && i < 300; i++) {
+    int n = (i * 7919) % 300; // every key once, out of order
+    snprintf(rkey, sizeof(rkey), "%s::%03d", n % 3 == 0 ? "alpha" : n % 3 == 1 ? "beta" : "gamma", n);
+    chain_ok = splinter_store_set(st3, rkey, "x", 1) == 0;
+  }
+  slog = (struct scan_log){ .sorted = 1 };
+  int iprefix = chain_ok ? splinter_store_scan_prefix(st3, "beta::", scan_collect, &slog) : -1;
+  int iprefix_ok = iprefix == 100 && slog.n == 100 && slog.sorted && strcmp(slog.keys[0], "beta::001") == 0 &&
+                   strcmp(slog.last, "beta::298") == 0;
+  slog = (struct scan_log){ .sorted = 1 };
+  int irange = splinter_store_scan_range(st3, "alpha::150", "beta::", scan_collect, &slog);
+  int irange_ok = irange == 50 && slog.sorted && strcmp(slog.keys[0], "alpha::150") == 0;
+  slog = (struct scan_log){ .sorted = 1, .stop_at = 5 };
+  TEST("an indexed store scans a prefix or range in order, stopping where asked",
+    iprefix_ok && irange_ok &&
+    splinter_store_scan_range(st3, NULL, NULL, scan_collect, &slog) == 5 && strcmp(slog.keys[0], "alpha::000") == 0 &&
+    splinter_store_scan_prefix(st3, "delta::", scan_collect, &slog) == 0 &&
+    splinter_store_scan_range(st3, "a", "b", NULL, NULL) == -2);
+  chain_ok = splinter_store_unset(st3, "beta::001") > 0 && splinter_store_unset(st3, "beta::004") > 0 &&
+             splinter_store_set_ttl(st3, "beta::007", 1) == 0 && splinter_store_set(st3, "beta::010", "y", 1) == 0;
+  usleep(5000);
+  slog = (struct scan_log){ .sorted = 1 };
+  iprefix = splinter_store_scan_prefix(st3, "beta::", scan_collect, &slog);
+  iprefix_ok = iprefix == 97 && slog.sorted && strcmp(slog.keys[0], "beta::010") == 0;
+  slog = (struct scan_log){ .sorted = 1 };
+  memset(&hsnap, 0, sizeof(hsnap));
+  TEST("deleted and expired keys drop out of scans, and new ones come in where they sort",
+    chain_ok && iprefix_ok && splinter_store_set(st3, "beta::001", "z", 1) == 0 &&
+    splinter_store_scan_prefix(st3, "beta::", scan_collect, &slog) == 98 && strcmp(slog.keys[0], "beta::001") == 0 &&
+    splinter_store_get_header_snapshot(st3, &hsnap) == 0 && hsnap.key_index == 1);
+  // Other processes keep creating and deleting keys in the middle of the
+  // range ("beta::NNN~c" sorts right after "beta::NNN") while we scan it.
+  for (i = 0; i < 2; i++) {
+    if (fork() == 0) {
+      char ck[32];
+      for (int n = 0; n < 20000; n++) {
+        snprintf(ck, sizeof(ck), "beta::%03d~%d", (n * 3 + 1) % 300, i);
+        splinter_store_set(st3, ck, "c", 1);
+        splinter_store_unset(st3, ck);
+      }
+      _exit(0);
+    }
+  }
+  int iscans = 0, iscan_bad = 0, ikids = 2;
+  while (ikids > 0 || iscans < 20) {
+    slog = (struct scan_log){ .sorted = 1 };
+    int n = splinter_store_scan_prefix(st3, "beta::", scan_collect, &slog);
+    iscan_bad += n != slog.n || slog.stable != 98 || !slog.sorted;
+    iscans++;
+    while (ikids > 0 && waitpid(-1, NULL, WNOHANG) > 0) ikids--;
+  }
+  TEST("scans visit every key in order, once, while other processes create and delete keys",
+    iscan_bad == 0 && iscans >= 20);
+  chain_ok = splinter_store_resize(st3, 1024) == 0;
+  slog = (struct scan_log){ .sorted = 1 };
+  iprefix_ok = chain_ok && splinter_store_scan_prefix(st3, "alpha::", scan_collect, &slog) == 100 && slog.sorted &&
+               strcmp(slog.keys[0], "alpha::000") == 0;
+  splinter_store_close(st3);
+  unlink(buspath);
+  iopts.key_index = 0;
+  st3 = splinter_store_create_ex(bus3, &iopts);
+  chain_ok = st3 != NULL;
+  for (i = 0; chain_ok && i < 300; i++) {
+    snprintf(rkey, sizeof(rkey), "%s::%03d", i % 3 == 0 ? "alpha" : i % 3 == 1 ? "beta" : "gamma", i);
+    chain_ok = splinter_store_set(st3, rkey, "x", 1) == 0;
+  }
+  slog = (struct scan_log){ .sorted = 1 };
+  memset(&hsnap, 0, sizeof(hsnap));
+  TEST("the index survives a resize, and stores without one scan the same keys",
+    iprefix_ok && chain_ok && splinter_store_scan_prefix(st3, "gamma::", scan_collect, &slog) == 100 &&
+    slog.sorted && strcmp(slog.keys[0], "gamma::002") == 0 &&
+    splinter_store_scan_range(st3, "alpha::150", "beta::", NULL, NULL) == -2 &&
+    splinter_store_get_header_snapshot(st3, &hsnap) == 0 && hsnap.key_index == 0);
+  splinter_store_close(st3);
+  unlink(buspath);
+
+  // Tag blooms: 1000 slots, so the last bitmap word is a partial one
+  splinter_create_opts_t gopts = { .slots = 1000, .max_value_sz = 32 };
+  uint64_t s42 = splinter_tag_mask("session:42"), red = splinter_tag_mask("color:red"), tags = 0;
+  uint64_t tbits[16];
+  st3 = splinter_store_create_ex(bus3, &gopts);
+  chain_ok = st3 != NULL && s42 != 0 && s42 == splinter_tag_mask("session:42") && s42 != red;
+  for (i = 0; chain_ok && i < 600; i++) {
+    snprintf(rkey, sizeof(rkey), "tk%d", i);
+    chain_ok = splinter_store_set(st3, rkey, "x", 1) == 0 &&
+               splinter_store_add_tags(st3, rkey, (i % 3 == 0 ? s42 : 0) | (i % 5 == 0 ? red : 0)) == 0;
+  }
+  TEST("tags are added to, replaced on and read from existing keys only",
+    chain_ok && splinter_store_get_tags(st3, "tk15", &tags) == 0 && tags == (s42 | red) &&
+    splinter_store_set(st3, "tk15", "yy", 2) == 0 && splinter_store_get_tags(st3, "tk15", &tags) == 0 &&
+    tags == (s42 | red) && splinter_store_set_tags(st3, "tk12", red) == 0 &&
+    splinter_store_get_tags(st3, "tk12", &tags) == 0 && tags == red &&
+    splinter_store_add_tags(st3, "nope", s42) == -1 && errno == ENOENT &&
+    splinter_store_get_tags(st3, "nope", &tags) == -1 &&
+    splinter_store_unset(st3, "tk3") > 0 && splinter_store_set(st3, "tk3", "x", 1) == 0 &&
+    splinter_store_get_tags(st3, "tk3", &tags) == 0 && tags == 0);
+  // tk3 lost its tags, tk12 had s42 taken away; tk9 expires
+  chain_ok = splinter_store_set_ttl(st3, "tk9", 1) == 0;
+  usleep(5000);
+  int tfound = splinter_store_find_tagged(st3, s42, tbits, 16), tlisted = 0, tbad = 0;
+  char *lkeys[1000];
+  size_t lcount = 0;
+  chain_ok = chain_ok && splinter_store_list_slots(st3, tbits, 16, lkeys, 1000, &lcount) == 0;
+  for (size_t k = 0; chain_ok && k < lcount; k++) {
+    int n = atoi(lkeys[k] + 2);
+    tbad += splinter_store_get_tags(st3, lkeys[k], &tags) != 0 || (tags & s42) != s42;
+    tlisted += n % 3 == 0 && n != 3 && n != 9 && n != 12;
+  }
+  TEST("find_tagged returns a slot bitmap of exactly the live keys carrying every bit",
+    chain_ok && tfound == 197 && (int)lcount == tfound && tlisted == 197 && tbad == 0 &&
+    splinter_store_find_tagged(st3, s42 | red, tbits, 16) == 40 &&
+    splinter_store_find_tagged(st3, s42, tbits, 15) == -1 && errno == ERANGE &&
+    splinter_store_find_tagged(st3, 0, tbits, 16) == -2);
+  // resize while the tags stay with their keys, then watch a tag
+  chain_ok = splinter_store_resize(st3, 2048) == 0 &&
+             splinter_store_find_tagged(st3, red, tbits, 16) == -1 && errno == ERANGE;
+  uint64_t tbig[32];
+  int tred = chain_ok ? splinter_store_find_tagged(st3, red, tbig, 32) : -1;
+  splinter_watch_t *tw = splinter_store_watch_create(st3);
+  const char *ttags[] = { "session:42", "color:red" };
+  splinter_watch_event_t tev[4];
+  int twatched = tw ? splinter_watch_add_tagged(tw, ttags, 2) : -1;
+  TEST("tags move with their keys in a resize, and tagged keys can be watched",
+    tred == 121 && twatched == 40 && splinter_store_set(st3, "tk30", "w", 1) == 0 &&
+    splinter_store_set(st3, "tk31", "w", 1) == 0 && splinter_watch_wait(tw, 1000, tev, 4) == 1 &&
+    strcmp(tev[0].key, "tk30") == 0);
+  splinter_watch_destroy(tw);
+  splinter_store_close(st3);
+  unlink(buspath);
+
+  // Embeddings: 37 floats, so rows carry padding
+  splinter_create_opts_t vopts = { .slots = 2000, .max_value_sz = 32, .embed_dim = EMBED_DIM };
+  float evec[EMBED_DIM], eout[EMBED_DIM], equery[EMBED_DIM];
+  uint64_t eepoch = 0;
+  st3 = splinter_store_create_ex(bus3, &vopts);
+  chain_ok = st3 != NULL;
+  for (i = 0; chain_ok && i < 1200; i++) {
+    snprintf(rkey, sizeof(rkey), "emb%d", i);
+    embed_fill(evec, i);
+    chain_ok = splinter_store_set_with_embeddings(st3, rkey, "v", 1, evec) == 0;
+  }
+  chain_ok = chain_ok && splinter_store_set(st3, "plain", "p", 1) == 0 &&
+             splinter_store_get_slot_snapshot(st3, "emb7", &snap1) == 0;
+  eepoch = snap1.epoch;
+  embed_fill(evec, 7);
+  TEST("embeddings are stored with a key's value, kept by plain sets and replaced on their own",
+    chain_ok && splinter_store_get_embeddings(st3, "emb7", eout) == 0 &&
+    memcmp(eout, evec, sizeof(evec)) == 0 && splinter_store_set(st3, "emb7", "w", 1) == 0 &&
+    splinter_store_get_embeddings(st3, "emb7", eout) == 0 && memcmp(eout, evec, sizeof(evec)) == 0 &&
+    (embed_fill(evec, 9999), splinter_store_set_embeddings(st3, "emb7", evec)) == 0 &&
+    splinter_store_get_embeddings(st3, "emb7", eout) == 0 && memcmp(eout, evec, sizeof(evec)) == 0 &&
+    splinter_store_get_slot_snapshot(st3, "emb7", &snap1) == 0 && snap1.epoch > eepoch &&
+    splinter_store_get_with_embeddings(st3, "emb7", buf, sizeof(buf), &out_sz, eout) == 0 &&
+    out_sz == 1 && buf[0] == 'w' && memcmp(eout, evec, sizeof(evec)) == 0 &&
+    splinter_store_get_embeddings(st3, "plain", eout) == -1 && errno == ENODATA &&
+    splinter_store_set_embeddings(st3, "nope", evec) == -1 && errno == ENOENT &&
+    splinter_store_get_header_snapshot(st3, &hsnap) == 0 && hsnap.embed_dim == EMBED_DIM &&
+    splinter_get_embeddings("emb7", eout) == -1 && errno == ENOTSUP);
+  // emb7 now holds vector 9999; ask for something close to emb500, and drop emb501
+  embed_fill(equery, 500);
+  for (i = 0; i < EMBED_DIM; i++) equery[i] += i % 2 ? 0.01f : -0.01f;
+  chain_ok = splinter_store_unset(st3, "emb501") > 0;
+  splinter_knn_hit_t ehits[16], ehits4[16];
+  int emetric, eok = chain_ok;
+  for (emetric = SPLINTER_METRIC_DOT; eok && emetric <= SPLINTER_METRIC_L2; emetric++) {
+    int n1 = splinter_store_knn(st3, equery, 10, emetric, 1, ehits);
+    int n4 = splinter_store_knn(st3, equery, 10, emetric, 4, ehits4);
+    eok = n1 == 10 && n4 == 10;
+    for (int h = 0; eok && h < 10; h++) {
+      int n = atoi(ehits[h].key + 3);
+      embed_fill(evec, n == 7 ? 9999 : n);
+      double want = embed_score(equery, evec, emetric);
+      eok = strcmp(ehits[h].key, ehits4[h].key) == 0 && n != 501 &&
+            __builtin_fabs(want - ehits[h].score) < 1e-4 * (1 + __builtin_fabs(want)) &&
+            (h == 0 || (emetric == SPLINTER_METRIC_L2 ? ehits[h].score >= ehits[h - 1].score :
+                                                         ehits[h].score <= ehits[h - 1].score));
+    }
+    // only the other nine hits score better than the last one
+    int ebetter = 0;
+    for (int n = 0; eok && n < 1200; n++) {
+      if (n == 501) continue;
+      embed_fill(evec, n == 7 ? 9999 : n);
+      double sc = embed_score(equery, evec, emetric);
+      ebetter += emetric == SPLINTER_METRIC_L2 ? sc < ehits[9].score - 1e-4 : sc > ehits[9].score + 1e-4;
+    }
+    eok = eok && ebetter <= 9;
+    if (emetric != SPLINTER_METRIC_DOT) eok = eok && strcmp(ehits[0].key, "emb500") == 0;
+  }
+  TEST("knn finds the same nearest keys as a brute-force check, for every metric and thread count",
+    eok && splinter_store_knn(st3, equery, 0, SPLINTER_METRIC_DOT, 1, ehits) == -2 &&
+    splinter_store_knn(st3, equery, 1, 7, 1, ehits) == -2);
+  chain_ok = splinter_store_resize(st3, 4096) == 0;
+  int eall = chain_ok ? splinter_store_knn(st3, equery, 16, SPLINTER_METRIC_COSINE, 0, ehits) : -1;
+  embed_fill(evec, 1199);
+  TEST("embeddings move with their keys in a resize",
+    eall == 16 && strcmp(ehits[0].key, "emb500") == 0 &&
+    splinter_store_get_embeddings(st3, "emb1199", eout) == 0 && memcmp(eout, evec, sizeof(evec)) == 0 &&
+    splinter_store_get_embeddings(st3, "emb501", eout) == -1 && errno == ENOENT);
+  splinter_store_close(st3);
+#ifndef SPLINTER_PERSISTENT
+  snprintf(buspath, sizeof(buspath) -1, "/dev/shm/%s", bus3);
+#else
+  snprintf(buspath, sizeof(buspath) -1, "./%s", bus3);
+#endif /* SPLINTER_PERSISTENT */
+  unlink(buspath);
+
+  // HNSW: recall against brute force at a few ef operating points
+  splinter_create_opts_t nopts = { .slots = 8192, .max_value_sz = 16, .embed_dim = EMBED_DIM,
+                                   .ann_m = 16, .ann_metric = SPLINTER_METRIC_L2 };
+  splinter_knn_hit_t gtruth[10], ghits[64];
+  const unsigned int gefs[] = { 10, 40, 160 };
+  double grecall[3] = { 0 };
+  struct timespec g0, g1;
+  int gq, gn, gok;
+  st3 = splinter_store_create_ex(bus3, &nopts);
+  chain_ok = st3 != NULL;
+  clock_gettime(CLOCK_MONOTONIC, &g0);
+  for (i = 0; chain_ok && i < 5000; i++) {
+    snprintf(rkey, sizeof(rkey), "emb%d", i);
+    embed_fill(evec, i);
+    chain_ok = splinter_store_set_with_embeddings(st3, rkey, "v", 1, evec) == 0;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &g1);
+  printf("# ann build: 5000 x %d floats, M=16, %.1f us/insert\n", EMBED_DIM,
+    ((g1.tv_sec - g0.tv_sec) * 1e9 + (g1.tv_nsec - g0.tv_nsec)) / 1e3 / 5000);
+  gok = chain_ok;
+  for (unsigned int e = 0; gok && e < 3; e++) {
+    int ghit = 0;
+    long gns = 0;
+    for (gq = 0; gok && gq < 50; gq++) {
+      embed_fill(equery, 100000 + gq);
+      gok = splinter_store_knn(st3, equery, 10, SPLINTER_METRIC_L2, 1, gtruth) == 10;
+      clock_gettime(CLOCK_MONOTONIC, &g0);
+      gn = splinter_store_ann(st3, equery, 10, gefs[e], ghits);
+      clock_gettime(CLOCK_MONOTONIC, &g1);
+      gns += (g1.tv_sec - g0.tv_sec) * 1000000000L + (g1.tv_nsec - g0.tv_nsec);
+      gok = gok && gn == 10;
+      for (int a = 0; gok && a < 10; a++)
+        for (int b = 0; b < 10; b++)
+          ghit += strcmp(ghits[a].key, gtruth[b].key) == 0;
+    }
+    grecall[e] = ghit / 500.0;
+    printf("# ann ef=%u recall@10=%.3f %.1f us/query\n", gefs[e], grecall[e], gns / 1e3 / 50);
+  }
+  TEST("ann recall against brute force rises with ef and is high at ef=160",
+    gok && grecall[2] >= 0.95 && grecall[2] >= grecall[0] &&
+    splinter_store_get_header_snapshot(st3, &hsnap) == 0 && hsnap.ann_m == 16 &&
+    hsnap.ann_ef_construction == 100 && hsnap.ann_ef_search == 64 && hsnap.ann_metric == SPLINTER_METRIC_L2);
+  // a key's own vector finds it first; deleted keys are routed through but never returned
+  embed_fill(equery, 1234);
+  chain_ok = splinter_store_ann(st3, equery, 1, 0, ghits) == 1 && strcmp(ghits[0].key, "emb1234") == 0 &&
+             ghits[0].score < 1e-6 && splinter_store_unset(st3, "emb1234") > 0;
+  gn = chain_ok ? splinter_store_ann(st3, equery, 32, 0, ghits) : -1;
+  gok = gn == 32;
+  for (int a = 0; gok && a < gn; a++)
+    gok = strcmp(ghits[a].key, "emb1234") != 0 && (a == 0 || ghits[a].score >= ghits[a - 1].score);
+  embed_fill(equery, 777777);
+  TEST("ann follows updates and deletes, and checks its arguments",
+    gok && splinter_store_set_embeddings(st3, "emb42", equery) == 0 &&
+    splinter_store_ann(st3, equery, 1, 0, ghits) == 1 && strcmp(ghits[0].key, "emb42") == 0 &&
+    splinter_store_set_with_embeddings(st3, "emb1234", "v", 1, equery) == 0 &&
+    splinter_store_ann(st3, equery, 2, 0, ghits) == 2 && ghits[1].score < 1e-6 &&
+    splinter_store_ann(st3, equery, 0, 0, ghits) == -2 &&
+    splinter_ann(equery, 1, 0, ghits) == -1 && errno == ENOTSUP &&
+    (nopts.ann_m = 1, splinter_store_create_ex("ann-bad", &nopts)) == NULL && errno == ENOTSUP &&
+    (nopts.ann_m = 16, nopts.embed_dim = 0, splinter_store_create_ex("ann-bad", &nopts)) == NULL &&
+    errno == ENOTSUP);
+  // the new table's graph is built as the keys move
+  chain_ok = splinter_store_resize(st3, 16384) == 0;
+  gok = chain_ok;
+  for (gq = 0; gok && gq < 50; gq++) {
+    int n = gq * 97 + 3;
+    if (n == 42 || n == 1234) continue;
+    snprintf(rkey, sizeof(rkey), "emb%d", n);
+    embed_fill(equery, n);
+    gok = splinter_store_ann(st3, equery, 1, 0, ghits) == 1 && strcmp(ghits[0].key, rkey) == 0;
+  }
+  TEST("ann finds keys by their own vectors after a resize", gok);
+  splinter_store_close(st3);
+
+  // Closing a store with watch sets still open stops them; they're destroyed after
+  const char *cwkeys[] = { "cw1" };
+  splinter_watch_event_t cev[2];
+  unlink(buspath);
+  st3 = splinter_store_create(bus3, 64, 32);
+  splinter_watch_t *cw = st3 ? splinter_store_watch_create(st3) : NULL;
+  splinter_watch_t *dw = splinter_watch_create();
+  chain_ok = cw && dw && splinter_watch_add(cw, cwkeys, 1) == 0 && splinter_watch_fd(cw) >= 0 &&
+             splinter_watch_add(dw, cwkeys, 1) == 0 && splinter_watch_fd(dw) >= 0 &&
+             splinter_store_set(st3, "cw1", "x", 1) == 0;
+  splinter_store_close(st3);
+  int cw_rc = splinter_watch_wait(cw, 0, cev, 2), cw_err = errno;
+  splinter_watch_destroy(cw);
+#ifndef SPLINTER_PERSISTENT
+  snprintf(buspath, sizeof(buspath) -1, "/dev/shm/%s", bus3);
+#else
+  snprintf(buspath, sizeof(buspath) -1, "./%s", bus3);
+#endif /* SPLINTER_PERSISTENT */
+  unlink(buspath);
+
   // Cleanup
   splinter_close();
+  TEST("closing a store releases its watch sets, which fail with EBADF until destroyed",
+    chain_ok && cw_rc == -1 && cw_err == EBADF &&
+    splinter_watch_wait(dw, 0, cev, 2) == -1 && errno == EBADF &&
+    splinter_watch_add(dw, cwkeys, 1) == -1 && errno == EBADF && splinter_watch_fd(dw) == -1);
+  splinter_watch_destroy(dw);
 
 #ifndef SPLINTER_PERSISTENT
   snprintf(buspath, sizeof(buspath) -1, "/dev/shm/%s", bus);
@@ -123,6 +1105,18 @@ int main(void) {
   snprintf(buspath, sizeof(buspath) -1, "./%s", bus);
 #endif /* SPLINTER_PERSISTENT */
   unlink(buspath);
+#ifndef SPLINTER_PERSISTENT
+  snprintf(buspath, sizeof(buspath) -1, "/dev/shm/%s", bus2);
+#else
+  snprintf(buspath, sizeof(buspath) -1, "./%s", bus2);
+#endif /* SPLINTER_PERSISTENT */
+  unlink(buspath);
+#ifndef SPLINTER_PERSISTENT
+  snprintf(buspath, sizeof(buspath) -1, "/dev/shm/%s", bus3);
+#else
+  snprintf(buspath, sizeof(buspath) -1, "./%s", bus3);
+#endif /* SPLINTER_PERSISTENT */
+  unlink(buspath);
 
 #ifdef HAVE_VALGRIND_H
   if (RUNNING_ON_VALGRIND) {